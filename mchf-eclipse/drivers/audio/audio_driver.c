@@ -38,6 +38,7 @@
 #include "uhsdr_hw_i2s.h"
 #include "rtty.h"
 #include "psk.h"
+#include "ft8.h"
 #include "cw_decoder.h"
 #include "freedv_uhsdr.h"
 #include "freq_shift.h"
@@ -66,6 +67,28 @@ typedef struct
 } LMSData;
 #endif
 
+#ifdef USE_SPECTRUM_FFT_2048
+// Polyphase decimator for Zoom FFT
+// a single linear phase FIR lowpass for the whole decimation, of which we only calculate
+// every decimation-th output sample. Works for any integer decimation and any block size.
+#define ZOOM_DECIM_TAPS_PER_PHASE   24
+#define ZOOM_DECIM_TAPS_MAX         (ZOOM_DECIM_TAPS_PER_PHASE * (1 << MAGNIFY_MAX))
+
+typedef struct
+{
+    uint16_t decimation;
+    uint16_t num_taps;
+    uint16_t phase;     // input samples received since the last output sample
+    uint16_t pos;       // position of the oldest sample in the delay lines
+    float32_t coeffs[ZOOM_DECIM_TAPS_MAX];
+    // delay lines hold each sample twice (at pos and pos + num_taps),
+    // so the last num_taps samples are always contiguous
+    float32_t state_i[2 * ZOOM_DECIM_TAPS_MAX];
+    float32_t state_q[2 * ZOOM_DECIM_TAPS_MAX];
+} ZoomDecimator;
+
+static ZoomDecimator zoom_decim;
+#else
 // Decimator for Zoom FFT
 static	arm_fir_decimate_instance_f32	DECIMATE_ZOOM_FFT_I;
 float32_t			__MCHF_SPECIALMEM decimZoomFFTIState[FIR_RXAUDIO_BLOCK_SIZE + FIR_RXAUDIO_NUM_TAPS];
@@ -73,6 +96,7 @@ float32_t			__MCHF_SPECIALMEM decimZoomFFTIState[FIR_RXAUDIO_BLOCK_SIZE + FIR_RX
 // Decimator for Zoom FFT
 static	arm_fir_decimate_instance_f32	DECIMATE_ZOOM_FFT_Q;
 float32_t			__MCHF_SPECIALMEM decimZoomFFTQState[FIR_RXAUDIO_BLOCK_SIZE + FIR_RXAUDIO_NUM_TAPS];
+#endif
 
 // Audio RX - Interpolator
 static	arm_fir_interpolate_instance_f32 INTERPOLATE_RX[NUM_AUDIO_CHANNELS];
@@ -161,6 +185,7 @@ static arm_biquad_casd_df1_inst_f32 IIR_biquad_2[NUM_AUDIO_CHANNELS] =
 };
 
 
+#ifndef USE_SPECTRUM_FFT_2048
 // variables for ZoomFFT lowpass filtering
 static arm_biquad_casd_df1_inst_f32 IIR_biquad_Zoom_FFT_I =
 {
@@ -189,6 +214,7 @@ static arm_biquad_casd_df1_inst_f32 IIR_biquad_Zoom_FFT_Q =
             0,0,0,0,   0,0,0,0,   0,0,0,0,   0,0,0,0
         } // 4 x 4 = 16 state variables
 };
+#endif
 
 // sr = 12ksps, Fstop = 2k7, we lowpass-filtered the audio already in the main aido path (IIR),
 // so only the minimum size filter (4 taps) is used here
@@ -201,6 +227,7 @@ static float32_t NR_interpolate_coeffs [NR_INTERPOLATE_NO_TAPS] = {-495.07575866
 // 6ksps, Fstop = 2k65, KAISER
 //static float32_t NR_interpolate_coeffs [NR_INTERPOLATE_NO_TAPS] = {-903.6623076669911820E-6, 0.001594488333496738,-0.002320508982899863, 0.002832351511451895,-0.002797105957386612, 0.001852836963547170, 308.6133633078010230E-6,-0.003842008360761881, 0.008649943961959465,-0.014305251526745446, 0.020012524686320185,-0.024618364878703208, 0.026664997481476788,-0.024458388333600374, 0.016080841021827566, 818.1032282579135430E-6,-0.029933800539235892, 0.079833661336890141,-0.182038248016552551, 0.626273078268197225, 0.626273078268197225,-0.182038248016552551, 0.079833661336890141,-0.029933800539235892, 818.1032282579135430E-6, 0.016080841021827566,-0.024458388333600374, 0.026664997481476788,-0.024618364878703208, 0.020012524686320185,-0.014305251526745446, 0.008649943961959465,-0.003842008360761881, 308.6133633078010230E-6, 0.001852836963547170,-0.002797105957386612, 0.002832351511451895,-0.002320508982899863, 0.001594488333496738,-903.6623076669911820E-6};
 
+#ifndef USE_SPECTRUM_FFT_2048
 static float32_t* mag_coeffs[MAGNIFY_NUM] =
 {
 
@@ -361,6 +388,7 @@ static float32_t* mag_coeffs[MAGNIFY_NUM] =
             -0.993055129539134551
         }
 };
+#endif
 
 #ifdef USE_SIMPLE_FREEDV_FILTERS
 //******* From here 2 set of filters for the I/Q FreeDV aliasing filter**********
@@ -1052,6 +1080,65 @@ static void AudioDriver_SetRxTxAudioProcessingAudioFilters(uint8_t dmod_mode)
 /**
  * Sets up the spectrum filters according to the current zoom level
  */
+#ifdef USE_SPECTRUM_FFT_2048
+/**
+ * Designs the zoom FFT decimation lowpass as Blackman windowed sinc with the cutoff at the
+ * Nyquist frequency of the decimated signal and resets the decimator.
+ *
+ * @param decimation any integer from 1 to 2^MAGNIFY_MAX
+ */
+static void AudioDriver_ZoomDecimatorInit(ZoomDecimator* zd, uint16_t decimation)
+{
+    zd->decimation = decimation;
+    zd->num_taps = ZOOM_DECIM_TAPS_PER_PHASE * decimation;
+    zd->phase = 0;
+    zd->pos = 0;
+
+    const float32_t fc = 0.5 / decimation; // relative to the input sample rate
+    const float32_t center = (zd->num_taps - 1) / 2.0;
+    float32_t sum = 0;
+
+    for (int n = 0; n < zd->num_taps; n++)
+    {
+        const float32_t t = n - center;
+        const float32_t sinc = t == 0 ? 1.0 : sinf(2 * PI * fc * t) / (2 * PI * fc * t);
+        const float32_t window = 0.42 - 0.5 * cosf(2 * PI * n / (zd->num_taps - 1)) + 0.08 * cosf(4 * PI * n / (zd->num_taps - 1));
+        zd->coeffs[n] = sinc * window;
+        sum += zd->coeffs[n];
+    }
+    // unity gain at DC. The filter is symmetric, so we don't have to reverse it for the convolution
+    arm_scale_f32(zd->coeffs, 1.0 / sum, zd->coeffs, zd->num_taps);
+
+    memset(zd->state_i, 0, sizeof(zd->state_i));
+    memset(zd->state_q, 0, sizeof(zd->state_q));
+}
+
+/**
+ * Lowpass filters and decimates a block of IQ samples
+ * @returns number of samples placed in dst, may vary from block to block if blockSize is not a multiple of the decimation
+ */
+static uint16_t AudioDriver_ZoomDecimatorRun(ZoomDecimator* zd, iq_buffer_t* src, iq_buffer_t* dst, const uint16_t blockSize)
+{
+    uint16_t out = 0;
+
+    for (uint16_t idx = 0; idx < blockSize; idx++)
+    {
+        zd->state_i[zd->pos] = zd->state_i[zd->pos + zd->num_taps] = src->i_buffer[idx];
+        zd->state_q[zd->pos] = zd->state_q[zd->pos + zd->num_taps] = src->q_buffer[idx];
+        zd->pos = zd->pos + 1 < zd->num_taps ? zd->pos + 1 : 0;
+
+        if (++zd->phase == zd->decimation)
+        {
+            zd->phase = 0;
+            arm_dot_prod_f32(&zd->state_i[zd->pos], zd->coeffs, zd->num_taps, &dst->i_buffer[out]);
+            arm_dot_prod_f32(&zd->state_q[zd->pos], zd->coeffs, zd->num_taps, &dst->q_buffer[out]);
+            out++;
+        }
+    }
+    return out;
+}
+#endif
+
 static void AudioDriver_Spectrum_Set()
 {
     // this sets the coefficients for the ZoomFFT decimation filter
@@ -1062,6 +1149,10 @@ static void AudioDriver_Spectrum_Set()
         sd.magnify = MAGNIFY_MIN;
     }
 
+#ifdef USE_SPECTRUM_FFT_2048
+    AudioDriver_ZoomDecimatorInit(&zoom_decim, 1 << sd.magnify);
+#else
+
     // for 0 the mag_coeffs will a NULL  ptr, since the filter is not going to be used in this  mode!
     IIR_biquad_Zoom_FFT_I.pCoeffs = mag_coeffs[sd.magnify];
     IIR_biquad_Zoom_FFT_Q.pCoeffs = mag_coeffs[sd.magnify];
@@ -1083,6 +1174,7 @@ static void AudioDriver_Spectrum_Set()
             FirZoomFFTDecimate[sd.magnify].pCoeffs,
             decimZoomFFTQState,            // Filter state variables
             FIR_RXAUDIO_BLOCK_SIZE);
+#endif
 }
 
 /**
@@ -1323,6 +1415,20 @@ static void AudioDriver_NoiseBlanker(AudioSample_t * const src, int16_t blockSiz
 
 
 #ifdef USE_FREEDV
+#define FDV_RX_FACTOR_DECIMATE (IQ_SAMPLE_RATE/8000) // 6x @ 48ksps
+#define FDV_RX_FACTOR_INTERPOLATE (AUDIO_SAMPLE_RATE/8000) // 6x @ 48ksps
+// a block of n samples contains at most ceil(n/factor) sample positions with a wrapped modulus
+#define FDV_RX_SAMPLES_MAX ((IQ_BLOCK_SIZE + FDV_RX_FACTOR_DECIMATE - 1) / FDV_RX_FACTOR_DECIMATE)
+#define FDV_RX_AUDIO_MAX ((AUDIO_BLOCK_SIZE + FDV_RX_FACTOR_INTERPOLATE - 1) / FDV_RX_FACTOR_INTERPOLATE)
+
+// kept off the interrupt stack, only used from the audio interrupt
+#ifdef USE_SIMPLE_FREEDV_FILTERS
+static fdv_iq_rb_item_t fdv_rx_samples[FDV_RX_SAMPLES_MAX];
+#else
+static fdv_demod_rb_item_t fdv_rx_samples[FDV_RX_SAMPLES_MAX];
+#endif
+static int16_t fdv_rx_audio[FDV_RX_AUDIO_MAX];
+
 /**
  * @returns: true if digital signal should be used (no analog processing should be done), false -> analog processing maybe used
  * since no digital signal was detected.
@@ -1337,8 +1443,8 @@ static bool AudioDriver_RxProcessorFreeDV (iq_buffer_t* iq_buf_p, float32_t * co
     static bool bufferFilled;
     static float32_t History[3]={0.0,0.0,0.0};
 
-    const int32_t factor_Decimate = IQ_SAMPLE_RATE/8000; // 6x @ 48ksps
-    const int32_t factor_Interpolate = AUDIO_SAMPLE_RATE/8000; // 6x @ 48ksps
+    const int32_t factor_Decimate = FDV_RX_FACTOR_DECIMATE;
+    const int32_t factor_Interpolate = FDV_RX_FACTOR_INTERPOLATE;
 
     bool lsb_active = RadioManagement_LSBActive(ts.dmod_mode);
 
@@ -1361,6 +1467,9 @@ static bool AudioDriver_RxProcessorFreeDV (iq_buffer_t* iq_buf_p, float32_t * co
 #endif
 
     // DOWNSAMPLING
+    // collect the decimated samples of this block and hand them over to FreeDV in a single copy
+    int16_t fdv_samples_num = 0;
+
     for (int k = 0; k < blockSize; k++)
     {
         if (modulus_Decimate == 0)  //every nth sample has to be catched -> downsampling
@@ -1370,19 +1479,14 @@ static bool AudioDriver_RxProcessorFreeDV (iq_buffer_t* iq_buf_p, float32_t * co
             // 10 for normal RX, 1000 for USB PC debugging
 
 #ifdef USE_SIMPLE_FREEDV_FILTERS
-            fdv_iq_rb_item_t sample;
             // this is the USB demodulation I + Q
-
-            sample.real = real_buffer[k] * f32_to_i16_gain;
-            sample.imag = imag_buffer[k] * f32_to_i16_gain;
-            RingBuffer_PutSamples(&fdv_iq_rb, &sample, 1);
-
+            fdv_rx_samples[fdv_samples_num].real = real_buffer[k] * f32_to_i16_gain;
+            fdv_rx_samples[fdv_samples_num].imag = imag_buffer[k] * f32_to_i16_gain;
 #else
-            int16_t sample;
             // this is the USB demodulation I + Q
-            sample = (real_buffer[k] + imag_buffer[k]) * f32_to_i16_gain;
-            RingBuffer_PutSamples(&fdv_demod_rb, &sample, 1);
+            fdv_rx_samples[fdv_samples_num] = (real_buffer[k] + imag_buffer[k]) * f32_to_i16_gain;
 #endif
+            fdv_samples_num++;
         }
 
         // increment and wrap
@@ -1393,6 +1497,12 @@ static bool AudioDriver_RxProcessorFreeDV (iq_buffer_t* iq_buf_p, float32_t * co
         }
     }
 
+#ifdef USE_SIMPLE_FREEDV_FILTERS
+    RingBuffer_PutSamples(&fdv_iq_rb, fdv_rx_samples, fdv_samples_num);
+#else
+    RingBuffer_PutSamples(&fdv_demod_rb, fdv_rx_samples, fdv_samples_num);
+#endif
+
 
     // if we run out  of buffers lately
     // we wait for availability of at least 2 buffers
@@ -1405,8 +1515,15 @@ static bool AudioDriver_RxProcessorFreeDV (iq_buffer_t* iq_buf_p, float32_t * co
         bufferFilled = true;
     }
 
-    if (bufferFilled == true && RingBuffer_GetData(&fdv_audio_rb) >= (modulus_Interpolate != 0?5:6)) // freeDV encode has finished (running in ui_driver.c)?
+    // number of 8k samples consumed by this block: one at every position where modulus_Interpolate wraps to 0
+    const int32_t first_sample_idx = (factor_Interpolate - modulus_Interpolate) % factor_Interpolate;
+    const int32_t fdv_audio_num = first_sample_idx < blockSize ? (blockSize - 1 - first_sample_idx) / factor_Interpolate + 1 : 0;
+
+    if (bufferFilled == true && RingBuffer_GetData(&fdv_audio_rb) >= fdv_audio_num) // freeDV encode has finished (running in ui_driver.c)?
     {
+        int32_t fdv_audio_idx = 0;
+        RingBuffer_GetSamples(&fdv_audio_rb, fdv_rx_audio, fdv_audio_num);
+
         // Best thing here would be to use the arm_fir_decimate function! Why?
         // --> we need phase linear filters, because we have to filter I & Q and preserve their phase relationship
         // IIR filters are power saving, but they do not care about phase, so useless at this point
@@ -1425,9 +1542,7 @@ static bool AudioDriver_RxProcessorFreeDV (iq_buffer_t* iq_buf_p, float32_t * co
 
             if (modulus_Interpolate == 0)
             {
-                int16_t sample_in;
-                RingBuffer_GetSamples(&fdv_audio_rb, &sample_in, 1);
-                sample = (float32_t)sample_in * 0.25;
+                sample = (float32_t)fdv_rx_audio[fdv_audio_idx++] * 0.25;
                 // we scale samples down to align this with other demodulators
                 // TODO: find out correct scaling val, not just a rough estimation
             }
@@ -1452,8 +1567,12 @@ static bool AudioDriver_RxProcessorFreeDV (iq_buffer_t* iq_buf_p, float32_t * co
     }
     else
     {
+        // we only count real underruns, not the initial filling of the buffer
+        if (bufferFilled == true)
+        {
+            profileEvent(FreeDVRXUnderrun);
+        }
         bufferFilled = false;
-        profileEvent(FreeDVTXUnderrun);
     }
     if (retval == false && freedv_conf.mute_if_squelched == true)
     {
@@ -1470,20 +1589,13 @@ static bool AudioDriver_RxProcessorFreeDV (iq_buffer_t* iq_buf_p, float32_t * co
 #ifdef USE_RTTY_PROCESSOR
 static void AudioDriver_RxProcessor_Rtty(float32_t * const src, int16_t blockSize)
 {
-    for (uint16_t idx = 0; idx < blockSize; idx++)
-    {
-        Rtty_Demodulator_ProcessSample(src[idx]);
-    }
+    Rtty_Demodulator_ProcessBlock(src, blockSize);
 }
 #endif
 
 static void AudioDriver_RxProcessor_Bpsk(float32_t * const src, int16_t blockSize)
 {
-
-    for (uint16_t idx = 0; idx < blockSize; idx++)
-    {
-        Psk_Demodulator_ProcessSample(src[idx]);
-    }
+    Psk_Demodulator_ProcessBlock(src, blockSize);
 }
 
 
@@ -1508,9 +1620,11 @@ static void AudioDriver_RxProcessor_Bpsk(float32_t * const src, int16_t blockSiz
 
 #define FM_TONE_DETECT_ALPHA    0.9                     // setting for IIR filtering of ratiometric result from frequency-differential tone detection
 
-#define FM_SUBAUDIBLE_TONE_DET_THRESHOLD    1.75        // threshold of "smoothed" output of Goertzel, above which a tone is considered to be "provisionally" detected pending debounce
-#define FM_SUBAUDIBLE_DEBOUNCE_MAX          5           // maximum "detect" count in debounce
-#define FM_SUBAUDIBLE_TONE_DEBOUNCE_THRESHOLD   2       // number of debounce counts at/above which a tone detection is considered valid
+#define FM_SUBAUDIBLE_TONE_DET_THRESHOLD    1.75        // threshold of "smoothed" output of the tone detector, above which a detected tone is considered to be still present
+#define FM_SUBAUDIBLE_TONE_OPEN_THRESHOLD   3.0         // threshold above which a tone is considered to be "provisionally" detected pending debounce, if no tone is detected yet
+#define FM_SUBAUDIBLE_UPDATE_SAMPLES        75          // decimated samples between two evaluations of the tone detector (25ms)
+#define FM_SUBAUDIBLE_DEBOUNCE_MAX          8           // maximum "detect" count in debounce
+#define FM_SUBAUDIBLE_TONE_DEBOUNCE_THRESHOLD   4       // number of debounce counts at/above which a tone detection is considered valid
 
 
 typedef struct
@@ -1524,7 +1638,9 @@ typedef struct
     float subdet;                // used for tone detection
     uint8_t count;
     uint8_t tdet;// used for squelch processing and debouncing tone detection, respectively
-    ulong gcount;            // used for averaging in tone detection
+    ulong gcount;            // decimated samples since the last evaluation of the tone detector
+    float32_t tone_acc;          // sum of the samples of the current decimation step
+    uint8_t tone_acc_count;
 
 } demod_fm_data_t;
 
@@ -1543,7 +1659,7 @@ demod_fm_data_t fm_data;
  */
  static bool AudioDriver_DemodFM(const float32_t* i_buffer, const float32_t* q_buffer, float32_t* a_buffer, const int16_t blockSize)
 {
-	float32_t goertzel_buf[blockSize], squelch_buf[blockSize];
+	float32_t subtone_buf[blockSize], squelch_buf[blockSize];
 
 	if (ts.iq_freq_mode != FREQ_IQ_CONV_MODE_OFF)// bail out if translate mode is not active
 	{
@@ -1566,7 +1682,7 @@ demod_fm_data_t fm_data;
 			float32_t a = fm_data.lpf_prev + (FM_RX_LPF_ALPHA * (angle - fm_data.lpf_prev));	//
 			fm_data.lpf_prev = a;			// save "[n-1]" sample for next iteration
 
-			goertzel_buf[i] = a;	// save in "c" for subaudible tone detection
+			subtone_buf[i] = a;	// save in "c" for subaudible tone detection
 
 			if (((!ads.fm_conf.squelched) && (!tone_det_enabled))
 					|| ((ads.fm_conf.subaudible_tone_detected) && (tone_det_enabled))
@@ -1665,43 +1781,49 @@ demod_fm_data_t fm_data;
 		if (tone_det_enabled)// is subaudible tone detection enabled?  If so, do decoding
 		{
 			//
-			// Use Goertzel algorithm for subaudible tone detection
+			// Use sliding DFTs for subaudible tone detection
 			//
 			// We will detect differentially at three frequencies:  Above, below and on-frequency.  The two former will be used to provide a sample of the total energy
 			// present as well as improve nearby-frequency discrimination.  By dividing the on-frequency energy with the averaged off-frequency energy we'll
 			// get a ratio that is irrespective of the actual detected audio amplitude:  A ratio of 1.00 is considered "neutral" and it goes above unity with the increasing
 			// likelihood that a tone was present on the target frequency
 			//
-			// Goertzel constants for the three decoders are pre-calculated in the function "UiCalcSubaudibleDetFreq()"
-			//
-			// (Yes, I know that below could be rewritten to be a bit more compact-looking, but it would not be much faster and it would be less-readable)
+			// Sliding DFT constants for the three decoders are pre-calculated in the function "AudioManagement_CalcSubaudibleDetFreq()"
 			//
-			// Note that the "c" buffer contains audio that is somewhat low-pass filtered by the integrator, above
+			// The sliding DFTs always hold the last FM_SUBAUDIBLE_SDFT_SIZE samples, so the ratio is evaluated every 25ms instead of once
+			// per window. A tone is detected as soon as enough of it is in the window and lost shortly after it ends.
+			// The higher threshold to detect a tone than to keep it keeps the overlapping windows of noise from opening the squelch.
 			//
-		    fm_data.gcount++;// this counter is used for the accumulation of data over multiple cycles
+			// Note that the "c" buffer contains audio that is somewhat low-pass filtered by the integrator, above, so averaging
+			// FM_SUBAUDIBLE_DECIMATION samples is good enough for the decimation
 			//
 			for (uint16_t i = 0; i < blockSize; i++)
 			{
-
-				// Detect above target frequency
-				AudioFilter_GoertzelInput(&ads.fm_conf.goertzel[FM_HIGH],goertzel_buf[i]);
-				// Detect energy below target frequency
-				AudioFilter_GoertzelInput(&ads.fm_conf.goertzel[FM_LOW],goertzel_buf[i]);
-				// Detect on-frequency energy
-				AudioFilter_GoertzelInput(&ads.fm_conf.goertzel[FM_CTR],goertzel_buf[i]);
+				fm_data.tone_acc += subtone_buf[i];
+				fm_data.tone_acc_count++;
+				if (fm_data.tone_acc_count == FM_SUBAUDIBLE_DECIMATION)
+				{
+					AudioFilter_SlidingDftInput(&ads.fm_conf.tone_det, &fm_data.tone_acc, 1);
+					fm_data.tone_acc = 0;
+					fm_data.tone_acc_count = 0;
+					fm_data.gcount++;
+				}
 			}
 
-			if (fm_data.gcount >= FM_SUBAUDIBLE_GOERTZEL_WINDOW)// have we accumulated enough samples to do the final energy calculation?
+			if (fm_data.gcount >= FM_SUBAUDIBLE_UPDATE_SAMPLES)// time for the next evaluation?
 			{
-				float32_t s = AudioFilter_GoertzelEnergy(&ads.fm_conf.goertzel[FM_HIGH]) + AudioFilter_GoertzelEnergy(&ads.fm_conf.goertzel[FM_LOW]);
+				float32_t mag[3];
+				AudioFilter_SlidingDftMagnitudes(&ads.fm_conf.tone_det, mag);
+
+				float32_t s = mag[FM_HIGH] + mag[FM_LOW];
 				// sum +/- energy levels:
 				// s = "off frequency" energy reading
 
-				float32_t r = AudioFilter_GoertzelEnergy(&ads.fm_conf.goertzel[FM_CTR]);
+				float32_t r = mag[FM_CTR];
 				fm_data.subdet = ((1 - FM_TONE_DETECT_ALPHA) * fm_data.subdet)
 						+ (r / (s / 2) * FM_TONE_DETECT_ALPHA);	// do IIR filtering of the ratio between on and off-frequency energy
 
-				if (fm_data.subdet > FM_SUBAUDIBLE_TONE_DET_THRESHOLD)// is subaudible tone detector ratio above threshold?
+				if (fm_data.subdet > (ads.fm_conf.subaudible_tone_detected ? FM_SUBAUDIBLE_TONE_DET_THRESHOLD : FM_SUBAUDIBLE_TONE_OPEN_THRESHOLD))// is subaudible tone detector ratio above threshold?
 				{
 				    fm_data.tdet++;	// yes - increment count			// yes - bump debounce count
 					if (fm_data.tdet > FM_SUBAUDIBLE_DEBOUNCE_MAX)// is count above the maximum?
@@ -1725,7 +1847,7 @@ demod_fm_data_t fm_data;
 					ads.fm_conf.subaudible_tone_detected = 0;	// no tone detected
 				}
 
-				fm_data.gcount = 0;		// reset accumulation counter
+				fm_data.gcount = 0;		// reset evaluation counter
 			}
 		}
 		else	 		// subaudible tone detection disabled
@@ -1823,6 +1945,7 @@ static void AudioDriver_SpectrumCopyIqBuffers(iq_buffer_t* iq_puf_b, const size_
             sd.samp_ptr = 0;
         }
     }
+    sd.samp_count += blockSize;
 }
 
 /**
@@ -1878,10 +2001,16 @@ static void AudioDriver_SpectrumZoomProcessSamples(iq_buffer_t* iq_buf_p,  const
             // example: decimate by 8 --> 48kHz / 8 = 6kHz spectrum display bandwidth
             // frequency resolution of the display --> 6kHz / 256 = 23.44Hz
             // in 32x Mag-mode the resolution is 5.9Hz, not bad for such a small processor . . .
+            // with a 2048 point FFT (F7/H7) we get 0.73Hz in 32x Mag-mode
             //
 
             iq_buffer_t decim_iq_buf;
 
+#ifdef USE_SPECTRUM_FFT_2048
+            // 3. + 4. in one step, lowpass and decimation by a polyphase FIR filter
+            const uint16_t decim_count = AudioDriver_ZoomDecimatorRun(&zoom_decim, iq_buf_p, &decim_iq_buf, blockSize);
+#else
+
             // lowpass Filtering
             // Mag 2x - 12k lowpass --> 24k bandwidth
             // Mag 4x - 6k lowpass --> 12k bandwidth
@@ -1896,9 +2025,11 @@ static void AudioDriver_SpectrumZoomProcessSamples(iq_buffer_t* iq_buf_p,  const
             // decimation
             arm_fir_decimate_f32(&DECIMATE_ZOOM_FFT_I, decim_iq_buf.i_buffer, decim_iq_buf.i_buffer, blockSize);
             arm_fir_decimate_f32(&DECIMATE_ZOOM_FFT_Q, decim_iq_buf.q_buffer, decim_iq_buf.q_buffer, blockSize);
+            const uint16_t decim_count = blockSize/ (1<<sd.magnify);
+#endif
             // collect samples for spectrum display 256-point-FFT
 
-            AudioDriver_SpectrumCopyIqBuffers(&decim_iq_buf, blockSize/ (1<<sd.magnify));
+            AudioDriver_SpectrumCopyIqBuffers(&decim_iq_buf, decim_count);
             sd.FFT_frequency = ts.tune_freq + AudioDriver_GetTranslateFreq(); // spectrum shows center at translate frequency, LO + Translate Freq  is center frequency;
 
             // TODO: also insert sample collection for snap carrier here
@@ -2548,6 +2679,12 @@ static void RxProcessor_DemodAudioPostprocessing(float32_t (*a_buffer)[AUDIO_BLO
         {
             AudioDriver_RxProcessor_Bpsk(a_buffer[0], blockSizeDecim);
         }
+#ifdef USE_FT8_DECODER
+        if (is_demod_ft8()) // only works when decimation rate is 4 --> sample rate == 12ksps
+        {
+            Ft8_RxProcessor(a_buffer[0], blockSizeDecim);
+        }
+#endif
 
         if((dmod_mode == DEMOD_CW || dmod_mode == DEMOD_AM || dmod_mode == DEMOD_SAM))
             // switch to use TUNE HELPER in AM/SAM
@@ -59,7 +59,9 @@ typedef struct {
 
 // -----------------------------
 // FFT buffer, this is double the size of the length of the FFT used for spectrum display and waterfall spectrum
-#ifdef USE_FFT_1024
+#if defined(USE_SPECTRUM_FFT_2048)
+	#define FFT_IQ_BUFF_LEN		4096
+#elif defined(USE_FFT_1024)
 	#define FFT_IQ_BUFF_LEN		1024
 #else
 	#define FFT_IQ_BUFF_LEN		512
@@ -171,7 +173,7 @@ typedef struct
     float       subaudible_tone_det_freq;    // frequency, in Hz, of currently-selected subaudible tone for detection
     bool        subaudible_tone_detected;    // TRUE if subaudible tone has been detected
 
-    Goertzel goertzel[3];
+    SlidingDft  tone_det;            // three tone detectors, index with FM_HIGH, FM_LOW, FM_CTR
     #define FM_HIGH 0
     #define FM_LOW  1
     #define FM_CTR  2
@@ -447,7 +449,8 @@ extern uint32_t fm_tone_burst_freq[FM_TONE_BURST_MAX+1];
 // FM RX
 #define FM_SQUELCH_MAX      20              // maximum setting for FM squelch
 #define FM_SQUELCH_DEFAULT  12              // default setting for FM squelch
-#define FM_SUBAUDIBLE_GOERTZEL_WINDOW   400             // this sets the overall number of samples involved in the Goertzel decode windows (this value * "size/2")
+#define FM_SUBAUDIBLE_DECIMATION        16              // subaudible tone detection runs at IQ_SAMPLE_RATE/16 = 3ksps
+#define FM_SUBAUDIBLE_SDFT_SIZE         800             // subaudible tone detection window, 267ms and 3.75Hz bins at 3ksps
 
 
 #define	MIN_BEEP_FREQUENCY	200			// minimum beep frequency in Hz
@@ -1278,30 +1278,141 @@ void AudioFilter_SetDefaultMemories()
     ts.filter_path_mem[FILTER_MODE_FM][3] = 3;
 }
 
-void AudioFilter_CalcGoertzel(Goertzel* g, float32_t freq, const uint32_t size, const float goertzel_coeff, float32_t samplerate)
+/**
+ * @brief resets a tone detector bank to "num" tones, all state is cleared
+ */
+void AudioFilter_GoertzelBankInit(GoertzelBank* gb, uint32_t num)
 {
-    g->a = (0.5 + (freq * goertzel_coeff) * size/samplerate);
-    g->b = (2*PI*g->a)/size;
-    g->sin = sinf(g->b);
-    g->cos = cosf(g->b);
-    g->r = 2 * g->cos;
+    memset(gb, 0, sizeof(*gb));
+    gb->num = num > GOERTZEL_BANK_MAX_TONES ? GOERTZEL_BANK_MAX_TONES : num;
 }
 
-void AudioFilter_GoertzelInput(Goertzel* goertzel, float32_t in)
+/**
+ * @brief set detection frequency of one tone in the bank
+ * @param size number of samples evaluated before AudioFilter_GoertzelBankMagnitudes() is called, frequency is rounded to the bin of this size
+ * @param goertzel_coeff factor applied to freq, permits detection of off-frequency energy with same base frequency
+ */
+void AudioFilter_GoertzelBankSetTone(GoertzelBank* gb, uint32_t tone, float32_t freq, const uint32_t size, const float goertzel_coeff, float32_t samplerate)
 {
-	goertzel->buf[0] = goertzel->r * goertzel->buf[1] - goertzel->buf[2]	+ in;
-	goertzel->buf[2] = goertzel->buf[1];
-	goertzel->buf[1] = goertzel->buf[0];
+    if (tone < gb->num)
+    {
+        const int k = (0.5 + (freq * goertzel_coeff) * size/samplerate);
+        const float32_t w = (2*PI*k)/size;
+        gb->sin[tone] = sinf(w);
+        gb->cos[tone] = cosf(w);
+        gb->r[tone] = 2 * gb->cos[tone];
+        gb->s1[tone] = 0;
+        gb->s2[tone] = 0;
+    }
 }
 
-float32_t AudioFilter_GoertzelEnergy(Goertzel* goertzel)
+/**
+ * @brief feeds a block of samples into all tone detectors of the bank
+ */
+void AudioFilter_GoertzelBankInput(GoertzelBank* gb, const float32_t* in, uint32_t blockSize)
 {
-	float32_t a = (goertzel->buf[1] - (goertzel->buf[2] * goertzel->cos));// calculate energy at frequency
-	float32_t b = (goertzel->buf[2] * goertzel->sin);
-	goertzel->buf[0] = 0;
-	goertzel->buf[1] = 0;
-	goertzel->buf[2] = 0;
-	return sqrtf(a * a + b * b);
+    // tone by tone keeps the recursion in registers, the input block is small enough to stay in cache
+    for (uint32_t tone = 0; tone < gb->num; tone++)
+    {
+        const float32_t r = gb->r[tone];
+        float32_t s1 = gb->s1[tone];
+        float32_t s2 = gb->s2[tone];
+
+        uint32_t i = 0;
+        // two samples per iteration saves the register shuffling
+        for (; i + 1 < blockSize; i += 2)
+        {
+            s2 = r * s1 - s2 + in[i];
+            s1 = r * s2 - s1 + in[i+1];
+        }
+        if (i < blockSize)
+        {
+            const float32_t s0 = r * s1 - s2 + in[i];
+            s2 = s1;
+            s1 = s0;
+        }
+        gb->s1[tone] = s1;
+        gb->s2[tone] = s2;
+    }
+}
+
+/**
+ * @brief calculates magnitude of all tones and clears detector state for next evaluation period
+ * @param mag array of at least gb->num elements
+ */
+void AudioFilter_GoertzelBankMagnitudes(GoertzelBank* gb, float32_t* mag)
+{
+    for (uint32_t tone = 0; tone < gb->num; tone++)
+    {
+        const float32_t a = gb->s1[tone] - gb->s2[tone] * gb->cos[tone];
+        const float32_t b = gb->s2[tone] * gb->sin[tone];
+        arm_sqrt_f32(a * a + b * b, &mag[tone]);
+        gb->s1[tone] = 0;
+        gb->s2[tone] = 0;
+    }
+}
+
+// a damping slightly below 1 keeps the recursive sliding DFT stable despite float rounding
+#define SLIDING_DFT_DAMPING 0.99999f
+
+/**
+ * @brief initialize a sliding DFT of "size" samples, all bins are set to 0 Hz
+ * @param delay_line caller provided storage for size samples
+ */
+void AudioFilter_SlidingDftInit(SlidingDft* sd, float32_t* delay_line, uint32_t size, uint32_t num)
+{
+    memset(sd, 0, sizeof(*sd));
+    sd->num = num > GOERTZEL_BANK_MAX_TONES ? GOERTZEL_BANK_MAX_TONES : num;
+    sd->delay = delay_line;
+    sd->size = size;
+    sd->comb = powf(SLIDING_DFT_DAMPING, size);
+    memset(delay_line, 0, size * sizeof(*delay_line));
+}
+
+void AudioFilter_SlidingDftSetBin(SlidingDft* sd, uint32_t bin, float32_t freq, float32_t samplerate)
+{
+    if (bin < sd->num)
+    {
+        const int k = (0.5 + freq * sd->size/samplerate);
+        const float32_t w = (2*PI*k)/sd->size;
+        sd->cos[bin] = SLIDING_DFT_DAMPING * cosf(w);
+        sd->sin[bin] = SLIDING_DFT_DAMPING * sinf(w);
+        sd->re[bin] = 0;
+        sd->im[bin] = 0;
+    }
+}
+
+/**
+ * @brief advances the window by blockSize samples, X_k(n) = (X_k(n-1) + x(n) - x(n-size)) * exp(j*2*pi*k/size)
+ */
+void AudioFilter_SlidingDftInput(SlidingDft* sd, const float32_t* in, uint32_t blockSize)
+{
+    for (uint32_t i = 0; i < blockSize; i++)
+    {
+        const float32_t delta = in[i] - sd->comb * sd->delay[sd->idx];
+        sd->delay[sd->idx] = in[i];
+        sd->idx = sd->idx + 1 == sd->size ? 0 : sd->idx + 1;
+
+        for (uint32_t bin = 0; bin < sd->num; bin++)
+        {
+            const float32_t re = sd->re[bin] + delta;
+            const float32_t im = sd->im[bin];
+            sd->re[bin] = re * sd->cos[bin] - im * sd->sin[bin];
+            sd->im[bin] = re * sd->sin[bin] + im * sd->cos[bin];
+        }
+    }
+}
+
+/**
+ * @brief magnitudes of the current window, does not change the state
+ * @param mag array of at least sd->num elements
+ */
+void AudioFilter_SlidingDftMagnitudes(SlidingDft* sd, float32_t* mag)
+{
+    for (uint32_t bin = 0; bin < sd->num; bin++)
+    {
+        arm_sqrt_f32(sd->re[bin] * sd->re[bin] + sd->im[bin] * sd->im[bin], &mag[bin]);
+    }
 }
 
 
@@ -160,19 +160,47 @@ uint8_t  AudioFilter_NextApplicableFilter();
 void     AudioFilter_SetDefaultMemories();
 
 
+#define GOERTZEL_BANK_MAX_TONES 8
+
+/**
+ * Bank of Goertzel tone detectors, evaluated together over whole sample blocks.
+ * State is kept as struct of arrays so that the per tone loops can be unrolled/vectorized.
+ */
+typedef struct
+{
+    uint32_t  num;                              // number of tones in use
+    float32_t r[GOERTZEL_BANK_MAX_TONES];       // 2 * cos(w)
+    float32_t cos[GOERTZEL_BANK_MAX_TONES];
+    float32_t sin[GOERTZEL_BANK_MAX_TONES];
+    float32_t s1[GOERTZEL_BANK_MAX_TONES];      // filter state s[n-1]
+    float32_t s2[GOERTZEL_BANK_MAX_TONES];      // filter state s[n-2]
+} GoertzelBank;
+
+/**
+ * Sliding DFT over the last "size" samples for a set of bins, delivers updated magnitudes after every input block.
+ * The delay line has to be provided by the caller (size elements).
+ */
 typedef struct
 {
-	int a;
-	float32_t b;
-	float32_t sin;
-	float32_t cos;
-	float32_t r;
-	float32_t buf[3];
-} Goertzel;
-
-
-void AudioFilter_CalcGoertzel(Goertzel* g, float32_t freq, const uint32_t size, const float goertzel_coeff, float32_t samplerate);
-void AudioFilter_GoertzelInput(Goertzel* goertzel, float32_t in);
-float32_t AudioFilter_GoertzelEnergy(Goertzel* goertzel);
+    uint32_t  num;                              // number of bins in use
+    float32_t cos[GOERTZEL_BANK_MAX_TONES];     // twiddle of bin k: exp(j*2*pi*k/size), scaled by damping
+    float32_t sin[GOERTZEL_BANK_MAX_TONES];
+    float32_t re[GOERTZEL_BANK_MAX_TONES];      // current DFT value of bin
+    float32_t im[GOERTZEL_BANK_MAX_TONES];
+    float32_t comb;                             // damping^size, applied to the sample leaving the window
+    float32_t* delay;                           // last "size" input samples
+    uint32_t  size;
+    uint32_t  idx;
+} SlidingDft;
+
+void AudioFilter_GoertzelBankInit(GoertzelBank* gb, uint32_t num);
+void AudioFilter_GoertzelBankSetTone(GoertzelBank* gb, uint32_t tone, float32_t freq, const uint32_t size, const float goertzel_coeff, float32_t samplerate);
+void AudioFilter_GoertzelBankInput(GoertzelBank* gb, const float32_t* in, uint32_t blockSize);
+void AudioFilter_GoertzelBankMagnitudes(GoertzelBank* gb, float32_t* mag);
+
+void AudioFilter_SlidingDftInit(SlidingDft* sd, float32_t* delay_line, uint32_t size, uint32_t num);
+void AudioFilter_SlidingDftSetBin(SlidingDft* sd, uint32_t bin, float32_t freq, float32_t samplerate);
+void AudioFilter_SlidingDftInput(SlidingDft* sd, const float32_t* in, uint32_t blockSize);
+void AudioFilter_SlidingDftMagnitudes(SlidingDft* sd, float32_t* mag);
 
 #endif /* DRIVERS_AUDIO_AUDIO_FILTER_H_ */
@@ -307,21 +307,25 @@ void AudioManagement_CalcSubaudibleGenFreq(float32_t freq)
 
 #define FM_GOERTZEL_HIGH    1.04        // ratio of "high" detect frequency with respect to center
 #define FM_GOERTZEL_LOW     0.95        // ratio of "low" detect frequency with respect to center
+
+static float32_t fm_tone_det_delay[FM_SUBAUDIBLE_SDFT_SIZE];   // delay line of the sliding DFT tone detectors
+
 /**
  * @brief Calculate frequency word for subaudible tone, call after change of detection frequency  [KA7OEI October, 2015]
  */
 void AudioManagement_CalcSubaudibleDetFreq(float32_t freq)
 {
-    const uint32_t size = AUDIO_BLOCK_SIZE;
+    const float32_t samplerate = IQ_SAMPLE_RATE / FM_SUBAUDIBLE_DECIMATION;
 
     ads.fm_conf.subaudible_tone_det_freq = freq;       // look up tone frequency (in Hz)
 
     if (freq > 0)
     {
-        // Calculate Goertzel terms for tone detector(s)
-        AudioFilter_CalcGoertzel(&ads.fm_conf.goertzel[FM_HIGH], ads.fm_conf.subaudible_tone_det_freq, FM_SUBAUDIBLE_GOERTZEL_WINDOW*size,FM_GOERTZEL_HIGH, IQ_SAMPLE_RATE);
-        AudioFilter_CalcGoertzel(&ads.fm_conf.goertzel[FM_LOW], ads.fm_conf.subaudible_tone_det_freq, FM_SUBAUDIBLE_GOERTZEL_WINDOW*size,FM_GOERTZEL_LOW, IQ_SAMPLE_RATE);
-        AudioFilter_CalcGoertzel(&ads.fm_conf.goertzel[FM_CTR], ads.fm_conf.subaudible_tone_det_freq, FM_SUBAUDIBLE_GOERTZEL_WINDOW*size,1.0, IQ_SAMPLE_RATE);
+        // Calculate sliding DFT terms for tone detector(s)
+        AudioFilter_SlidingDftInit(&ads.fm_conf.tone_det, fm_tone_det_delay, FM_SUBAUDIBLE_SDFT_SIZE, 3);
+        AudioFilter_SlidingDftSetBin(&ads.fm_conf.tone_det, FM_HIGH, ads.fm_conf.subaudible_tone_det_freq * FM_GOERTZEL_HIGH, samplerate);
+        AudioFilter_SlidingDftSetBin(&ads.fm_conf.tone_det, FM_LOW, ads.fm_conf.subaudible_tone_det_freq * FM_GOERTZEL_LOW, samplerate);
+        AudioFilter_SlidingDftSetBin(&ads.fm_conf.tone_det, FM_CTR, ads.fm_conf.subaudible_tone_det_freq, samplerate);
     }
 }
 
@@ -12,6 +12,7 @@
 #include "audio_nr.h"
 #include "arm_const_structs.h"
 #include "profiling.h"
+#include "uhsdr_math.h"
 
 //#define debug_alternate_NR
 
@@ -2005,9 +2006,16 @@ else
 
             //new noise estimate MMSE based!!!
 
+            // the exponentials of all bins are done in one block call, much cheaper than expf() per bin
+            for(int bindx = 0; bindx < nr_params.NR_FFT_L / 2; bindx++)
+            {
+                ph1y[bindx] = NR2.xih1r * NR2.X[bindx][0]/xt[bindx];
+            }
+            Math_expf_fast_block(ph1y, ph1y, nr_params.NR_FFT_L / 2);
+
             for(int bindx = 0; bindx < nr_params.NR_FFT_L / 2; bindx++)// 1. Step of NR - calculate the SNR's
             {
-                ph1y[bindx] = 1.0 / (1.0 + NR2.pfac * expf(NR2.xih1r * NR2.X[bindx][0]/xt[bindx]));
+                ph1y[bindx] = 1.0 / (1.0 + NR2.pfac * ph1y[bindx]);
                 pslp[bindx] = NR2.ap * pslp[bindx] + (1.0 - NR2.ap) * ph1y[bindx];
                 //ph1y[bindx] = fmin(ph1y[bindx], 1.0 - pnsaf * (pslp[bindx] > psthr)); //?????
 
@@ -48,7 +48,7 @@
 #include "cw_gen.h"
 #include <stdio.h>
 
-Goertzel cw_goertzel;
+GoertzelBank cw_goertzel;
 
 cw_config_t cw_decoder_config =
 { .sampling_freq = 12000.0, .target_freq = 750.0,
@@ -60,17 +60,25 @@ cw_config_t cw_decoder_config =
 		.noisecancel_enable = 1,
 		.spikecancel = 0,
 		.use_3_goertzels = false,
+		.use_adaptive = false,
 		.snap_enable = true,
 		.show_CW_LED = true // menu choice whether the user wants the CW LED indicator to be working or not
 };
 
 static void CW_Decode(void);
+static void CwAdaptive_Reset(void);
+static bool CwAdaptive_Detect(float32_t magnitude);
+static void CwAdaptive_Decode(void);
+static uint8_t CwAdaptive_SpeedWpm(void);
 
 void CwDecode_Filter_Set()
 {
 	// set Goertzel parameters for CW decoding
-	AudioFilter_CalcGoertzel(&cw_goertzel, ts.cw_sidetone_freq , // cw_decoder_config.target_freq,
+	AudioFilter_GoertzelBankInit(&cw_goertzel, 1);
+	AudioFilter_GoertzelBankSetTone(&cw_goertzel, 0, ts.cw_sidetone_freq , // cw_decoder_config.target_freq,
 			cw_decoder_config.blocksize, 1.0, cw_decoder_config.sampling_freq);
+	// block duration has changed, learned timing has to be converted -> simply start over
+	CwAdaptive_Reset();
 }
 
 //#define SIGNAL_TAU			0.01
@@ -196,12 +204,10 @@ static void CW_Decode_exe(void)
 	// these are already in raw_signal_buffer
 
 	//    2.) calculate Goertzel
-	for (uint16_t index = 0; index < cw_decoder_config.blocksize; index++)
-	{
-		AudioFilter_GoertzelInput(&cw_goertzel, raw_signal_buffer[index]);
-	}
+	AudioFilter_GoertzelBankInput(&cw_goertzel, raw_signal_buffer, cw_decoder_config.blocksize);
 
-	float32_t magnitudeSquared = AudioFilter_GoertzelEnergy(&cw_goertzel);
+	float32_t magnitude;
+	AudioFilter_GoertzelBankMagnitudes(&cw_goertzel, &magnitude);
 
 	// I am not sure whether we would need an AGC here, because the audio chain already has an AGC
 	// Now I am sure, we do not need it
@@ -212,7 +218,7 @@ static void CW_Decode_exe(void)
 	float32_t pklvl;                   	// Used for AGC calculations
 	if (cw_decoder_config.AGC_enable)
 	{
-		pklvl = CW_agcvol * CW_vol * magnitudeSquared; // Get level at Goertzel frequency
+		pklvl = CW_agcvol * CW_vol * magnitude; // Get level at Goertzel frequency
 		if (pklvl > AGC_MAX_PEAK)
 			CW_agcvol = CW_agcvol * CW_AGC_ATTACK; // Decrease volume if above this level.
 		if (pklvl < AGC_MIN_PEAK)
@@ -224,7 +230,7 @@ static void CW_Decode_exe(void)
 	else
 #endif
 	{
-		siglevel = magnitudeSquared;
+		siglevel = magnitude;
 	}
 	//    4.) signal averaging/smoothing
 
@@ -246,12 +252,16 @@ static void CW_Decode_exe(void)
 #else
 	// better use exponential averager for averaging/smoothing here !? Let�s try!
 //	siglevel = siglevel * SIGNAL_TAU + ONEM_SIGNAL_TAU * old_siglevel;
-//	old_siglevel = magnitudeSquared;
+//	old_siglevel = magnitude;
 #endif
 
 
 	// 4b.) automatic threshold correction
-	if(cw_decoder_config.use_3_goertzels)
+	if (cw_decoder_config.use_adaptive)
+	{
+		newstate = CwAdaptive_Detect(magnitude);
+	}
+	else if(cw_decoder_config.use_3_goertzels)
 	{
 	CW_mag = siglevel;
 	CW_env = decayavg(CW_env, CW_mag, (CW_mag > CW_env)?
@@ -292,12 +302,13 @@ static void CW_Decode_exe(void)
 	else
 	{
 		siglevel = siglevel * SIGNAL_TAU + ONEM_SIGNAL_TAU * old_siglevel;
-		old_siglevel = magnitudeSquared;
+		old_siglevel = magnitude;
 		newstate = (siglevel >= cw_decoder_config.thresh);
 	}
 
-	if(cw_decoder_config.noisecancel_enable)
+	if(cw_decoder_config.noisecancel_enable && cw_decoder_config.use_adaptive == false)
 	{
+		// the matched filter of the adaptive decoder already takes care of single block changes
 		static bool change; // reads to be the same to confirm a true change
 
 		if (change == TRUE)
@@ -354,25 +365,40 @@ static void CW_Decode_exe(void)
 	//    7.) CW Decode
 	if(ts.cw_decoder_enable && ts.dmod_mode == DEMOD_CW)
 	{
-	  CW_Decode();                                     // Do all the heavy lifting
+		if (cw_decoder_config.use_adaptive)
+		{
+			CwAdaptive_Decode();
+		}
+		else
+		{
+			CW_Decode();                                     // Do all the heavy lifting
+		}
 	}
-	// calculation of speed of the received morse signal on basis of the standard "PARIS"
-	float32_t spdcalc =  10.0 * cw_times.dot_avg + 4.0 * cw_times.dash_avg + 9.0 * cw_times.symspace_avg + 5.0 * cw_times.cwspace_avg;
 
-	// update only if initialized and prevent division  by zero
-	if(b.initialized == true && spdcalc > 0)
+	if (cw_decoder_config.use_adaptive)
 	{
-		// Convert to Milliseconds per Word
-		float32_t speed_ms_per_word = spdcalc * 1000.0 / (cw_decoder_config.sampling_freq / (float32_t)cw_decoder_config.blocksize);
-		float32_t speed_wpm_raw = (0.5 + 60000.0 / speed_ms_per_word); // calculate words per minute
-		speed_wpm_avg = speed_wpm_raw * 0.3 + 0.7 * speed_wpm_avg; // a little lowpass filtering
+		cw_decoder_config.speed = CwAdaptive_SpeedWpm();
 	}
 	else
 	{
-		speed_wpm_avg = 0; // we have no calculated speed, i.e. not synchronized to signal
-	}
+		// calculation of speed of the received morse signal on basis of the standard "PARIS"
+		float32_t spdcalc =  10.0 * cw_times.dot_avg + 4.0 * cw_times.dash_avg + 9.0 * cw_times.symspace_avg + 5.0 * cw_times.cwspace_avg;
 
-	cw_decoder_config.speed = speed_wpm_avg; // for external use, 0 indicates no signal condition
+		// update only if initialized and prevent division  by zero
+		if(b.initialized == true && spdcalc > 0)
+		{
+			// Convert to Milliseconds per Word
+			float32_t speed_ms_per_word = spdcalc * 1000.0 / (cw_decoder_config.sampling_freq / (float32_t)cw_decoder_config.blocksize);
+			float32_t speed_wpm_raw = (0.5 + 60000.0 / speed_ms_per_word); // calculate words per minute
+			speed_wpm_avg = speed_wpm_raw * 0.3 + 0.7 * speed_wpm_avg; // a little lowpass filtering
+		}
+		else
+		{
+			speed_wpm_avg = 0; // we have no calculated speed, i.e. not synchronized to signal
+		}
+
+		cw_decoder_config.speed = speed_wpm_avg; // for external use, 0 indicates no signal condition
+	}
 
 	if(ts.txrx_mode == TRX_MODE_TX)
 	{	// just to ensure that during RX/TX switching the red LED remains lit in TX_mode
@@ -663,6 +689,12 @@ bool DataRecognitionFunc(bool* new_char_p)
 				}
 			}
 		}
+		else if (cw_decoder_config.spikecancel == CW_SPIKECANCEL_MODE_OFF)
+		{
+			// zero length state, e.g. a stale entry reached after ErrorCorrectionFunc() moved sig_outcount.
+			// spikeCancel() did not skip it, so we have to, otherwise the callers loop forever
+			sig_outcount = ring_idx_increment(sig_outcount, CW_SIG_BUFSIZE);
+		}
 	}
 	//-----------------------------------
 	// Long key down or key up
@@ -1077,6 +1109,318 @@ void CW_Decode(void)
 	}
 }
 
+//------------------------------------------------------------------
+//
+// Adaptive decoder
+//
+// Instead of a fixed threshold on the Goertzel magnitude, the magnitude is
+// passed through a matched filter (moving average) sized to the
+// currently estimated dit. This suppresses noise spikes and drops shorter than
+// a dit without the need for spike cancel. Mark/space decision is taken
+// at half of the distance between tracked signal peak and noise floor.
+//
+// Timing is classified using a decaying histogram of mark durations in
+// milliseconds. A 2-means split of the histogram delivers the dit length
+// which is tracked continuously, this also gives us the speed in WPM.
+// Each character gets a confidence value based on how far its elements
+// are away from their ideal durations. It is shown by the color of the
+// WPM display.
+//
+// All memory is static and the cost per Goertzel block is bounded
+// by CW_ADAPTIVE_MF_LEN_MAX and CW_ADAPTIVE_HIST_BINS.
+//
+//------------------------------------------------------------------
+#define CW_ADAPTIVE_MF_LEN_MAX      64      // longest matched filter in Goertzel blocks
+#define CW_ADAPTIVE_HIST_BINS       128     // covers marks up to 512ms, i.e. a dah at 7 WPM
+#define CW_ADAPTIVE_HIST_BIN_MS     4.0
+#define CW_ADAPTIVE_HIST_DECAY      0.97    // per mark, older marks are forgotten after ~30 elements
+#define CW_ADAPTIVE_HIST_MIN_WEIGHT 0.5     // bins with less weight are ignored for initial split
+#define CW_ADAPTIVE_KMEANS_ITER     3
+#define CW_ADAPTIVE_DIT_MS_DEFAULT  48.0    // 25 WPM
+#define CW_ADAPTIVE_DIT_MS_MIN      (1200.0 / 60.0)
+#define CW_ADAPTIVE_DIT_MS_MAX      (1200.0 / 5.0)
+#define CW_ADAPTIVE_WARMUP_MARKS    4       // matched filter is not used before we have seen this many marks
+#define CW_ADAPTIVE_PEAK_ATTACK     0.2
+#define CW_ADAPTIVE_NOISE_ATTACK    0.5
+#define CW_ADAPTIVE_MIN_SNR         3.0     // peak to noise floor amplitude ratio (~10dB) required to detect marks at all
+#define CW_ADAPTIVE_HYSTERESIS      0.1     // relative to peak - noise distance
+
+typedef struct
+{
+	float32_t mf_line[CW_ADAPTIVE_MF_LEN_MAX]; // circular delay line of Goertzel magnitudes
+	uint16_t mf_idx;
+	uint16_t mf_len;          // current matched filter length in blocks, follows dit_ms
+	float32_t peak_env;       // tracked level of marks at matched filter output
+	float32_t noise_env;      // tracked level of spaces at matched filter output
+	float32_t mark_hist[CW_ADAPTIVE_HIST_BINS]; // decaying histogram of mark durations
+	float32_t hist_weight;    // total weight in mark_hist, used to tell if we have a speed estimate
+	float32_t dit_ms;         // current dit length estimate
+	bool mark;                // current slicer output, selects the hysteresis side of the threshold
+	float32_t char_conf;      // lowest element confidence of the character currently assembled
+	bool char_pending;        // elements have been collected but character not yet printed
+} cw_adaptive_t;
+
+static cw_adaptive_t cw_adaptive; // CwDecode_Filter_Set() has to be called before use
+
+static float32_t CwAdaptive_BlockMs(void)
+{
+	return (1000.0 * cw_decoder_config.blocksize) / cw_decoder_config.sampling_freq;
+}
+
+/**
+ * @brief set dit length estimate and size the matched filter accordingly
+ */
+static void CwAdaptive_SetDit(float32_t dit_ms)
+{
+	if (dit_ms < CW_ADAPTIVE_DIT_MS_MIN)
+	{
+		dit_ms = CW_ADAPTIVE_DIT_MS_MIN;
+	}
+	else if (dit_ms > CW_ADAPTIVE_DIT_MS_MAX)
+	{
+		dit_ms = CW_ADAPTIVE_DIT_MS_MAX;
+	}
+	cw_adaptive.dit_ms = dit_ms;
+
+	uint16_t mf_len = dit_ms / CwAdaptive_BlockMs() + 0.5;
+	if (mf_len < 1)
+	{
+		mf_len = 1;
+	}
+	else if (mf_len > CW_ADAPTIVE_MF_LEN_MAX)
+	{
+		mf_len = CW_ADAPTIVE_MF_LEN_MAX;
+	}
+	// as long as we have seen just a few marks, the estimate is not reliable. A too long filter
+	// would merge elements, which drives the estimate even further away. So start with no filtering.
+	cw_adaptive.mf_len = cw_adaptive.hist_weight < CW_ADAPTIVE_WARMUP_MARKS ? 1 : mf_len;
+}
+
+static void CwAdaptive_Reset(void)
+{
+	memset(&cw_adaptive, 0, sizeof(cw_adaptive));
+	cw_adaptive.char_conf = 1.0;
+	CwAdaptive_SetDit(CW_ADAPTIVE_DIT_MS_DEFAULT);
+}
+
+/**
+ * @brief matched filter and adaptive slicer, called once per Goertzel block
+ * @param magnitude Goertzel magnitude of the current block
+ * @returns true if a mark is detected
+ */
+static bool CwAdaptive_Detect(float32_t magnitude)
+{
+	cw_adaptive.mf_line[cw_adaptive.mf_idx] = magnitude;
+	cw_adaptive.mf_idx = ring_idx_increment(cw_adaptive.mf_idx, CW_ADAPTIVE_MF_LEN_MAX);
+
+	// moving average over the last mf_len blocks == matched filter for a rectangular dit
+	float32_t sum = 0;
+	int32_t idx = cw_adaptive.mf_idx;
+	for (uint16_t i = 0; i < cw_adaptive.mf_len; i++)
+	{
+		idx = ring_idx_decrement(idx, CW_ADAPTIVE_MF_LEN_MAX);
+		sum += cw_adaptive.mf_line[idx];
+	}
+	const float32_t level = sum / cw_adaptive.mf_len;
+
+	if (cw_adaptive.noise_env == 0)
+	{
+		// first call after reset, start with "no signal" instead of infinite SNR
+		cw_adaptive.noise_env = level;
+		cw_adaptive.peak_env = level;
+	}
+
+	// peak follows marks quickly and decays within ~32 dits, noise floor does it the other way round
+	// but rises even slower since it must not follow long dahs
+	const float32_t slow = 1.0 / (32 * cw_adaptive.mf_len);
+	cw_adaptive.peak_env += (level - cw_adaptive.peak_env) * (level > cw_adaptive.peak_env ? CW_ADAPTIVE_PEAK_ATTACK : slow);
+	cw_adaptive.noise_env += (level - cw_adaptive.noise_env) * (level < cw_adaptive.noise_env ? CW_ADAPTIVE_NOISE_ATTACK : slow / 4);
+
+	const float32_t distance = cw_adaptive.peak_env - cw_adaptive.noise_env;
+
+	if (cw_adaptive.peak_env < CW_ADAPTIVE_MIN_SNR * cw_adaptive.noise_env)
+	{
+		cw_adaptive.mark = false; // nothing in the passband which looks like a signal
+	}
+	else
+	{
+		const float32_t thresh = cw_adaptive.noise_env + distance * (cw_adaptive.mark ? 0.5 - CW_ADAPTIVE_HYSTERESIS : 0.5 + CW_ADAPTIVE_HYSTERESIS);
+		cw_adaptive.mark = level > thresh;
+	}
+	return cw_adaptive.mark;
+}
+
+/**
+ * @brief add a mark duration to the histogram and re-estimate the dit length by splitting the histogram into dits and dahs
+ */
+static void CwAdaptive_AddMark(float32_t t_ms)
+{
+	uint32_t bin = t_ms / CW_ADAPTIVE_HIST_BIN_MS;
+	if (bin >= CW_ADAPTIVE_HIST_BINS)
+	{
+		bin = CW_ADAPTIVE_HIST_BINS - 1;
+	}
+
+	arm_scale_f32(cw_adaptive.mark_hist, CW_ADAPTIVE_HIST_DECAY, cw_adaptive.mark_hist, CW_ADAPTIVE_HIST_BINS);
+	cw_adaptive.mark_hist[bin] += 1.0;
+	cw_adaptive.hist_weight = cw_adaptive.hist_weight * CW_ADAPTIVE_HIST_DECAY + 1.0;
+
+	// initial split: geometric mean of shortest and longest populated bin, if these are far enough apart
+	// to be dits and dahs. Otherwise we see just one kind of elements and use the old estimate.
+	int32_t lo = -1, hi = -1;
+	for (int32_t i = 0; i < CW_ADAPTIVE_HIST_BINS; i++)
+	{
+		if (cw_adaptive.mark_hist[i] >= CW_ADAPTIVE_HIST_MIN_WEIGHT)
+		{
+			if (lo < 0)
+			{
+				lo = i;
+			}
+			hi = i;
+		}
+	}
+
+	float32_t boundary = 2.0 * cw_adaptive.dit_ms;
+	if (lo >= 0 && (hi + 0.5) >= 2.0 * (lo + 0.5))
+	{
+		boundary = sqrtf((lo + 0.5) * (hi + 0.5)) * CW_ADAPTIVE_HIST_BIN_MS;
+	}
+
+	float32_t dit_ms = cw_adaptive.dit_ms;
+	for (uint32_t iter = 0; iter < CW_ADAPTIVE_KMEANS_ITER; iter++)
+	{
+		float32_t dit_w = 0, dit_sum = 0, dah_w = 0, dah_sum = 0;
+
+		for (uint32_t i = 0; i < CW_ADAPTIVE_HIST_BINS; i++)
+		{
+			const float32_t center = (i + 0.5) * CW_ADAPTIVE_HIST_BIN_MS;
+			const float32_t w = cw_adaptive.mark_hist[i];
+			if (center < boundary)
+			{
+				dit_w += w;
+				dit_sum += w * center;
+			}
+			else
+			{
+				dah_w += w;
+				dah_sum += w * center;
+			}
+		}
+
+		if (dit_w + dah_w > 0)
+		{
+			// a dah counts as three dits
+			dit_ms = (dit_sum + dah_sum / 3.0) / (dit_w + dah_w);
+		}
+		boundary = 2.0 * dit_ms;
+	}
+
+	CwAdaptive_SetDit(dit_ms);
+}
+
+/**
+ * @brief how close is a duration to its ideal length, 1.0 == perfect, 0.0 == on the decision boundary (1 dit off)
+ */
+static float32_t CwAdaptive_ElementConfidence(float32_t t_ms, float32_t ideal_ms)
+{
+	float32_t conf = 1.0 - fabsf(t_ms - ideal_ms) / cw_adaptive.dit_ms;
+	return conf < 0.0 ? 0.0 : conf;
+}
+
+static void CwAdaptive_PrintChar(bool word_space)
+{
+	if (data_len > 0)
+	{
+		CodeGenFunc();
+		const uint8_t decoded = CwGen_CharacterIdFunc(code);
+
+		cw_decoder_config.confidence = decoded < 0xfe ? cw_adaptive.char_conf * 100 : 0;
+
+		if (decoded != 0xfe)
+		{
+			PrintCharFunc(decoded);
+		}
+	}
+	if (word_space && cw_adaptive.char_pending)
+	{
+		lcdLineScrollPrint(' ');
+	}
+	cw_adaptive.char_pending = false;
+	cw_adaptive.char_conf = 1.0;
+}
+
+/**
+ * @brief adaptive replacement of CW_Decode(), processes all pending states in sig[]
+ */
+static void CwAdaptive_Decode(void)
+{
+	const float32_t block_ms = CwAdaptive_BlockMs();
+
+	// never more than CW_SIG_BUFSIZE iterations
+	while (sig_outcount != sig_incount)
+	{
+		const float32_t t_ms = sig[sig_outcount].time * block_ms;
+		const bool is_markstate = sig[sig_outcount].state;
+		const float32_t dit_ms = cw_adaptive.dit_ms;
+
+		sig_outcount = ring_idx_increment(sig_outcount, CW_SIG_BUFSIZE);
+
+		if (is_markstate)
+		{
+			const bool is_dash = t_ms >= 2.0 * dit_ms;
+			float32_t conf = CwAdaptive_ElementConfidence(t_ms, is_dash ? 3.0 * dit_ms : dit_ms);
+			if (cw_adaptive.char_conf > conf)
+			{
+				cw_adaptive.char_conf = conf;
+			}
+
+			// data[] is only evaluated by CodeGenFunc() in adaptive mode, durations are not needed
+			data[data_len].state = is_dash;
+			data[data_len].time = sig[ring_idx_decrement(sig_outcount, CW_SIG_BUFSIZE)].time;
+			if (data_len < CW_DATA_BUFSIZE - 2)
+			{
+				data_len++; // overlong characters are garbage anyway and will be decoded as error
+			}
+			cw_adaptive.char_pending = true;
+
+			// learn timing after classification, so that the first element of a new speed does not influence itself
+			CwAdaptive_AddMark(t_ms);
+		}
+		else if (cw_adaptive.char_pending)
+		{
+			if (t_ms < 2.0 * dit_ms)
+			{
+				// symbol space inside a character
+				float32_t conf = CwAdaptive_ElementConfidence(t_ms, dit_ms);
+				if (cw_adaptive.char_conf > conf)
+				{
+					cw_adaptive.char_conf = conf;
+				}
+			}
+			else
+			{
+				// character or word space, word spaces are usually already handled by timeout below
+				CwAdaptive_PrintChar(t_ms >= 5.0 * dit_ms);
+			}
+		}
+	}
+
+	// long key up finalizes character and issues the word space
+	if (cw_state == false && cw_adaptive.char_pending && cur_time * block_ms >= 5.0 * cw_adaptive.dit_ms)
+	{
+		CwAdaptive_PrintChar(true);
+	}
+}
+
+/**
+ * @returns speed derived from the dit length estimate, 0 if there is no signal or no estimate yet
+ */
+static uint8_t CwAdaptive_SpeedWpm(void)
+{
+	bool has_signal = cw_adaptive.peak_env >= CW_ADAPTIVE_MIN_SNR * cw_adaptive.noise_env;
+	return (has_signal && cw_adaptive.hist_weight > 1.0) ? (1200.0 / cw_adaptive.dit_ms + 0.5) : 0;
+}
+
 void CwDecoder_WpmDisplayClearOrPrepare(bool prepare)
 {
     uint16_t color1 = prepare?White:Black;
@@ -1091,17 +1435,42 @@ void CwDecoder_WpmDisplayClearOrPrepare(bool prepare)
     }
 }
 
+/**
+ * @returns color of the WPM display, the adaptive decoder signals a doubtful last character by yellow or orange
+ */
+static uint16_t CwDecoder_WpmColor(void)
+{
+	uint16_t retval = White;
+	if (cw_decoder_config.use_adaptive && cw_decoder_config.speed > 0)
+	{
+		if (cw_decoder_config.confidence < CW_CONFIDENCE_LOW)
+		{
+			retval = Orange;
+		}
+		else if (cw_decoder_config.confidence < CW_CONFIDENCE_GOOD)
+		{
+			retval = Yellow;
+		}
+	}
+	return retval;
+}
+
 void CwDecoder_WpmDisplayUpdate(bool force_update)
 {
 	static uint8_t old_speed = 0;
+	static uint16_t old_color = White;
+
+	const uint16_t color = CwDecoder_WpmColor();
 
-	if(cw_decoder_config.speed != old_speed || force_update == true)
+	if(cw_decoder_config.speed != old_speed || color != old_color || force_update == true)
 	{
 	    char WPM_str[10];
 
 	    snprintf(WPM_str, 10, cw_decoder_config.speed > 0? "%3u" : " --", cw_decoder_config.speed);
 
-		UiLcdHy28_PrintText(ts.Layout->CW_DECODER_WPM.x, ts.Layout->CW_DECODER_WPM.y, WPM_str,White,Black,0);
+		UiLcdHy28_PrintText(ts.Layout->CW_DECODER_WPM.x, ts.Layout->CW_DECODER_WPM.y, WPM_str,color,Black,0);
+		old_speed = cw_decoder_config.speed;
+		old_color = color;
 	}
 }
 
@@ -33,8 +33,12 @@ typedef struct
 #define CW_SPIKECANCEL_MODE_SPIKE 1
 #define CW_SPIKECANCEL_MODE_SHORT 2
 	bool use_3_goertzels;
+	bool use_adaptive; // matched filter detector and histogram based timing classifier instead of threshold/spike cancel logic
 	bool snap_enable;
     bool show_CW_LED; // menu choice whether the user wants the CW LED indicator to be working or not
+    uint8_t confidence; // confidence of the last decoded character in percent (adaptive decoder only), shown as color of the WPM display
+#define CW_CONFIDENCE_LOW 25
+#define CW_CONFIDENCE_GOOD 60
 } cw_config_t;
 
 extern cw_config_t cw_decoder_config;
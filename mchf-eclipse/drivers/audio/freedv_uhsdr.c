@@ -26,9 +26,13 @@ MultiModeBuffer_t __MCHF_SPECIALMEM mmb;
 #ifdef USE_FREEDV
 
 #include "freedv_api.h"
+#include "codec2.h"
+#include "codec2_arena.h"
 
 freedv_conf_t freedv_conf;
 
+static uint64_t freedv_arena[FDV_ARENA_SIZE/sizeof(uint64_t)]; // uint64_t for 8 byte alignment
+
 struct freedv *f_FREEDV;
 
 
@@ -39,12 +43,68 @@ RingBuffer_DefineExtMem(fdv_iq_rb,sizeof(mmb.fdv_iq_buff)/sizeof(fdv_iq_rb_item_
 __MCHF_SPECIALMEM fdv_audio_rb_item_t fdv_audio_rb_mem[FDV_AUDIO_MEM_SIZE];
 RingBuffer_DefineExtMem(fdv_audio_rb, FDV_AUDIO_MEM_SIZE, fdv_audio_rb_mem)
 
+// queue of packed codec2 frames between the demodulator and the speech synthesis
+#define FDV_CODEC_FRAME_BYTES 7 // largest used codec2 frame: 1300 mode with 52 bits
+typedef struct
+{
+    uint8_t bits[FDV_CODEC_FRAME_BYTES];
+    uint8_t valid; // if 0, the frame was squelched, play silence instead
+} fdv_codec_rb_item_t;
+
+#define FDV_CODEC_RB_SIZE 16 // 640ms of speech, holds more than 2 700D modem frames (4 codec2 frames each)
+static fdv_codec_rb_item_t fdv_codec_rb_mem[FDV_CODEC_RB_SIZE];
+static RingBuffer_DefineExtMem(fdv_codec_rb, FDV_CODEC_RB_SIZE, fdv_codec_rb_mem)
+
+// text channel queues between the CAT interface (main loop) and the text callbacks of the modem
+typedef uint8_t fdv_txt_tx_rb_item_t;
+typedef uint8_t fdv_txt_rx_rb_item_t;
+#define FDV_TXT_RB_SIZE 256
+static fdv_txt_tx_rb_item_t fdv_txt_tx_rb_mem[FDV_TXT_RB_SIZE];
+static RingBuffer_DefineExtMem(fdv_txt_tx_rb, FDV_TXT_RB_SIZE, fdv_txt_tx_rb_mem)
+static fdv_txt_rx_rb_item_t fdv_txt_rx_rb_mem[FDV_TXT_RB_SIZE];
+static RingBuffer_DefineExtMem(fdv_txt_rx_rb, FDV_TXT_RB_SIZE, fdv_txt_rx_rb_mem)
+
 typedef struct {
     int32_t start;
     int32_t offset;
     int32_t count;
 } flex_buffer;
 
+#ifdef USE_FREEDV_AUTO
+// FreeDV mode AUTO: all other modes of freedv_modes[] are open at the same time and each one gets its own copy
+// of the demodulator input. While searching, all modes run their demodulator on the same stream, the first one
+// which keeps sync for FDV_AUTO_LOCK_SAMPLES wins, becomes f_FREEDV and is the only one which is run.
+// If the winner has no sync for FDV_AUTO_UNLOCK_SAMPLES, the search starts again.
+// We transmit in the last winner, or in the first mode if nothing has been received yet.
+#ifdef USE_SIMPLE_FREEDV_FILTERS
+    #error "USE_FREEDV_AUTO requires the real valued demodulator input of the full FreeDV filters"
+#endif
+
+#define FDV_AUTO_CHAN_MAX       2                       // 1600 and 700D
+#define FDV_AUTO_CHAN_SIZE      (FDV_BUFFER_SIZE * 2)   // more than the largest freedv_nin() of all modes
+// the 1600 modem reports sync on noise for up to ~300ms, 700D only counts once the UW has been verified
+#define FDV_AUTO_LOCK_SAMPLES   (6 * 8000 / 10)         // 600ms at 8ksps
+#define FDV_AUTO_UNLOCK_SAMPLES (3 * 8000)              // 3s at 8ksps
+
+typedef struct
+{
+    struct freedv* f;
+    uint8_t fdv_mode;       // index in freedv_modes[]
+    uint32_t sync_samples;  // number of samples this mode has been in sync
+    int32_t count;          // number of samples in buffer
+    fdv_demod_rb_item_t buffer[FDV_AUTO_CHAN_SIZE];
+} fdv_auto_chan_t;
+
+static struct
+{
+    fdv_auto_chan_t chan[FDV_AUTO_CHAN_MAX];
+    uint8_t chan_num;           // number of open modes, 0 if mode AUTO is not active
+    int8_t winner;              // index in chan[] of the locked mode, -1 while searching
+    uint8_t next;               // index in chan[] of the mode to run next while searching
+    uint32_t nosync_samples;    // number of samples the winner has been without sync
+} fdv_auto;
+#endif
+
 static uint16_t freedv_display_x_offset;
 
 /**
@@ -83,11 +143,28 @@ int FreeDV_Is_Squelch_Enable(freedv_conf_t* freedv_conf_p)
     return freedv_conf_p->squelch_snr_thresh != FDV_SQUELCH_OFF;
 }
 
+static void FreeDv_SetupSquelch(struct freedv* f)
+{
+    freedv_set_squelch_en(f, FreeDV_Is_Squelch_Enable(&freedv_conf));
+    freedv_set_snr_squelch_thresh(f, FreeDV_Get_Squelch_SNR(&freedv_conf));
+}
+
 void FreeDV_Squelch_Update(freedv_conf_t* freedv_conf_p)
 {
     UNUSED(freedv_conf_p);
-    freedv_set_squelch_en(f_FREEDV, FreeDV_Is_Squelch_Enable(&freedv_conf));
-    freedv_set_snr_squelch_thresh(f_FREEDV, FreeDV_Get_Squelch_SNR(&freedv_conf));
+#ifdef USE_FREEDV_AUTO
+    if (fdv_auto.chan_num > 0)
+    {
+        for (int idx = 0; idx < fdv_auto.chan_num; idx++)
+        {
+            FreeDv_SetupSquelch(fdv_auto.chan[idx].f);
+        }
+    }
+    else
+#endif
+    {
+        FreeDv_SetupSquelch(f_FREEDV);
+    }
 }
 
 static void FreeDv_DisplayBer()
@@ -155,14 +232,310 @@ void FreeDv_DisplayPrepare()
     UiLcdHy28_PrintText(ts.Layout->FREEDV_BER.x, ts.Layout->FREEDV_BER.y,"BER=",Yellow,Black, ts.Layout->FREEDV_FONT);
 }
 
+/**
+ * During TX the BER line shows the number of TX buffer underruns since TX start instead.
+ * Each underrun is a gap in the transmitted signal the other station will hear.
+ */
+static void FreeDv_DisplayTxUnderruns(uint32_t underruns)
+{
+    char ur_string[12];
+
+    snprintf(ur_string,12,"UND=%-5lu",underruns);
+    UiLcdHy28_PrintText(ts.Layout->FREEDV_BER.x,ts.Layout->FREEDV_BER.y, ur_string,underruns == 0 ? Yellow : Red,Black, ts.Layout->FREEDV_FONT);
+}
+
 void FreeDv_DisplayUpdate()
 {
-    FreeDv_DisplayBer();
-    FreeDv_DisplaySnr();
+    static bool tx_display = false;
+    static uint32_t tx_underruns_start;
+
+#ifdef USE_FREEDV_AUTO
+    // in mode AUTO the mode label shows the mode we locked to
+    static const char* mode_label = NULL;
+    if (mode_label != FreeDV_GetModeLabel())
+    {
+        mode_label = FreeDV_GetModeLabel();
+        UiDriver_DisplayDemodMode();
+    }
+#endif
+
+    if (ts.txrx_mode == TRX_MODE_TX)
+    {
+        uint32_t tx_underruns = profileTimedEventGet(FreeDVTXUnderrun)->count;
+        if (tx_display == false)
+        {
+            tx_underruns_start = tx_underruns;
+            tx_display = true;
+        }
+        FreeDv_DisplayTxUnderruns(tx_underruns - tx_underruns_start);
+    }
+    else
+    {
+        if (tx_display == true)
+        {
+            UiLcdHy28_PrintText(ts.Layout->FREEDV_BER.x, ts.Layout->FREEDV_BER.y,"BER=     ",Yellow,Black, ts.Layout->FREEDV_FONT);
+            tx_display = false;
+        }
+        FreeDv_DisplayBer();
+        FreeDv_DisplaySnr();
+    }
     UiDriver_TextMsgDisplay();
 }
 
 
+// these buffers are large enough to hold the requested/provided amount of data for freedv_comprx
+// these are larger than the FDV_BUFFER_SIZE since some more bytes may be asked for.
+#ifdef USE_SIMPLE_FREEDV_FILTERS
+    #define     input_rb fdv_iq_rb
+    #define     input_rb_item_t fdv_iq_rb_item_t
+    #define     FREEDV_RX_FUNC freedv_comprx_codec
+    #define     FREEDV_RX_INPUT_T COMP
+#else
+    #define     input_rb fdv_demod_rb
+    #define     input_rb_item_t fdv_demod_rb_item_t
+    #define     FREEDV_RX_FUNC freedv_rx_codec
+    #define     FREEDV_RX_INPUT_T int16_t
+#endif
+
+/**
+ * @return max. number of codec2 frames a single modem frame of f delivers
+ */
+static int FreeDv_MaxCodecFrames(struct freedv* f)
+{
+    return freedv_get_n_speech_samples(f) / codec2_samples_per_frame(freedv_get_codec2(f));
+}
+
+/**
+ * Runs the modem and FEC of f on one modem frame (freedv_nin() samples). If requested, the resulting packed
+ * codec2 frames are queued for FreeDv_RxSynthesis. Squelched frames are queued as silence, nothing is queued
+ * without sync (as before, no audio is played without sync).
+ *
+ * @param queue if false, the codec2 frames are dropped
+ * @return true if f is in sync
+ */
+static bool FreeDv_RxDemodFrame(struct freedv* f, FREEDV_RX_INPUT_T* input_buffer, bool queue)
+{
+    struct CODEC2* c2 = freedv_get_codec2(f);
+    const int samples_per_codec_frame = codec2_samples_per_frame(c2);
+    const int bytes_per_codec_frame = (codec2_bits_per_frame(c2) + 7) / 8;
+    const int max_codec_frames = FreeDv_MaxCodecFrames(f);
+
+    uint8_t packed_codec_bits[max_codec_frames * bytes_per_codec_frame];
+    fdv_codec_rb_item_t codec_frames[max_codec_frames];
+    int valid;
+
+    profileTimedEventStart(ProfileFreeDV);
+    int nout = FREEDV_RX_FUNC(f, packed_codec_bits, input_buffer, &valid); // run the demodulation
+    profileTimedEventStop(ProfileFreeDV);
+
+    const bool sync = freedv_get_sync(f) != 0;
+
+    if (queue && sync && nout > 0)
+    {
+        const int codec_frames_num = nout / samples_per_codec_frame;
+
+        for (int idx = 0; idx < codec_frames_num; idx++)
+        {
+            codec_frames[idx].valid = valid == 1;
+            if (codec_frames[idx].valid)
+            {
+                memcpy(codec_frames[idx].bits, &packed_codec_bits[idx * bytes_per_codec_frame], bytes_per_codec_frame);
+            }
+        }
+        RingBuffer_PutSamples(&fdv_codec_rb, codec_frames, codec_frames_num);
+    }
+    return sync;
+}
+
+/**
+ * RX stage 1: demodulates one modem frame with f_FREEDV and queues the codec2 frames for FreeDv_RxSynthesis.
+ *
+ * Only one modem frame is processed per call, we are called much more often than modem frames arrive,
+ * so a backlog caused by freedv_nin() jitter is caught up within a few calls without blocking the synthesis.
+ */
+static void FreeDv_RxDemod()
+{
+    const int nin = freedv_nin(f_FREEDV);
+
+    if (RingBuffer_GetData(&input_rb) >= nin
+            && RingBuffer_GetRoom(&fdv_codec_rb) > FreeDv_MaxCodecFrames(f_FREEDV))
+    {
+        FREEDV_RX_INPUT_T input_buffer[freedv_get_n_max_modem_samples(f_FREEDV)];
+
+#ifdef USE_SIMPLE_FREEDV_FILTERS
+        input_rb_item_t input_samples[nin];
+        RingBuffer_GetSamples(&input_rb, input_samples, nin);
+        for (int idx = 0; idx < nin; idx++)
+        {
+            input_buffer[idx].real = input_samples[idx].real;
+            input_buffer[idx].imag = input_samples[idx].imag;
+        }
+#else
+        RingBuffer_GetSamples(&input_rb, input_buffer, nin);
+#endif
+
+        FreeDv_RxDemodFrame(f_FREEDV, input_buffer, true);
+    }
+}
+
+#ifdef USE_FREEDV_AUTO
+static bool FreeDv_AutoChanActive(int idx)
+{
+    return fdv_auto.winner < 0 || fdv_auto.winner == idx;
+}
+
+/**
+ * Drops the demodulator input buffered for all modes, e.g. after TX
+ */
+static void FreeDv_AutoClearInput()
+{
+    for (int idx = 0; idx < fdv_auto.chan_num; idx++)
+    {
+        fdv_auto.chan[idx].count = 0;
+        fdv_auto.chan[idx].sync_samples = 0;
+    }
+}
+
+/**
+ * Starts the search, all modes are run again
+ */
+static void FreeDv_AutoSearch()
+{
+    fdv_auto.winner = -1;
+    fdv_auto.next = 0;
+    FreeDv_AutoClearInput();
+}
+
+static void FreeDv_AutoLock(int idx)
+{
+    fdv_auto.winner = idx;
+    fdv_auto.nosync_samples = 0;
+    f_FREEDV = fdv_auto.chan[idx].f;
+    // queued codec2 frames may belong to the previous winner
+    RingBuffer_ClearGetTail(&fdv_codec_rb);
+}
+
+/**
+ * RX stage 1 of mode AUTO: the demodulator input is shared by all modes which are run, each one gets a copy
+ * of the new samples. Per call one modem frame of one mode is demodulated, while searching the modes take turns.
+ */
+static void FreeDv_RxDemodAuto()
+{
+    int32_t num = RingBuffer_GetData(&input_rb);
+
+    for (int idx = 0; idx < fdv_auto.chan_num; idx++)
+    {
+        if (FreeDv_AutoChanActive(idx) && num > FDV_AUTO_CHAN_SIZE - fdv_auto.chan[idx].count)
+        {
+            num = FDV_AUTO_CHAN_SIZE - fdv_auto.chan[idx].count;
+        }
+    }
+
+    if (num > 0)
+    {
+        const input_rb_item_t* samples = NULL;
+
+        for (int idx = 0; idx < fdv_auto.chan_num; idx++)
+        {
+            fdv_auto_chan_t* chan = &fdv_auto.chan[idx];
+            if (FreeDv_AutoChanActive(idx))
+            {
+                if (samples == NULL)
+                {
+                    RingBuffer_GetSamples(&input_rb, &chan->buffer[chan->count], num);
+                    samples = &chan->buffer[chan->count];
+                }
+                else
+                {
+                    memcpy(&chan->buffer[chan->count], samples, num * sizeof(chan->buffer[0]));
+                }
+                chan->count += num;
+            }
+        }
+    }
+
+    int run_idx = fdv_auto.winner;
+    if (run_idx < 0)
+    {
+        for (int tries = 0; tries < fdv_auto.chan_num && run_idx < 0; tries++)
+        {
+            const int idx = fdv_auto.next;
+            fdv_auto.next = (fdv_auto.next + 1) % fdv_auto.chan_num;
+            if (fdv_auto.chan[idx].count >= freedv_nin(fdv_auto.chan[idx].f))
+            {
+                run_idx = idx;
+            }
+        }
+    }
+
+    if (run_idx >= 0)
+    {
+        fdv_auto_chan_t* chan = &fdv_auto.chan[run_idx];
+        const int nin = freedv_nin(chan->f);
+
+        if (chan->count >= nin
+                && RingBuffer_GetRoom(&fdv_codec_rb) > FreeDv_MaxCodecFrames(chan->f))
+        {
+            const bool sync = FreeDv_RxDemodFrame(chan->f, chan->buffer, run_idx == fdv_auto.winner);
+
+            chan->count -= nin;
+            memmove(chan->buffer, &chan->buffer[nin], chan->count * sizeof(chan->buffer[0]));
+
+            if (fdv_auto.winner < 0)
+            {
+                // 700D reports sync already during its trial phase, wait for the verified sync
+                const bool verified_sync = freedv_modes[chan->fdv_mode].freedv_id == FREEDV_MODE_700D ?
+                        freedv_get_sync_interleaver(chan->f) != 0 : sync;
+
+                chan->sync_samples = verified_sync ? chan->sync_samples + nin : 0;
+                if (chan->sync_samples >= FDV_AUTO_LOCK_SAMPLES)
+                {
+                    FreeDv_AutoLock(run_idx);
+                }
+            }
+            else
+            {
+                fdv_auto.nosync_samples = sync ? 0 : fdv_auto.nosync_samples + nin;
+                if (fdv_auto.nosync_samples >= FDV_AUTO_UNLOCK_SAMPLES)
+                {
+                    FreeDv_AutoSearch();
+                }
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * RX stage 2: synthesizes one queued codec2 frame into fdv_audio_rb if there is room for it.
+ * A codec2 frame is 40ms of speech, so decoding a single frame per call keeps the time spent here
+ * short and evenly distributed, instead of decoding all frames of a 160ms 700D modem frame in one go.
+ */
+static void FreeDv_RxSynthesis()
+{
+    struct CODEC2* c2 = freedv_get_codec2(f_FREEDV);
+    const int samples_per_codec_frame = codec2_samples_per_frame(c2);
+
+    if (RingBuffer_GetData(&fdv_codec_rb) > 0
+            && RingBuffer_GetRoom(&fdv_audio_rb) > samples_per_codec_frame)
+    {
+        fdv_codec_rb_item_t codec_frame;
+        int16_t speech[samples_per_codec_frame];
+
+        RingBuffer_GetSamples(&fdv_codec_rb, &codec_frame, 1);
+
+        if (codec_frame.valid)
+        {
+            codec2_decode(c2, speech, codec_frame.bits);
+        }
+        else
+        {
+            memset(speech, 0, sizeof(speech));
+        }
+        RingBuffer_PutSamples(&fdv_audio_rb, speech, samples_per_codec_frame);
+    }
+}
+
 void FreeDv_HandleFreeDv()
 {
 
@@ -177,7 +550,7 @@ void FreeDv_HandleFreeDv()
     {
         if ((ts.txrx_mode == TRX_MODE_TX)
                 && RingBuffer_GetData(&fdv_audio_rb) >= freedv_get_n_speech_samples(f_FREEDV)
-                && RingBuffer_GetRoom(&fdv_iq_rb) >= freedv_get_n_nom_modem_samples(f_FREEDV))
+                && RingBuffer_GetRoom(&fdv_iq_rb) > freedv_get_n_nom_modem_samples(f_FREEDV))
         {
             // ...and if we are transmitting and samples from dv_tx_processor are ready
             if (tx_was_here == false)
@@ -198,14 +571,13 @@ void FreeDv_HandleFreeDv()
                     audio_buffer); // start the encoding process
             profileTimedEventStop(7);
 
+            fdv_iq_rb_item_t iq_samples[freedv_get_n_nom_modem_samples(f_FREEDV)];
             for (int idx = 0; idx < freedv_get_n_nom_modem_samples(f_FREEDV); idx++)
             {
-                fdv_iq_rb_item_t sample;
-                sample.real = iq_buffer[idx].real;
-                sample.imag = iq_buffer[idx].imag;
-
-                RingBuffer_PutSamples(&fdv_iq_rb, &sample, 1);
+                iq_samples[idx].real = iq_buffer[idx].real;
+                iq_samples[idx].imag = iq_buffer[idx].imag;
             }
+            RingBuffer_PutSamples(&fdv_iq_rb, iq_samples, freedv_get_n_nom_modem_samples(f_FREEDV));
 
         }
         else if ((ts.txrx_mode == TRX_MODE_RX))
@@ -215,7 +587,11 @@ void FreeDv_HandleFreeDv()
             if (rx_was_here == false)
             {
                 RingBuffer_ClearGetTail(&fdv_demod_rb);
+                RingBuffer_ClearGetTail(&fdv_codec_rb);
                 RingBuffer_ClearPutHead(&fdv_audio_rb);
+#ifdef USE_FREEDV_AUTO
+                FreeDv_AutoClearInput();
+#endif
 
                 freedv_set_total_bit_errors(f_FREEDV,0);  //reset ber calculation after coming from TX
                 freedv_set_total_bits(f_FREEDV,0);
@@ -224,47 +600,17 @@ void FreeDv_HandleFreeDv()
                 tx_was_here = false;
             }
 
-            // these buffers are large enough to hold the requested/provided amount of data for freedv_comprx
-            // these are larger than the FDV_BUFFER_SIZE since some more bytes may be asked for.
-#ifdef USE_SIMPLE_FREEDV_FILTERS
-            #define     input_rb fdv_iq_rb
-            #define     input_rb_item_t fdv_iq_rb_item_t
-            #define     FREEDV_RX_FUNC freedv_comprx
-            #define     FREEDV_RX_INPUT_T COMP
-#else
-            #define     input_rb fdv_demod_rb
-            #define     input_rb_item_t fdv_demod_rb_item_t
-            #define     FREEDV_RX_FUNC freedv_rx
-            #define     FREEDV_RX_INPUT_T int16_t
-#endif
-            FREEDV_RX_INPUT_T input_buffer[freedv_get_n_max_modem_samples(f_FREEDV)];
-            int16_t audio_buffer[freedv_get_n_max_modem_samples(f_FREEDV)];
-
-            // while makes this highest prio
-            // if may give more responsiveness but can cause interrupted reception
-            while (RingBuffer_GetData(&input_rb) >= freedv_nin(f_FREEDV)
-                    && RingBuffer_GetRoom(&fdv_audio_rb) >= freedv_nin(f_FREEDV))
+            // synthesis first, the audio output must not run dry while we demodulate
+            FreeDv_RxSynthesis();
+#ifdef USE_FREEDV_AUTO
+            if (fdv_auto.chan_num > 0)
             {
-                // MchfBoard_GreenLed(LED_STATE_OFF);
-                 // if we arrive here the rx_buffer is full enough and will be consumed now.
-#ifdef USE_SIMPLE_FREEDV_FILTERS
-                for (int idx = 0; idx < freedv_nin(f_FREEDV); idx++ )
-                {
-                    input_rb_item_t sample;
-                    RingBuffer_GetSamples(&input_rb, &sample, 1);
-                    input_buffer[idx].real = sample.real;
-                    input_buffer[idx].imag = sample.imag;
-                }
-#else
-                RingBuffer_GetSamples(&input_rb, &input_buffer, freedv_nin(f_FREEDV));
+                FreeDv_RxDemodAuto();
+            }
+            else
 #endif
-
-                int count = FREEDV_RX_FUNC(f_FREEDV, audio_buffer, input_buffer); // run the decoding process
-
-                if (freedv_get_sync(f_FREEDV) != 0)
-                {
-                    RingBuffer_PutSamples(&fdv_audio_rb, &audio_buffer, count);
-                }
+            {
+                FreeDv_RxDemod();
             }
         }
     }
@@ -275,27 +621,69 @@ void FreeDv_HandleFreeDv()
             tx_was_here = false;
             rx_was_here = false;
             RingBuffer_ClearGetTail(&fdv_iq_rb);
+            RingBuffer_ClearGetTail(&fdv_codec_rb);
             RingBuffer_ClearGetTail(&fdv_audio_rb);
         }
     }
 }
 
 
-// FreeDV txt test - will be out of here
+// FreeDV text channel: the beacon message in tx_str is sent if there is no text from the CAT interface
+#define FDV_TXT_IDLE_TICKS 100 // sysclock ticks (10ms) without queued text before the queued text line is ended
+
 typedef struct {
     char  tx_str[80];
     char *ptx_str;
+    bool  tx_queued_text; // we are sending text from fdv_txt_tx_rb
+    uint32_t tx_queued_tick; // sysclock when fdv_txt_tx_rb was seen non-empty the last time
 } my_callback_state_t;
 
 static my_callback_state_t  my_cb_state;
 
+/**
+ * Called by the modulator whenever it needs the next character for the text channel.
+ * Queued text interrupts the beacon message at the next character, starting on a new line.
+ * Short gaps in the queued text are filled with spaces, only after FDV_TXT_IDLE_TICKS
+ * the line is ended and the beacon message starts again.
+ */
 static char my_get_next_tx_char(void *callback_state) {
     my_callback_state_t* pstate = (my_callback_state_t*)callback_state;
+    char  c;
 
-    char  c = *pstate->ptx_str++;
+    if (RingBuffer_GetData(&fdv_txt_tx_rb) > 0)
+    {
+        if (pstate->tx_queued_text == false && pstate->ptx_str != pstate->tx_str)
+        {
+            // the beacon message is cut off, the queued text follows on a line of its own
+            c = '\r';
+            pstate->ptx_str = pstate->tx_str;
+        }
+        else
+        {
+            RingBuffer_GetSamples(&fdv_txt_tx_rb, &c, 1);
+        }
+        pstate->tx_queued_text = true;
+        pstate->tx_queued_tick = ts.sysclock;
+    }
+    else if (pstate->tx_queued_text)
+    {
+        if (ts.sysclock - pstate->tx_queued_tick > FDV_TXT_IDLE_TICKS)
+        {
+            c = '\r';
+            pstate->tx_queued_text = false;
+        }
+        else
+        {
+            c = ' ';
+        }
+    }
+    else
+    {
+        c = *pstate->ptx_str++;
 
-    if (*pstate->ptx_str == 0) {
-        pstate->ptx_str = pstate->tx_str;
+        if (*pstate->ptx_str == 0) {
+            pstate->ptx_str = pstate->tx_str;
+        }
     }
 
     return c;
@@ -306,13 +694,68 @@ static void my_put_next_rx_char(void *callback_state, char ch)
 {
     UNUSED(callback_state);
     UiDriver_TextMsgPutChar(ch);
+
+    // if nobody fetches the received text, we drop the newest characters
+    if (RingBuffer_GetRoom(&fdv_txt_rx_rb) > 1)
+    {
+        RingBuffer_PutSamples(&fdv_txt_rx_rb, &ch, 1);
+    }
+}
+
+/**
+ * Queues text to be sent in the FreeDV text channel, does not block.
+ * @return number of characters accepted, the others have to be offered again later
+ */
+int32_t FreeDV_TextTxPut(const uint8_t* text, int32_t len)
+{
+    int32_t room = RingBuffer_GetRoom(&fdv_txt_tx_rb) - 1; // PutSamples needs more room than we put in
+
+    if (len > room)
+    {
+        len = room;
+    }
+    if (len > 0)
+    {
+        RingBuffer_PutSamples(&fdv_txt_tx_rb, (void*)text, len);
+    }
+    return len > 0 ? len : 0;
+}
+
+/**
+ * @return number of characters FreeDV_TextTxPut will accept
+ */
+int32_t FreeDV_TextTxRoom()
+{
+    return RingBuffer_GetRoom(&fdv_txt_tx_rb) - 1;
+}
+
+/**
+ * Fetches text received in the FreeDV text channel, does not block.
+ * @return number of characters copied to text
+ */
+int32_t FreeDV_TextRxGet(uint8_t* text, int32_t len)
+{
+    int32_t data = RingBuffer_GetData(&fdv_txt_rx_rb);
+
+    if (len > data)
+    {
+        len = data;
+    }
+    if (len > 0)
+    {
+        RingBuffer_GetSamples(&fdv_txt_rx_rb, text, len);
+    }
+    return len;
 }
 
 freedv_mode_desc_t freedv_modes[] =
 {
-        { "1600", "FD1600", FREEDV_MODE_1600 },
+        { "1600", "FD1600", FREEDV_MODE_1600, 0 },
 #ifdef USE_FREEDV_700D
-        { "700D", "FD700D", FREEDV_MODE_700D },
+        { "700D", "FD700D", FREEDV_MODE_700D, 0 },
+#endif
+#ifdef USE_FREEDV_AUTO
+        { "AUTO", "FDAUTO", FREEDV_MODE_AUTO, 0 },
 #endif
 };
 
@@ -326,12 +769,57 @@ void  FreeDV_Init()
 
      // move this to ui_configuration;
      FreeDV_Set_Squelch_SNR(&freedv_conf,-2);
-     freedv_conf.mode = 0; // 0 = 1600, 1 = 700D
+     freedv_conf.mode = 0; // 0 = 1600, 1 = 700D, 2 = AUTO
 
+     codec2_arena_init(freedv_arena, sizeof(freedv_arena));
      FreeDV_SetMode(freedv_conf.mode, true);
 
 }
 
+static void FreeDv_SetupInstance(struct freedv* f)
+{
+    freedv_set_callback_txt(f, &my_put_next_rx_char, &my_get_next_tx_char, &my_cb_state);
+    FreeDv_SetupSquelch(f);
+    freedv_set_tx_bpf(f, 0);
+}
+
+#ifdef USE_FREEDV_AUTO
+/**
+ * Opens all modes for the parallel search of mode AUTO
+ * @return the first mode, NULL if not all modes could be opened
+ */
+static struct freedv* FreeDv_AutoOpen()
+{
+    bool ok = true;
+
+    fdv_auto.chan_num = 0;
+    for (uint8_t fdv_mode = 0; ok && fdv_mode < freedv_modes_num && fdv_auto.chan_num < FDV_AUTO_CHAN_MAX; fdv_mode++)
+    {
+        if (freedv_modes[fdv_mode].freedv_id != FREEDV_MODE_AUTO)
+        {
+            fdv_auto_chan_t* chan = &fdv_auto.chan[fdv_auto.chan_num];
+
+            chan->f = freedv_open(freedv_modes[fdv_mode].freedv_id);
+            ok = chan->f != NULL;
+            if (ok)
+            {
+                FreeDv_SetupInstance(chan->f);
+                chan->fdv_mode = fdv_mode;
+                fdv_auto.chan_num++;
+            }
+        }
+    }
+
+    if (ok == false)
+    {
+        fdv_auto.chan_num = 0;
+    }
+    FreeDv_AutoSearch();
+
+    return fdv_auto.chan_num > 0 ? fdv_auto.chan[0].f : NULL;
+}
+#endif
+
 /**
  *
  * @return true if mode was activated, false if old mode is still active
@@ -355,8 +843,16 @@ int32_t FreeDV_SetMode(uint8_t fdv_mode, int32_t firstTime)
         retval = (ts.txrx_mode == TRX_MODE_RX);
         if (retval == true && f_FREEDV != NULL && freedv_conf.mode != fdv_mode)
         {
-            freedv_close(f_FREEDV);
+            // everything the old mode allocated lives in the arena, so instead of freedv_close()
+            // we simply drop it all at once. This also takes care of memory codec2 forgets to free.
+            freedv_modes[freedv_conf.mode].arena_high_water = FreeDV_GetArenaHighWater(freedv_conf.mode);
+            codec2_arena_reset();
             f_FREEDV = NULL;
+#ifdef USE_FREEDV_AUTO
+            fdv_auto.chan_num = 0;
+#endif
+            // queued codec2 frames belong to the old mode
+            RingBuffer_ClearGetTail(&fdv_codec_rb);
         }
     }
 
@@ -365,28 +861,26 @@ int32_t FreeDV_SetMode(uint8_t fdv_mode, int32_t firstTime)
     // really
     if (retval && f_FREEDV == NULL)
     {
-        f_FREEDV = freedv_open(freedv_modes[fdv_mode].freedv_id);
+        sprintf(my_cb_state.tx_str, ts.special_functions_enabled == 1 ? FREEDV_TX_DF8OE_MESSAGE : FREEDV_TX_MESSAGE);
+        my_cb_state.ptx_str = my_cb_state.tx_str;
+        my_cb_state.tx_queued_text = false;
 
-        retval = f_FREEDV != NULL;
-        if (retval)
+#ifdef USE_FREEDV_AUTO
+        if (freedv_modes[fdv_mode].freedv_id == FREEDV_MODE_AUTO)
         {
-            sprintf(my_cb_state.tx_str, ts.special_functions_enabled == 1 ? FREEDV_TX_DF8OE_MESSAGE : FREEDV_TX_MESSAGE);
-
-            my_cb_state.ptx_str = my_cb_state.tx_str;
-            freedv_set_callback_txt(f_FREEDV, &my_put_next_rx_char, &my_get_next_tx_char, &my_cb_state);
-
-            if (FreeDV_Is_Squelch_Enable(&freedv_conf))
-            {
-                freedv_set_squelch_en(f_FREEDV,1);
-                freedv_set_snr_squelch_thresh(f_FREEDV, FreeDV_Get_Squelch_SNR(&freedv_conf));
-            }
-            else
+            f_FREEDV = FreeDv_AutoOpen();
+        }
+        else
+#endif
+        {
+            f_FREEDV = freedv_open(freedv_modes[fdv_mode].freedv_id);
+            if (f_FREEDV != NULL)
             {
-                freedv_set_squelch_en(f_FREEDV,0);
+                FreeDv_SetupInstance(f_FREEDV);
             }
-
-            freedv_set_tx_bpf(f_FREEDV, 0);
         }
+
+        retval = f_FREEDV != NULL;
     }
 
     if (retval)
@@ -399,6 +893,36 @@ int32_t FreeDV_SetMode(uint8_t fdv_mode, int32_t firstTime)
 
     return retval;
 }
+/**
+ * @return max. number of bytes of the codec2 arena used by the mode so far, 0 if the mode has never been used
+ */
+uint32_t FreeDV_GetArenaHighWater(uint8_t fdv_mode)
+{
+    uint32_t retval = freedv_modes[fdv_mode].arena_high_water;
+
+    if (f_FREEDV != NULL && fdv_mode == freedv_conf.mode && codec2_arena_high_water() > retval)
+    {
+        retval = codec2_arena_high_water();
+    }
+    return retval;
+}
+
+/**
+ * @return label of the active mode, in mode AUTO the label of the mode we are locked to
+ */
+const char* FreeDV_GetModeLabel()
+{
+    const char* retval = freedv_modes[freedv_conf.mode].label;
+
+#ifdef USE_FREEDV_AUTO
+    if (fdv_auto.chan_num > 0 && fdv_auto.winner >= 0)
+    {
+        retval = freedv_modes[fdv_auto.chan[fdv_auto.winner].fdv_mode].label;
+    }
+#endif
+    return retval;
+}
+
 int32_t FreeDV_Iq_Get_FrameLen()
 {
     return freedv_get_n_nom_modem_samples(f_FREEDV);
@@ -411,24 +935,189 @@ int32_t FreeDV_Audio_Get_FrameLen()
 
 
 #ifdef DEBUG_FREEDV
-void FreeDV_Test()
+#include "codec2_fdmdv.h"
+
+#define FDV_TEST_SECONDS    10
+#define FDV_TEST_SNR_DB     4.0 // AWGN channel, SNR in 3kHz bandwidth
+#define FDV_TEST_BUF_SIZE   (FDV_BUFFER_SIZE * 2)
+
+typedef struct
+{
+    const char* name;
+    uint32_t sync_ms;       // time until first sync, UINT32_MAX if never in sync
+    uint32_t bits;
+    uint32_t bit_errors;
+    uint32_t tx_cycles;     // average per modem frame, 0 if not measured
+    uint32_t rx_cycles;     // average per demodulator call
+} freedv_test_result_t;
+
+static COMP fdv_test_buf[FDV_TEST_BUF_SIZE];
+
+/**
+ * Runs the demodulator of f on all complete modem frames in fdv_test_buf, the remaining samples are moved to
+ * the start of the buffer.
+ * @param samples_done number of samples demodulated so far, updated
+ * @return number of samples left in fdv_test_buf
+ */
+static int32_t FreeDV_TestRx(struct freedv* f, int32_t count, uint32_t* samples_done, freedv_test_result_t* res, uint64_t* rx_cycles, uint32_t* rx_calls)
+{
+    int16_t speech[freedv_get_n_speech_samples(f)];
+    int32_t pos = 0;
+
+    while (count - pos >= freedv_nin(f))
+    {
+        const int nin = freedv_nin(f);
+#ifdef USE_SIMPLE_FREEDV_FILTERS
+        const uint32_t start = profileCycleCount_get();
+        freedv_comprx(f, speech, &fdv_test_buf[pos]);
+#else
+        // the demodulator input is real on these machines
+        int16_t demod_in[nin];
+        for (int idx = 0; idx < nin; idx++)
+        {
+            demod_in[idx] = fdv_test_buf[pos + idx].real;
+        }
+        const uint32_t start = profileCycleCount_get();
+        freedv_rx(f, speech, demod_in);
+#endif
+        *rx_cycles += profileCycleCount_get() - start;
+        (*rx_calls)++;
+
+        pos += nin;
+        *samples_done += nin;
+        if (res->sync_ms == UINT32_MAX && freedv_get_sync(f) != 0)
+        {
+            res->sync_ms = *samples_done / 8;
+        }
+    }
+    memmove(fdv_test_buf, &fdv_test_buf[pos], (count - pos) * sizeof(fdv_test_buf[0]));
+
+    return count - pos;
+}
+
+/**
+ * Loopback of a FreeDV mode: test frames are modulated, sent through an AWGN channel and demodulated again.
+ */
+static void FreeDV_TestLoopback(uint8_t fdv_mode, freedv_test_result_t* res)
+{
+    res->name = freedv_modes[fdv_mode].name;
+    res->sync_ms = UINT32_MAX;
+
+    struct freedv* f = freedv_open(freedv_modes[fdv_mode].freedv_id);
+    if (f != NULL)
+    {
+        const int n_nom = freedv_get_n_nom_modem_samples(f);
+        int16_t speech[freedv_get_n_speech_samples(f)];
+        float sig_pwr_av = 0.0;
+        int32_t count = 0;
+        uint32_t samples_done = 0;
+        uint64_t tx_cycles = 0, rx_cycles = 0;
+        uint32_t tx_calls = 0, rx_calls = 0;
+
+        freedv_set_test_frames(f, 1);
+        freedv_set_tx_bpf(f, 0);
+        memset(speech, 0, sizeof(speech)); // not used with test frames
+
+        for (int32_t frames = FDV_TEST_SECONDS * 8000 / n_nom; frames > 0 && count + n_nom <= FDV_TEST_BUF_SIZE; frames--)
+        {
+            const uint32_t start = profileCycleCount_get();
+            freedv_comptx(f, &fdv_test_buf[count], speech);
+            tx_cycles += profileCycleCount_get() - start;
+            tx_calls++;
+
+            fdmdv_simulate_channel(&sig_pwr_av, &fdv_test_buf[count], n_nom, FDV_TEST_SNR_DB);
+            count = FreeDV_TestRx(f, count + n_nom, &samples_done, res, &rx_cycles, &rx_calls);
+        }
+
+        res->bits = freedv_get_total_bits(f);
+        res->bit_errors = freedv_get_total_bit_errors(f);
+        res->tx_cycles = tx_calls ? tx_cycles / tx_calls : 0;
+        res->rx_cycles = rx_calls ? rx_cycles / rx_calls : 0;
+    }
+    codec2_arena_reset();
+}
+
+/**
+ * Demodulates the recorded 1600 signal in test_buffer, there are no test frames in it, so only the time to sync
+ * and the demodulator cycles are reported.
+ */
+static void FreeDV_TestRecording(freedv_test_result_t* res)
 {
-    ts.digital_mode = DigitalMode_FreeDV;
-    ts.txrx_mode = TRX_MODE_RX;
-    while (1)
+    res->name = "REC";
+    res->sync_ms = UINT32_MAX;
+
+    struct freedv* f = freedv_open(FREEDV_MODE_1600);
+    if (f != NULL)
     {
-        for (int idx = 0; idx < FREEDV_TEST_BUFFER_FRAME_SIZE*FREEDV_TEST_BUFFER_FRAME_COUNT; idx++)
+        int32_t count = 0;
+        uint32_t samples_done = 0;
+        uint64_t rx_cycles = 0;
+        uint32_t rx_calls = 0;
+
+        for (int idx = 0; idx < FREEDV_TEST_BUFFER_FRAME_COUNT; idx++)
         {
-            int16_t sample[2];
-            sample[0] = test_buffer[idx].real;
-            sample[1] = test_buffer[idx].imag;
+            memcpy(&fdv_test_buf[count], &test_buffer[idx * FREEDV_TEST_BUFFER_FRAME_SIZE], FREEDV_TEST_BUFFER_FRAME_SIZE * sizeof(COMP));
+            count = FreeDV_TestRx(f, count + FREEDV_TEST_BUFFER_FRAME_SIZE, &samples_done, res, &rx_cycles, &rx_calls);
+        }
+        res->rx_cycles = rx_calls ? rx_cycles / rx_calls : 0;
+    }
+    codec2_arena_reset();
+}
 
-            RingBuffer_PutSamples(&fdv_iq_rb,&sample,2);
-            FreeDv_HandleFreeDv();
-            RingBuffer_GetSamples(&fdv_audio_rb,sample,1);
+/**
+ * FreeDV self test, takes over the radio for a few seconds per mode. Runs every mode through
+ * modulator -> AWGN channel -> demodulator and the recorded signal in test_buffer through the demodulator, then
+ * shows per mode the time to sync, the bit error rate and the cycles per modulator / demodulator call on the LCD.
+ * Afterwards the configured mode is opened again.
+ * support/hosttest/freedv_channel.c runs the same loopback off target, including fading channels.
+ */
+void FreeDV_Test()
+{
+    freedv_test_result_t results[freedv_modes_num + 1];
+    uint8_t results_num = 0;
+
+    const uint8_t digital_mode = ts.digital_mode;
+
+    // keep FreeDv_HandleFreeDv and the audio driver away from f_FREEDV while we use the arena
+    ts.digital_mode = DigitalMode_None;
+    codec2_arena_reset();
+    f_FREEDV = NULL;
+#ifdef USE_FREEDV_AUTO
+    fdv_auto.chan_num = 0;
+#endif
+    RingBuffer_ClearGetTail(&fdv_codec_rb);
+
+    memset(results, 0, sizeof(results));
+    for (uint8_t fdv_mode = 0; fdv_mode < freedv_modes_num; fdv_mode++)
+    {
+#ifdef USE_FREEDV_AUTO
+        if (freedv_modes[fdv_mode].freedv_id == FREEDV_MODE_AUTO)
+        {
+            continue;
         }
+#endif
+        FreeDV_TestLoopback(fdv_mode, &results[results_num++]);
     }
+    FreeDV_TestRecording(&results[results_num++]);
+
+    FreeDV_SetMode(freedv_conf.mode, true);
+    ts.digital_mode = digital_mode;
 
+    UiLcdHy28_LcdClear(Black);
+    UiLcdHy28_PrintText(0, 0, "FreeDV test: sync ms, BER, kcyc TX/RX", Yellow, Black, 0);
+    for (int idx = 0; idx < results_num; idx++)
+    {
+        char line[48];
+        const freedv_test_result_t* res = &results[idx];
+
+        snprintf(line, sizeof(line), "%-4s %5ld %5lu/%-6lu %5lu %5lu",
+                res->name,
+                res->sync_ms == UINT32_MAX ? -1 : (int32_t)res->sync_ms,
+                res->bit_errors, res->bits,
+                res->tx_cycles / 1000, res->rx_cycles / 1000);
+        UiLcdHy28_PrintText(0, (idx + 1) * UiLcdHy28_TextHeight(0), line,
+                res->sync_ms == UINT32_MAX ? Red : White, Black, 0);
+    }
 }
 #endif
 
@@ -72,15 +72,39 @@ typedef union
 #define FREEDV_TX_MESSAGE	" CQ CQ CQ UHSDR " TRX_NAME " SDR with integrated FreeDV codec calling!"
 #define FREEDV_TX_DF8OE_MESSAGE	" DF8OE JO42jr using UHSDR " TRX_NAME " SDR with integrated FreeDV codec"
 
+// all memory of the codec2 / FreeDV code comes from a static arena (see codec2_arena.h)
+// budgets are the high water mark of opening and running the mode, measured on a 64bit host
+// so they are an upper bound for the 32bit MCUs
+#define FDV_ARENA_1600 (66*1024)
+#define FDV_ARENA_700D (94*1024)
+
+#if defined(USE_FREEDV_AUTO)
+    // all modes are open at the same time while searching
+    #define FDV_ARENA_SIZE (FDV_ARENA_700D + FDV_ARENA_1600)
+#elif defined(USE_FREEDV_700D)
+    #define FDV_ARENA_SIZE (FDV_ARENA_700D > FDV_ARENA_1600 ? FDV_ARENA_700D : FDV_ARENA_1600)
+#else
+    #define FDV_ARENA_SIZE FDV_ARENA_1600
+#endif
+
+#ifdef USE_FREEDV_AUTO
+// not a codec2 mode id, used for the mode which runs the sync search of all other modes in parallel
+#define FREEDV_MODE_AUTO 0xff
+#endif
+
 typedef struct {
     char* name;
     char* label;
     uint8_t freedv_id;
+    uint32_t arena_high_water; // max. arena usage seen while this mode was active, 0 if never used
 } freedv_mode_desc_t;
 
 extern    freedv_mode_desc_t freedv_modes[];
 extern    const uint8_t freedv_modes_num;
 
+uint32_t FreeDV_GetArenaHighWater(uint8_t fdv_mode);
+const char* FreeDV_GetModeLabel();
+
 
 
 typedef struct {
@@ -107,6 +131,10 @@ int32_t FreeDV_Iq_Get_FrameLen();
 int32_t FreeDV_Audio_Get_FrameLen();
 
 
+int32_t FreeDV_TextTxPut(const uint8_t* text, int32_t len);
+int32_t FreeDV_TextTxRoom();
+int32_t FreeDV_TextRxGet(uint8_t* text, int32_t len);
+
 void FreeDv_DisplayClear();
 void FreeDv_DisplayPrepare();
 void FreeDv_DisplayUpdate();
@@ -0,0 +1,825 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+ **                                                                                 **
+ **                               UHSDR FIRMWARE                                    **
+ **                                                                                 **
+ **---------------------------------------------------------------------------------**
+ **  Licence:        GNU GPLv3, see LICENSE.md                                                      **
+ ************************************************************************************/
+
+/*
+ * FT8 receive engine
+ *
+ * The work is split in two parts so that the audio processing is never delayed by the decoder:
+ *
+ * - Ft8_RxProcessor() runs in the audio interrupt and only copies the 12ksps audio into a ring buffer.
+ * - Ft8_HandleDecoder() runs from the main loop and does one small piece of work per call:
+ *   one spectrum of the waterfall (every 80ms), one sync search row or one LDPC decode attempt.
+ *
+ * Per slot a waterfall with half symbol time steps and half tone frequency steps is recorded (8 bit, 0.5dB units).
+ * After ~13.8s the Costas arrays are searched in the waterfall (time offsets of +-2s), the best candidates are converted into
+ * 174 soft bits which are decoded with the LDPC decoder of the FreeDV codec (mpdecode_core.c).
+ * Its Tanner graph is kept in ft8_decoder and not in the codec2 arena, which FreeDV resets at will.
+ * Everything has to be finished before the next slot starts, otherwise remaining candidates are dropped.
+ */
+
+#include "uhsdr_board.h"
+
+#ifdef USE_FT8_DECODER
+
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include "ft8.h"
+#include "ft8_ldpc.h"
+#include "kiss_fftr.h"
+#include "mpdecode_core.h"
+#include "uhsdr_rtc.h"
+#include "ui_driver.h" // only necessary because of UiDriver_TextMsgPutChar
+
+#define FT8_SAMPLE_RATE			12000
+#define FT8_SYMBOL_SAMPLES		1920 // 6.25 baud
+#define FT8_HOP_SAMPLES			(FT8_SYMBOL_SAMPLES/2) // waterfall time step, half a symbol
+#define FT8_FFT_SIZE			(2*FT8_SYMBOL_SAMPLES) // zero padded, gives 3.125Hz bins, half the tone spacing
+
+#define FT8_NUM_SYMBOLS			79
+#define FT8_NUM_DATA_SYMBOLS	58
+#define FT8_NUM_TONES			8
+#define FT8_COSTAS_LEN			7
+
+#define FT8_BIN_MIN				64 // 200Hz
+#define FT8_NUM_BINS			896 // up to 3000Hz
+#define FT8_NUM_STEPS			172 // 13.76s, leaves ~1.2s for the decoding
+
+// time offsets checked by the sync search, dt -2..+2s. A signal with dt 0 starts 0.5s into the slot, i.e. at step 7.25.
+// Signals that are cut off by the waterfall are searched with the remaining two Costas arrays,
+// the lost data symbols (up to 2 at either end) are given to the LDPC decoder as erasures.
+#define FT8_SEARCH_T_MIN		(-18)
+#define FT8_SEARCH_T_MAX		32
+#define FT8_SEARCH_F_NUM		(FT8_NUM_BINS - 2*(FT8_NUM_TONES-1)) // frequency offsets checked by the sync search
+#define FT8_MAX_CANDIDATES		40
+#define FT8_MIN_SYNC_SCORE		6 // 3dB
+
+#define FT8_WF_REF				96 // waterfall value of the mean noise power of a time step
+#define FT8_NOISE_LOG_BIAS		2.51 // dB, mean power of white noise minus the mean of its dB values
+#define FT8_SNR_BW_DB			24 // 2500Hz relative to the noise bandwidth of a waterfall bin (Hann window, 1.5 * 6.25Hz)
+
+#define FT8_RING_SIZE			8192 // must be power of 2, ~680ms of audio
+#define FT8_RING_MASK			(FT8_RING_SIZE-1)
+
+#ifdef LDPC_MIN_SUM
+#define FT8_LDPC_EDGES			LDPC_MS_GRAPH_EDGES(FT8_174_91_NUMBERPARITYBITS, FT8_174_91_MAX_ROW_WEIGHT)
+#endif
+
+#define FT8_MSG_BITS			77
+#define FT8_CRC_BITS			14
+#define FT8_CRC_POLY			0x2757
+
+// limits of the 28 bit callsign and 15 bit grid fields
+#define FT8_NTOKENS				2063592
+#define FT8_MAX22				4194304
+#define FT8_MAXGRID4			32400
+
+typedef enum
+{
+	FT8_STATE_WAIT_SLOT = 0,
+	FT8_STATE_CAPTURE,
+	FT8_STATE_SEARCH,
+	FT8_STATE_DECODE,
+} ft8_state_t;
+
+typedef struct
+{
+	int16_t score;
+	int16_t t; // waterfall step of the first symbol, may be outside the waterfall
+	uint16_t f; // waterfall bin of tone 0
+} ft8_candidate_t;
+
+typedef struct
+{
+	// written by audio interrupt only
+	float32_t ring[FT8_RING_SIZE];
+	volatile uint32_t ring_wr;
+
+	// everything below belongs to the main loop
+	uint32_t ring_rd;
+	ft8_state_t state;
+	uint8_t last_second;
+	uint8_t slot_second;
+	uint16_t step; // number of waterfall lines captured in this slot
+	int16_t search_t; // next time offset to be searched
+	uint16_t decode_idx; // next candidate to be decoded
+
+	kiss_fftr_cfg fft_cfg;
+	float32_t window[FT8_SYMBOL_SAMPLES];
+	float32_t fft_in[FT8_FFT_SIZE];
+	kiss_fft_cpx fft_out[FT8_FFT_SIZE/2+1];
+	float32_t llr[FT8_174_91_CODELENGTH];
+	uint8_t codeword[FT8_174_91_CODELENGTH];
+
+	ft8_candidate_t candidates[FT8_MAX_CANDIDATES];
+	uint8_t num_candidates;
+
+	struct LDPC ldpc;
+#ifdef LDPC_MIN_SUM
+	struct LDPC_MS_GRAPH ldpc_graph;
+	uint16_t ldpc_c_first[FT8_174_91_NUMBERPARITYBITS + 1];
+	uint16_t ldpc_c_var[FT8_LDPC_EDGES];
+	uint16_t ldpc_v_first[FT8_174_91_CODELENGTH + 1];
+	uint16_t ldpc_v_edge[FT8_LDPC_EDGES];
+	int16_t ldpc_c2v[FT8_LDPC_EDGES];
+	int16_t ldpc_v2c[FT8_LDPC_EDGES];
+#endif
+
+	bool initialized;
+} ft8_decoder_t;
+
+static ft8_decoder_t ft8_decoder;
+
+// the waterfall of one slot, this is the big one (~150k)
+static uint8_t ft8_waterfall[FT8_NUM_STEPS][FT8_NUM_BINS];
+
+ft8_result_t ft8_result;
+
+static const uint8_t ft8_costas[FT8_COSTAS_LEN] = { 3, 1, 4, 0, 6, 5, 2 };
+static const uint8_t ft8_graymap[FT8_NUM_TONES] = { 0, 1, 3, 2, 5, 6, 4, 7 };
+
+// character sets used by the message packing
+static const char ft8_chars_alnum_space[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const char ft8_chars_alnum[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const char ft8_chars_letters_space[] = " ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const char ft8_chars_text[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ+-./?";
+
+/**
+ * @brief allocates the fft and sets up the LDPC decoder and its graph, only done once since the fft memory is never given back
+ */
+void Ft8_Decoder_Init()
+{
+	ft8_decoder_t* dec = &ft8_decoder;
+
+	if (dec->initialized == false)
+	{
+		dec->fft_cfg = kiss_fftr_alloc(FT8_FFT_SIZE, 0, NULL, NULL);
+
+		for (int i = 0; i < FT8_SYMBOL_SAMPLES; i++)
+		{
+			// Hann window, scaled so that the fft output does not depend on the fft length
+			dec->window[i] = (1.0 - cosf(2 * PI * i / FT8_SYMBOL_SAMPLES)) / FT8_SYMBOL_SAMPLES;
+		}
+
+		dec->ldpc.max_iter = FT8_174_91_MAX_ITER;
+		dec->ldpc.dec_type = FT8_174_91_DEC_TYPE;
+		dec->ldpc.q_scale_factor = 1;
+		dec->ldpc.r_scale_factor = 1;
+		dec->ldpc.CodeLength = FT8_174_91_CODELENGTH;
+		dec->ldpc.NumberParityBits = FT8_174_91_NUMBERPARITYBITS;
+		dec->ldpc.NumberRowsHcols = FT8_174_91_NUMBERROWSHCOLS;
+		dec->ldpc.max_row_weight = FT8_174_91_MAX_ROW_WEIGHT;
+		dec->ldpc.max_col_weight = FT8_174_91_MAX_COL_WEIGHT;
+		dec->ldpc.H_rows = (uint16_t *) FT8_174_91_H_rows;
+		dec->ldpc.H_cols = (uint16_t *) FT8_174_91_H_cols;
+
+#ifdef LDPC_MIN_SUM
+		dec->ldpc_graph.c_first = dec->ldpc_c_first;
+		dec->ldpc_graph.c_var = dec->ldpc_c_var;
+		dec->ldpc_graph.v_first = dec->ldpc_v_first;
+		dec->ldpc_graph.v_edge = dec->ldpc_v_edge;
+		dec->ldpc_graph.c2v = dec->ldpc_c2v;
+		dec->ldpc_graph.v2c = dec->ldpc_v2c;
+		ldpc_ms_graph_init(&dec->ldpc, &dec->ldpc_graph);
+#endif
+
+		dec->initialized = true;
+	}
+
+	dec->state = FT8_STATE_WAIT_SLOT;
+	dec->last_second = 0xff;
+	ft8_result.count = 0;
+}
+
+/**
+ * @brief audio interrupt part, just stores the 12ksps audio
+ */
+void Ft8_RxProcessor(float32_t* src, int16_t blockSize)
+{
+	uint32_t wr = ft8_decoder.ring_wr;
+	for (int i = 0; i < blockSize; i++)
+	{
+		ft8_decoder.ring[(wr + i) & FT8_RING_MASK] = src[i];
+	}
+	ft8_decoder.ring_wr = wr + blockSize;
+}
+
+/**
+ * @brief current second of the minute, from RTC if available, otherwise from the system tick (not synchronized!)
+ */
+static uint8_t Ft8_GetSecond()
+{
+	uint8_t retval;
+	if (ts.rtc_present)
+	{
+		RTC_TimeTypeDef sTime;
+		Rtc_GetTime(&hrtc, &sTime, RTC_FORMAT_BIN);
+		retval = sTime.Seconds;
+	}
+	else
+	{
+		retval = (HAL_GetTick() / 1000) % 60;
+	}
+	return retval;
+}
+
+/**
+ * @brief calculates one waterfall line from the audio in the ring buffer
+ */
+static void Ft8_WaterfallStep(uint8_t* line)
+{
+	ft8_decoder_t* dec = &ft8_decoder;
+
+	for (int i = 0; i < FT8_SYMBOL_SAMPLES; i++)
+	{
+		dec->fft_in[i] = dec->ring[(dec->ring_rd + i) & FT8_RING_MASK] * dec->window[i];
+	}
+	memset(&dec->fft_in[FT8_SYMBOL_SAMPLES], 0, (FT8_FFT_SIZE - FT8_SYMBOL_SAMPLES) * sizeof(dec->fft_in[0]));
+
+	kiss_fftr(dec->fft_cfg, dec->fft_in, dec->fft_out);
+
+	// we reuse fft_in for the dB values, it is no longer needed
+	float32_t* power_db = dec->fft_in;
+	float32_t db_sum = 0;
+	for (int bin = 0; bin < FT8_NUM_BINS; bin++)
+	{
+		const kiss_fft_cpx* c = &dec->fft_out[FT8_BIN_MIN + bin];
+		power_db[bin] = 10 * log10f(c->r * c->r + c->i * c->i + 1e-20);
+		db_sum += power_db[bin];
+	}
+
+	// the values are stored relative to the noise power of this step, so we don't depend on the audio level.
+	// The mean of the dB values is hardly moved by the few bins with signals, for noise it is 2.5dB below its mean power.
+	const float32_t ref_db = db_sum / FT8_NUM_BINS + FT8_NOISE_LOG_BIAS;
+	for (int bin = 0; bin < FT8_NUM_BINS; bin++)
+	{
+		int32_t val = FT8_WF_REF + (int32_t)(2 * (power_db[bin] - ref_db));
+		line[bin] = val < 0 ? 0 : (val > 255 ? 255 : val);
+	}
+}
+
+/**
+ * @brief Costas array sync score of a signal with first symbol in step t and tone 0 at bin f
+ * @return score in 0.5dB units, difference of the sync tones against their neighbours in frequency and time,
+ *         symbols outside the waterfall are not counted
+ */
+static int16_t Ft8_SyncScore(int16_t t, uint16_t f)
+{
+	int32_t score = 0;
+	int32_t count = 0;
+
+	for (int m = 0; m < 3; m++)
+	{
+		for (int k = 0; k < FT8_COSTAS_LEN; k++)
+		{
+			const int16_t t_sym = t + 2 * (36 * m + k);
+			if (t_sym < 0 || t_sym >= FT8_NUM_STEPS)
+			{
+				continue;
+			}
+			const uint8_t tone = ft8_costas[k];
+			const uint8_t* p = &ft8_waterfall[t_sym][f];
+			const int32_t s = p[2 * tone];
+
+			if (tone > 0)
+			{
+				score += s - p[2 * (tone - 1)];
+				count++;
+			}
+			if (tone < FT8_NUM_TONES - 1)
+			{
+				score += s - p[2 * (tone + 1)];
+				count++;
+			}
+			if (t_sym >= 2)
+			{
+				score += s - ft8_waterfall[t_sym - 2][f + 2 * tone];
+				count++;
+			}
+			if (t_sym + 2 < FT8_NUM_STEPS)
+			{
+				score += s - ft8_waterfall[t_sym + 2][f + 2 * tone];
+				count++;
+			}
+		}
+	}
+	return count ? score / count : 0;
+}
+
+/**
+ * @brief searches one time offset over all frequencies and keeps the best candidates
+ */
+static void Ft8_SearchRow(int16_t t)
+{
+	ft8_decoder_t* dec = &ft8_decoder;
+
+	for (uint16_t f = 0; f < FT8_SEARCH_F_NUM; f++)
+	{
+		const int16_t score = Ft8_SyncScore(t, f);
+		if (score >= FT8_MIN_SYNC_SCORE)
+		{
+			int idx;
+			if (dec->num_candidates < FT8_MAX_CANDIDATES)
+			{
+				idx = dec->num_candidates++;
+			}
+			else
+			{
+				// replace the weakest one if we are better
+				idx = 0;
+				for (int i = 1; i < FT8_MAX_CANDIDATES; i++)
+				{
+					if (dec->candidates[i].score < dec->candidates[idx].score)
+					{
+						idx = i;
+					}
+				}
+				if (dec->candidates[idx].score >= score)
+				{
+					idx = -1;
+				}
+			}
+			if (idx >= 0)
+			{
+				dec->candidates[idx].score = score;
+				dec->candidates[idx].t = t;
+				dec->candidates[idx].f = f;
+			}
+		}
+	}
+}
+
+/**
+ * @brief sorts the candidates by descending score, so the strongest are decoded first
+ */
+static void Ft8_SortCandidates()
+{
+	ft8_decoder_t* dec = &ft8_decoder;
+
+	for (int i = 1; i < dec->num_candidates; i++)
+	{
+		const ft8_candidate_t c = dec->candidates[i];
+		int j = i;
+		for (; j > 0 && dec->candidates[j-1].score < c.score; j--)
+		{
+			dec->candidates[j] = dec->candidates[j-1];
+		}
+		dec->candidates[j] = c;
+	}
+}
+
+/**
+ * @brief extracts the 174 soft bits of a candidate, max-log approximation on the dB values of the 8 tones
+ * Symbols outside the waterfall give 0, i.e. erasures.
+ */
+static void Ft8_ExtractLlr(const ft8_candidate_t* cand, float32_t* llr)
+{
+	float32_t sum = 0, sum2 = 0;
+	int32_t num_llr = 0;
+
+	for (int i = 0; i < FT8_NUM_DATA_SYMBOLS; i++)
+	{
+		// skip the Costas arrays at symbols 0..6, 36..42, 72..78
+		const int k = i < FT8_NUM_DATA_SYMBOLS/2 ? i + 7 : i + 14;
+		const int16_t t_sym = cand->t + 2 * k;
+		if (t_sym < 0 || t_sym >= FT8_NUM_STEPS)
+		{
+			llr[3 * i] = llr[3 * i + 1] = llr[3 * i + 2] = 0;
+			continue;
+		}
+		const uint8_t* p = &ft8_waterfall[t_sym][cand->f];
+
+		float32_t s[FT8_NUM_TONES];
+		for (int j = 0; j < FT8_NUM_TONES; j++)
+		{
+			s[j] = p[2 * ft8_graymap[j]];
+		}
+
+		for (int b = 0; b < 3; b++)
+		{
+			const int mask = 4 >> b;
+			float32_t max_one = 0, max_zero = 0;
+			for (int j = 0; j < FT8_NUM_TONES; j++)
+			{
+				if (j & mask)
+				{
+					max_one = s[j] > max_one ? s[j] : max_one;
+				}
+				else
+				{
+					max_zero = s[j] > max_zero ? s[j] : max_zero;
+				}
+			}
+			const float32_t l = max_one - max_zero;
+			llr[3 * i + b] = l;
+			sum += l;
+			sum2 += l * l;
+		}
+		num_llr += 3;
+	}
+
+	// normalize to a variance of 24, works well with the sum product decoder
+	// mpdecode_core expects negative values for a 1 bit
+	const float32_t mean = sum / num_llr;
+	const float32_t var = sum2 / num_llr - mean * mean;
+	const float32_t scale = var > 0 ? -sqrtf(24.0 / var) : -1.0;
+	arm_scale_f32(llr, scale, llr, FT8_174_91_CODELENGTH);
+}
+
+/**
+ * @brief CRC-14 over the 77 message bits, zero extended to 82 bits, as used by FT8
+ */
+static uint16_t Ft8_Crc(const uint8_t* bits)
+{
+	uint16_t crc = 0;
+	for (int i = 0; i < FT8_MSG_BITS + 5; i++)
+	{
+		const uint16_t bit = i < FT8_MSG_BITS ? bits[i] : 0;
+		const uint16_t feedback = ((crc >> (FT8_CRC_BITS - 1)) & 1) ^ bit;
+		crc = (crc << 1) & ((1 << FT8_CRC_BITS) - 1);
+		if (feedback)
+		{
+			crc ^= FT8_CRC_POLY;
+		}
+	}
+	return crc;
+}
+
+static uint32_t Ft8_GetBits(const uint8_t* bits, int start, int len)
+{
+	uint32_t retval = 0;
+	for (int i = 0; i < len; i++)
+	{
+		retval = (retval << 1) | bits[start + i];
+	}
+	return retval;
+}
+
+/**
+ * @brief unpacks a 28 bit callsign field
+ * @return false if the value is not a valid callsign or token
+ */
+static bool Ft8_UnpackCall(uint32_t n28, bool suffix, char suffix_char, char* out)
+{
+	bool retval = true;
+
+	if (n28 < FT8_NTOKENS)
+	{
+		if (n28 == 0)
+		{
+			strcpy(out, "DE");
+		}
+		else if (n28 == 1)
+		{
+			strcpy(out, "QRZ");
+		}
+		else if (n28 == 2)
+		{
+			strcpy(out, "CQ");
+		}
+		else if (n28 <= 1002)
+		{
+			sprintf(out, "CQ %03u", (unsigned int)(n28 - 3));
+		}
+		else if (n28 <= 532443)
+		{
+			// CQ with up to 4 letters, e.g. "CQ DX"
+			uint32_t n = n28 - 1003;
+			char aaaa[5];
+			for (int i = 3; i >= 0; i--)
+			{
+				aaaa[i] = ft8_chars_letters_space[n % 27];
+				n /= 27;
+			}
+			aaaa[4] = '\0';
+			char* a = aaaa;
+			while (*a == ' ')
+			{
+				a++;
+			}
+			sprintf(out, "CQ %s", a);
+		}
+		else
+		{
+			retval = false;
+		}
+	}
+	else if (n28 - FT8_NTOKENS < FT8_MAX22)
+	{
+		// we don't keep a table of received callsigns, so hashed calls can't be resolved
+		strcpy(out, "<...>");
+	}
+	else
+	{
+		uint32_t n = n28 - FT8_NTOKENS - FT8_MAX22;
+		char call[7];
+
+		call[5] = ft8_chars_letters_space[n % 27]; n /= 27;
+		call[4] = ft8_chars_letters_space[n % 27]; n /= 27;
+		call[3] = ft8_chars_letters_space[n % 27]; n /= 27;
+		call[2] = '0' + n % 10; n /= 10;
+		call[1] = ft8_chars_alnum[n % 36]; n /= 36;
+		if (n < 37)
+		{
+			call[0] = ft8_chars_alnum_space[n];
+			call[6] = '\0';
+
+			char* c = call;
+			while (*c == ' ')
+			{
+				c++;
+			}
+			for (char* e = &call[5]; e > c && *e == ' '; e--)
+			{
+				*e = '\0';
+			}
+
+			// special prefixes which don't fit into the standard callsign layout
+			if (strncmp(c, "3D0", 3) == 0)
+			{
+				sprintf(out, "3DA0%s", c + 3);
+			}
+			else if (c[0] == 'Q' && c[1] >= 'A' && c[1] <= 'Z')
+			{
+				sprintf(out, "3X%s", c + 1);
+			}
+			else
+			{
+				strcpy(out, c);
+			}
+
+			if (suffix)
+			{
+				const size_t len = strlen(out);
+				out[len] = '/';
+				out[len+1] = suffix_char;
+				out[len+2] = '\0';
+			}
+		}
+		else
+		{
+			retval = false;
+		}
+	}
+	return retval;
+}
+
+/**
+ * @brief unpacks 71 bit free text, 13 characters base 42
+ */
+static void Ft8_UnpackText(const uint8_t* bits, char* out)
+{
+	// the 71 bit number as 9 bytes, most significant byte first
+	uint8_t num[9] = { 0 };
+	for (int i = 0; i < 71; i++)
+	{
+		const int pos = i + 1; // right aligned in 72 bits
+		num[pos / 8] |= bits[i] << (7 - pos % 8);
+	}
+
+	for (int idx = 12; idx >= 0; idx--)
+	{
+		uint16_t rem = 0;
+		for (int i = 0; i < 9; i++)
+		{
+			const uint16_t cur = (rem << 8) | num[i];
+			num[i] = cur / 42;
+			rem = cur % 42;
+		}
+		out[idx] = ft8_chars_text[rem];
+	}
+	out[13] = '\0';
+
+	for (int i = 12; i >= 0 && out[i] == ' '; i--)
+	{
+		out[i] = '\0';
+	}
+}
+
+/**
+ * @brief unpacks the 77 bit message into text, only the standard message and free text are supported
+ * @return false if the message type is not supported
+ */
+static bool Ft8_Unpack(const uint8_t* bits, char* text)
+{
+	bool retval = false;
+	const uint8_t i3 = Ft8_GetBits(bits, 74, 3);
+
+	if (i3 == 0 && Ft8_GetBits(bits, 71, 3) == 0)
+	{
+		Ft8_UnpackText(bits, text);
+		retval = true;
+	}
+	else if (i3 == 1 || i3 == 2)
+	{
+		// c28 r1 c28 r1 R1 g15 i3
+		const char suffix_char = i3 == 1 ? 'R' : 'P';
+		char call_to[14], call_de[14], extra[8];
+
+		const uint32_t n28a = Ft8_GetBits(bits, 0, 28);
+		const uint32_t n28b = Ft8_GetBits(bits, 29, 28);
+		const bool ir = bits[58];
+		const uint16_t igrid4 = Ft8_GetBits(bits, 59, 15);
+
+		if (igrid4 <= FT8_MAXGRID4)
+		{
+			uint16_t n = igrid4;
+			char grid[5];
+			grid[3] = '0' + n % 10; n /= 10;
+			grid[2] = '0' + n % 10; n /= 10;
+			grid[1] = 'A' + n % 18; n /= 18;
+			grid[0] = 'A' + n % 18;
+			grid[4] = '\0';
+			sprintf(extra, "%s%s", ir ? "R " : "", grid);
+		}
+		else
+		{
+			const int irpt = igrid4 - FT8_MAXGRID4;
+			switch (irpt)
+			{
+			case 1:
+				extra[0] = '\0';
+				break;
+			case 2:
+				strcpy(extra, "RRR");
+				break;
+			case 3:
+				strcpy(extra, "RR73");
+				break;
+			case 4:
+				strcpy(extra, "73");
+				break;
+			default:
+				sprintf(extra, "%s%+03d", ir ? "R" : "", irpt - 35);
+				break;
+			}
+		}
+
+		if (Ft8_UnpackCall(n28a, bits[28], suffix_char, call_to) && Ft8_UnpackCall(n28b, bits[57], suffix_char, call_de))
+		{
+			snprintf(text, FT8_TEXT_LEN, "%s %s%s%s", call_to, call_de, extra[0] ? " " : "", extra);
+			retval = true;
+		}
+	}
+	return retval;
+}
+
+/**
+ * @brief tries to decode a single candidate, adds the message to the result list if successful
+ */
+static void Ft8_DecodeCandidate(const ft8_candidate_t* cand)
+{
+	ft8_decoder_t* dec = &ft8_decoder;
+	int parityCheckCount = 0;
+
+	Ft8_ExtractLlr(cand, dec->llr);
+	run_ldpc_decoder(&dec->ldpc, dec->codeword, dec->llr, &parityCheckCount);
+
+	bool ok = parityCheckCount == FT8_174_91_NUMBERPARITYBITS;
+
+	if (ok)
+	{
+		// the all zero codeword passes all checks but is never sent
+		uint8_t any = 0;
+		for (int i = 0; i < FT8_MSG_BITS + FT8_CRC_BITS; i++)
+		{
+			any |= dec->codeword[i];
+		}
+		ok = any != 0 && Ft8_Crc(dec->codeword) == Ft8_GetBits(dec->codeword, FT8_MSG_BITS, FT8_CRC_BITS);
+	}
+
+	ft8_message_t msg;
+	if (ok && Ft8_Unpack(dec->codeword, msg.text))
+	{
+		// neighbouring candidates often decode to the same message
+		for (int i = 0; i < ft8_result.count; i++)
+		{
+			if (strcmp(ft8_result.messages[i].text, msg.text) == 0)
+			{
+				ok = false;
+				break;
+			}
+		}
+
+		if (ok && ft8_result.count < FT8_MAX_MESSAGES)
+		{
+			// SNR from the sync tones relative to the noise power of a bin
+			int32_t sig = 0;
+			int32_t num_sig = 0;
+			for (int m = 0; m < 3; m++)
+			{
+				for (int k = 0; k < FT8_COSTAS_LEN; k++)
+				{
+					const int16_t t_sym = cand->t + 2 * (36 * m + k);
+					if (t_sym >= 0 && t_sym < FT8_NUM_STEPS)
+					{
+						sig += ft8_waterfall[t_sym][cand->f + 2 * ft8_costas[k]];
+						num_sig++;
+					}
+				}
+			}
+			const int32_t snr = (sig / num_sig - FT8_WF_REF) / 2 - FT8_SNR_BW_DB;
+
+			msg.snr = snr < -30 ? -30 : (snr > 49 ? 49 : snr);
+			msg.freq = ((FT8_BIN_MIN + cand->f) * FT8_SAMPLE_RATE + FT8_FFT_SIZE / 2) / FT8_FFT_SIZE;
+			msg.dt = (cand->t - 1) * ((float32_t)FT8_HOP_SAMPLES / FT8_SAMPLE_RATE) - 0.5;
+			ft8_result.messages[ft8_result.count++] = msg;
+
+			char line[FT8_TEXT_LEN + 12];
+			snprintf(line, sizeof(line), "%+03d %4u %s", msg.snr, msg.freq, msg.text);
+			UiDriver_TextMsgPutChar('\n');
+			for (char* c = line; *c != '\0'; c++)
+			{
+				UiDriver_TextMsgPutChar(*c);
+			}
+		}
+	}
+}
+
+/**
+ * @brief main loop part of the decoder, call as often as possible, does only a small piece of work per call
+ */
+void Ft8_HandleDecoder()
+{
+	ft8_decoder_t* dec = &ft8_decoder;
+
+	if (dec->initialized == false)
+	{
+		return;
+	}
+
+	const uint8_t second = Ft8_GetSecond();
+	if (second != dec->last_second)
+	{
+		dec->last_second = second;
+		if (second % FT8_SLOT_TIME == 0)
+		{
+			// new slot starts now, whatever we did before has to be dropped
+			// first window is centered at the slot start, so we take half a window of history
+			dec->state = FT8_STATE_CAPTURE;
+			dec->slot_second = second;
+			dec->step = 0;
+			dec->ring_rd = dec->ring_wr - FT8_HOP_SAMPLES;
+			return;
+		}
+	}
+
+	switch (dec->state)
+	{
+	case FT8_STATE_CAPTURE:
+	{
+		const uint32_t available = dec->ring_wr - dec->ring_rd;
+		if (available > FT8_RING_SIZE - FT8_HOP_SAMPLES)
+		{
+			// we were too slow, the audio has been overwritten already
+			ft8_result.overruns++;
+			dec->state = FT8_STATE_WAIT_SLOT;
+		}
+		else if (available >= FT8_SYMBOL_SAMPLES)
+		{
+			Ft8_WaterfallStep(ft8_waterfall[dec->step]);
+			dec->ring_rd += FT8_HOP_SAMPLES;
+			dec->step++;
+			if (dec->step == FT8_NUM_STEPS)
+			{
+				dec->num_candidates = 0;
+				dec->search_t = FT8_SEARCH_T_MIN;
+				dec->state = FT8_STATE_SEARCH;
+			}
+		}
+		break;
+	}
+	case FT8_STATE_SEARCH:
+		Ft8_SearchRow(dec->search_t++);
+		if (dec->search_t > FT8_SEARCH_T_MAX)
+		{
+			Ft8_SortCandidates();
+			ft8_result.count = 0;
+			ft8_result.slot_second = dec->slot_second;
+			dec->decode_idx = 0;
+			dec->state = FT8_STATE_DECODE;
+		}
+		break;
+	case FT8_STATE_DECODE:
+		if (dec->decode_idx < dec->num_candidates)
+		{
+			Ft8_DecodeCandidate(&dec->candidates[dec->decode_idx++]);
+		}
+		else
+		{
+			ft8_result.slot_count++;
+			dec->state = FT8_STATE_WAIT_SLOT;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FT8_H
+#define __FT8_H
+
+#include "uhsdr_types.h"
+
+#define FT8_SLOT_TIME			15 // seconds per FT8 transmit/receive slot
+#define FT8_MAX_MESSAGES		24 // decoded messages kept from the last slot
+#define FT8_TEXT_LEN			36 // longest unpacked message text incl. terminating zero
+
+typedef struct
+{
+	char text[FT8_TEXT_LEN];
+	float32_t dt; // time offset in s relative to the nominal start 0.5s into the slot
+	uint16_t freq; // audio frequency of tone 0 in Hz
+	int8_t snr; // rough SNR estimate in dB in 2500Hz bandwidth
+} ft8_message_t;
+
+typedef struct
+{
+	ft8_message_t messages[FT8_MAX_MESSAGES];
+	uint8_t count; // number of valid entries in messages
+	uint8_t slot_second; // slot start second (0,15,30,45) of the decoded slot
+	uint32_t slot_count; // incremented whenever a new decode result is available
+	uint32_t overruns; // slots dropped because the main loop did not keep up with the audio
+} ft8_result_t;
+
+extern ft8_result_t ft8_result;
+
+void Ft8_Decoder_Init();
+void Ft8_RxProcessor(float32_t* src, int16_t blockSize);
+void Ft8_HandleDecoder();
+
+#endif
@@ -0,0 +1,26 @@
+/*
+  FILE....: ft8_ldpc.c
+
+  Static arrays for the FT8 LDPC (174,91) code in the layout used by mpdecode_core.c.
+
+  H_rows: FT8_174_91_NUMBERPARITYBITS x FT8_174_91_MAX_ROW_WEIGHT entries, stored column by column,
+          i.e. entry j of parity check row i is H_rows[i + j * 83]. Values are the 1-based
+          codeword bit indices taking part in that check, unused entries (rows of weight 6) are 0.
+  H_cols: FT8_174_91_CODELENGTH x FT8_174_91_MAX_COL_WEIGHT entries, entry j of codeword bit i is
+          H_cols[i + j * 174]. Values are the 1-based parity check indices of that bit.
+
+  Codeword bit order is the one used on air: 77 message bits, 14 CRC bits, 83 parity bits.
+  The matrix is the one published in the FT8 protocol description / WSJT-X source (ldpc_174_91_c_reordered_parity.f90),
+  H_rows is its "Nm" table, H_cols its "Mn" table (the transpose of Nm).
+*/
+
+#include <stdint.h>
+#include "ft8_ldpc.h"
+
+const uint16_t FT8_174_91_H_rows[] = {
+4, 5, 6, 7, 8, 6, 5, 9, 10, 11, 12, 13, 8, 14, 15, 1, 16, 17, 11, 45, 8, 18, 19, 20, 2, 21, 22, 16, 23, 19, 20, 14, 3, 19, 7, 12, 13, 24, 25, 20, 21, 35, 14, 4, 1, 26, 52, 7, 23, 26, 2, 27, 18, 6, 28, 9, 22, 3, 31, 12, 5, 2, 15, 10, 23, 11, 29, 30, 10, 22, 28, 28, 1, 17, 51, 21, 16, 3, 9, 15, 18, 25, 17, 31, 32, 24, 33, 25, 32, 34, 35, 36, 37, 38, 39, 40, 41, 42, 33, 43, 37, 44, 55, 46, 36, 38, 47, 48, 45, 47, 39, 43, 35, 36, 31, 44, 46, 49, 50, 51, 52, 53, 46, 54, 82, 30, 29, 4, 51, 84, 50, 55, 41, 27, 40, 49, 33, 48, 54, 53, 13, 69, 43, 39, 54, 56, 44, 34, 49, 34, 50, 53, 57, 32, 29, 26, 27, 57, 37, 47, 24, 40, 58, 42, 38, 42, 59, 60, 61, 62, 63, 64, 65, 66, 67, 67, 68, 69, 70, 71, 59, 72, 73, 74, 75, 64, 71, 76, 77, 70, 74, 78, 58, 62, 79, 59, 63, 79, 80, 81, 58, 61, 64, 76, 69, 65, 77, 133, 83, 68, 52, 56, 110, 81, 67, 77, 41, 56, 55, 85, 70, 63, 68, 48, 133, 66, 75, 86, 87, 82, 71, 88, 87, 60, 66, 85, 72, 84, 45, 89, 98, 73, 76, 30, 90, 60, 79, 65, 75, 91, 93, 94, 95, 83, 97, 78, 99, 100, 87, 102, 103, 82, 88, 106, 106, 108, 81, 110, 111, 112, 89, 104, 92, 113, 83, 118, 112, 120, 73, 94, 98, 124, 117, 90, 118, 114, 129, 90, 80, 100, 142, 113, 120, 57, 91, 115, 99, 95, 109, 61, 124, 124, 108, 85, 131, 109, 78, 150, 89, 102, 101, 108, 91, 94, 92, 97, 86, 84, 93, 103, 88, 80, 103, 163, 138, 130, 72, 106, 74, 144, 99, 129, 92, 115, 122, 96, 93, 126, 98, 139, 107, 101, 105, 149, 104, 102, 123, 107, 141, 109, 121, 130, 119, 113, 116, 138, 128, 117, 127, 134, 131, 110, 136, 132, 127, 135, 100, 119, 118, 148, 101, 120, 140, 171, 125, 134, 86, 122, 145, 132, 172, 141, 62, 125, 141, 116, 105, 147, 121, 95, 155, 97, 136, 135, 119, 111, 127, 142, 147, 137, 112, 140, 132, 117, 128, 116, 165, 152, 137, 104, 134, 111, 146, 122, 170, 96, 146, 151, 143, 96, 138, 107, 146, 126, 139, 155, 162, 114, 123, 159, 157, 160, 131, 166, 161, 166, 114, 163, 165, 160, 121, 164, 158, 145, 125, 161, 164, 169, 167, 105, 144, 157, 149, 130, 140, 171, 174, 170, 173, 136, 137, 168, 173, 174, 148, 115, 126, 167, 156, 129, 155, 174, 123, 169, 135, 167, 164, 171, 144, 153, 157, 162, 142, 128, 159, 166, 143, 147, 153, 172, 169, 154, 139, 151, 150, 152, 160, 172, 153, 0, 0, 0, 148, 0, 154, 0, 0, 158, 0, 0, 145, 156, 0, 0, 0, 154, 0, 173, 0, 143, 0, 0, 0, 151, 0, 0, 0, 161, 0, 0, 0, 0, 168, 0, 0, 0, 156, 170, 0, 0, 0, 0, 152, 168, 0, 0, 0, 0, 133, 0, 0, 0, 158, 0, 0, 0, 0, 159, 0, 0, 0, 149, 0, 0, 0, 162, 165, 0, 0, 150, 0, 0, 0, 0, 0, 0, 0, 163, 0, 0, 0
+};
+
+const uint16_t FT8_174_91_H_cols[] = {
+16, 25, 33, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 14, 15, 17, 18, 22, 23, 24, 26, 27, 29, 3, 5, 46, 51, 55, 44, 43, 1, 2, 4, 7, 8, 9, 10, 11, 12, 13, 14, 15, 17, 19, 20, 21, 24, 25, 35, 36, 37, 38, 39, 41, 20, 46, 45, 27, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 12, 13, 14, 16, 17, 18, 19, 22, 23, 7, 29, 33, 18, 13, 5, 47, 54, 45, 10, 14, 22, 35, 1, 1, 2, 3, 4, 1, 6, 7, 8, 9, 10, 11, 12, 13, 11, 15, 7, 17, 18, 19, 20, 21, 22, 13, 2, 23, 26, 27, 21, 29, 19, 3, 14, 33, 30, 6, 27, 25, 38, 20, 18, 32, 42, 28, 34, 31, 46, 6, 8, 40, 17, 42, 4, 36, 13, 2, 56, 5, 12, 59, 3, 45, 1, 7, 11, 14, 16, 10, 15, 17, 20, 12, 23, 27, 24, 19, 34, 35, 33, 40, 41, 49, 20, 42, 45, 51, 58, 44, 7, 6, 35, 13, 56, 64, 19, 36, 37, 32, 63, 28, 74, 53, 30, 31, 41, 57, 49, 38, 39, 50, 52, 71, 67, 68, 32, 6, 16, 65, 30, 22, 18, 23, 28, 52, 50, 81, 29, 33, 26, 34, 27, 55, 53, 48, 46, 45, 57, 56, 49, 52, 70, 35, 15, 68, 36, 28, 31, 20, 40, 60, 10, 44, 39, 24, 21, 71, 30, 25, 61, 38, 41, 26, 32, 40, 34, 42, 26, 69, 55, 62, 63, 66, 60, 39, 46, 24, 5, 31, 49, 4, 60, 32, 48, 35, 39, 14, 71, 23, 35, 16, 9, 54, 50, 30, 64, 28, 25, 22, 47, 54, 34, 36, 36, 40, 26, 46, 15, 52, 43, 9, 33, 69, 55, 39, 29, 48, 51, 44, 60, 45, 68, 24, 10, 41, 50, 66, 22, 64, 29, 8, 67, 38, 38, 72, 26, 76, 65, 18, 56, 39, 37, 28, 60, 25, 30, 67, 75, 32, 69, 21, 53, 46, 59, 43, 42, 75, 44, 49, 73, 62, 78, 45, 61, 54, 48, 21, 79, 69, 66, 60, 58, 43, 80, 77, 83, 81, 34, 40, 76, 70, 65, 78, 82, 73, 74, 72, 72, 78, 59, 71, 54, 67, 42, 31, 76, 82, 61, 79, 51, 83, 60, 64, 73, 40, 77, 58, 66, 68, 75, 47, 69, 62, 53, 63, 75, 80, 30, 80, 51, 51, 56, 37, 82, 69, 49, 57, 59, 55, 65, 78, 76, 80, 83, 77, 50, 58, 81, 73, 48, 64, 43, 72, 70, 68, 67, 72, 74, 79, 64, 66, 70, 65, 58, 5, 67, 75, 82, 41, 62, 61, 74, 78, 55, 79, 16, 63, 57, 47, 80, 69, 43, 37, 51, 74, 72, 37, 63, 44, 57, 82, 58, 53, 52, 52, 65, 73, 83, 77, 56, 71, 59, 79, 62, 61, 77, 76, 78, 70, 53, 68, 72, 81, 47, 81, 73, 50, 64, 80, 79, 81, 74, 77, 59, 54, 66, 55, 70, 82, 31, 68, 80, 62, 75, 71, 61, 47, 76, 83, 63, 83, 48, 57
+};
@@ -0,0 +1,16 @@
+/*
+  FILE....: ft8_ldpc.h
+
+  Static arrays for the FT8 LDPC (174,91) code in the layout used by mpdecode_core.c.
+*/
+
+#define FT8_174_91_NUMBERPARITYBITS 83
+#define FT8_174_91_MAX_ROW_WEIGHT 7
+#define FT8_174_91_CODELENGTH 174
+#define FT8_174_91_NUMBERROWSHCOLS 174
+#define FT8_174_91_MAX_COL_WEIGHT 3
+#define FT8_174_91_DEC_TYPE 0
+#define FT8_174_91_MAX_ITER 25
+
+extern const uint16_t FT8_174_91_H_rows[];
+extern const uint16_t FT8_174_91_H_cols[];
@@ -11,6 +11,7 @@
 #include "psk.h"
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include "softdds.h"
 #include "uhsdr_digi_buffer.h"
 #include "ui_driver.h" // only necessary because of UiDriver_TextMsgPutChar
@@ -21,11 +22,15 @@
 #define PSK_SAMPLE_RATE 12000 // TODO This should come from elsewhere, to be fixed
 
 // RX constants
-#define PSK_BND_FLT_LEN 5
-#define PSK_BUF_LEN (PSK_SAMPLE_RATE / PSK_OFFSET)
-// this must be an integer result without remainder and must be a multiple of 4
+#define PSK_RX_OVERSAMPLING 16 // samples per symbol after decimation, all rates are decimated to this
+#define PSK_RX_FIR_LEN_MAX (PSK_SAMPLE_RATE * 100 / 3125) // one symbol of the slowest rate (31.25 baud)
+#define PSK_RX_AFC_RANGE 25.0 // max. frequency correction of the AFC in Hz
+#define PSK_VITERBI_DEPTH 20 // decision delay of the QPSK viterbi decoder in bits, must be < 32
 
-#define PSK_SHIFT_DIFF (1.0 * PSK_OFFSET / PSK_SAMPLE_RATE) // phase change between two samples of PSK_OFFSET Hz
+// QPSK convolutional code, K=5, as used by PSK31 QPSK
+#define PSK_QPSK_POLY1 0x19
+#define PSK_QPSK_POLY2 0x17
+#define PSK_QPSK_STATES 16
 
 // TX constants
 #define SAMPLE_MAX 32766 // max amplitude of generated samples
@@ -35,35 +40,45 @@ typedef struct
 {
     uint16_t rate;
 
-    uint16_t tx_idx;
     uint8_t tx_char;
     uint16_t tx_bits;
-    int16_t tx_wave_sign_next;
-    int16_t tx_wave_sign_current;
-    uint16_t tx_bit_phase;
-    uint32_t tx_bit_len;
     int16_t tx_zeros;
     int16_t tx_ones;
-    bool tx_win;
-
-    float32_t rx_phase;
-    float32_t rx_samples_in[PSK_BND_FLT_LEN];
-    float32_t rx_samples[PSK_BND_FLT_LEN];
-    int16_t rx_bnd_idx;
-    float32_t rx_cos_prod[PSK_BUF_LEN];
-    float32_t rx_sin_prod[PSK_BUF_LEN];
-    float32_t rx_scmix[PSK_BUF_LEN];
-    int32_t rx_idx;
+    uint32_t tx_symbol_len; // samples per symbol at output sample rate
+    uint32_t tx_symbol_phase;
+    float32_t tx_prev_re; // symbol vector we fade from
+    float32_t tx_prev_im;
+    float32_t tx_cur_re; // symbol vector we fade to
+    float32_t tx_cur_im;
+    uint8_t tx_enc_state; // QPSK convolutional encoder shift register
+    psk_modulator_t tx_mod_state;
+
+    // complex NCO which mixes the PSK_OFFSET carrier down to baseband, AFC controls its frequency
+    float32_t rx_nco_re;
+    float32_t rx_nco_im;
+    float32_t rx_nco_step_re;
+    float32_t rx_nco_step_im;
+    // circular buffers of the matched lowpass / decimation filter
+    float32_t rx_fir_i[PSK_RX_FIR_LEN_MAX];
+    float32_t rx_fir_q[PSK_RX_FIR_LEN_MAX];
+    uint16_t rx_fir_len;
+    uint16_t rx_fir_idx;
+    uint16_t rx_decim;
+    uint16_t rx_decim_cnt;
+    // last symbol worth of decimated baseband samples for the Gardner timing detector
+    float32_t rx_hist_re[PSK_RX_OVERSAMPLING];
+    float32_t rx_hist_im[PSK_RX_OVERSAMPLING];
+    uint8_t rx_hist_idx;
+    float32_t rx_clock; // symbol clock, counts decimated samples
+    float32_t rx_agc; // averaged symbol power, used to normalize the loop errors
+    float32_t rx_freq; // AFC frequency correction in Hz, could be of interest for tuning
+    float32_t rx_last_re; // previous symbol, we demodulate differentially
+    float32_t rx_last_im;
     int8_t rx_last_bit;
-    float32_t rx_err; // could be of interest for tuning
-    float32_t rx_last_symbol;
-    int16_t rx_symbol_len; // how many buffers fit into one bit
-    int16_t rx_symbol_idx;
-    // float32_t rx_symbol_buf[PSK_MAX_SYMBOL_BUF];
     uint32_t rx_word;
-    psk_modulator_t tx_mod_state;
-    float32_t rx_sum_sin;
-    float32_t rx_sum_cos;
+    // QPSK viterbi decoder
+    float32_t rx_vit_metric[PSK_QPSK_STATES];
+    uint32_t rx_vit_path[PSK_QPSK_STATES];
 } PskState_Internal_t;
 
 
@@ -330,95 +345,27 @@ static const uint16_t psk_varicode[] = {
 #define PSK_VARICODE_NUM (sizeof(psk_varicode)/sizeof(*psk_varicode))
 
 
-static const float32_t PskBndPassB_31[] = {
-		6.6165543533213894e-05,
-		0.0,
-		-0.00013233108706642779,
-		0.0,
-		6.6165543533213894e-05
-};
-
-static const float32_t PskBndPassA_31[] = {
-		1.0,
-		-3.8414813063247664,
-		5.6662277107033248,
-		-3.7972899991488904,
-		0.9771256616899302
-};
-
-static const float32_t PskBndPassB_63[] = {
-		0.0002616526950658905,
-		0.0,
-		-0.000523305390131781,
-		0.0,
-		0.0002616526950658905
-};
-
-static const float32_t PskBndPassA_63[] = {
-		1.0,
-		-3.8195192250239174,
-		5.6013869366249818,
-		-3.7321386869273105,
-		0.95477455992103932
-};
-
-static const float32_t PskBndPassB_125[] = {
-		0.0010232176384709002,
-		0.0,
-		-0.0020464352769418003,
-		0.0,
-		0.0010232176384709002
-};
+// matched lowpass filter for the baseband signal, one symbol long (Hann window, i.e. raised cosine pulse shape)
+// stored time reversed so that it can be applied to the circular buffers with two plain dot products
+static float32_t psk_rx_fir_coeffs[PSK_RX_FIR_LEN_MAX];
 
-static const float32_t PskBndPassA_125[] = {
-		1.0,
-		-3.7763786572915334,
-		5.4745855184361272,
-		-3.6055008493327723,
-		0.91159449659996006
-};
+// phase change for each of the four QPSK encoder outputs: 00 = 180 deg, 01 = +90 deg, 10 = -90 deg, 11 = 0 deg
+static const float32_t psk_qpsk_rot_re[4] = { -1.0,  0.0,  0.0, 1.0 };
+static const float32_t psk_qpsk_rot_im[4] = {  0.0,  1.0, -1.0, 0.0 };
 
 static soft_dds_t psk_dds;
 static soft_dds_t psk_bit_dds;
-static soft_dds_t psk_rx_dds;
-
-
-#if 0
-static void PskBufAdd(int len, float32_t buf[], float32_t v)
-{
-	for (int i = len - 1; i > 0; i--)
-	{
-		buf[i] = buf[i-1];
-	}
-	buf[0] = v;
-}
-#endif
-
-static float32_t Psk_IirNext(const float32_t bpf_b[], const float32_t bpf_a[], float32_t x[], float32_t y[], int idx, int taps)
-{
-	float32_t resp = 0;
-	int iidx; 
-
-	for (int i = 0; i < taps; i++)
-	{
-		iidx = (idx - i + taps) % taps;
-		resp += bpf_b[i] * x[iidx];
-		if (i>0)
-		{
-			resp -= bpf_a[i] * y[iidx];
-		}
-	}
-	return resp / bpf_a[0];
-}
-
 
 
 
 const psk_speed_item_t psk_speeds[PSK_SPEED_NUM] =
 {
-		{ .id =PSK_SPEED_31, .value = 31.25,  .bpf_b = PskBndPassB_31, .bpf_a = PskBndPassA_31, .rate = 384, .label = " 31" },
-		{ .id =PSK_SPEED_63, .value = 62.5,   .bpf_b = PskBndPassB_63, .bpf_a = PskBndPassA_63, .rate = 192, .label = " 63"  },
-		{ .id =PSK_SPEED_125, .value = 125.0, .bpf_b = PskBndPassB_125, .bpf_a = PskBndPassA_125, .rate = 96, .label = "125" }
+		{ .id =PSK_SPEED_31, .value = 31.25,  .qpsk = false, .rate = 384, .label = " 31" },
+		{ .id =PSK_SPEED_63, .value = 62.5,   .qpsk = false, .rate = 192, .label = " 63"  },
+		{ .id =PSK_SPEED_125, .value = 125.0, .qpsk = false, .rate = 96, .label = "125" },
+		{ .id =PSK_SPEED_31_QPSK, .value = 31.25,  .qpsk = true, .rate = 384, .label = "Q31" },
+		{ .id =PSK_SPEED_63_QPSK, .value = 62.5,   .qpsk = true, .rate = 192, .label = "Q63"  },
+		{ .id =PSK_SPEED_125_QPSK, .value = 125.0, .qpsk = true, .rate = 96, .label = "Q125" },
 };
 
 psk_ctrl_t psk_ctrl_config =
@@ -439,54 +386,70 @@ void Psk_Modulator_PrepareTx()
 	Psk_Modulator_SetState(PSK_MOD_PREAMBLE);
 }
 
-void Bpsk_Demodulator_Init()
+/**
+ * Sets the frequency of the receive NCO, i.e. PSK_OFFSET plus the AFC correction
+ */
+static void PskDecoder_SetNcoFreq(float32_t freq)
+{
+	float32_t w = 2 * PI * freq / PSK_SAMPLE_RATE;
+	psk_state.rx_nco_step_re = cosf(w);
+	psk_state.rx_nco_step_im = sinf(w);
+}
+
+static void Psk_Demodulator_Init()
 {
-	psk_state.rx_phase = 0;
-	psk_state.rx_bnd_idx = 0;
-	
-	for (int i = 0; i < PSK_BND_FLT_LEN; i++)
-	{
-		psk_state.rx_samples_in[i] = 0;
-		psk_state.rx_samples[i] = 0;
-	}
-	
-	for (int i = 0; i < PSK_BUF_LEN; i++)
+	psk_state.rx_fir_len = psk_state.rate;
+	psk_state.rx_decim = psk_state.rate / PSK_RX_OVERSAMPLING;
+
+	// Hann window, normalized to unity gain at DC
+	float32_t sum = 0;
+	for (int i = 0; i < psk_state.rx_fir_len; i++)
 	{
-		psk_state.rx_cos_prod[i] = 0;
-		psk_state.rx_sin_prod[i] = 0;
-		psk_state.rx_scmix[i] = 0;
+		psk_rx_fir_coeffs[i] = 0.5 - 0.5 * cosf(2 * PI * (i + 0.5) / psk_state.rx_fir_len);
+		sum += psk_rx_fir_coeffs[i];
 	}
-
-	psk_state.rx_idx = 0;
+	arm_scale_f32(psk_rx_fir_coeffs, 1.0 / sum, psk_rx_fir_coeffs, psk_state.rx_fir_len);
+
+	memset(psk_state.rx_fir_i, 0, sizeof(psk_state.rx_fir_i));
+	memset(psk_state.rx_fir_q, 0, sizeof(psk_state.rx_fir_q));
+	memset(psk_state.rx_hist_re, 0, sizeof(psk_state.rx_hist_re));
+	memset(psk_state.rx_hist_im, 0, sizeof(psk_state.rx_hist_im));
+	psk_state.rx_fir_idx = 0;
+	psk_state.rx_decim_cnt = 0;
+	psk_state.rx_hist_idx = 0;
+
+	psk_state.rx_nco_re = 1;
+	psk_state.rx_nco_im = 0;
+	psk_state.rx_freq = 0;
+	PskDecoder_SetNcoFreq(PSK_OFFSET);
+
+	psk_state.rx_clock = 0;
+	psk_state.rx_agc = 0;
+	psk_state.rx_last_re = 0;
+	psk_state.rx_last_im = 0;
 	psk_state.rx_last_bit = 0;
-	psk_state.rx_last_symbol = 0;
-	psk_state.rx_symbol_len = psk_state.rate / PSK_BUF_LEN;
-	psk_state.rx_symbol_idx = 0;
-	
-	// for (int i = 0; i < psk_state.rx_symbol_len; i ++)
-	// {
-	// 	psk_state.rx_symbol_buf[i];
-	// }
-
 	psk_state.rx_word = 0;
+
+	for (int i = 0; i < PSK_QPSK_STATES; i++)
+	{
+		psk_state.rx_vit_metric[i] = 0;
+		psk_state.rx_vit_path[i] = 0;
+	}
 }
 
 
 void Psk_Modem_Init(uint32_t output_sample_rate)
 {
 
-	psk_state.tx_idx = 0;
-
 	softdds_setFreqDDS(&psk_dds,    PSK_OFFSET, output_sample_rate, true);
-	softdds_setFreqDDS(&psk_rx_dds, PSK_OFFSET, PSK_SAMPLE_RATE,    true);
-    // we use a sine wave with a frequency of half of the bit rate
-    // as envelope generator
-    softdds_setFreqDDS(&psk_bit_dds, (float32_t)psk_speeds[psk_ctrl_config.speed_idx].value / 2.0, output_sample_rate, false);
+    // we use a sine wave with a quarter of the symbol rate as envelope generator
+    // it rises from 0 to max within one symbol and is used to crossfade from one symbol to the next
+    softdds_setFreqDDS(&psk_bit_dds, (float32_t)psk_speeds[psk_ctrl_config.speed_idx].value / 4.0, output_sample_rate, false);
 
-	psk_state.tx_bit_len = lround(output_sample_rate / psk_speeds[psk_ctrl_config.speed_idx].value * 2); // 480000 / 31.25 * 2 = 3072
-	psk_state.rate = PSK_SAMPLE_RATE / psk_speeds[psk_ctrl_config.speed_idx].value;
+	psk_state.tx_symbol_len = lround(output_sample_rate / psk_speeds[psk_ctrl_config.speed_idx].value); // 48000 / 31.25 = 1536
+	psk_state.rate = psk_speeds[psk_ctrl_config.speed_idx].rate;
 
-	Bpsk_Demodulator_Init();
+	Psk_Demodulator_Init();
 }
 
 
@@ -520,319 +483,424 @@ static uint16_t Bpsk_FindCharReversed(uint8_t c)
     return retval;
 }
 
+static uint8_t Psk_Parity(uint8_t bits)
+{
+	bits ^= bits >> 4;
+	bits ^= bits >> 2;
+	bits ^= bits >> 1;
+	return bits & 1;
+}
+
 /**
- *
- * Basically samples the phase every bit length based on a sample which is one full sine wave
- * of the carrier frequency. So it is not using multiple sampling points or anything.
- * We throw away a lot of phase differences symbols
- * using more of these should make the code more robust, shouldn't it?
- *
- * @param symbol_out averaged phase of the samples.
+ * QPSK convolutional encoder output (2 bits) for a 5 bit encoder shift register content, newest bit is LSB
  */
-
-static void BpskDecoder_NextSymbol(float32_t symbol_out)
+static uint8_t Psk_ConvCode(uint8_t shift_reg)
 {
-    int8_t bit;
-
-    static float32_t symbol_store = 0;
+	return Psk_Parity(shift_reg & PSK_QPSK_POLY1) | (Psk_Parity(shift_reg & PSK_QPSK_POLY2) << 1);
+}
 
-    // if (psk_state.rx_symbol_len - psk_state.rx_symbol_idx < 6)
+/**
+ * Collects the varicode bits and emits a character when the 2 zero bits gap is found
+ *
+ * @param bit the decoded bit
+ */
+static void PskDecoder_NextBit(int8_t bit)
+{
+    // have we found 2 consecutive 0 bits? And previously at least one received bit == 1?
+    // indicates an end of character
+    if (psk_state.rx_last_bit == 0 && bit == 0 && psk_state.rx_word != 0)
     {
-        symbol_store = symbol_out;
-    }
+        // we lookup up the bits received (minus the last zero, which we shift out to the right)
+        // and put it into the buffer
+        UiDriver_TextMsgPutChar(Bpsk_DecodeVaricode(psk_state.rx_word >> 1));
 
-    psk_state.rx_symbol_idx += 1;
-    if (psk_state.rx_symbol_idx >= psk_state.rx_symbol_len)
+        // clean out the stored bit pattern
+        psk_state.rx_word = 0;
+    }
+    else
     {
-        psk_state.rx_symbol_idx = 0;
-        // TODO here should come additional part to check if timing of sampling should be moved
-        if (psk_state.rx_last_symbol * symbol_store < 0)
-        {
-            bit = 0;
-        }
-        else
-        {
-            bit = 1;
-        }
-
-        psk_state.rx_last_symbol = symbol_store;
-        symbol_store = 0;
-
-        // have we found 2 consecutive 0 bits? And previously at least one received bit == 1?
-        // indicates an end of character
-        if (psk_state.rx_last_bit == 0 && bit == 0 && psk_state.rx_word != 0)
-        {
-            // we lookup up the bits received (minus the last zero, which we shift out to the right)
-            // and put it into the buffer
-            UiDriver_TextMsgPutChar(Bpsk_DecodeVaricode(psk_state.rx_word >> 1));
-
-            // clean out the stored bit pattern
-            psk_state.rx_word = 0;
-        }
-        else
-        {
-            psk_state.rx_word = (psk_state.rx_word << 1) | bit;
-        }
-
-        psk_state.rx_last_bit = bit;
-
+        psk_state.rx_word = (psk_state.rx_word << 1) | bit;
     }
+
+    psk_state.rx_last_bit = bit;
 }
 
-static float32_t BpskDecoder_Bandpass(float32_t sample)
+/**
+ * Soft decision viterbi decoder for the QPSK convolutional code. Survivor paths are kept as bit patterns,
+ * so a decision is available with a fixed delay of PSK_VITERBI_DEPTH bits.
+ *
+ * @param d_re normalized phase change vector of the received symbol, real part
+ * @param d_im normalized phase change vector of the received symbol, imaginary part
+ */
+static void PskDecoder_Viterbi(float32_t d_re, float32_t d_im)
 {
-    // save original sample in bpf's input buffer
-    psk_state.rx_samples_in[psk_state.rx_bnd_idx] = sample;
+	float32_t metric[PSK_QPSK_STATES];
+	uint32_t path[PSK_QPSK_STATES];
+	float32_t best_metric = -INFINITY;
+	int best_state = 0;
+
+	// branch metric is the correlation with the expected phase change of each encoder output
+	float32_t branch[4];
+	for (int sym = 0; sym < 4; sym++)
+	{
+		branch[sym] = d_re * psk_qpsk_rot_re[sym] + d_im * psk_qpsk_rot_im[sym];
+	}
 
-    // IIR bandpass for signal frequency range, implemented in a ring buffer
-    float32_t retval = Psk_IirNext(psk_speeds[psk_ctrl_config.speed_idx].bpf_b, psk_speeds[psk_ctrl_config.speed_idx].bpf_a, psk_state.rx_samples_in,
-        psk_state.rx_samples, psk_state.rx_bnd_idx, PSK_BND_FLT_LEN);
+	for (int state = 0; state < PSK_QPSK_STATES; state++)
+	{
+		// the state is formed by the last 4 input bits, the two possible predecessors
+		// differ only in the oldest bit, which is shifted out
+		int prev0 = state >> 1;
+		int prev1 = prev0 | (PSK_QPSK_STATES >> 1);
+		float32_t m0 = psk_state.rx_vit_metric[prev0] + branch[Psk_ConvCode(state)];
+		float32_t m1 = psk_state.rx_vit_metric[prev1] + branch[Psk_ConvCode(state | PSK_QPSK_STATES)];
+
+		if (m0 >= m1)
+		{
+			metric[state] = m0;
+			path[state] = (psk_state.rx_vit_path[prev0] << 1) | (state & 1);
+		}
+		else
+		{
+			metric[state] = m1;
+			path[state] = (psk_state.rx_vit_path[prev1] << 1) | (state & 1);
+		}
 
-    // save filtered sample in state buffer, used in next run;
-    psk_state.rx_samples[psk_state.rx_bnd_idx] = retval;
+		if (metric[state] > best_metric)
+		{
+			best_metric = metric[state];
+			best_state = state;
+		}
+	}
 
-    // increment our ring buffer index
-    psk_state.rx_bnd_idx++;
-    psk_state.rx_bnd_idx %= PSK_BND_FLT_LEN;
+	// keep the metrics bounded
+	for (int state = 0; state < PSK_QPSK_STATES; state++)
+	{
+		psk_state.rx_vit_metric[state] = metric[state] - best_metric;
+		psk_state.rx_vit_path[state] = path[state];
+	}
 
-    return retval;
+	PskDecoder_NextBit((psk_state.rx_vit_path[best_state] >> PSK_VITERBI_DEPTH) & 1);
 }
 
 /**
- * Process an audio sample and decode signal.
- *
- * @param audio sample at PSK_SAMPLE_RATE
+ * Rotates the receive NCO by a small phase angle, used by the Costas loop
  */
-void Psk_Demodulator_ProcessSample(float32_t sample)
+static void PskDecoder_RotateNco(float32_t angle)
 {
-    float32_t fsample = BpskDecoder_Bandpass(sample);
-
-	// VCO generates a sine/cosine wave "carrier" with PSK_OFFSET Hz as frequency
-    float32_t vco_sin, vco_cos;
-    // we have to use a different DDS as for TX (different sample rates), IQ gives us sin and cos waves of PSK_OFFSET Hz
-    softdds_genIQSingleTone(&psk_rx_dds, &vco_sin , &vco_cos, 1);
-
-	// we now multiple these carriers with our signal
-	// this allows us to compare phase differences
-    float32_t sin_mix = vco_sin * fsample;
-    float32_t cos_mix = vco_cos * fsample;
-
-    // update sums by differences between old and new value in ringbuffer
-    psk_state.rx_sum_sin += sin_mix - psk_state.rx_sin_prod[psk_state.rx_idx];
-    psk_state.rx_sum_cos += cos_mix - psk_state.rx_cos_prod[psk_state.rx_idx];
-
-    // store new value
-    psk_state.rx_sin_prod[psk_state.rx_idx] = sin_mix;
-    psk_state.rx_cos_prod[psk_state.rx_idx] = cos_mix;
+	float32_t c = cosf(angle);
+	float32_t s = sinf(angle);
+	float32_t re = psk_state.rx_nco_re * c - psk_state.rx_nco_im * s;
+	psk_state.rx_nco_im = psk_state.rx_nco_re * s + psk_state.rx_nco_im * c;
+	psk_state.rx_nco_re = re;
+}
 
-	// we now calculate an average
-	float32_t symbol_out = psk_state.rx_sum_sin / PSK_BUF_LEN;
-	float32_t cos_out    = psk_state.rx_sum_cos / PSK_BUF_LEN;
+/**
+ * Processes one symbol sampled at the optimum time as determined by the timing recovery.
+ * Runs the Costas loop AFC and demodulates the phase change against the previous symbol.
+ */
+static void PskDecoder_NextSymbol(float32_t re, float32_t im)
+{
+	bool qpsk = psk_speeds[psk_ctrl_config.speed_idx].qpsk;
+	float32_t baud = psk_speeds[psk_ctrl_config.speed_idx].value;
+	float32_t power = re * re + im * im;
 
-    // GUESS: now try to estimate the frequency error of our VCO vs. the incoming signal
-	float32_t rx_scmix = symbol_out * cos_out;
-	psk_state.rx_err += rx_scmix - psk_state.rx_scmix[psk_state.rx_idx];
-	psk_state.rx_scmix[psk_state.rx_idx] = rx_scmix;
+	// phase change between the previous and the current symbol
+	float32_t d_re = re * psk_state.rx_last_re + im * psk_state.rx_last_im;
+	float32_t d_im = im * psk_state.rx_last_re - re * psk_state.rx_last_im;
 
+	psk_state.rx_last_re = re;
+	psk_state.rx_last_im = im;
 
-	float32_t smax = 0;
+	psk_state.rx_agc += (power - psk_state.rx_agc) / 32;
 
-	for (int i = 0; i < PSK_BUF_LEN; i++)
+	// loops are only updated if the symbol has reasonable power
+	if (power > psk_state.rx_agc / 4)
 	{
-		if (fabsf(psk_state.rx_cos_prod[i]) > smax)
+		// removing the modulation by squaring (BPSK) or taking the 4th power (QPSK)
+		// the phase error is normalized to the symbol power, so it is ~ the phase deviation in radians
+		float32_t sq_re = re * re - im * im;
+		float32_t sq_im = 2 * re * im;
+		float32_t dsq_re = d_re * d_re - d_im * d_im;
+		float32_t dsq_im = 2 * d_re * d_im;
+
+		float32_t phase_err, freq_err;
+		if (qpsk)
 		{
-			smax = fabsf(psk_state.rx_cos_prod[i]);
+			phase_err = sq_re * sq_im / (2 * power * power);
+			freq_err = atan2f(2 * dsq_re * dsq_im, dsq_re * dsq_re - dsq_im * dsq_im) / 4;
 		}
-		if (fabsf(psk_state.rx_sin_prod[i]) > smax)
+		else
 		{
-			smax = fabsf(psk_state.rx_sin_prod[i]);
+			phase_err = sq_im / (2 * power);
+			freq_err = atan2f(dsq_im, dsq_re) / 2;
 		}
-	}
 
-	// calculate the final correction value from rx_err
-	// avoid division by zero if smax is 0
-	float32_t rx_err_corr = psk_state.rx_err/ (PSK_BUF_LEN * ((smax != 0) ? (smax * smax * 4.0) : 1.0));
+		// frequency locked loop, the phase drift per symbol is turned into Hz
+		// it pulls in offsets outside of the capture range of the Costas loop, up to +/- baud/4 (BPSK) or baud/8 (QPSK)
+		psk_state.rx_freq += freq_err * baud / (2 * PI) * 0.05;
+		// 2nd order Costas loop, the phase correction is applied to the NCO directly, the integrator is the NCO frequency
+		psk_state.rx_freq += phase_err * baud * 0.002;
 
-	// if the error is too large, we limit it to +/- 0.1
-	if(fabsf(rx_err_corr) > 0.1)
-	{
-		rx_err_corr = (rx_err_corr > 0) ? 0.1 : -0.1;
+		if (fabsf(psk_state.rx_freq) > PSK_RX_AFC_RANGE)
+		{
+			psk_state.rx_freq = psk_state.rx_freq > 0 ? PSK_RX_AFC_RANGE : -PSK_RX_AFC_RANGE;
+		}
+		PskDecoder_RotateNco(phase_err * 0.1);
+		PskDecoder_SetNcoFreq(PSK_OFFSET + psk_state.rx_freq);
 	}
-	rx_err_corr = 0;
 
-	// now advance our phase counter with our error correction
-    psk_state.rx_phase += PSK_SHIFT_DIFF + rx_err_corr * PSK_SHIFT_DIFF;
-
-
-	// we just passed one "full" offset frequency wave length?
-	// now see if we have enough symbols to decide if it is a 1 or 0
-    // the symbol is basically an averaged phase difference over the last PSK_BUF_LEN
-    // samples.
-	if (psk_state.rx_phase > 1)
+	if (qpsk)
 	{
-		psk_state.rx_phase -= 1;
-		BpskDecoder_NextSymbol(symbol_out);
+		float32_t d_mag = sqrtf(d_re * d_re + d_im * d_im);
+		if (d_mag > 0)
+		{
+			d_re /= d_mag;
+			d_im /= d_mag;
+		}
+		PskDecoder_Viterbi(d_re, d_im);
 	}
-
-	if (psk_state.rx_phase < 0)
+	else
 	{
-		psk_state.rx_phase += 1;
+		// no phase change is a 1, a phase reversal a 0
+		PskDecoder_NextBit(d_re > 0 ? 1 : 0);
 	}
-
-    // we prepare us for the next sample in our ring buffer
-    psk_state.rx_idx = (psk_state.rx_idx + 1) % PSK_BUF_LEN;
 }
 
-static bool bit_start(uint16_t tx_bit_phase)
+/**
+ * Gardner timing recovery on the decimated baseband signal. Keeps the symbol clock centered on the
+ * maximum eye opening and hands over one sample per symbol to PskDecoder_NextSymbol.
+ */
+static void PskDecoder_Baseband(float32_t re, float32_t im)
 {
-    return tx_bit_phase == psk_state.tx_bit_len / 4;
-}
+	psk_state.rx_hist_re[psk_state.rx_hist_idx] = re;
+	psk_state.rx_hist_im[psk_state.rx_hist_idx] = im;
 
-static bool bit_middle(uint16_t tx_bit_phase)
-{
-    return tx_bit_phase == 0;
+	psk_state.rx_clock += 1;
+	if (psk_state.rx_clock >= PSK_RX_OVERSAMPLING)
+	{
+		psk_state.rx_clock -= PSK_RX_OVERSAMPLING;
+
+		uint8_t mid_idx = (psk_state.rx_hist_idx + PSK_RX_OVERSAMPLING / 2) % PSK_RX_OVERSAMPLING;
+
+		if (psk_state.rx_agc > 0)
+		{
+			float32_t err = ((psk_state.rx_last_re - re) * psk_state.rx_hist_re[mid_idx]
+					+ (psk_state.rx_last_im - im) * psk_state.rx_hist_im[mid_idx]) / psk_state.rx_agc;
+			// limit the correction per symbol
+			if (fabsf(err) > 1.0)
+			{
+				err = err > 0 ? 1.0 : -1.0;
+			}
+			psk_state.rx_clock -= err * PSK_RX_OVERSAMPLING / 16.0;
+		}
+
+		PskDecoder_NextSymbol(re, im);
+	}
+
+	psk_state.rx_hist_idx = (psk_state.rx_hist_idx + 1) % PSK_RX_OVERSAMPLING;
 }
 
 /**
- * Generates a BPSK signal. Uses an oscillator for generating continous base signal of a
- * given frequency (defined in PSK_OFFSET). This signal is phase controlled by a variable
- * psk_state.tx_wave_sign_current. A second frequency generator provides an envelope shape based on a cosine
- * of half of the bpsk rate. For 0 bits to transmit the symbol is using the enveloped signal and shifts
- * in the middle.
- *
+ * Process a block of audio samples and decode signal.
  *
- * @return
+ * @param src audio samples at PSK_SAMPLE_RATE
+ * @param blockSize number of samples
  */
-int16_t Psk_Modulator_GenSample()
+void Psk_Demodulator_ProcessBlock(float32_t* src, int16_t blockSize)
 {
-    // tx_bit_len / 4 -> start of a bit
-    // tx_bit_len / 0 -> middle of a bit
-    // tx_bit_len / 2 -> end of a bit
+	const uint16_t fir_len = psk_state.rx_fir_len;
 
-    int32_t retval = 0; // by default we produce silence
+	for (int16_t idx = 0; idx < blockSize; idx++)
+	{
+		// mix down to baseband and store in the circular filter buffers, this is the only per sample work
+		psk_state.rx_fir_i[psk_state.rx_fir_idx] = src[idx] * psk_state.rx_nco_re;
+		psk_state.rx_fir_q[psk_state.rx_fir_idx] = - src[idx] * psk_state.rx_nco_im;
 
-    // check if the modulator is supposed to be active...
-    if (Psk_Modulator_GetState() != PSK_MOD_OFF)
+		float32_t nco_re = psk_state.rx_nco_re * psk_state.rx_nco_step_re - psk_state.rx_nco_im * psk_state.rx_nco_step_im;
+		psk_state.rx_nco_im = psk_state.rx_nco_re * psk_state.rx_nco_step_im + psk_state.rx_nco_im * psk_state.rx_nco_step_re;
+		psk_state.rx_nco_re = nco_re;
+
+		psk_state.rx_fir_idx++;
+		if (psk_state.rx_fir_idx >= fir_len)
+		{
+			psk_state.rx_fir_idx = 0;
+		}
+
+		psk_state.rx_decim_cnt++;
+		if (psk_state.rx_decim_cnt >= psk_state.rx_decim)
+		{
+			psk_state.rx_decim_cnt = 0;
+
+			// the oldest sample is at rx_fir_idx, so the filter is applied in two contiguous parts
+			uint16_t old_len = fir_len - psk_state.rx_fir_idx;
+			float32_t i_old, i_new, q_old, q_new;
+			arm_dot_prod_f32(psk_rx_fir_coeffs, &psk_state.rx_fir_i[psk_state.rx_fir_idx], old_len, &i_old);
+			arm_dot_prod_f32(&psk_rx_fir_coeffs[old_len], psk_state.rx_fir_i, psk_state.rx_fir_idx, &i_new);
+			arm_dot_prod_f32(psk_rx_fir_coeffs, &psk_state.rx_fir_q[psk_state.rx_fir_idx], old_len, &q_old);
+			arm_dot_prod_f32(&psk_rx_fir_coeffs[old_len], psk_state.rx_fir_q, psk_state.rx_fir_idx, &q_new);
+
+			PskDecoder_Baseband(i_old + i_new, q_old + q_new);
+		}
+	}
+
+	// the NCO is a complex rotator, avoid slowly drifting amplitude due to rounding errors
+	float32_t nco_mag = sqrtf(psk_state.rx_nco_re * psk_state.rx_nco_re + psk_state.rx_nco_im * psk_state.rx_nco_im);
+	psk_state.rx_nco_re /= nco_mag;
+	psk_state.rx_nco_im /= nco_mag;
+}
+
+/**
+ * Returns the next bit to transmit. Handles preamble, character spacing and postamble.
+ * A 1 bit means no phase change, a 0 bit a phase change of 180 degree (BPSK).
+ */
+static uint8_t Psk_Modulator_NextBit()
+{
+    // check if we still have bits to transmit
+    if (psk_state.tx_bits == 0)
     {
-        // try to find out what to transmit next
-        if (bit_start(psk_state.tx_bit_phase))
+        // no, all bits have been transmitted
+        if (psk_state.tx_zeros < 2 || (Psk_Modulator_GetState() == PSK_MOD_PREAMBLE))
         {
-            // check if we still have bits to transmit
-            if (psk_state.tx_bits == 0)
-            {
-                // no, all bits have been transmitted
-                if (psk_state.tx_zeros < 2 || (Psk_Modulator_GetState() == PSK_MOD_PREAMBLE))
-                {
-                    // send spacing zeros before anything else happens
-                    // normal characters don't have 2 zeros following each other
-                    psk_state.tx_zeros++;
-
-                    // are we sending a preamble and have transmitted enough zeroes?
-                    // we do this for roughly a second, i.e. we simply use the rate as "timer"
-                    if ((Psk_Modulator_GetState() == PSK_MOD_PREAMBLE) && psk_state.tx_zeros >= psk_speeds[psk_ctrl_config.speed_idx].value)
-                    {
-                        Psk_Modulator_SetState(PSK_MOD_ACTIVE);
-                    }
-                }
-                else if (DigiModes_TxBufferHasData())
-                {
-                    DigiModes_TxBufferRemove( &psk_state.tx_char, BPSK );
-                    Psk_Modulator_SetState(PSK_MOD_ACTIVE);
-                    if (psk_state.tx_char == 0x04) // EOT, stop tranmission
-                    {
-                        // we send from buffer, and nothing more is in the buffer
-                        // request sending the trailing sequence
-                        Psk_Modulator_SetState(PSK_MOD_POSTAMBLE);
-                    }
-                    else
-                    {
-                        // if all zeros have been sent, look for new
-                        // input from input buffer
-                        psk_state.tx_bits = Bpsk_FindCharReversed(psk_state.tx_char);
-                        // reset counter for spacing zeros
-                        psk_state.tx_zeros = 0;
-                        // reset counter for trailing postamble (which conclude a transmission)
-                        psk_state.tx_ones = 0;
-                    }
-                }
+            // send spacing zeros before anything else happens
+            // normal characters don't have 2 zeros following each other
+            psk_state.tx_zeros++;
 
-                if (Psk_Modulator_GetState() == PSK_MOD_POSTAMBLE)
-                {
-                    // this is for generating  trailing postamble if the
-                    // input comes from a buffer or if we are asked to
-                    // switch off,
-                    // we do this for roughly a second, i.e. we simply use the rate as "timer"
-                    if (psk_state.tx_ones < psk_speeds[psk_ctrl_config.speed_idx].value)
-                    {
-                        psk_state.tx_ones+=16;
-                        psk_state.tx_bits = 0xffff; // we add 16 bits of postamble
-                        // so we may send a few more postamble than request, but who cares...
-                    }
-                    else
-                    {
-                        Psk_Modulator_SetState(PSK_MOD_INACTIVE);
-                    }
-                }
+            // are we sending a preamble and have transmitted enough zeroes?
+            // we do this for roughly a second, i.e. we simply use the rate as "timer"
+            if ((Psk_Modulator_GetState() == PSK_MOD_PREAMBLE) && psk_state.tx_zeros >= psk_speeds[psk_ctrl_config.speed_idx].value)
+            {
+                Psk_Modulator_SetState(PSK_MOD_ACTIVE);
             }
-
-            // we test the current bit. If it is a zero, and we have no more postamble to transmit
-            // we alternate the phase of our signal phase (180 degree shift)
-            if ((psk_state.tx_bits & 0x1) == 0 && psk_state.tx_ones == 0)
+        }
+        else if (DigiModes_TxBufferHasData())
+        {
+            DigiModes_TxBufferRemove( &psk_state.tx_char, BPSK );
+            Psk_Modulator_SetState(PSK_MOD_ACTIVE);
+            if (psk_state.tx_char == 0x04) // EOT, stop tranmission
             {
-                psk_state.tx_wave_sign_next *= -1;
+                // we send from buffer, and nothing more is in the buffer
+                // request sending the trailing sequence
+                Psk_Modulator_SetState(PSK_MOD_POSTAMBLE);
             }
+            else
+            {
+                // if all zeros have been sent, look for new
+                // input from input buffer
+                psk_state.tx_bits = Bpsk_FindCharReversed(psk_state.tx_char);
+                // reset counter for spacing zeros
+                psk_state.tx_zeros = 0;
+                // reset counter for trailing postamble (which conclude a transmission)
+                psk_state.tx_ones = 0;
+            }
+        }
 
-            // if it is a phase shift, which equals a zero to transmit or we transmit our last bit
-            if (psk_state.tx_wave_sign_next != psk_state.tx_wave_sign_current || Psk_Modulator_GetState() == PSK_MOD_INACTIVE)
+        if (Psk_Modulator_GetState() == PSK_MOD_POSTAMBLE)
+        {
+            // this is for generating  trailing postamble if the
+            // input comes from a buffer or if we are asked to
+            // switch off,
+            // we do this for roughly a second, i.e. we simply use the rate as "timer"
+            if (psk_state.tx_ones < psk_speeds[psk_ctrl_config.speed_idx].value)
             {
-                // we have to shape the signal
-                psk_state.tx_win = true;
+                psk_state.tx_ones+=16;
+                psk_state.tx_bits = 0xffff; // we add 16 bits of postamble
+                // so we may send a few more postamble than request, but who cares...
             }
             else
             {
-                // it is a one and not the end, so we simply keep the full swing,
-                // i.e. a constant amplitude signal
-                psk_state.tx_win = false;
+                Psk_Modulator_SetState(PSK_MOD_INACTIVE);
             }
-
-            psk_state.tx_bits >>= 1; // remove "used" bit
         }
+    }
 
-        //  here we are in the middle of bit
-        //  we move the next sign in, since it may indicate a phase shift
-        // in this case we are transmitting a zero
-        if (bit_middle(psk_state.tx_bit_phase))
-        {
+    // if we have postamble to transmit, we send only ones
+    uint8_t bit = ((psk_state.tx_bits & 0x1) != 0 || psk_state.tx_ones != 0) ? 1 : 0;
+    psk_state.tx_bits >>= 1; // remove "used" bit
 
-            psk_state.tx_wave_sign_current = psk_state.tx_wave_sign_next;
+    return bit;
+}
 
+/**
+ * Generates a BPSK or QPSK signal. Uses an oscillator for generating continous base signal of a
+ * given frequency (defined in PSK_OFFSET). Each symbol is a phase change against the previous one,
+ * the carrier is crossfaded from the previous to the new symbol vector over one symbol length using
+ * a raised cosine shape. For BPSK a phase reversal results in the typical cosine envelope, while
+ * a one is sent as constant amplitude signal.
+ *
+ * @return next audio sample
+ */
+int16_t Psk_Modulator_GenSample()
+{
+    int32_t retval = 0; // by default we produce silence
 
-            // if we are in the middle of a bit AND it is a zero bit
-            // we have to start our envelope from null
-            if (psk_state.tx_win)
+    // check if the modulator is supposed to be active...
+    if (Psk_Modulator_GetState() != PSK_MOD_OFF)
+    {
+        // start of a new symbol, try to find out what to transmit next
+        if (psk_state.tx_symbol_phase == 0)
+        {
+            if (Psk_Modulator_GetState() == PSK_MOD_INACTIVE)
             {
-                Bpsk_ResetWin(); // we start the envelope from 0 to max
+                // the last symbol faded out, now turn us off, we're done.
+                Psk_Modulator_SetState(PSK_MOD_OFF);
+                return 0;
             }
+
+            uint8_t bit = Psk_Modulator_NextBit();
+
+            psk_state.tx_prev_re = psk_state.tx_cur_re;
+            psk_state.tx_prev_im = psk_state.tx_cur_im;
+
             if (Psk_Modulator_GetState() == PSK_MOD_INACTIVE)
             {
-                // now turn us off, we're done.
-                Psk_Modulator_SetState(PSK_MOD_OFF);
+                // fade out to silence
+                psk_state.tx_cur_re = 0;
+                psk_state.tx_cur_im = 0;
             }
+            else if (psk_state.tx_prev_re == 0 && psk_state.tx_prev_im == 0)
+            {
+                // fade in from silence
+                psk_state.tx_cur_re = 1;
+            }
+            else
+            {
+                float32_t rot_re, rot_im;
+                if (psk_speeds[psk_ctrl_config.speed_idx].qpsk)
+                {
+                    psk_state.tx_enc_state = ((psk_state.tx_enc_state << 1) | bit) & 0x1f;
+                    uint8_t sym = Psk_ConvCode(psk_state.tx_enc_state);
+                    rot_re = psk_qpsk_rot_re[sym];
+                    rot_im = psk_qpsk_rot_im[sym];
+                }
+                else
+                {
+                    rot_re = bit ? 1.0 : -1.0;
+                    rot_im = 0;
+                }
+                psk_state.tx_cur_re = psk_state.tx_prev_re * rot_re - psk_state.tx_prev_im * rot_im;
+                psk_state.tx_cur_im = psk_state.tx_prev_re * rot_im + psk_state.tx_prev_im * rot_re;
+            }
+
+            Bpsk_ResetWin(); // we start the envelope from 0 to max
         }
 
-        // if we are shaping the signal envelope
-        // we use the "slow" to generate our shape.
-        // we use abs so that we are getting only the gain
-        // not the phase from here
-        // otherwise we use the SAMPLE_MAX as coeff for constant amplitude
-        int32_t coeff = psk_state.tx_win ? abs(softdds_nextSample(&psk_bit_dds)) : SAMPLE_MAX;
+        // crossfade weight of the new symbol, rises from 0 to 1 as sin^2 within one symbol
+        float32_t win = softdds_nextSample(&psk_bit_dds) / (float32_t)SAMPLE_MAX;
+        win *= win;
+
+        float32_t sym_re = psk_state.tx_prev_re + (psk_state.tx_cur_re - psk_state.tx_prev_re) * win;
+        float32_t sym_im = psk_state.tx_prev_im + (psk_state.tx_cur_im - psk_state.tx_prev_im) * win;
 
-        // the bit length counter is incremented after each sample
-        // and wraps around after one  bit length
-        psk_state.tx_bit_phase = (psk_state.tx_bit_phase + 1) % (psk_state.tx_bit_len / 2); // % 1576 == 1 bit length
+        uint32_t carrier_idx = softdds_nextSampleIndex(&psk_dds);
+        float32_t carrier_sin = DDS_TABLE[carrier_idx];
+        float32_t carrier_cos = DDS_TABLE[(carrier_idx + DDS_TBL_SIZE / 4) % DDS_TBL_SIZE];
 
+        // the sample counter is incremented after each sample
+        // and wraps around after one symbol length
+        psk_state.tx_symbol_phase = (psk_state.tx_symbol_phase + 1) % psk_state.tx_symbol_len;
 
-        retval = (coeff * psk_state.tx_wave_sign_current * softdds_nextSample(&psk_dds)) / SAMPLE_MAX;
+        retval = sym_re * carrier_cos - sym_im * carrier_sin;
     }
 
     return retval;
@@ -863,13 +931,14 @@ psk_modulator_t Psk_Modulator_SetState(psk_modulator_t newState)
     {
     case PSK_MOD_PREAMBLE:
         psk_state.tx_ones = 0;
-        psk_state.tx_win = true;
         psk_state.tx_char = '\0';
         psk_state.tx_bits = 0;
-        psk_state.tx_wave_sign_next = 1;
-        psk_state.tx_wave_sign_current = 1;
-        psk_state.tx_bit_phase = 0;
+        psk_state.tx_symbol_phase = 0;
         psk_state.tx_zeros = 0;
+        psk_state.tx_enc_state = 0;
+        // we start from silence
+        psk_state.tx_cur_re = 0;
+        psk_state.tx_cur_im = 0;
         psk_state.tx_mod_state = newState;
         break;
     case PSK_MOD_OFF:
@@ -22,6 +22,9 @@ typedef enum {
     PSK_SPEED_31,
     PSK_SPEED_63,
 	PSK_SPEED_125,
+    PSK_SPEED_31_QPSK,
+    PSK_SPEED_63_QPSK,
+    PSK_SPEED_125_QPSK,
     PSK_SPEED_NUM
 } psk_speed_t;
 
@@ -29,9 +32,8 @@ typedef struct
 {
     psk_speed_t id;
     float32_t value;
-    const float32_t* bpf_b;
-    const float32_t* bpf_a;
-    uint16_t rate;
+    bool qpsk;
+    uint16_t rate; // samples per symbol at 12ksps
     char* label;
 } psk_speed_item_t;
 
@@ -59,7 +61,7 @@ psk_modulator_t Psk_Modulator_SetState(psk_modulator_t newState);
 
 void Psk_Modem_Init(uint32_t output_sample_rate);
 void Psk_Modulator_PrepareTx();
-void Psk_Demodulator_ProcessSample(float32_t sample);
+void Psk_Demodulator_ProcessBlock(float32_t* src, int16_t blockSize);
 int16_t Psk_Modulator_GenSample();
 
 #endif
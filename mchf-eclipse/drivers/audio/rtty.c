@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <limits.h>
+#include <string.h>
 
 #include "softdds.h"
 #include "rtty.h"
@@ -170,6 +171,7 @@ const rtty_speed_item_t rtty_speeds[RTTY_SPEED_NUM] =
 {
 		{ .id =RTTY_SPEED_45, .value = 45.45, .label = "45" },
 		{ .id =RTTY_SPEED_50, .value = 50, .label = "50"  },
+		{ .id =RTTY_SPEED_75, .value = 75, .label = "75"  },
 };
 
 const rtty_shift_item_t rtty_shifts[RTTY_SHIFT_NUM] =
@@ -191,51 +193,32 @@ rtty_ctrl_t rtty_ctrl_config =
 
 
 
-typedef struct
-{
-	float32_t gain;
-	float32_t coeffs[4];
-	uint16_t freq; // center freq
-} rtty_bpf_config_t;
+#define RTTY_MARK_FREQ (915) // mark tone in Hz, space is always mark + shift
+#define RTTY_SAMPLE_RATE (12000)
 
-typedef struct
-{
-	float32_t gain;
-	float32_t coeffs[2];
-} rtty_lpf_config_t;
+// the decimated rx blocks are never larger than this, larger blocks are processed in chunks of this size
+#define RTTY_BLOCK_SIZE_MAX (IQ_BLOCK_SIZE)
+
+#define RTTY_BPF_STAGES (2)
+#define RTTY_LPF_STAGES (1)
 
 typedef struct
 {
-	float32_t xv[5];
-	float32_t yv[5];
-} rtty_bpf_data_t;
+	arm_biquad_casd_df1_inst_f32 inst;
+	float32_t coeffs[5*RTTY_BPF_STAGES];
+	float32_t state[4*RTTY_BPF_STAGES];
+} rtty_biquad_t;
 
 typedef struct
 {
-	float32_t xv[3];
-	float32_t yv[3];
-} rtty_lpf_data_t;
-
-
-
-static float32_t RttyDecoder_bandPassFreq(float32_t sampleIn, const rtty_bpf_config_t* coeffs, rtty_bpf_data_t* data) {
-	data->xv[0] = data->xv[1]; data->xv[1] = data->xv[2]; data->xv[2] = data->xv[3]; data->xv[3] = data->xv[4];
-	data->xv[4] = sampleIn / coeffs->gain; // gain at centre
-	data->yv[0] = data->yv[1]; data->yv[1] = data->yv[2]; data->yv[2] = data->yv[3]; data->yv[3] = data->yv[4];
-	data->yv[4] = (data->xv[0] + data->xv[4]) - 2 * data->xv[2]
-															 + (coeffs->coeffs[0] * data->yv[0]) + (coeffs->coeffs[1] * data->yv[1])
-															 + (coeffs->coeffs[2] * data->yv[2]) + (coeffs->coeffs[3] * data->yv[3]);
-	return data->yv[4];
-}
-
-static float32_t RttyDecoder_lowPass(float32_t sampleIn, const rtty_lpf_config_t* coeffs, rtty_lpf_data_t* data) {
-	data->xv[0] = data->xv[1]; data->xv[1] = data->xv[2];
-	data->xv[2] = sampleIn / coeffs->gain; // gain at DC
-	data->yv[0] = data->yv[1]; data->yv[1] = data->yv[2];
-	data->yv[2] = (data->xv[0] + data->xv[2]) + 2 * data->xv[1]
-															 + (coeffs->coeffs[0] * data->yv[0]) + (coeffs->coeffs[1] * data->yv[1]);
-	return data->yv[2];
-}
+	float32_t mark_env;
+	float32_t space_env;
+	float32_t mark_noise;
+	float32_t space_noise;
+	float32_t attack; // fast attack of envelope and noise trackers
+	float32_t decay; // slow decay of envelope tracker
+	float32_t noise_decay; // even slower rise of noise tracker
+} rtty_atc_t;
 
 typedef enum {
 	RTTY_RUN_STATE_WAIT_START = 0,
@@ -252,16 +235,21 @@ typedef enum {
 
 
 typedef struct {
-	rtty_bpf_data_t bpfSpaceData;
-	rtty_bpf_data_t bpfMarkData;
-	rtty_lpf_data_t lpfData;
-	rtty_bpf_config_t *bpfSpaceConfig;
-	rtty_bpf_config_t *bpfMarkConfig;
-	rtty_lpf_config_t *lpfConfig;
+	rtty_biquad_t bpfSpace;
+	rtty_biquad_t bpfMark;
+	rtty_biquad_t lpf;
+	rtty_atc_t atc;
+
+	uint16_t markFreq;
+	uint16_t spaceFreq;
 
 	uint16_t oneBitSampleCount;
 	int32_t DPLLOldVal;
 	int32_t DPLLBitPhase;
+	bool DPLLPhaseChanged;
+
+	int16_t startBitState;
+	int16_t startBitWaitHalf;
 
 	uint8_t byteResult;
 	uint16_t byteResultp;
@@ -278,156 +266,108 @@ typedef struct {
 
 rtty_decoder_data_t rttyDecoderData;
 
-
-
-
-#if 0 // 48Khz filters, not needed
-// this is for 48ksps sample rate
-// for filter designing, see http://www-users.cs.york.ac.uk/~fisher/mkfilter/
-// order 2 Butterworth, freqs: 865-965 Hz
-rtty_bpf_config_t rtty_bp_48khz_915 =
-{
-		.gain = 2.356080041e+04,  // gain at centre
-		.coeffs = {-0.9816582826, 3.9166274264, -5.8882201843, 3.9530488323 },
-		.freq = 915
-};
-
-// order 2 Butterworth, freqs: 1035-1135 Hz
-rtty_bpf_config_t rtty_bp_48khz_1085 =
-{
-		.gain = 2.356080365e+04,
-		.coeffs = {-0.9816582826, 3.9051693660, -5.8653953990, 3.9414842213 },
-		.freq = 1085
-};
-#endif
-
-// order 2 Butterworth, freq: 50 Hz
-rtty_lpf_config_t rtty_lp_48khz_50 =
-{
-		.gain = 9.381008646e+04,
-		.coeffs = {-0.9907866988, 1.9907440595 }
-};
-
-// this is for 12ksps sample rate
-// for filter designing, see http://www-users.cs.york.ac.uk/~fisher/mkfilter/
-// order 2 Butterworth, freqs: 865-965 Hz, centre: 915 Hz
-static rtty_bpf_config_t rtty_bp_12khz_915 =
-{
-		.gain = 1.513364755e+03,
-		.coeffs = { -0.9286270861, 3.3584472566, -4.9635817596, 3.4851652468 },
-		.freq = 915
-};
-
-// order 2 Butterworth, freqs: 1315-1415 Hz, centre 1365Hz
-static rtty_bpf_config_t rtty_bp_12khz_1365 =
-{
-		.gain = 1.513365019e+03,
-		.coeffs = { -0.9286270861, 2.8583904591, -4.1263569881, 2.9662407442 },
-		.freq = 1365
-};
-// order 2 Butterworth, freqs: 1035-1135 Hz, centre: 1085Hz
-static rtty_bpf_config_t rtty_bp_12khz_1085 =
-{
-		.gain = 1.513364927e+03,
-		.coeffs = { -0.9286270861, 3.1900687350, -4.6666321298, 3.3104336142 },
-		.freq = 1085
-};
-// order 2 Butterworth, freqs: 1065-1165 Hz, centre: 1115Hz
-// for 200Hz shift
-static rtty_bpf_config_t rtty_bp_12khz_1115 =
-{
-		.gain = 1.513364944e+03,
-		.coeffs = { -0.9286270861, 3.1576917276, -4.6112830458, 3.2768349860 },
-		.freq = 1115
-};
-
-// for 85Hz shift --> 915 + 85Hz = space = 1000Hz
-// 3dB bandwidth 50Hz
-// order 2 Butterworth, freqs: 975-1025 Hz, centre: 1000Hz
-static rtty_bpf_config_t rtty_bp_12khz_1000 =
-{
-		.gain = 5.944465260e+03,
-		.coeffs = { -0.9636529842, 3.3693752166, -4.9084595657, 3.4323354886 },
-		.freq = 1000
-};
-
-// for 425Hz shift --> 915 + 425Hz = space = 1340Hz
-// 3dB bandwidth 100Hz
-// order 2 Butterworth, freqs: 1290 - 1390 Hz, centre: 1340Hz
-static rtty_bpf_config_t rtty_bp_12khz_1340 =
-{
-		.gain = 1.513365018e+03,
-		.coeffs = { -0.9286270862, 2.8906128091, -4.1762457780, 2.9996788796 },
-		.freq = 1340
-};
-
-// for 850Hz shift --> 915 + 850Hz = space = 1765Hz
-// 3dB bandwidth 100Hz
-// order 2 Butterworth, freqs: 1715 - 1815 Hz, centre: 1765Hz
-static rtty_bpf_config_t rtty_bp_12khz_1765 =
+/**
+ * @brief calculates the mark or space bandpass as cascade of two identical 2nd order bandpass stages
+ * (constant 0dB peak gain), coefficients are computed at runtime so any shift and speed can be used
+ * @param f0 center frequency in Hz
+ * @param bw 3dB bandwidth of the whole cascade in Hz
+ */
+static void RttyDecoder_CalcBandpass(rtty_biquad_t* bq, float32_t f0, float32_t bw, float32_t FS)
 {
-		.gain = 1.513365057e+03,
-		.coeffs = { -0.9286270862, 2.1190223173, -3.1352567157, 2.1989754113 },
-		.freq = 1765
-};
+	// cascading two identical stages narrows the 3dB bandwidth by sqrt(sqrt(2)-1)
+	float32_t Q = 0.6436f * f0 / bw;
+	float32_t w0 = 2 * PI * f0 / FS;
+	float32_t alpha = sinf(w0) / (2 * Q);
+	float32_t scaling = 1 + alpha;
 
+	for (int stage = 0; stage < RTTY_BPF_STAGES; stage++)
+	{
+		float32_t* coeffs = &bq->coeffs[5*stage];
+		coeffs[0] = alpha / scaling;
+		coeffs[1] = 0;
+		coeffs[2] = - alpha / scaling;
+		coeffs[3] = 2 * cosf(w0) / scaling; // already negated!
+		coeffs[4] = (alpha - 1) / scaling; // already negated!
+	}
+	arm_biquad_cascade_df1_init_f32(&bq->inst, RTTY_BPF_STAGES, bq->coeffs, bq->state);
+}
 
-static rtty_lpf_config_t rtty_lp_12khz_50 =
+/**
+ * @brief calculates the 2nd order Butterworth lowpass used to smooth the mark/space difference
+ */
+static void RttyDecoder_CalcLowpass(rtty_biquad_t* bq, float32_t f0, float32_t FS)
 {
-		.gain = 5.944465310e+03,
-		.coeffs = { -0.9636529842, 1.9629800894 }
-};
+	float32_t w0 = 2 * PI * f0 / FS;
+	float32_t alpha = sinf(w0) / (2 * M_SQRT1_2);
+	float32_t cosw0 = cosf(w0);
+	float32_t scaling = 1 + alpha;
+
+	bq->coeffs[0] = (1 - cosw0) / 2 / scaling;
+	bq->coeffs[1] = (1 - cosw0) / scaling;
+	bq->coeffs[2] = (1 - cosw0) / 2 / scaling;
+	bq->coeffs[3] = 2 * cosw0 / scaling; // already negated!
+	bq->coeffs[4] = (alpha - 1) / scaling; // already negated!
+
+	arm_biquad_cascade_df1_init_f32(&bq->inst, RTTY_LPF_STAGES, bq->coeffs, bq->state);
+}
 
 static rtty_mode_config_t  rtty_mode_current_config;
 
 
+// false while Rtty_Modem_Init() rebuilds rttyDecoderData, the audio interrupt must not use it then.
+// The interrupt preempts the UI code calling Rtty_Modem_Init(), never the other way round, so a flag is sufficient.
+static volatile bool rtty_decoder_ready;
+
 void Rtty_Modem_Init(uint32_t output_sample_rate)
 {
 
+	// everything but the filters is prepared in local copies, the audio interrupt may be decoding right now
 	// TODO: pass config as parameter and make it changeable via menu
-	rtty_mode_current_config.samplerate = 12000;
-	rtty_mode_current_config.shift = rtty_shifts[rtty_ctrl_config.shift_idx].value;
-	rtty_mode_current_config.speed = rtty_speeds[rtty_ctrl_config.speed_idx].value;
-	rtty_mode_current_config.stopbits = rtty_ctrl_config.stopbits_idx;
+	rtty_mode_config_t config;
+	config.samplerate = RTTY_SAMPLE_RATE;
+	config.shift = rtty_shifts[rtty_ctrl_config.shift_idx].value;
+	config.speed = rtty_speeds[rtty_ctrl_config.speed_idx].value;
+	config.stopbits = rtty_ctrl_config.stopbits_idx;
 
-	rttyDecoderData.config_p = &rtty_mode_current_config;
+	rtty_decoder_data_t data = { 0 };
+	data.config_p = &rtty_mode_current_config;
 
 	// common config to all supported modes
-	rttyDecoderData.oneBitSampleCount = (uint16_t)roundf(rttyDecoderData.config_p->samplerate/rttyDecoderData.config_p->speed);
-	rttyDecoderData.charSetMode = RTTY_MODE_LETTERS;
-	rttyDecoderData.state = RTTY_RUN_STATE_WAIT_START;
+	data.oneBitSampleCount = (uint16_t)roundf(config.samplerate/config.speed);
+	data.charSetMode = RTTY_MODE_LETTERS;
+	data.state = RTTY_RUN_STATE_WAIT_START;
 
-	rttyDecoderData.bpfMarkConfig = &rtty_bp_12khz_915; // this is mark, or '1'
-	rttyDecoderData.lpfConfig = &rtty_lp_12khz_50;
+	data.markFreq = RTTY_MARK_FREQ; // this is mark, or '1'
+	data.spaceFreq = RTTY_MARK_FREQ + config.shift; // this is space or '0'
 
-	// now we handled the specifics
-	switch (rttyDecoderData.config_p->shift)
-	{
-	case 85:
-		rttyDecoderData.bpfSpaceConfig = &rtty_bp_12khz_1000;
-		break;
-	case 200:
-		rttyDecoderData.bpfSpaceConfig = &rtty_bp_12khz_1115;
-		break;
-	case 425:
-		rttyDecoderData.bpfSpaceConfig = &rtty_bp_12khz_1340;
-		break;
-	case 450:
-		rttyDecoderData.bpfSpaceConfig = &rtty_bp_12khz_1365; // this is space or '0'
-		break;
-	case 850:
-		rttyDecoderData.bpfSpaceConfig = &rtty_bp_12khz_1765; // this is space or '0'
-		break;
-	case 170:
-	default:
-		// all unsupported shifts are mapped to 170
-		rttyDecoderData.bpfSpaceConfig = &rtty_bp_12khz_1085; // this is space or '0'
-	}
+	// ATC time constants, taken from the weights used by fldigi's decayavg() calls
+	data.atc.attack = 4.0 / data.oneBitSampleCount;
+	data.atc.decay = 1.0 / (data.oneBitSampleCount * 16);
+	data.atc.noise_decay = 1.0 / (data.oneBitSampleCount * 48);
 
 	// configure DDS for transmission
-	softdds_setFreqDDS(&rttyDecoderData.tx_dds[0], rttyDecoderData.bpfSpaceConfig->freq, output_sample_rate, 0);
-	softdds_setFreqDDS(&rttyDecoderData.tx_dds[1], rttyDecoderData.bpfMarkConfig->freq, output_sample_rate, 0);
+	softdds_setFreqDDS(&data.tx_dds[0], data.spaceFreq, output_sample_rate, 0);
+	softdds_setFreqDDS(&data.tx_dds[1], data.markFreq, output_sample_rate, 0);
+
+	// the filter instances point to their own coefficients and state,
+	// so they are set up in place after the copy, with the audio interrupt locked out
+	rtty_decoder_ready = false;
+	rtty_mode_current_config = config;
+	rttyDecoderData = data;
+
+	// the tone filters are about twice the baud rate wide (100Hz @ 45.45 baud)
+	// but never wider than 60% of the shift, otherwise mark and space would overlap for narrow shifts
+	float32_t bpf_bw = 2.2 * config.speed;
+	if (bpf_bw > 0.6 * config.shift)
+	{
+		bpf_bw = 0.6 * config.shift;
+	}
+	RttyDecoder_CalcBandpass(&rttyDecoderData.bpfMark, data.markFreq, bpf_bw, config.samplerate);
+	RttyDecoder_CalcBandpass(&rttyDecoderData.bpfSpace, data.spaceFreq, bpf_bw, config.samplerate);
+	// 50Hz @ 45.45 baud
+	RttyDecoder_CalcLowpass(&rttyDecoderData.lpf, 1.1 * config.speed, config.samplerate);
 
+	rtty_decoder_ready = true;
 }
 
 float32_t decayavg(float32_t average, float32_t input, int weight)
@@ -444,54 +384,38 @@ float32_t decayavg(float32_t average, float32_t input, int weight)
 	return retval;
 }
 
-
-// this function returns the bit value of the current sample
-static int RttyDecoder_demodulator(float32_t sample)
+/**
+ * @brief RTTY decoding with ATC = automatic threshold correction, makes the decoder robust against selective fading
+ * experiment to implement an ATC (Automatic threshold correction), DD4WH, 2017_08_24
+ * everything taken from FlDigi, licensed by GNU GPLv2 or later
+ * https://github.com/ukhas/dl-fldigi/blob/master/src/cw_rtty/rtty.cxx
+ * @param mark squared mark filter output
+ * @param space squared space filter output
+ * @param out decision values, > 0 means space, may be identical to mark or space
+ */
+static void RttyDecoder_Atc(const float32_t* mark, const float32_t* space, float32_t* out, uint16_t blockSize)
 {
+	rtty_atc_t* atc = &rttyDecoderData.atc;
+
+	for (uint16_t idx = 0; idx < blockSize; idx++)
+	{
+		float32_t mark_mag = mark[idx];
+		float32_t space_mag = space[idx];
 
-	float32_t space_mag = RttyDecoder_bandPassFreq(sample, rttyDecoderData.bpfSpaceConfig, &rttyDecoderData.bpfSpaceData);
-	float32_t mark_mag = RttyDecoder_bandPassFreq(sample, rttyDecoderData.bpfMarkConfig, &rttyDecoderData.bpfMarkData);
-
-	float32_t v1 = 0.0;
-	// calculating the RMS of the two lines (squaring them)
-	space_mag *= space_mag;
-	mark_mag *= mark_mag;
-
-    if(rtty_ctrl_config.atc_disable == false)
-	{   // RTTY decoding with ATC = automatic threshold correction
-		// FIXME: space & mark seem to be swapped in the following code
-		// dirty fix
-		float32_t helper = space_mag;
-		space_mag = mark_mag;
-		mark_mag = helper;
-		static float32_t mark_env = 0.0;
-		static float32_t space_env = 0.0;
-		static float32_t mark_noise = 0.0;
-		static float32_t space_noise = 0.0;
-		// experiment to implement an ATC (Automatic threshold correction), DD4WH, 2017_08_24
-		// everything taken from FlDigi, licensed by GNU GPLv2 or later
-		// https://github.com/ukhas/dl-fldigi/blob/master/src/cw_rtty/rtty.cxx
 		// calculate envelope of the mark and space signals
 		// uses fast attack and slow decay
-		mark_env = decayavg (mark_env, mark_mag,
-				(mark_mag > mark_env) ? rttyDecoderData.oneBitSampleCount / 4 : rttyDecoderData.oneBitSampleCount * 16);
-		space_env = decayavg (space_env, space_mag,
-				(space_mag > space_env) ? rttyDecoderData.oneBitSampleCount / 4 : rttyDecoderData.oneBitSampleCount * 16);
+		atc->mark_env += (mark_mag - atc->mark_env) * ((mark_mag > atc->mark_env) ? atc->attack : atc->decay);
+		atc->space_env += (space_mag - atc->space_env) * ((space_mag > atc->space_env) ? atc->attack : atc->decay);
 		// calculate the noise on the mark and space signals
-		mark_noise = decayavg (mark_noise, mark_mag,
-				(mark_mag < mark_noise) ? rttyDecoderData.oneBitSampleCount / 4 : rttyDecoderData.oneBitSampleCount * 48);
-		space_noise = decayavg (space_noise, space_mag,
-				(space_mag < space_noise) ? rttyDecoderData.oneBitSampleCount / 4 : rttyDecoderData.oneBitSampleCount * 48);
-		// the noise floor is the lower signal of space and mark noise
-		float32_t noise_floor = (space_noise < mark_noise) ? space_noise : mark_noise;
+		atc->mark_noise += (mark_mag - atc->mark_noise) * ((mark_mag < atc->mark_noise) ? atc->attack : atc->noise_decay);
+		atc->space_noise += (space_mag - atc->space_noise) * ((space_mag < atc->space_noise) ? atc->attack : atc->noise_decay);
 
-		// Linear ATC, section 3 of www.w7ay.net/site/Technical/ATC
-		//		v1 = space_mag - mark_mag - 0.5 * (space_env - mark_env);
+		// the noise floor is the lower signal of space and mark noise
+		float32_t noise_floor = (atc->space_noise < atc->mark_noise) ? atc->space_noise : atc->mark_noise;
 
 		// Compensating for the noise floor by using clipping
-		float32_t mclipped = 0.0, sclipped = 0.0;
-		mclipped = mark_mag > mark_env ? mark_env : mark_mag;
-		sclipped = space_mag > space_env ? space_env : space_mag;
+		float32_t mclipped = mark_mag > atc->mark_env ? atc->mark_env : mark_mag;
+		float32_t sclipped = space_mag > atc->space_env ? atc->space_env : space_mag;
 		if (mclipped < noise_floor)
 		{
 			mclipped = noise_floor;
@@ -501,72 +425,75 @@ static int RttyDecoder_demodulator(float32_t sample)
 			sclipped = noise_floor;
 		}
 
-		// we could add options for mark-only or space-only decoding
-		// however, the current implementation with ATC already works quite well with mark-only/space-only
-		/*					switch (progdefaults.rtty_cwi) {
-						case 1 : // mark only decode
-							space_env = sclipped = noise_floor;
-							break;
-						case 2: // space only decode
-							mark_env = mclipped = noise_floor;
-						default : ;
-		}
-		 */
+		float32_t mark_level = atc->mark_env - noise_floor;
+		float32_t space_level = atc->space_env - noise_floor;
 
 		// Optimal ATC (Section 6 of of www.w7ay.net/site/Technical/ATC)
-		v1  = (mclipped - noise_floor) * (mark_env - noise_floor) -
-				(sclipped - noise_floor) * (space_env - noise_floor) -
-				0.25 *  ((mark_env - noise_floor) * (mark_env - noise_floor) -
-						(space_env - noise_floor) * (space_env - noise_floor));
+		out[idx] = (sclipped - noise_floor) * space_level - (mclipped - noise_floor) * mark_level
+				- 0.25 * (space_level * space_level - mark_level * mark_level);
+	}
+}
+
+/**
+ * @brief demodulates a block of audio samples into bit values
+ * @param bits receives one bit value per input sample, 1 == mark, 0 == space
+ */
+static void RttyDecoder_Demodulator(float32_t* src, uint8_t* bits, uint16_t blockSize)
+{
+	float32_t mark[RTTY_BLOCK_SIZE_MAX];
+	float32_t space[RTTY_BLOCK_SIZE_MAX];
 
-		v1 = RttyDecoder_lowPass(v1, rttyDecoderData.lpfConfig, &rttyDecoderData.lpfData);
+	arm_biquad_cascade_df1_f32(&rttyDecoderData.bpfMark.inst, src, mark, blockSize);
+	arm_biquad_cascade_df1_f32(&rttyDecoderData.bpfSpace.inst, src, space, blockSize);
 
+	// calculating the power of the two lines (squaring them)
+	arm_mult_f32(mark, mark, mark, blockSize);
+	arm_mult_f32(space, space, space, blockSize);
+
+	if(rtty_ctrl_config.atc_disable == false)
+	{
+		RttyDecoder_Atc(mark, space, mark, blockSize);
 	}
 	else
 	{   // RTTY without ATC, which works very well too!
-		// inverting line 1
-		mark_mag *= -1;
+		// summing the space line and the inverted mark line
+		arm_sub_f32(space, mark, mark, blockSize);
+	}
 
-		// summing the two lines
-		v1 = mark_mag + space_mag;
+	// lowpass filtering the summed line
+	arm_biquad_cascade_df1_f32(&rttyDecoderData.lpf.inst, mark, mark, blockSize);
 
-		// lowpass filtering the summed line
-		v1 = RttyDecoder_lowPass(v1, rttyDecoderData.lpfConfig, &rttyDecoderData.lpfData);
+	for (uint16_t idx = 0; idx < blockSize; idx++)
+	{
+		bits[idx] = (mark[idx] > 0)?0:1;
 	}
-
-	return (v1 > 0)?0:1;
 }
 
 // this function returns true once at the half of a bit with the bit's value
-static bool RttyDecoder_getBitDPLL(float32_t sample, bool* val_p) {
-	static bool phaseChanged = false;
+static bool RttyDecoder_getBitDPLL(uint8_t bit, bool* val_p) {
 	bool retval = false;
 
+	*val_p = bit;
 
-	if (rttyDecoderData.DPLLBitPhase < rttyDecoderData.oneBitSampleCount)
-	{
-		*val_p = RttyDecoder_demodulator(sample);
-
-		if (!phaseChanged && *val_p != rttyDecoderData.DPLLOldVal) {
-			if (rttyDecoderData.DPLLBitPhase < rttyDecoderData.oneBitSampleCount/2)
-			{
-				// rttyDecoderData.DPLLBitPhase += rttyDecoderData.oneBitSampleCount/8; // early
-				rttyDecoderData.DPLLBitPhase += rttyDecoderData.oneBitSampleCount/32; // early
-			}
-			else
-			{
-				//rttyDecoderData.DPLLBitPhase -= rttyDecoderData.oneBitSampleCount/8; // late
-				rttyDecoderData.DPLLBitPhase -= rttyDecoderData.oneBitSampleCount/32; // late
-			}
-			phaseChanged = true;
+	if (!rttyDecoderData.DPLLPhaseChanged && *val_p != rttyDecoderData.DPLLOldVal) {
+		if (rttyDecoderData.DPLLBitPhase < rttyDecoderData.oneBitSampleCount/2)
+		{
+			rttyDecoderData.DPLLBitPhase += rttyDecoderData.oneBitSampleCount/32; // early
 		}
-		rttyDecoderData.DPLLOldVal = *val_p;
-		rttyDecoderData.DPLLBitPhase++;
+		else
+		{
+			rttyDecoderData.DPLLBitPhase -= rttyDecoderData.oneBitSampleCount/32; // late
+		}
+		// only one correction per bit
+		rttyDecoderData.DPLLPhaseChanged = true;
 	}
+	rttyDecoderData.DPLLOldVal = *val_p;
+	rttyDecoderData.DPLLBitPhase++;
 
 	if (rttyDecoderData.DPLLBitPhase >= rttyDecoderData.oneBitSampleCount)
 	{
 		rttyDecoderData.DPLLBitPhase -= rttyDecoderData.oneBitSampleCount;
+		rttyDecoderData.DPLLPhaseChanged = false;
 		retval = true;
 	}
 
@@ -574,39 +501,35 @@ static bool RttyDecoder_getBitDPLL(float32_t sample, bool* val_p) {
 }
 
 // this function returns only true when the start bit is successfully received
-static bool RttyDecoder_waitForStartBit(float32_t sample) {
+static bool RttyDecoder_waitForStartBit(uint8_t bitResult) {
 	bool retval = false;
-	int bitResult;
-	static int16_t wait_for_start_state = 0;
-	static int16_t wait_for_half = 0;
 
-	bitResult = RttyDecoder_demodulator(sample);
-	switch (wait_for_start_state)
+	switch (rttyDecoderData.startBitState)
 	{
 	case 0:
 		// waiting for a falling edge
 		if (bitResult != 0)
 		{
-			wait_for_start_state++;
+			rttyDecoderData.startBitState++;
 		}
 		break;
 	case 1:
 		if (bitResult != 1)
 		{
-			wait_for_start_state++;
+			rttyDecoderData.startBitState++;
 		}
 		break;
 	case 2:
-		wait_for_half = rttyDecoderData.oneBitSampleCount/2;
-		wait_for_start_state ++;
+		rttyDecoderData.startBitWaitHalf = rttyDecoderData.oneBitSampleCount/2;
+		rttyDecoderData.startBitState ++;
         /* fall through */ // this is for the compiler, the following comment is for Eclipse
 		/* no break */
 	case 3:
-		wait_for_half--;
-		if (wait_for_half == 0)
+		rttyDecoderData.startBitWaitHalf--;
+		if (rttyDecoderData.startBitWaitHalf == 0)
 		{
 			retval = (bitResult == 0);
-			wait_for_start_state = 0;
+			rttyDecoderData.startBitState = 0;
 		}
 		break;
 	}
@@ -619,17 +542,20 @@ static const char RTTYLetters[] = "<E\nA SIU\nDRJNFCKTZLWHYPQOBG^MXV^";
 static const char RTTYSymbols[] = "<3\n- ,87\n$4#,.:(5+)2.60197.^./=^";
 
 
-void Rtty_Demodulator_ProcessSample(float32_t sample)
+static void RttyDecoder_ProcessBit(uint8_t bit)
 {
 
 	switch(rttyDecoderData.state)
 	{
 	case RTTY_RUN_STATE_WAIT_START: // not synchronized, need to wait for start bit
-		if (RttyDecoder_waitForStartBit(sample))
+		if (RttyDecoder_waitForStartBit(bit))
 		{
 			rttyDecoderData.state = RTTY_RUN_STATE_BIT;
 			rttyDecoderData.byteResultp = 1;
 			rttyDecoderData.byteResult = 0;
+			// we are in the middle of the start bit, so the next bit is sampled one bit length from now
+			rttyDecoderData.DPLLBitPhase = 0;
+			rttyDecoderData.DPLLPhaseChanged = false;
 		}
 		break;
 	case RTTY_RUN_STATE_BIT:
@@ -637,7 +563,7 @@ void Rtty_Demodulator_ProcessSample(float32_t sample)
 		if (rttyDecoderData.byteResultp < 8)
 		{
 			bool bitResult = false;
-			if (RttyDecoder_getBitDPLL(sample, &bitResult))
+			if (RttyDecoder_getBitDPLL(bit, &bitResult))
 			{
 				switch (rttyDecoderData.byteResultp)
 				{
@@ -698,6 +624,31 @@ void Rtty_Demodulator_ProcessSample(float32_t sample)
 	}
 }
 
+/**
+ * @brief RTTY receive entry point, demodulates a block of 12ksps audio samples and decodes the resulting bits
+ */
+void Rtty_Demodulator_ProcessBlock(float32_t* src, int16_t blockSize)
+{
+	uint8_t bits[RTTY_BLOCK_SIZE_MAX];
+
+	if (rtty_decoder_ready == false)
+	{
+		return;
+	}
+
+	for (int16_t offset = 0; offset < blockSize; offset += RTTY_BLOCK_SIZE_MAX)
+	{
+		uint16_t chunkSize = (blockSize - offset) < RTTY_BLOCK_SIZE_MAX ? (blockSize - offset) : RTTY_BLOCK_SIZE_MAX;
+
+		RttyDecoder_Demodulator(&src[offset], bits, chunkSize);
+
+		for (uint16_t idx = 0; idx < chunkSize; idx++)
+		{
+			RttyDecoder_ProcessBit(bits[idx]);
+		}
+	}
+}
+
 typedef enum
 {
 	MSK_IDLE = 0,
@@ -793,6 +744,11 @@ const char rtty_test_string[] = " --- UHSDR FIRMWARE RTTY TX TEST DE DB4PLE ---
 
 int16_t Rtty_Modulator_GenSample()
 {
+	if (rtty_decoder_ready == false)
+	{
+		return 0;
+	}
+
 	if (rtty_tx.char_bit_samples == 0)
 	{
 		rtty_tx.char_bit_samples = rttyDecoderData.oneBitSampleCount * 4;
@@ -33,6 +33,7 @@ typedef struct
 typedef enum {
     RTTY_SPEED_45,
     RTTY_SPEED_50,
+    RTTY_SPEED_75,
     RTTY_SPEED_NUM
 } rtty_speed_t;
 
@@ -78,7 +79,7 @@ typedef struct
 
 extern rtty_ctrl_t rtty_ctrl_config;
 void Rtty_Modem_Init(uint32_t output_sample_rate);
-void Rtty_Demodulator_ProcessSample(float32_t sample);
+void Rtty_Demodulator_ProcessBlock(float32_t* src, int16_t blockSize);
 int16_t Rtty_Modulator_GenSample();
 
 #endif
@@ -589,6 +589,16 @@ static bool TxProcessor_FM(audio_block_t* a_blocks,  iq_buffer_t* iq_buf_p, uint
 
 #ifdef USE_FREEDV
 
+#define FDV_TX_FACTOR_DECIMATE (IQ_SAMPLE_RATE/8000) // 6x @ 48ksps
+#define FDV_TX_FACTOR_INTERPOLATE (AUDIO_SAMPLE_RATE/8000) // 6x @ 48ksps
+// a block of n samples contains at most ceil(n/factor) sample positions with a wrapped modulus
+#define FDV_TX_SAMPLES_MAX ((AUDIO_BLOCK_SIZE + FDV_TX_FACTOR_DECIMATE - 1) / FDV_TX_FACTOR_DECIMATE)
+#define FDV_TX_IQ_MAX ((IQ_BLOCK_SIZE + FDV_TX_FACTOR_INTERPOLATE - 1) / FDV_TX_FACTOR_INTERPOLATE)
+
+// kept off the interrupt stack, only used from the audio interrupt
+static fdv_audio_rb_item_t fdv_tx_samples[FDV_TX_SAMPLES_MAX];
+static fdv_iq_rb_item_t fdv_tx_iq[FDV_TX_IQ_MAX];
+
 /**
  * Runs FreeDV modulation on audio input signal. This signal is correctly shifted away from center frequency by the receive frequency shift both by absolute value and direction
  *
@@ -603,8 +613,8 @@ static bool TxProcessor_FreeDV (audio_block_t a_block, iq_buffer_t* iq_buf_p, in
     static int16_t modulus_Decimate = 0;
     static int16_t modulus_Interpolate = 0;
 
-    const int32_t factor_Decimate = IQ_SAMPLE_RATE/8000; // 6x @ 48ksps
-    const int32_t factor_Interpolate = AUDIO_SAMPLE_RATE/8000; // 6x @ 48ksps
+    const int32_t factor_Decimate = FDV_TX_FACTOR_DECIMATE;
+    const int32_t factor_Interpolate = FDV_TX_FACTOR_INTERPOLATE;
 
     static bool bufferFilled = false;
     bool retval = false;
@@ -620,12 +630,14 @@ static bool TxProcessor_FreeDV (audio_block_t a_block, iq_buffer_t* iq_buf_p, in
     // for decimation-by-6 the stopband frequency is 48/6*2 = 4kHz
 
     // DOWNSAMPLING
+    // collect the decimated samples of this block and hand them over to FreeDV in a single copy
+    int16_t fdv_samples_num = 0;
+
     for (int k = 0; k < blockSize; k++)
     {
         if (modulus_Decimate == 0)  //every 6th sample has to be catched -> downsampling by 6
         {
-            int16_t sample = ((int32_t)a_block[k])/4;
-            RingBuffer_PutSamples(&fdv_audio_rb,&sample,1);
+            fdv_tx_samples[fdv_samples_num++] = ((int32_t)a_block[k])/4;
         }
 
         // increment and wrap
@@ -635,6 +647,7 @@ static bool TxProcessor_FreeDV (audio_block_t a_block, iq_buffer_t* iq_buf_p, in
             modulus_Decimate = 0;
         }
     }
+    RingBuffer_PutSamples(&fdv_audio_rb, fdv_tx_samples, fdv_samples_num);
 
 
     // we wait for at least two frames being processed until we start transmitting
@@ -644,8 +657,15 @@ static bool TxProcessor_FreeDV (audio_block_t a_block, iq_buffer_t* iq_buf_p, in
         bufferFilled = true;
     }
 
-    if (bufferFilled == true && RingBuffer_GetData(&fdv_iq_rb) >= (modulus_Interpolate == 1?5:6))
+    // number of 8k samples consumed by this block: one at every position where modulus_Interpolate wraps to 0
+    const int32_t first_sample_idx = (factor_Interpolate - modulus_Interpolate) % factor_Interpolate;
+    const int32_t fdv_iq_num = first_sample_idx < blockSize ? (blockSize - 1 - first_sample_idx) / factor_Interpolate + 1 : 0;
+
+    if (bufferFilled == true && RingBuffer_GetData(&fdv_iq_rb) >= fdv_iq_num)
     {
+        int32_t fdv_iq_idx = 0;
+        RingBuffer_GetSamples(&fdv_iq_rb, fdv_tx_iq, fdv_iq_num);
+
         // Best thing here would be to use the arm_fir_decimate function! Why?
         // --> we need phase linear filters, because we have to filter I & Q and preserve their phase relationship
         // IIR filters are power saving, but they do not care about phase, so useless at this point
@@ -661,10 +681,9 @@ static bool TxProcessor_FreeDV (audio_block_t a_block, iq_buffer_t* iq_buf_p, in
         {
             if (modulus_Interpolate == 0) // put in sample pair
             {
-                fdv_iq_rb_item_t sample;
-                RingBuffer_GetSamples(&fdv_iq_rb, &sample, 1);
-                i_buffer[j] = sample.real;
-                q_buffer[j] = sample.imag;
+                i_buffer[j] = fdv_tx_iq[fdv_iq_idx].real;
+                q_buffer[j] = fdv_tx_iq[fdv_iq_idx].imag;
+                fdv_iq_idx++;
             }
             else // in 5 of 6 cases just stuff in zeros = zero-padding / zero-stuffing
             {
@@ -697,7 +716,11 @@ static bool TxProcessor_FreeDV (audio_block_t a_block, iq_buffer_t* iq_buf_p, in
     }
     else
     {
-        profileEvent(FreeDVTXUnderrun);
+        // we only count real underruns, not the initial filling of the buffer
+        if (bufferFilled == true)
+        {
+            profileEvent(FreeDVTXUnderrun);
+        }
         bufferFilled = false;
     }
 
@@ -979,6 +1002,11 @@ void TxProcessor_Run(AudioSample_t * const srcCodec, IqSample_t * const dst, Aud
             TxProcessor_CwInputForDigitalModes(adb.a_buffer, blockSize);
             iq_gain_comp = 1.0;
             break;
+#ifdef USE_FT8_DECODER
+        case DigitalMode_FT8:
+            // receive only, we never get here since RadioManagement_SwitchTxRx refuses to go to TX
+            break;
+#endif
         }
     }
     else if(dmod_mode == DEMOD_CW || ts.cw_text_entry)
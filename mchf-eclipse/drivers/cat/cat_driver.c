@@ -22,6 +22,8 @@
 #include "audio_driver.h"
 #include "radio_management.h"
 #include "config_storage.h"
+#include "freedv_uhsdr.h"
+#include "ui_spectrum.h"
 
 uint8_t limit_4bits(uint32_t in)
 {
@@ -206,6 +208,32 @@ static uint8_t CatDriver_InterfaceBufferPutData(uint8_t* Buf,uint32_t Len)
     return res;
 }
 
+// room we leave in the USB transmit buffer for CAT answers when sending stream data, the longest answer has 32 bytes
+#define CAT_STREAM_RESERVE 64
+
+/**
+ * @brief free room for unsolicited stream data (e.g. spectrum frames) on the CAT interface
+ * @returns number of bytes which can be passed to CatDriver_StreamPutData, 0 if not connected
+ */
+uint32_t CatDriver_StreamSpace()
+{
+    uint32_t retval = 0;
+    if (CatDriver_GetInterfaceState() == CAT_CONNECTED)
+    {
+        const uint32_t free = CDC_Transmit_Free_FS();
+        retval = free > CAT_STREAM_RESERVE ? free - CAT_STREAM_RESERVE : 0;
+    }
+    return retval;
+}
+
+/**
+ * @brief send unsolicited stream data on the CAT interface, all or nothing
+ * must be called from the same context as the CAT protocol handler so that stream data and CAT answers don't mix
+ */
+bool CatDriver_StreamPutData(uint8_t* Buf, uint32_t Len)
+{
+    return Len <= CatDriver_StreamSpace() && CatDriver_InterfaceBufferPutData(Buf, Len) != 0;
+}
 
 /*
 
@@ -735,10 +763,17 @@ typedef enum
     FT817_NOOP          = 0xff,
 
     UHSDR_ID            = 0x42, // this command is not known to the FT817 so we can use this to identify a UHSDR
+    UHSDR_FREEDV_TXT_TX = 0x43, // queue up to 4 characters for the FreeDV text channel, 0x00 bytes are skipped
+    UHSDR_FREEDV_TXT_RX = 0x44, // fetch up to UHSDR_FREEDV_TXT_RX_MAX characters received in the FreeDV text channel
+    UHSDR_SIGNALS       = 0x45, // fetch up to UHSDR_SIGNALS_MAX entries of the spectrum signal list starting at the entry given in the first byte
+    UHSDR_SPECTRUM_STREAM = 0x46, // start/stop the spectrum stream, first byte max. frames per second (0 = stop), second byte bin reduction (2^n bins merged)
 } Ft817_CatCmd_t;
 
 struct FT817 ft817;
 
+#define UHSDR_FREEDV_TXT_RX_MAX 16
+#define UHSDR_SIGNALS_MAX 4
+
 
 uint8_t CatDriver_Clone_Checksum(uint8_t* buf, size_t len)
 {
@@ -1310,6 +1345,69 @@ static void CatDriver_HandleCommands()
             resp[4] = 'R';
             bc = 5;
             break;
+#ifdef USE_FREEDV
+        case UHSDR_FREEDV_TXT_TX:
+        {
+            // answer is the number of accepted characters and the room left in the queue,
+            // so that the host can throttle itself and offer the rest again later
+            uint8_t txt[4];
+            int32_t len = 0;
+            for (int idx = 0; idx < 4; idx++)
+            {
+                if (ft817.req[idx] != 0)
+                {
+                    txt[len++] = ft817.req[idx];
+                }
+            }
+            int32_t room = FreeDV_TextTxRoom();
+            resp[0] = len <= room ? FreeDV_TextTxPut(txt, len) : 0; // all or nothing, keeps the text in order
+            room = FreeDV_TextTxRoom();
+            resp[1] = room > 255 ? 255 : room;
+            bc = 2;
+            break;
+        }
+        case UHSDR_FREEDV_TXT_RX:
+            // answer is the number of characters followed by the characters
+            resp[0] = FreeDV_TextRxGet(&resp[1], UHSDR_FREEDV_TXT_RX_MAX);
+            bc = 1 + resp[0];
+            break;
+#endif
+        case UHSDR_SIGNALS:
+        {
+            // answer is the number of signals in the list and the number of entries following,
+            // each entry is frequency in Hz (4 bytes), SNR in dB (1 byte) and duration in s (2 bytes), little endian
+            const uint8_t num = sd.signals_num;
+            uint8_t count = 0;
+            bc = 2;
+            for (uint8_t idx = ft817.req[0]; idx < num && count < UHSDR_SIGNALS_MAX; idx++, count++)
+            {
+                const SpectrumSignal_t* sig = &sd.signals[idx];
+                const uint32_t duration = (sig->last_seen - sig->first_seen) / 100;
+                const float32_t snr = sig->snr < 255 ? sig->snr : 255;
+
+                resp[bc++] = sig->freq;
+                resp[bc++] = sig->freq >> 8;
+                resp[bc++] = sig->freq >> 16;
+                resp[bc++] = sig->freq >> 24;
+                resp[bc++] = snr;
+                resp[bc++] = duration < 0xffff ? duration : 0xffff;
+                resp[bc++] = (duration < 0xffff ? duration : 0xffff) >> 8;
+            }
+            resp[0] = num;
+            resp[1] = count;
+            break;
+        }
+        case UHSDR_SPECTRUM_STREAM:
+        {
+            // answer is the accepted frame rate and the number of bins per frame (little endian)
+            // the frames are sent unsolicited between CAT answers, see UiSpectrum_StreamFrame for the format
+            const uint16_t bins = UiSpectrum_StreamConfigure(ft817.req[0], ft817.req[1]);
+            resp[0] = bins != 0 ? UiSpectrum_StreamRate() : 0;
+            resp[1] = bins;
+            resp[2] = bins >> 8;
+            bc = 3;
+            break;
+        }
             // default:
             // while (1);
 
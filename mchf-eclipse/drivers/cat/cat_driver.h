@@ -44,4 +44,7 @@ bool CatDriver_CloneInStart();
 bool CatDriver_CWKeyPressed();
 bool CatDriver_CatPttActive();
 
+uint32_t CatDriver_StreamSpace();
+bool CatDriver_StreamPutData(uint8_t* Buf, uint32_t Len);
+
 #endif
@@ -2508,7 +2508,11 @@ void analyse_one_frame(struct CODEC2 *c2, MODEL *model, short speech[])
       c2->Sn[i+m_pitch-n_samp] = speech[i];
 
     //PROFILE_SAMPLE(dft_start);
+#ifndef FDV_ARM_MATH
     dft_speech(&c2->c2const, c2->fft_fwd_cfg, Sw, c2->Sn, c2->w);
+#else
+    dft_speech(&c2->c2const, c2->fftr_fwd_cfg, Sw, c2->Sn, c2->w);
+#endif
     //PROFILE_SAMPLE_AND_LOG(nlp_start, dft_start, "    dft_speech");
 
     /* Estimate pitch */
@@ -0,0 +1,139 @@
+/*
+ * codec2_arena.c
+ *
+ * Mode scoped memory arena for the codec2 / FreeDV code, see codec2_arena.h
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "codec2_arena.h"
+
+#define ARENA_ALIGN         8
+#define ARENA_NONE          0xffffffff
+
+// every allocation is preceded by this header, so that we can walk back from the top
+typedef struct {
+    uint32_t prev;          // offset of the header of the previous allocation, ARENA_NONE for the first one
+    uint32_t freed;
+} arena_hdr_t;
+
+typedef struct {
+    uint8_t* mem;
+    size_t size;
+    size_t top;             // first unused byte
+    uint32_t last;          // offset of the header of the most recent allocation
+    size_t high_water;      // max. of top since last reset
+    size_t failed;          // number of allocations which did not fit since last reset
+} codec2_arena_t;
+
+static codec2_arena_t arena = { .last = ARENA_NONE };
+
+/**
+ * Assign the memory to be used by the arena, discards everything allocated so far.
+ */
+void codec2_arena_init(void* mem, size_t size)
+{
+    arena.mem = mem;
+    arena.size = size;
+    codec2_arena_reset();
+}
+
+/**
+ * Release all allocations at once, O(1). Any pointer handed out before becomes invalid.
+ */
+void codec2_arena_reset(void)
+{
+    arena.top = 0;
+    arena.last = ARENA_NONE;
+    arena.high_water = 0;
+    arena.failed = 0;
+}
+
+void* codec2_arena_malloc(size_t size)
+{
+    void* retval = NULL;
+
+    if (arena.mem == NULL)
+    {
+        retval = malloc(size);
+    }
+    else
+    {
+        const size_t need = sizeof(arena_hdr_t) + ((size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1));
+
+        if (arena.top + need <= arena.size)
+        {
+            arena_hdr_t* hdr = (arena_hdr_t*)&arena.mem[arena.top];
+            hdr->prev = arena.last;
+            hdr->freed = 0;
+
+            arena.last = arena.top;
+            arena.top += need;
+            if (arena.top > arena.high_water)
+            {
+                arena.high_water = arena.top;
+            }
+            retval = hdr + 1;
+        }
+        else
+        {
+            arena.failed++;
+        }
+    }
+    return retval;
+}
+
+void* codec2_arena_calloc(size_t nmemb, size_t size)
+{
+    void* retval = codec2_arena_malloc(nmemb * size);
+    if (retval != NULL)
+    {
+        memset(retval, 0, nmemb * size);
+    }
+    return retval;
+}
+
+void codec2_arena_free(void* ptr)
+{
+    if (ptr != NULL)
+    {
+        if (arena.mem == NULL || (uint8_t*)ptr < arena.mem || (uint8_t*)ptr >= &arena.mem[arena.size])
+        {
+            // not ours, came from the heap
+            free(ptr);
+        }
+        else
+        {
+            ((arena_hdr_t*)ptr - 1)->freed = 1;
+
+            // give back all freed allocations at the top
+            while (arena.last != ARENA_NONE && ((arena_hdr_t*)&arena.mem[arena.last])->freed)
+            {
+                arena.top = arena.last;
+                arena.last = ((arena_hdr_t*)&arena.mem[arena.last])->prev;
+            }
+        }
+    }
+}
+
+size_t codec2_arena_size(void)
+{
+    return arena.size;
+}
+
+size_t codec2_arena_used(void)
+{
+    return arena.top;
+}
+
+size_t codec2_arena_high_water(void)
+{
+    return arena.high_water;
+}
+
+size_t codec2_arena_failed(void)
+{
+    return arena.failed;
+}
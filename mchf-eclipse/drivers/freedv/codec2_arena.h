@@ -0,0 +1,38 @@
+/*
+ * codec2_arena.h
+ *
+ * Mode scoped memory arena for the codec2 / FreeDV code.
+ *
+ * All MALLOC/CALLOC/FREE calls of the codec2 code (see debug_alloc.h) are served from a single static
+ * block of memory instead of the heap. Memory is handed out from the bottom up, FREE only gives memory back
+ * once everything allocated after it has been freed as well (which is the case for the temporary buffers
+ * used while running a mode, e.g. in the LDPC decoder).
+ * When a mode is closed, codec2_arena_reset() releases everything at once, so a mode switch can neither
+ * fragment the heap nor fail halfway because of it.
+ *
+ * If no memory has been assigned with codec2_arena_init(), the normal heap functions are used.
+ */
+
+#ifndef DRIVERS_FREEDV_CODEC2_ARENA_H_
+#define DRIVERS_FREEDV_CODEC2_ARENA_H_
+
+#include <stddef.h>
+
+#ifdef FDV_ARM_MATH
+// firmware builds always use the arena
+#define USE_CODEC2_ARENA
+#endif
+
+void codec2_arena_init(void* mem, size_t size);
+void codec2_arena_reset(void);
+
+void* codec2_arena_malloc(size_t size);
+void* codec2_arena_calloc(size_t nmemb, size_t size);
+void codec2_arena_free(void* ptr);
+
+size_t codec2_arena_size(void);
+size_t codec2_arena_used(void);
+size_t codec2_arena_high_water(void);
+size_t codec2_arena_failed(void);
+
+#endif /* DRIVERS_FREEDV_CODEC2_ARENA_H_ */
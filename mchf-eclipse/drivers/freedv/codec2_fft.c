@@ -13,60 +13,35 @@
 #include "_kiss_fft_guts.h"
 
 #else
-#if 0
-// caching constants in RAM did not seem to have an effect on performance
-// TODO: Decide what to with this code
-#define FFT_INIT_CACHE_SIZE 4
-const arm_cfft_instance_f32* fft_init_cache[FFT_INIT_CACHE_SIZE];
-
-static const arm_cfft_instance_f32* arm_fft_instance2ram(const arm_cfft_instance_f32* in)
+/*
+ * All transforms of codec2/FreeDV share statically allocated configurations,
+ * one per size and direction. The CMSIS twiddle and bit reversal tables are
+ * const and stay in flash, only the small real FFT instances live in RAM.
+ * Nothing is allocated at runtime, so the *_free() functions have nothing to do.
+ */
+static codec2_fft_struct codec2_fft_cfgs[][2] =
 {
+    { { &arm_cfft_sR_f32_len64, 0 },   { &arm_cfft_sR_f32_len64, 1 } },
+    { { &arm_cfft_sR_f32_len128, 0 },  { &arm_cfft_sR_f32_len128, 1 } },
+    { { &arm_cfft_sR_f32_len256, 0 },  { &arm_cfft_sR_f32_len256, 1 } },
+    { { &arm_cfft_sR_f32_len512, 0 },  { &arm_cfft_sR_f32_len512, 1 } },
+    { { &arm_cfft_sR_f32_len1024, 0 }, { &arm_cfft_sR_f32_len1024, 1 } },
+};
 
-    arm_cfft_instance_f32* out = malloc(sizeof(arm_cfft_instance_f32));
-
-    if (out) {
-        memcpy(out,in,sizeof(arm_cfft_instance_f32));
-        out->pBitRevTable = malloc(out->bitRevLength * sizeof(uint16_t));
-        out->pTwiddle = malloc(out->fftLen * sizeof(float32_t));
-        memcpy((void*)out->pBitRevTable,in->pBitRevTable,out->bitRevLength * sizeof(uint16_t));
-        memcpy((void*)out->pTwiddle,in->pTwiddle,out->fftLen * sizeof(float32_t));
-    }
-    return out;
-}
+#define CODEC2_FFT_CFGS_NUM (sizeof(codec2_fft_cfgs)/sizeof(codec2_fft_cfgs[0]))
 
+// different real FFT sizes in use at the same time: 512 (codec), 1024 (modem stats), dct2 sizes
+#define CODEC2_FFTR_SIZES_MAX 4
 
-static const arm_cfft_instance_f32* arm_fft_cache_get(const arm_cfft_instance_f32* romfft)
-{
-    const arm_cfft_instance_f32* retval = NULL;
-    static int used = 0;
-    for (int i = 0; fft_init_cache[i] != NULL && i < used; i++)
-    {
-        if (romfft->fftLen == fft_init_cache[i]->fftLen)
-        {
-            retval = fft_init_cache[i];
-            break;
-        }
-    }
-    if (retval == NULL && used < FFT_INIT_CACHE_SIZE)
-    {
-         retval = arm_fft_instance2ram(romfft);
-         fft_init_cache[used++] = retval;
-    }
-    if (retval == NULL)
-    {
-        retval = romfft;
-    }
-    return retval;
-}
-#endif
+static arm_rfft_fast_instance_f32 codec2_fftr_instances[CODEC2_FFTR_SIZES_MAX];
+static codec2_fftr_struct codec2_fftr_cfgs[CODEC2_FFTR_SIZES_MAX][2];
+static int codec2_fftr_used;
 #endif
 
 void codec2_fft_free(codec2_fft_cfg cfg)
 {
 #ifdef USE_KISS_FFT
     KISS_FFT_FREE(cfg);
-#else
-    FREE(cfg);
 #endif
 }
 
@@ -76,26 +51,14 @@ codec2_fft_cfg codec2_fft_alloc(int nfft, int inverse_fft, void* mem, size_t* le
 #ifdef USE_KISS_FFT
     retval = kiss_fft_alloc(nfft, inverse_fft, mem, lenmem);
 #else
-    retval = MALLOC(sizeof(codec2_fft_struct));
-    retval->inverse  = inverse_fft;
-    switch(nfft)
+    int idx;
+    for (idx = 0; idx < CODEC2_FFT_CFGS_NUM && codec2_fft_cfgs[idx][0].instance->fftLen != nfft; idx++);
+
+    if (idx == CODEC2_FFT_CFGS_NUM)
     {
-    case 128:
-        retval->instance = &arm_cfft_sR_f32_len128;
-        break;
-    case 256:
-        retval->instance = &arm_cfft_sR_f32_len256;
-        break;
-    case 512:
-        retval->instance = &arm_cfft_sR_f32_len512;
-        break;
-//    case 1024:
-//        retval->instance = &arm_cfft_sR_f32_len1024;
-//        break;
-    default:
         abort();
     }
-    // retval->instance = arm_fft_cache_get(retval->instance);
+    retval = &codec2_fft_cfgs[idx][inverse_fft != 0];
 #endif
     return retval;
 }
@@ -106,21 +69,31 @@ codec2_fftr_cfg codec2_fftr_alloc(int nfft, int inverse_fft, void* mem, size_t*
 #ifdef USE_KISS_FFT
     retval = kiss_fftr_alloc(nfft, inverse_fft, mem, lenmem);
 #else
-    retval = MALLOC(sizeof(codec2_fftr_struct));
-    retval->inverse  = inverse_fft;
-    retval->instance = MALLOC(sizeof(arm_rfft_fast_instance_f32));
-    arm_rfft_fast_init_f32(retval->instance,nfft);
-    // memcpy(&retval->instance->Sint,arm_fft_cache_get(&retval->instance->Sint),sizeof(arm_cfft_instance_f32));
+    int idx;
+    for (idx = 0; idx < codec2_fftr_used && codec2_fftr_instances[idx].fftLenRFFT != nfft; idx++);
+
+    if (idx == codec2_fftr_used)
+    {
+        // first user of this size, initialize the shared instance
+        if (idx == CODEC2_FFTR_SIZES_MAX || arm_rfft_fast_init_f32(&codec2_fftr_instances[idx], nfft) != ARM_MATH_SUCCESS)
+        {
+            abort();
+        }
+        codec2_fftr_cfgs[idx][0].instance = &codec2_fftr_instances[idx];
+        codec2_fftr_cfgs[idx][0].inverse = 0;
+        codec2_fftr_cfgs[idx][1].instance = &codec2_fftr_instances[idx];
+        codec2_fftr_cfgs[idx][1].inverse = 1;
+        codec2_fftr_used++;
+    }
+    retval = &codec2_fftr_cfgs[idx][inverse_fft != 0];
 #endif
     return retval;
 }
+
 void codec2_fftr_free(codec2_fftr_cfg cfg)
 {
 #ifdef USE_KISS_FFT
     KISS_FFT_FREE(cfg);
-#else
-    FREE(cfg->instance);
-    FREE(cfg);
 #endif
 }
 
@@ -72,6 +72,7 @@ static inline void codec2_fftri(codec2_fftr_cfg cfg, codec2_fft_cpx* in, codec2_
 
 }
 
+// with CMSIS the configurations are shared between all users of the same size and direction, see codec2_fft.c
 codec2_fft_cfg codec2_fft_alloc(int nfft, int inverse_fft, void* mem, size_t* lenmem);
 codec2_fftr_cfg codec2_fftr_alloc(int nfft, int inverse_fft, void* mem, size_t* lenmem);
 void codec2_fft_free(codec2_fft_cfg cfg);
@@ -43,7 +43,6 @@
 #include "fdmdv_internal.h"
 #include "pilots_coh.h"
 #include "comp_prim.h"
-#include "kiss_fft.h"
 #include "linreg.h"
 #include "rn_coh.h"
 #include "test_bits_coh.h"
@@ -40,7 +40,6 @@
 #define COHPSK_NT         5                           /* number of symbols we estimate timing over */
 
 #include "fdmdv_internal.h"
-#include "kiss_fft.h"
 
 struct COHPSK {
     COMP         ch_fdm_frame_buf[NSW*NSYMROWPILOT*COHPSK_M];  /* buffer of several frames of symbols from channel      */
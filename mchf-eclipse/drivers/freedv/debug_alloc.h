@@ -51,6 +51,18 @@ register char * sp asm ("sp");
 
 
 #else //DEBUG_ALLOC
+
+#include "codec2_arena.h"
+
+#ifdef USE_CODEC2_ARENA
+// Allocations come from the mode scoped arena
+  #define MALLOC(size) codec2_arena_malloc(size)
+
+  #define CALLOC(nmemb, size) codec2_arena_calloc(nmemb, size)
+
+  #define FREE(ptr) codec2_arena_free(ptr)
+
+#else //USE_CODEC2_ARENA
 // Default to normal calls
   #define MALLOC(size) malloc(size)
 
@@ -58,6 +70,8 @@ register char * sp asm ("sp");
 
   #define FREE(ptr) free(ptr)
 
+#endif //USE_CODEC2_ARENA
+
 #endif //DEBUG_ALLOC
 
 #endif //DEBUG_ALLOC_H
@@ -527,6 +527,7 @@ void freedv_close(struct freedv *freedv) {
             FREE(freedv->mod_out);
         FREE(freedv->codeword_symbols);
         FREE(freedv->codeword_amps);
+        ldpc_free_mem(freedv->ldpc);
         FREE(freedv->ldpc);
         ofdm_destroy(freedv->ofdm);
     }
@@ -2138,6 +2139,90 @@ int freedv_codecrx(struct freedv *f, unsigned char *packed_codec_bits, short dem
     return ret;
 }
 
+/*---------------------------------------------------------------------------*\
+
+  FUNCTIONS...: freedv_comprx_codec, freedv_rx_codec
+
+  Demodulator half of freedv_comprx() / freedv_rx(). Runs the modem, FEC
+  and txt channel exactly like these but leaves the Codec 2 synthesis to
+  the caller (codec2_decode() on freedv_get_codec2()), so that demodulation
+  and speech synthesis can be scheduled independently.
+
+  Returns the number of speech samples the modem frame stands for. If
+  *valid is 1, packed_codec_bits[] holds nout/codec2_samples_per_frame()
+  packed codec frames, otherwise the nout samples are squelched.
+
+\*---------------------------------------------------------------------------*/
+
+int freedv_comprx_codec(struct freedv *f, unsigned char packed_codec_bits[], COMP demod_in[], int *valid) {
+    assert(f != NULL);
+    int nout = 0;
+
+    assert(f->nin <= f->n_max_modem_samples);
+
+    *valid = 0;
+
+    if (FDV_MODE_ACTIVE( FREEDV_MODE_1600, f->mode)) {
+        nout = freedv_comprx_fdmdv_1600(f, demod_in, valid);
+    }
+    if ((FDV_MODE_ACTIVE( FREEDV_MODE_700, f->mode)) || (FDV_MODE_ACTIVE( FREEDV_MODE_700B, f->mode)) || (FDV_MODE_ACTIVE( FREEDV_MODE_700C, f->mode))) {
+        nout = freedv_comprx_700(f, demod_in, valid);
+    }
+    if( (FDV_MODE_ACTIVE( FREEDV_MODE_2400A, f->mode)) || (FDV_MODE_ACTIVE( FREEDV_MODE_2400B, f->mode)) || (FDV_MODE_ACTIVE( FREEDV_MODE_800XA, f->mode))){
+        nout = freedv_comprx_fsk(f, demod_in, valid);
+    }
+
+    if (*valid == 1) {
+        int bits_per_codec_frame  = codec2_bits_per_frame(f->codec2);
+        int bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
+        int frames = f->n_codec_bits / bits_per_codec_frame;
+
+        memcpy(packed_codec_bits, f->packed_codec_bits, bytes_per_codec_frame * frames);
+    }
+
+    return nout;
+}
+
+int freedv_rx_codec(struct freedv *f, unsigned char packed_codec_bits[], short demod_in[], int *valid) {
+    assert(f != NULL);
+    int i;
+    int nin = freedv_nin(f);
+    int nout = 0;
+
+    assert(nin <= f->n_max_modem_samples);
+
+    *valid = 0;
+
+    if (FDV_MODE_ACTIVE( FREEDV_MODE_700D, f->mode)) {
+        int bits_per_codec_frame  = codec2_bits_per_frame(f->codec2);
+        int bytes_per_codec_frame = (bits_per_codec_frame + 7) / 8;
+
+        /* same gain as freedv_rx() */
+        nout = freedv_comprx_700d(f, demod_in, 2.0, valid);
+
+        if (*valid == 1) {
+            int frames = f->ldpc->data_bits_per_frame/bits_per_codec_frame;
+
+            nout = 0;
+            if (f->modem_frame_count_rx < f->interleave_frames) {
+                nout = f->n_speech_samples;
+                memcpy(packed_codec_bits, f->packed_codec_bits + frames*f->modem_frame_count_rx*bytes_per_codec_frame, frames*bytes_per_codec_frame);
+                f->modem_frame_count_rx++;
+            }
+        }
+    }
+    else {
+        COMP rx_fdm[f->n_max_modem_samples];
+        for(i=0; i<nin; i++) {
+            rx_fdm[i].real = (float)demod_in[i];
+            rx_fdm[i].imag = 0.0;
+        }
+        nout = freedv_comprx_codec(f, packed_codec_bits, rx_fdm, valid);
+    }
+
+    return nout;
+}
+
 /*---------------------------------------------------------------------------*\
 
   FUNCTION....: freedv_get_version
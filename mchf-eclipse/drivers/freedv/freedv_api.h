@@ -154,6 +154,8 @@ int freedv_shortrx  (struct freedv *freedv, short speech_out[], short demod_in[]
 int freedv_floatrx  (struct freedv *freedv, short speech_out[], float demod_in[]);
 int freedv_comprx   (struct freedv *freedv, short speech_out[], COMP  demod_in[]);
 int freedv_codecrx  (struct freedv *freedv, unsigned char *packed_codec_bits, short demod_in[]);
+int freedv_comprx_codec(struct freedv *freedv, unsigned char packed_codec_bits[], COMP demod_in[], int *valid);
+int freedv_rx_codec (struct freedv *freedv, unsigned char packed_codec_bits[], short demod_in[], int *valid);
 
 // Set parameters ------------------------------------------------------------
 
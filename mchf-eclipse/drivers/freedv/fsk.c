@@ -75,7 +75,7 @@
 
 #include "fsk.h"
 #include "comp_prim.h"
-#include "kiss_fftr.h"
+#include "codec2_fft.h"
 #include "modem_probe.h"
 
 /*---------------------------------------------------------------------------*\
@@ -198,7 +198,7 @@ struct FSK * fsk_create_hbr(int Fs, int Rs,int P,int M, int tx_f1, int tx_fs)
         fsk->samp_old[i].imag = 0;
     }
 
-    fsk->fft_cfg = kiss_fft_alloc(fsk->Ndft,0,NULL,NULL);
+    fsk->fft_cfg = codec2_fft_alloc(fsk->Ndft,0,NULL,NULL);
     if(fsk->fft_cfg == NULL){
         free(fsk->samp_old);
         free(fsk);
@@ -208,7 +208,7 @@ struct FSK * fsk_create_hbr(int Fs, int Rs,int P,int M, int tx_f1, int tx_fs)
     fsk->fft_est = (float*)malloc(sizeof(float)*fsk->Ndft/2);
     if(fsk->fft_est == NULL){
         free(fsk->samp_old);
-        free(fsk->fft_cfg);
+        codec2_fft_free(fsk->fft_cfg);
         free(fsk);
         return NULL;
     }
@@ -219,7 +219,7 @@ struct FSK * fsk_create_hbr(int Fs, int Rs,int P,int M, int tx_f1, int tx_fs)
             if(fsk->hann_table == NULL){
                 free(fsk->fft_est);
                 free(fsk->samp_old);
-                free(fsk->fft_cfg);
+                codec2_fft_free(fsk->fft_cfg);
                 free(fsk);
                 return NULL;
             }
@@ -248,7 +248,7 @@ struct FSK * fsk_create_hbr(int Fs, int Rs,int P,int M, int tx_f1, int tx_fs)
     if(fsk->stats == NULL){
         free(fsk->fft_est);
         free(fsk->samp_old);
-        free(fsk->fft_cfg);
+        codec2_fft_free(fsk->fft_cfg);
         free(fsk);
         return NULL;
     }
@@ -336,7 +336,7 @@ struct FSK * fsk_create(int Fs, int Rs,int M, int tx_f1, int tx_fs)
         fsk->samp_old[i].imag = 0.0;
     }
     
-    fsk->fft_cfg = kiss_fft_alloc(Ndft,0,NULL,NULL);
+    fsk->fft_cfg = codec2_fft_alloc(Ndft,0,NULL,NULL);
     if(fsk->fft_cfg == NULL){
         free(fsk->samp_old);
         free(fsk);
@@ -346,7 +346,7 @@ struct FSK * fsk_create(int Fs, int Rs,int M, int tx_f1, int tx_fs)
     fsk->fft_est = (float*)malloc(sizeof(float)*fsk->Ndft/2);
     if(fsk->fft_est == NULL){
         free(fsk->samp_old);
-        free(fsk->fft_cfg);
+        codec2_fft_free(fsk->fft_cfg);
         free(fsk);
         return NULL;
     }
@@ -357,7 +357,7 @@ struct FSK * fsk_create(int Fs, int Rs,int M, int tx_f1, int tx_fs)
             if(fsk->hann_table == NULL){
                 free(fsk->fft_est);
                 free(fsk->samp_old);
-                free(fsk->fft_cfg);
+                codec2_fft_free(fsk->fft_cfg);
                 free(fsk);
                 return NULL;
             }
@@ -387,7 +387,7 @@ struct FSK * fsk_create(int Fs, int Rs,int M, int tx_f1, int tx_fs)
     if(fsk->stats == NULL){
         free(fsk->fft_est);
         free(fsk->samp_old);
-        free(fsk->fft_cfg);
+        codec2_fft_free(fsk->fft_cfg);
         free(fsk);
         return NULL;
     }
@@ -454,10 +454,10 @@ void fsk_set_nsym(struct FSK *fsk,int nsyms){
     
     fsk->Ndft = Ndft;
     
-    free(fsk->fft_cfg);
+    codec2_fft_free(fsk->fft_cfg);
     free(fsk->fft_est);
     
-    fsk->fft_cfg = kiss_fft_alloc(Ndft,0,NULL,NULL);
+    fsk->fft_cfg = codec2_fft_alloc(Ndft,0,NULL,NULL);
     fsk->fft_est = (float*)malloc(sizeof(float)*fsk->Ndft/2);
     
     for(i=0;i<Ndft/2;i++)fsk->fft_est[i] = 0;
@@ -487,7 +487,7 @@ uint32_t fsk_nin(struct FSK *fsk){
 }
 
 void fsk_destroy(struct FSK *fsk){
-    free(fsk->fft_cfg);
+    codec2_fft_free(fsk->fft_cfg);
     free(fsk->samp_old);
     free(fsk->stats);
     free(fsk);
@@ -546,18 +546,17 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[],float *freqs,int M){
     float max;
     float tc;
     int imax;
-    kiss_fft_cfg fft_cfg = fsk->fft_cfg;
+    codec2_fft_cfg fft_cfg = fsk->fft_cfg;
     int freqi[M];
     int f_min,f_max,f_zero;
     
-    /* Array to do complex FFT from using kiss_fft */
+    /* Array to do complex FFT in place */
     #ifdef DEMOD_ALLOC_STACK
-    kiss_fft_cpx *fftin  = (kiss_fft_cpx*)alloca(sizeof(kiss_fft_cpx)*Ndft);
-    kiss_fft_cpx *fftout = (kiss_fft_cpx*)alloca(sizeof(kiss_fft_cpx)*Ndft);
+    codec2_fft_cpx *fftin  = (codec2_fft_cpx*)alloca(sizeof(codec2_fft_cpx)*Ndft);
     #else
-    kiss_fft_cpx *fftin  = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*Ndft);
-    kiss_fft_cpx *fftout = (kiss_fft_cpx*)malloc(sizeof(kiss_fft_cpx)*Ndft);
+    codec2_fft_cpx *fftin  = (codec2_fft_cpx*)malloc(sizeof(codec2_fft_cpx)*Ndft);
     #endif
+    codec2_fft_cpx *fftout = fftin;
     
     #ifndef USE_HANN_TABLE
     COMP dphi = comp_exp_j((2*M_PI)/((float)Ndft-1));
@@ -592,39 +591,39 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[],float *freqs,int M){
             rphi = cmult(dphi,rphi);
             hann = .5-rphi.real;
             #endif
-            fftin[i].r = hann*fsk_in[i+Ndft*j].real;
-            fftin[i].i = hann*fsk_in[i+Ndft*j].imag;
+            fftin[i].real = hann*fsk_in[i+Ndft*j].real;
+            fftin[i].imag = hann*fsk_in[i+Ndft*j].imag;
         }
 
         /* Zero out the remaining slots on spare samples */
         for(; i<Ndft;i++){
-            fftin[i].r = 0;
-            fftin[i].i = 0;
+            fftin[i].real = 0;
+            fftin[i].imag = 0;
         }
         
         /* Do the FFT */
-        kiss_fft(fft_cfg,fftin,fftout);
+        codec2_fft_inplace(fft_cfg,fftin);
         
         /* Find the magnitude^2 of each freq slot and stash away in the real
         * value, so this only has to be done once. Since we're only comparing
         * these values and only need the mag of 2 points, we don't need to do
         * a sqrt to each value */
         for(i=0; i<Ndft/2; i++){
-            fftout[i].r = (fftout[i].r*fftout[i].r) + (fftout[i].i*fftout[i].i) ;
+            fftout[i].real = (fftout[i].real*fftout[i].real) + (fftout[i].imag*fftout[i].imag) ;
         }
         
         /* Zero out the minimum and maximum ends */
         for(i=0; i<f_min; i++){
-            fftout[i].r = 0;
+            fftout[i].real = 0;
         }
         for(i=f_max-1; i<Ndft/2; i++){
-            fftout[i].r = 0;
+            fftout[i].real = 0;
         }
         /* Mix back in with the previous fft block */
         /* Copy new fft est into imag of fftout for frequency divination below */
         for(i=0; i<Ndft/2; i++){
-            fsk->fft_est[i] = (fsk->fft_est[i]*(1-tc)) + (sqrtf(fftout[i].r)*tc);
-            fftout[i].i = fsk->fft_est[i];
+            fsk->fft_est[i] = (fsk->fft_est[i]*(1-tc)) + (sqrtf(fftout[i].real)*tc);
+            fftout[i].imag = fsk->fft_est[i];
         }
     }
     
@@ -636,8 +635,8 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[],float *freqs,int M){
         imax = 0;
         max = 0;
         for(j=0;j<Ndft/2;j++){
-            if(fftout[j].i > max){
-                max = fftout[j].i;
+            if(fftout[j].imag > max){
+                max = fftout[j].imag;
                 imax = j;
             }
         }
@@ -647,7 +646,7 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[],float *freqs,int M){
         f_max = imax + f_zero;
         f_max = f_max > Ndft ? Ndft : f_max;
         for(j=f_min; j<f_max; j++)
-            fftout[j].i = 0;
+            fftout[j].imag = 0;
         
         /* Stick the freq index on the list */
         freqi[i] = imax;
@@ -672,7 +671,6 @@ void fsk_demod_freq_est(struct FSK *fsk, COMP fsk_in[],float *freqs,int M){
     }
     #ifndef DEMOD_ALLOC_STACK
     free(fftin);
-    free(fftout);
     #endif
 }
 
@@ -30,7 +30,7 @@
 #define __C2FSK_H
 #include <stdint.h>
 #include "comp.h"
-#include "kiss_fftr.h"
+#include "codec2_fft.h"
 #include "modem_stats.h"
 
 #define MODE_2FSK 2
@@ -62,7 +62,7 @@ struct FSK {
     /*  Parameters used by demod */
     COMP phi_c[MODE_M_MAX];
     
-    kiss_fft_cfg fft_cfg;   /* Config for KISS FFT, used in freq est */
+    codec2_fft_cfg fft_cfg; /* Config for FFT, used in freq est */
     float norm_rx_timing;   /* Normalized RX timing */
     
     COMP* samp_old;         /* Tail end of last batch of samples */
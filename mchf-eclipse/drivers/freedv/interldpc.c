@@ -99,6 +99,7 @@ void set_up_hra_112_112(struct LDPC *ldpc, struct OFDM_CONFIG *config) {
     ldpc->max_col_weight = HRA_112_112_MAX_COL_WEIGHT;
     ldpc->H_rows = (uint16_t *) HRA_112_112_H_rows;
     ldpc->H_cols = (uint16_t *) HRA_112_112_H_cols;
+    ldpc->ms_graph = NULL;
 
     /* provided for convenience and to match Octave variable names */
 
@@ -119,6 +120,7 @@ void set_up_hra_504_396(struct LDPC *ldpc, struct OFDM_CONFIG *config) {
     ldpc->max_col_weight = HRAb_396_504_MAX_COL_WEIGHT;
     ldpc->H_rows = (uint16_t *) HRAb_396_504_H_rows;
     ldpc->H_cols = (uint16_t *) HRAb_396_504_H_cols;
+    ldpc->ms_graph = NULL;
 
     set_up_ldpc_constants(ldpc, HRAb_396_504_CODELENGTH, HRAb_396_504_NUMBERPARITYBITS, config->bps);
 }
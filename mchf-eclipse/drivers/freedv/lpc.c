@@ -35,6 +35,7 @@
 #include <math.h>
 #include "defines.h"
 #include "lpc.h"
+#include "fdv_arm_math.h"
 
 /*---------------------------------------------------------------------------*\
 
@@ -126,13 +127,20 @@ void autocorrelate(
   int order	/* order of LPC analysis */
 )
 {
-  int i,j;	/* loop variables */
+  int j;	/* loop variable */
 
+#ifndef FDV_ARM_MATH
+  int i;
   for(j=0; j<order+1; j++) {
     Rn[j] = 0.0;
     for(i=0; i<Nsam-j; i++)
       Rn[j] += Sn[i]*Sn[i+j];
   }
+#else
+  for(j=0; j<order+1; j++) {
+    arm_dot_prod_f32(Sn, &Sn[j], Nsam-j, &Rn[j]);
+  }
+#endif
 }
 
 /*---------------------------------------------------------------------------*\
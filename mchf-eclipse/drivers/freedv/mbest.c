@@ -34,17 +34,18 @@
 #include <string.h>
 
 #include "mbest.h"
+#include "debug_alloc.h"
 
 struct MBEST *mbest_create(int entries) {
     int           i,j;
     struct MBEST *mbest;
 
     assert(entries > 0);
-    mbest = (struct MBEST *)malloc(sizeof(struct MBEST));
+    mbest = (struct MBEST *)MALLOC(sizeof(struct MBEST));
     assert(mbest != NULL);
 
     mbest->entries = entries;
-    mbest->list = (struct MBEST_LIST *)malloc(entries*sizeof(struct MBEST_LIST));
+    mbest->list = (struct MBEST_LIST *)MALLOC(entries*sizeof(struct MBEST_LIST));
     assert(mbest->list != NULL);
 
     for(i=0; i<mbest->entries; i++) {
@@ -59,8 +60,8 @@ struct MBEST *mbest_create(int entries) {
 
 void mbest_destroy(struct MBEST *mbest) {
     assert(mbest != NULL);
-    free(mbest->list);
-    free(mbest);
+    FREE(mbest->list);
+    FREE(mbest);
 }
 
 
@@ -42,14 +42,14 @@ void modem_stats_open(struct MODEM_STATS *f)
     
     for(i=0; i<2*MODEM_STATS_NSPEC; i++)
 	f->fft_buf[i] = 0.0;
-    f->fft_cfg = kiss_fft_alloc (2*MODEM_STATS_NSPEC, 0, NULL, NULL);
+    f->fft_cfg = codec2_fftr_alloc (2*MODEM_STATS_NSPEC, 0, NULL, NULL);
     assert(f->fft_cfg != NULL);
 
 }
 
 void modem_stats_close(struct MODEM_STATS *f)
 {
-    KISS_FFT_FREE(f->fft_cfg);
+    codec2_fftr_free(f->fft_cfg);
 }
 
 /*---------------------------------------------------------------------------*\
@@ -84,8 +84,8 @@ void modem_stats_close(struct MODEM_STATS *f)
 void modem_stats_get_rx_spectrum(struct MODEM_STATS *f, float mag_spec_dB[], COMP rx_fdm[], int nin)
 {
     int   i,j;
-    COMP  fft_in[2*MODEM_STATS_NSPEC];
-    COMP  fft_out[2*MODEM_STATS_NSPEC];
+    codec2_fft_scalar fft_in[2*MODEM_STATS_NSPEC];
+    codec2_fft_cpx    fft_out[MODEM_STATS_NSPEC+1];
     float full_scale_dB;
 
     /* update buffer of input samples */
@@ -96,14 +96,13 @@ void modem_stats_get_rx_spectrum(struct MODEM_STATS *f, float mag_spec_dB[], COM
 	f->fft_buf[i] = rx_fdm[j].real;
     assert(i == 2*MODEM_STATS_NSPEC);
 
-    /* window and FFT */
+    /* window and FFT, the input is real so a real FFT of half the work is sufficient */
 
     for(i=0; i<2*MODEM_STATS_NSPEC; i++) {
-	fft_in[i].real = f->fft_buf[i] * (0.5 - 0.5*cosf((float)i*2.0*M_PI/(2*MODEM_STATS_NSPEC)));
-	fft_in[i].imag = 0.0;
+	fft_in[i] = f->fft_buf[i] * (0.5f - 0.5f*cosf((float)i*2.0f*M_PI/(2*MODEM_STATS_NSPEC)));
     }
 
-    kiss_fft(f->fft_cfg, (kiss_fft_cpx *)fft_in, (kiss_fft_cpx *)fft_out);
+    codec2_fftr(f->fft_cfg, fft_in, fft_out);
 
     /* FFT scales up a signal of level 1 FDMDV_NSPEC */
 
@@ -33,7 +33,7 @@
 #define __MODEM_STATS__
 
 #include "comp.h"
-#include "kiss_fft.h"
+#include "codec2_fft.h"
 
 #define MODEM_STATS_NC_MAX      20
 #define MODEM_STATS_NR_MAX      8
@@ -67,8 +67,8 @@ struct MODEM_STATS {
     
     /* Buf for FFT/waterfall */
 
-    float        fft_buf[2*MODEM_STATS_NSPEC];
-    kiss_fft_cfg fft_cfg;
+    float           fft_buf[2*MODEM_STATS_NSPEC];
+    codec2_fftr_cfg fft_cfg;
 };
 
 void modem_stats_open(struct MODEM_STATS *f);
@@ -489,9 +489,279 @@ return(result);
 }
 
 
+#ifdef LDPC_MIN_SUM
+
+/*
+ * Fixed point normalised min-sum decoder.
+ *
+ * Messages are int16_t LLRs with LDPC_MS_FRAC_BITS fractional bits.
+ * The check node update only needs the smallest and second smallest
+ * magnitude and the sign parity, no phi() lookups and no floats.
+ * Decoding ends as soon as the hard decisions satisfy all parity
+ * checks, after LDPC_MS_MAX_ITER iterations, or if the number of
+ * failed checks did not improve for LDPC_MS_STALL_ITER iterations
+ * (which happens mostly if there is no or a too weak signal).
+ */
+
+#define LDPC_MS_FRAC_BITS   4       // 1.0 == 16
+#define LDPC_MS_MAX_MSG     2047    // messages saturate at +-128.0
+#define LDPC_MS_MAX_ITER    30
+#define LDPC_MS_STALL_ITER  8
+
+static inline int16_t ldpc_ms_sat(int32_t val) {
+    if (val > LDPC_MS_MAX_MSG) {
+        val = LDPC_MS_MAX_MSG;
+    } else if (val < -LDPC_MS_MAX_MSG) {
+        val = -LDPC_MS_MAX_MSG;
+    }
+    return val;
+}
+
+/* derive the compact graph from the c_node/v_node structures used by SumProduct() */
+
+static struct LDPC_MS_GRAPH *ldpc_ms_graph_create(struct LDPC *ldpc) {
+    int CodeLength = ldpc->CodeLength;
+    int NumberParityBits = ldpc->NumberParityBits;
+    int NumberRowsHcols = ldpc->NumberRowsHcols;
+    int shift, H1, i, j, e;
+
+    shift = (NumberParityBits + NumberRowsHcols) - CodeLength;
+    if (NumberRowsHcols == CodeLength) {
+        H1=0;
+        shift=0;
+    } else {
+        H1=1;
+    }
+
+    /* the HRA structure adds up to 2 edges per check node, allocate the
+       graph first so that the temporary nodes below are freed last in first out */
+    int max_edges = NumberParityBits * (ldpc->max_row_weight + 2);
+
+    struct LDPC_MS_GRAPH *g = MALLOC(sizeof(struct LDPC_MS_GRAPH));
+    assert(g);
+    g->c_first = MALLOC(sizeof(uint16_t) * (NumberParityBits + 1));
+    g->c_var = MALLOC(sizeof(uint16_t) * max_edges);
+    g->v_first = MALLOC(sizeof(uint16_t) * (CodeLength + 1));
+    g->v_edge = MALLOC(sizeof(uint16_t) * max_edges);
+    g->c2v = MALLOC(sizeof(int16_t) * max_edges);
+    g->v2c = MALLOC(sizeof(int16_t) * max_edges);
+    assert(g->c_first && g->c_var && g->v_first && g->v_edge && g->c2v && g->v2c);
+
+    float *input = CALLOC(CodeLength, sizeof(float));
+    struct c_node *c_nodes = CALLOC(NumberParityBits, sizeof(struct c_node));
+    struct v_node *v_nodes = CALLOC(CodeLength, sizeof(struct v_node));
+    assert(input && c_nodes && v_nodes);
+
+    init_c_v_nodes(c_nodes, shift, NumberParityBits, ldpc->max_row_weight, ldpc->H_rows, H1, CodeLength,
+                   v_nodes, NumberRowsHcols, ldpc->H_cols, ldpc->max_col_weight, ldpc->dec_type, input);
+
+    for (e = 0, j = 0; j < NumberParityBits; j++) {
+        g->c_first[j] = e;
+        for (i = 0; i < c_nodes[j].degree; i++, e++) {
+            assert(e < max_edges);
+            g->c_var[e] = c_nodes[j].subs[i].index;
+        }
+    }
+    g->c_first[NumberParityBits] = e;
+
+    for (e = 0, i = 0; i < CodeLength; i++) {
+        g->v_first[i] = e;
+        for (j = 0; j < v_nodes[i].degree; j++, e++) {
+            struct v_sub_node *vp = &v_nodes[i].subs[j];
+            g->v_edge[e] = g->c_first[vp->index] + vp->socket;
+        }
+    }
+    g->v_first[CodeLength] = e;
+
+    for (i = CodeLength - 1; i >= 0; i--) FREE(v_nodes[i].subs);
+    FREE(v_nodes);
+    for (i = NumberParityBits - 1; i >= 0; i--) FREE(c_nodes[i].subs);
+    FREE(c_nodes);
+    FREE(input);
+
+    return g;
+}
+
+/* Builds the graph of a code without HRA part (NumberRowsHcols == CodeLength) straight from
+   H_rows/H_cols into the arrays g points to, which the caller provides (sized with
+   LDPC_MS_GRAPH_EDGES()), and attaches it to ldpc. Nothing is allocated, neither here nor
+   later in run_ldpc_decoder(), so the graph may live outside the codec2 arena. Such a graph
+   must not be released with ldpc_free_mem(). */
+
+void ldpc_ms_graph_init(struct LDPC *ldpc, struct LDPC_MS_GRAPH *g) {
+    int CodeLength = ldpc->CodeLength;
+    int NumberParityBits = ldpc->NumberParityBits;
+    int i, j, k, e, ce;
+
+    assert(ldpc->NumberRowsHcols == CodeLength);
+
+    for (e = 0, j = 0; j < NumberParityBits; j++) {
+        g->c_first[j] = e;
+        for (k = 0; k < ldpc->max_row_weight; k++) {
+            /* rows with less than max_row_weight entries are padded with 0 */
+            if (ldpc->H_rows[j + k*NumberParityBits] > 0) {
+                g->c_var[e++] = ldpc->H_rows[j + k*NumberParityBits] - 1;
+            }
+        }
+    }
+    g->c_first[NumberParityBits] = e;
+
+    for (e = 0, i = 0; i < CodeLength; i++) {
+        g->v_first[i] = e;
+        for (k = 0; k < ldpc->max_col_weight; k++) {
+            if (ldpc->H_cols[i + k*CodeLength] > 0) {
+                j = ldpc->H_cols[i + k*CodeLength] - 1;
+                /* find the edge of this variable node in check node j */
+                for (ce = g->c_first[j]; g->c_var[ce] != i; ce++) {
+                    assert(ce + 1 < g->c_first[j + 1]);
+                }
+                g->v_edge[e++] = ce;
+            }
+        }
+    }
+    g->v_first[CodeLength] = e;
+
+    ldpc->ms_graph = g;
+}
+
+// Returns the iteration count
+static int MinSum(struct LDPC_MS_GRAPH *g,
+                  int *parityCheckCount,
+                  char DecodedBits[],
+                  float input[],
+                  int CodeLength,
+                  int NumberParityBits,
+                  int max_iter)
+{
+    int16_t llr[CodeLength];
+    int i, j, e, iter;
+    int unsat = NumberParityBits;
+    int best_unsat = NumberParityBits + 1;
+    int stall = 0;
+    int result = max_iter;
+
+    for (i = 0; i < CodeLength; i++) {
+        llr[i] = ldpc_ms_sat(lrintf(input[i] * (1 << LDPC_MS_FRAC_BITS)));
+        for (e = g->v_first[i]; e < g->v_first[i + 1]; e++) {
+            g->v2c[g->v_edge[e]] = llr[i];
+        }
+    }
+
+    for (iter = 0; iter < max_iter; iter++) {
+
+        /* update check nodes: smallest and second smallest magnitude, parity of the signs */
+        for (j = 0; j < NumberParityBits; j++) {
+            int16_t min1 = LDPC_MS_MAX_MSG, min2 = LDPC_MS_MAX_MSG;
+            int min_edge = 0;
+            int sign = 0;
+
+            for (e = g->c_first[j]; e < g->c_first[j + 1]; e++) {
+                int16_t msg = g->v2c[e];
+                int16_t mag = msg < 0 ? -msg : msg;
+
+                sign ^= msg < 0;
+                if (mag < min1) {
+                    min2 = min1;
+                    min1 = mag;
+                    min_edge = e;
+                } else if (mag < min2) {
+                    min2 = mag;
+                }
+            }
+
+            /* scaling by 3/4 compensates that min-sum overestimates the check messages */
+            min1 = (min1 * 3) >> 2;
+            min2 = (min2 * 3) >> 2;
+
+            for (e = g->c_first[j]; e < g->c_first[j + 1]; e++) {
+                int16_t mag = (e == min_edge) ? min2 : min1;
+                g->c2v[e] = (sign ^ (g->v2c[e] < 0)) ? -mag : mag;
+            }
+        }
+
+        /* update variable nodes and make hard decision */
+        for (i = 0; i < CodeLength; i++) {
+            int32_t Qi = llr[i];
+
+            for (e = g->v_first[i]; e < g->v_first[i + 1]; e++) {
+                Qi += g->c2v[g->v_edge[e]];
+            }
+
+            DecodedBits[i] = Qi < 0;
+
+            for (e = g->v_first[i]; e < g->v_first[i + 1]; e++) {
+                int ve = g->v_edge[e];
+                g->v2c[ve] = ldpc_ms_sat(Qi - g->c2v[ve]);
+            }
+        }
+
+        /* count failed parity checks of the hard decisions */
+        unsat = 0;
+        for (j = 0; j < NumberParityBits; j++) {
+            int parity = 0;
+            for (e = g->c_first[j]; e < g->c_first[j + 1]; e++) {
+                parity ^= DecodedBits[g->c_var[e]];
+            }
+            unsat += parity;
+        }
+
+        if (unsat == 0) {
+            result = iter + 1;
+            break;
+        }
+
+        if (unsat < best_unsat) {
+            best_unsat = unsat;
+            stall = 0;
+        } else if (++stall >= LDPC_MS_STALL_ITER) {
+            result = iter + 1;
+            break;
+        }
+    }
+
+    *parityCheckCount = NumberParityBits - unsat;
+
+    return result;
+}
+
+#endif
+
+void ldpc_free_mem(struct LDPC *ldpc) {
+#ifdef LDPC_MIN_SUM
+    struct LDPC_MS_GRAPH *g = ldpc->ms_graph;
+
+    if (g != NULL) {
+        FREE(g->v2c);
+        FREE(g->c2v);
+        FREE(g->v_edge);
+        FREE(g->v_first);
+        FREE(g->c_var);
+        FREE(g->c_first);
+        FREE(g);
+        ldpc->ms_graph = NULL;
+    }
+#endif
+}
+
 /* Convenience function to call LDPC decoder from C programs */
 
 int run_ldpc_decoder(struct LDPC *ldpc, uint8_t out_char[], float input[], int *parityCheckCount) {
+#ifdef LDPC_MIN_SUM
+    int  max_iter = ldpc->max_iter < LDPC_MS_MAX_ITER ? ldpc->max_iter : LDPC_MS_MAX_ITER;
+    char DecodedBits[ldpc->CodeLength];
+    int  i;
+
+    if (ldpc->ms_graph == NULL) {
+        ldpc->ms_graph = ldpc_ms_graph_create(ldpc);
+    }
+
+    int iter = MinSum(ldpc->ms_graph, parityCheckCount, DecodedBits, input,
+                      ldpc->CodeLength, ldpc->NumberParityBits, max_iter);
+
+    for (i=0; i<ldpc->CodeLength; i++) out_char[i] = DecodedBits[i];
+
+    return iter;
+#else
     int         max_iter, dec_type;
     float       q_scale_factor, r_scale_factor;
     int         max_row_weight, max_col_weight;
@@ -563,6 +833,7 @@ int run_ldpc_decoder(struct LDPC *ldpc, uint8_t out_char[], float input[], int *
     FREE( v_nodes );
 
     return iter;
+#endif
 }
 
 
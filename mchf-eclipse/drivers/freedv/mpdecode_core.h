@@ -15,6 +15,30 @@
 
 #include "comp.h"
 
+/* on the MCU the float sum-product decoder is replaced by a fixed point
+   normalised min-sum decoder with a bounded iteration count, which is
+   several times faster at a small loss of coding gain */
+#ifdef FDV_ARM_MATH
+#define LDPC_MIN_SUM
+#endif
+
+#ifdef LDPC_MIN_SUM
+/* Tanner graph of the min-sum decoder */
+struct LDPC_MS_GRAPH {
+    uint16_t *c_first;  // [NumberParityBits+1] first edge of each check node
+    uint16_t *c_var;    // [edges] variable node of each edge, edges are ordered by check node
+    uint16_t *v_first;  // [CodeLength+1] first entry of each variable node in v_edge
+    uint16_t *v_edge;   // [edges] edges of each variable node
+    int16_t  *c2v;      // [edges] check to variable node messages
+    int16_t  *v2c;      // [edges] variable to check node messages
+};
+
+/* upper bound of the edges of a code without HRA part, for sizing the arrays of a static graph */
+#define LDPC_MS_GRAPH_EDGES(NumberParityBits, max_row_weight) ((NumberParityBits) * (max_row_weight))
+#else
+struct LDPC_MS_GRAPH;
+#endif
+
 struct LDPC {
     int max_iter;
     int dec_type;
@@ -37,6 +61,9 @@ struct LDPC {
 
     uint16_t *H_rows;
     uint16_t *H_cols;
+
+    /* Tanner graph used by the min-sum decoder, built on first use */
+    struct LDPC_MS_GRAPH *ms_graph;
 };
 
 void encode(struct LDPC *ldpc, unsigned char ibits[], unsigned char pbits[]);
@@ -48,7 +75,12 @@ void Demod2D(float symbol_likelihood[], COMP r[], COMP S_matrix[], float EsNo, f
 void Somap(float bit_likelihood[], float symbol_likelihood[], int number_symbols);
 void symbols_to_llrs(float llr[], COMP rx_qpsk_symbols[], float rx_amps[], float EsNo, float mean_amp, int nsyms);
 
+#ifdef LDPC_MIN_SUM
+void ldpc_ms_graph_init(struct LDPC *ldpc, struct LDPC_MS_GRAPH *g);
+#endif
+
 void ldpc_print_info(struct LDPC *ldpc);
+void ldpc_free_mem(struct LDPC *ldpc);
 
 
 #endif
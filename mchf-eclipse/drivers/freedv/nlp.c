@@ -29,6 +29,7 @@
 #include "nlp.h"
 #include "dump.h"
 #include "codec2_fft.h"
+#include "debug_alloc.h"
 #undef PROFILE
 #include "machdep.h"
 #include "os.h"
@@ -53,6 +54,7 @@
 #define F0_MAX      500
 #define CNLP        0.3	        /* post processor constant              */
 #define NLP_NTAP 48	        /* Decimation LPF order */
+#define NLP_FIR_BLOCK_MAX 80    /* max. new samples per call at 8 kHz   */
 #undef  POST_PROCESS_MBE        /* choose post processor                */
 
 /* 8 to 16 kHz sample rate conversion */
@@ -126,8 +128,15 @@ typedef struct {
     float         w[PMAX_M/DEC];     /* DFT window                   */
     float         sq[PMAX_M];	     /* squared speech samples       */
     float         mem_x,mem_y;       /* memory for notch filter      */
+#ifndef FDV_ARM_MATH
     float         mem_fir[NLP_NTAP]; /* decimation FIR filter memory */
     codec2_fft_cfg  fft_cfg;         /* kiss FFT config              */
+#else
+    arm_fir_decimate_instance_f32 fir; /* decimating FIR filter     */
+    float         fir_state[NLP_NTAP+NLP_FIR_BLOCK_MAX-1];
+    float         sq_dec[PMAX_M/DEC]; /* filtered, decimated sq[]    */
+    codec2_fftr_cfg fftr_cfg;        /* real FFT, input is real      */
+#endif
     float        *Sn16k;	     /* Fs=16kHz input speech vector */
     FILE         *f;
 } NLP;
@@ -156,7 +165,7 @@ void *nlp_create(C2CONST *c2const)
     int  m = c2const->m_pitch;
     int  Fs = c2const->Fs;
 
-    nlp = (NLP*)malloc(sizeof(NLP));
+    nlp = (NLP*)MALLOC(sizeof(NLP));
     if (nlp == NULL)
 	return NULL;
 
@@ -168,12 +177,12 @@ void *nlp_create(C2CONST *c2const)
     /* if running at 16kHz allocate storage for decimating filter memory */
 
     if (Fs == 16000) {
-        nlp->Sn16k = (float*)malloc(sizeof(float)*(FDMDV_OS_TAPS_16K + c2const->n_samp));
+        nlp->Sn16k = (float*)MALLOC(sizeof(float)*(FDMDV_OS_TAPS_16K + c2const->n_samp));
         for(i=0; i<FDMDV_OS_TAPS_16K; i++) {
            nlp->Sn16k[i] = 0.0;
         }
         if (nlp->Sn16k == NULL) {
-            free(nlp);
+            FREE(nlp);
             return NULL;
         }
 
@@ -192,11 +201,21 @@ void *nlp_create(C2CONST *c2const)
 	nlp->sq[i] = 0.0;
     nlp->mem_x = 0.0;
     nlp->mem_y = 0.0;
+#ifndef FDV_ARM_MATH
     for(i=0; i<NLP_NTAP; i++)
 	nlp->mem_fir[i] = 0.0;
 
     nlp->fft_cfg = codec2_fft_alloc (PE_FFT_SIZE, 0, NULL, NULL);
     assert(nlp->fft_cfg != NULL);
+#else
+    /* nlp_fir[] is symmetric, so no need to reverse it for CMSIS */
+    arm_fir_decimate_init_f32(&nlp->fir, NLP_NTAP, DEC, (float32_t*)nlp_fir, nlp->fir_state, NLP_FIR_BLOCK_MAX);
+    for(i=0; i<PMAX_M/DEC; i++)
+	nlp->sq_dec[i] = 0.0;
+
+    nlp->fftr_cfg = codec2_fftr_alloc (PE_FFT_SIZE, 0, NULL, NULL);
+    assert(nlp->fftr_cfg != NULL);
+#endif
 
     return (void*)nlp;
 }
@@ -215,11 +234,15 @@ void nlp_destroy(void *nlp_state)
     assert(nlp_state != NULL);
     nlp = (NLP*)nlp_state;
 
+#ifndef FDV_ARM_MATH
     codec2_fft_free(nlp->fft_cfg);
+#else
+    codec2_fftr_free(nlp->fftr_cfg);
+#endif
     if (nlp->Fs == 16000) {
-        free(nlp->Sn16k);
+        FREE(nlp->Sn16k);
     }
-    free(nlp_state);
+    FREE(nlp_state);
 }
 
 /*---------------------------------------------------------------------------*\
@@ -284,9 +307,13 @@ float nlp(
     if (nlp->Fs == 8000) {
         /* Square latest input samples */
 
+#ifndef FDV_ARM_MATH
         for(i=m-n; i<m; i++) {
 	  nlp->sq[i] = Sn[i]*Sn[i];
         }
+#else
+        arm_mult_f32(&Sn[m-n], &Sn[m-n], &nlp->sq[m-n], n);
+#endif
     }
     else {
         assert(nlp->Fs == 16000);
@@ -330,6 +357,7 @@ float nlp(
 
     PROFILE_SAMPLE_AND_LOG(tnotch, start, "      square and notch");
 
+#ifndef FDV_ARM_MATH
     for(i=m-n; i<m; i++) {	/* FIR filter vector */
 
 	for(j=0; j<NLP_NTAP-1; j++)
@@ -364,6 +392,33 @@ float nlp(
 
     for(i=0; i<PE_FFT_SIZE; i++)
 	Fw[i].real = Fw[i].real*Fw[i].real + Fw[i].imag*Fw[i].imag;
+#else
+    /* FIR filter vector and decimate. Only every DEC-th filtered sample
+       is used by the DFT, so the polyphase decimator computes just these.
+       CMSIS returns the filter output for the first of each DEC input
+       samples, i.e. the same positions sq[i*DEC] as the generic code. */
+
+    assert((n <= NLP_FIR_BLOCK_MAX) && (n % DEC == 0) && (m % DEC == 0));
+    arm_fir_decimate_f32(&nlp->fir, &nlp->sq[m-n], &nlp->sq_dec[(m-n)/DEC], n);
+
+    PROFILE_SAMPLE_AND_LOG(filter, tnotch, "      filter");
+
+    /* Decimate and DFT. The input is real and only bins up to
+       PE_FFT_SIZE*DEC/P_MIN are evaluated, so a real FFT giving the
+       lower half of the spectrum is sufficient. The upper half of Fw[]
+       serves as FFT input buffer. */
+
+    float *fw_in = (float*)&Fw[PE_FFT_SIZE/2];
+    memset(&fw_in[m/DEC], 0, (PE_FFT_SIZE-m/DEC)*sizeof(float));
+    arm_mult_f32(nlp->sq_dec, nlp->w, fw_in, m/DEC);
+    PROFILE_SAMPLE_AND_LOG(window, filter, "      window");
+
+    codec2_fftr(nlp->fftr_cfg, fw_in, Fw);
+    PROFILE_SAMPLE_AND_LOG(fft, window, "      fft");
+
+    for(i=0; i<PE_FFT_SIZE/2; i++)
+	Fw[i].real = Fw[i].real*Fw[i].real + Fw[i].imag*Fw[i].imag;
+#endif
 
     PROFILE_SAMPLE_AND_LOG(magsq, fft, "      mag sq");
     #ifdef DUMP
@@ -399,8 +454,12 @@ float nlp(
 
     /* Shift samples in buffer to make room for new samples */
 
+#ifndef FDV_ARM_MATH
     for(i=0; i<m-n; i++)
 	nlp->sq[i] = nlp->sq[i+n];
+#else
+    memmove(nlp->sq_dec, &nlp->sq_dec[n/DEC], (m-n)/DEC*sizeof(float));
+#endif
 
     /* return pitch period in samples and F0 estimate */
 
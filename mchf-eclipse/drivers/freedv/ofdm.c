@@ -44,6 +44,7 @@
 /* Static Prototypes */
 
 static complex float vector_sum(complex float *, int);
+static void freq_shift_down(complex float *, complex float *, int, int, float);
 static void dft(struct OFDM *, complex float *, complex float *);
 static void idft(struct OFDM *, complex float *, complex float *);
 static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits);
@@ -574,6 +575,45 @@ static complex float vector_sum(complex float *a, int num_elements) {
     return sum;
 }
 
+/*
+ * Down converts len samples of rx starting at sample index st by woff
+ * radians per sample: result[k] = rx[st + k] * cmplxconj(woff * (st + k))
+ */
+
+static void freq_shift_down(complex float *result, complex float *rx, int st, int len, float woff) {
+#ifndef FDV_ARM_MATH
+    int i, k;
+
+    for (i = st, k = 0; k < len; i++, k++) {
+        float tval = woff * i;
+        result[k] = rx[i] * cmplxconj(tval);
+    }
+#else
+    /*
+     * only one sin/cos pair per call, the phasor is advanced by a
+     * complex multiply per sample and written into result, which is
+     * then multiplied with the input by CMSIS. Over the at most a few
+     * thousand samples the recursion error stays well below the noise.
+     */
+    float *phasor = (float *) result;
+    float tval = woff * st;
+    float p_re = COSF(tval), p_im = -SINF(tval);
+    float d_re = COSF(woff), d_im = -SINF(woff);
+    int k;
+
+    for (k = 0; k < len; k++) {
+        float tmp = p_re * d_re - p_im * d_im;
+
+        phasor[2 * k] = p_re;
+        phasor[2 * k + 1] = p_im;
+        p_im = p_re * d_im + p_im * d_re;
+        p_re = tmp;
+    }
+
+    arm_cmplx_mult_cmplx_f32((float *) &rx[st], phasor, phasor, len);
+#endif
+}
+
 /*
  * Correlates the OFDM pilot symbol samples with a window of received
  * samples to determine the most likely timing offset.  Combines two
@@ -585,14 +625,17 @@ static complex float vector_sum(complex float *a, int num_elements) {
  */
 
 static int est_timing(struct OFDM *ofdm, complex float *rx, int length) {
-    complex float csam;
     int Ncorr = length - (ofdm_samplesperframe + (ofdm_m + ofdm_ncp));
     int SFrame = ofdm_samplesperframe;
     float corr[Ncorr];
-    int i, j;
+    int i;
 
     float acc = 0.0f;
 
+#ifndef FDV_ARM_MATH
+    complex float csam;
+    int j;
+
     for (i = 0; i < length; i++) {
         acc += cnormf(rx[i]);
     }
@@ -612,6 +655,26 @@ static int est_timing(struct OFDM *ofdm, complex float *rx, int length) {
 
         corr[i] = (cabsf(corr_st) + cabsf(corr_en)) / av_level;
     }
+#else
+    /* this is the inner loop of the sync search, Ncorr * 2 * (M+Ncp) complex MACs */
+    complex float pilot_conj[ofdm_m + ofdm_ncp];
+
+    arm_cmplx_conj_f32((float *) ofdm->pilot_samples, (float *) pilot_conj, ofdm_m + ofdm_ncp);
+
+    /* sum of |rx|^2 == sum of squares of the interleaved re/im values */
+    arm_power_f32((float *) rx, 2 * length, &acc);
+
+    float av_level = 2.0f * sqrtf(ofdm->timing_norm * acc / length) + 1E-12f;
+
+    for (i = 0; i < Ncorr; i++) {
+        float st_re, st_im, en_re, en_im;
+
+        arm_cmplx_dot_prod_f32((float *) &rx[i], (float *) pilot_conj, ofdm_m + ofdm_ncp, &st_re, &st_im);
+        arm_cmplx_dot_prod_f32((float *) &rx[i + SFrame], (float *) pilot_conj, ofdm_m + ofdm_ncp, &en_re, &en_im);
+
+        corr[i] = (sqrtf(st_re * st_re + st_im * st_im) + sqrtf(en_re * en_re + en_im * en_im)) / av_level;
+    }
+#endif
 
     /* find the max magnitude and its index */
 
@@ -647,9 +710,8 @@ static int est_timing(struct OFDM *ofdm, complex float *rx, int length) {
  */
 
 static float est_freq_offset(struct OFDM *ofdm, complex float *rx, int timing_est) {
-    complex float csam1, csam2;
     float foff_est;
-    int j, k;
+    int k;
 
     /*
       Freq offset can be considered as change in phase over two halves
@@ -662,6 +724,10 @@ static float est_freq_offset(struct OFDM *ofdm, complex float *rx, int timing_es
 
     /* calculate phase of pilots at half symbol intervals */
 
+#ifndef FDV_ARM_MATH
+    complex float csam1, csam2;
+    int j;
+
     for (j = 0, k = (ofdm_m + ofdm_ncp) / 2; j < (ofdm_m + ofdm_ncp) / 2; j++, k++) {
         csam1 = conjf(ofdm->pilot_samples[j]);
         csam2 = conjf(ofdm->pilot_samples[k]);
@@ -676,6 +742,28 @@ static float est_freq_offset(struct OFDM *ofdm, complex float *rx, int timing_es
         p3 = p3 + (rx[timing_est + j + ofdm_samplesperframe] * csam1);
         p4 = p4 + (rx[timing_est + k + ofdm_samplesperframe] * csam2);
     }
+#else
+    complex float pilot_conj[ofdm_m + ofdm_ncp];
+    float *pc = (float *) pilot_conj;
+    float re, im;
+
+    k = (ofdm_m + ofdm_ncp) / 2;
+    arm_cmplx_conj_f32((float *) ofdm->pilot_samples, pc, ofdm_m + ofdm_ncp);
+
+    /* pilot at start of frame */
+
+    arm_cmplx_dot_prod_f32((float *) &rx[timing_est], pc, k, &re, &im);
+    p1 = re + im * I;
+    arm_cmplx_dot_prod_f32((float *) &rx[timing_est + k], &pc[2 * k], k, &re, &im);
+    p2 = re + im * I;
+
+    /* pilot at end of frame */
+
+    arm_cmplx_dot_prod_f32((float *) &rx[timing_est + ofdm_samplesperframe], pc, k, &re, &im);
+    p3 = re + im * I;
+    arm_cmplx_dot_prod_f32((float *) &rx[timing_est + k + ofdm_samplesperframe], &pc[2 * k], k, &re, &im);
+    p4 = re + im * I;
+#endif
 
     /* Calculate sample rate of phase samples, we are sampling phase
        of pilot at half a symbol intervals */
@@ -995,7 +1083,7 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
     float aphase_est_pilot[ofdm_nc + 2];
     float aamp_est_pilot[ofdm_nc + 2];
     float freq_err_hz;
-    int i, j, k, rr, st, en, ft_est;
+    int i, j, rr, st, en, ft_est;
     int prev_timing_est = ofdm->timing_est;
 
     /*
@@ -1019,10 +1107,7 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
          * using a conjugate multiply
          */
 
-        for (i = st, j = 0; i < en; i++, j++) {
-            float tval = woff_est * i;
-            work[j] = ofdm->rxbuf[i] * cmplxconj(tval);
-        }
+        freq_shift_down(work, ofdm->rxbuf, st, en - st, woff_est);
 
         ft_est = est_timing(ofdm, work, (en - st));
         ofdm->timing_est += (ft_est - ceilf(ofdm_ftwindowwidth / 2));
@@ -1109,10 +1194,7 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
 
     /* down-convert at current timing instant---------------------------------- */
 
-    for (j = st, k = 0; j < en; j++, k++) {
-        float tval = woff_est * j;
-        work[k] = ofdm->rxbuf[j] * cmplxconj(tval);
-    }
+    freq_shift_down(work, ofdm->rxbuf, st, en - st, woff_est);
 
     /*
      * Each symbol is of course (ofdm_m + ofdm_ncp) samples long and
@@ -1148,10 +1230,7 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
 
         /* down-convert at current timing instant---------------------------------- */
 
-        for (j = st, k = 0; j < en; j++, k++) {
-            float tval = woff_est * j;
-            work[k] = ofdm->rxbuf[j] * cmplxconj(tval);
-        }
+        freq_shift_down(work, ofdm->rxbuf, st, en - st, woff_est);
 
         /*
          * We put these Nc+2 carrier symbols into our matrix after the previous pilot:
@@ -1197,10 +1276,7 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
 
     /* down-convert at current timing instant---------------------------------- */
 
-    for (j = st, k = 0; j < en; j++, k++) {
-        float tval = woff_est * j;
-        work[k] = ofdm->rxbuf[j] * cmplxconj(tval);
-    }
+    freq_shift_down(work, ofdm->rxbuf, st, en - st, woff_est);
 
     /*
      * We put the future pilot after all the previous symbols in the matrix:
@@ -1255,8 +1331,10 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
      * Then average the phase surrounding each of the data symbols.
      */
 
+#ifndef FDV_ARM_MATH
     for (i = 1; i < (ofdm_nc + 1); i++) {
         complex float symbol[3];
+        int k;
 
         for (j = (i - 1), k = 0; j < (i + 2); j++, k++) {
             symbol[k] = ofdm->rx_sym[1][j] * conjf(ofdm->pilots[j]); /* this pilot conjugate */
@@ -1289,6 +1367,35 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
 
         aamp_est_pilot[i] = cabsf(aphase_est_pilot_rect / 12.0f);
     }
+#else
+    /*
+     * The pilots are real valued BPSK symbols, so we can sum the four
+     * pilot rows per carrier first and apply the pilot sign once.
+     * The groups of 3 are then just a sliding sum over the carriers.
+     */
+    complex float pilot_sum[ofdm_nc + 2];
+    float *ps = (float *) pilot_sum;
+
+    arm_add_f32((float *) ofdm->rx_sym[1], (float *) ofdm->rx_sym[ofdm_ns + 1], ps, 2 * (ofdm_nc + 2));
+    arm_add_f32(ps, (float *) ofdm->rx_sym[0], ps, 2 * (ofdm_nc + 2));
+    arm_add_f32(ps, (float *) ofdm->rx_sym[ofdm_ns + 2], ps, 2 * (ofdm_nc + 2));
+
+    for (j = 0; j < (ofdm_nc + 2); j++) {
+        float pilot = crealf(ofdm->pilots[j]);
+
+        ps[2 * j] *= pilot;
+        ps[2 * j + 1] *= pilot;
+    }
+
+    for (i = 1; i < (ofdm_nc + 1); i++) {
+        aphase_est_pilot_rect = pilot_sum[i - 1] + pilot_sum[i] + pilot_sum[i + 1];
+        aphase_est_pilot[i] = cargf(aphase_est_pilot_rect);
+
+        /* amplitude is estimated over 12 pilots */
+
+        aamp_est_pilot[i] = cabsf(aphase_est_pilot_rect) / 12.0f;
+    }
+#endif
 
     /*
      * correct phase offset using phase estimate, and demodulate
@@ -1297,10 +1404,17 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
      */
 
     complex float rx_corr;
+    complex float phase_corr[ofdm_nc + 2];
     int abit[2];
     int bit_index = 0;
     float sum_amp = 0.0f;
 
+    /* the correction is the same for all rows, so only one sin/cos per carrier */
+
+    for (i = 1; i < (ofdm_nc + 1); i++) {
+        phase_corr[i] = (ofdm->phase_est_en == true) ? cmplxconj(aphase_est_pilot[i]) : 1.0f;
+    }
+
     for (rr = 0; rr < ofdm_rowsperframe; rr++) {
         /*
          * Note the i starts with the second carrier, ends with Nc+1.
@@ -1310,11 +1424,7 @@ static void ofdm_demod_core(struct OFDM *ofdm, int *rx_bits) {
          */
 
         for (i = 1; i < (ofdm_nc + 1); i++) {
-            if (ofdm->phase_est_en == true) {
-                rx_corr = ofdm->rx_sym[rr + 2][i] * cmplxconj(aphase_est_pilot[i]);
-            } else {
-                rx_corr = ofdm->rx_sym[rr + 2][i];
-            }
+            rx_corr = ofdm->rx_sym[rr + 2][i] * phase_corr[i];
 
             /*
              * Output complex data symbols after phase correction;
@@ -27,7 +27,6 @@
 
 #include "defines.h"
 #include "phase.h"
-#include "kiss_fft.h"
 #include "comp.h"
 #include "comp_prim.h"
 #include "sine.h"
@@ -1176,11 +1176,16 @@ float speech_to_uq_lsps(float lsp[],
     float R[order+1];
     float e, E;
 
+#ifndef FDV_ARM_MATH
     e = 0.0;
     for(i=0; i<m_pitch; i++) {
 	Wn[i] = Sn[i]*w[i];
 	e += Wn[i]*Wn[i];
     }
+#else
+    arm_mult_f32(Sn, w, Wn, m_pitch);
+    arm_power_f32(Wn, m_pitch, &e);
+#endif
 
     /* trap 0 energy case as LPC analysis will fail */
 
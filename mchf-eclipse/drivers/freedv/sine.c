@@ -37,7 +37,6 @@
 
 #include "defines.h"
 #include "sine.h"
-#include "kiss_fft.h"
 
 #define HPF_BETA 0.125
 
@@ -234,7 +233,8 @@ float hpf(float x, float states[])
 
 // TODO: we can either go for a faster FFT using fftr and some stack usage
 // or we can reduce stack usage to almost zero on STM32 by switching to fft_inplace
-#if 1
+// on STM32 the real FFT is used, it takes about half the time of the complex one
+#ifndef FDV_ARM_MATH
 void dft_speech(C2CONST *c2const, codec2_fft_cfg fft_fwd_cfg, COMP Sw[], float Sn[], float w[])
 {
     int  i;
@@ -262,29 +262,40 @@ void dft_speech(C2CONST *c2const, codec2_fft_cfg fft_fwd_cfg, COMP Sw[], float S
     codec2_fft_inplace(fft_fwd_cfg, Sw);
 }
 #else
-void dft_speech(codec2_fftr_cfg fftr_fwd_cfg, COMP Sw[], float Sn[], float w[])
+void dft_speech(C2CONST *c2const, codec2_fftr_cfg fftr_fwd_cfg, COMP Sw[], float Sn[], float w[])
 {
     int  i;
-  float sw[FFT_ENC];
+    int  m_pitch = c2const->m_pitch;
+    int   nw      = c2const->nw;
+    float sw[FFT_ENC];
 
-  for(i=0; i<FFT_ENC; i++) {
-    sw[i] = 0.0;
-  }
+    memset(sw, 0, sizeof(sw));
+
+    /* Centre analysis window on time axis, we need to arrange input
+       to FFT this way to make FFT phases correct */
 
-  /* Centre analysis window on time axis, we need to arrange input
-     to FFT this way to make FFT phases correct */
+    /* move 2nd half to start of FFT input vector */
 
-  /* move 2nd half to start of FFT input vector */
+    arm_mult_f32(&Sn[m_pitch/2], &w[m_pitch/2], &sw[0], nw/2);
 
-  for(i=0; i<nw/2; i++)
-    sw[i] = Sn[i+m_pitch/2]*w[i+m_pitch/2];
+    /* move 1st half to end of FFT input vector */
 
-  /* move 1st half to end of FFT input vector */
+    arm_mult_f32(&Sn[m_pitch/2-nw/2], &w[m_pitch/2-nw/2], &sw[FFT_ENC-nw/2], nw/2);
 
-  for(i=0; i<nw/2; i++)
-    sw[FFT_ENC-nw/2+i] = Sn[i+m_pitch/2-nw/2]*w[i+m_pitch/2-nw/2];
+    /* CMSIS packs the real valued bin FFT_ENC/2 into Sw[0].imag */
 
-  codec2_fftr(fftr_fwd_cfg, sw, Sw);
+    arm_rfft_fast_f32(fftr_fwd_cfg->instance, sw, (float*)Sw, 0);
+    Sw[FFT_ENC/2].real = Sw[0].imag;
+    Sw[FFT_ENC/2].imag = 0.0;
+    Sw[0].imag = 0.0;
+
+    /* the harmonic searches may look beyond FFT_ENC/2, so complete
+       the spectrum using the conjugate symmetry of a real input */
+
+    for(i=1; i<FFT_ENC/2; i++) {
+        Sw[FFT_ENC-i].real = Sw[i].real;
+        Sw[FFT_ENC-i].imag = -Sw[i].imag;
+    }
 }
 #endif
 
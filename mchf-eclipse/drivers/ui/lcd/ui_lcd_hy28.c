@@ -15,6 +15,8 @@
 // Common
 #include <stdio.h>
 #include <stdlib.h>
+#include <assert.h>
+#include <string.h>
 
 #include "uhsdr_board.h"
 #include "uhsdr_board_config.h"
@@ -37,6 +39,15 @@
 #define USE_SPI_DISPLAY
 #define USE_DISPLAY_PAR
 
+#if defined(USE_DISPLAY_PAR) && !defined(BOOTLOADER_BUILD)
+  // line buffers are transferred to the FSMC/FMC data register of parallel displays
+  // using memory to memory DMA, DMA2 Stream 7 is not used by anything else on any of our boards
+  #define USE_DISPLAY_PAR_DMA
+  #define DISPLAY_PAR_DMA           DMA2_Stream7
+  #define DISPLAY_PAR_DMA_IFCR      (DMA2->HIFCR)
+  #define DISPLAY_PAR_DMA_IFCR_ALL  (DMA_HIFCR_CTCIF7 | DMA_HIFCR_CHTIF7 | DMA_HIFCR_CTEIF7 | DMA_HIFCR_CDMEIF7 | DMA_HIFCR_CFEIF7)
+#endif
+
 
 #if !defined(USE_DISPLAY_PAR) && !defined(USE_SPI_DISPLAY)
 #warning Both USE_DISPLAY_PAR and USE_SPI_DISPLAY are disabled, no display driver will be available!
@@ -1097,6 +1108,66 @@ static void UiLcdHy28_SetActiveWindow(uint16_t XLeft, uint16_t XRight, uint16_t
     mchf_display.SetActiveWindow(XLeft, XRight, YTop, YBottom);
 }
 
+#ifdef USE_DISPLAY_PAR_DMA
+static inline void UiLcdHy28_ParallelDmaStop()
+{
+    while (DISPLAY_PAR_DMA->CR & DMA_SxCR_EN) { asm(""); }
+}
+
+static void UiLcdHy28_ParallelDmaInit()
+{
+    __HAL_RCC_DMA2_CLK_ENABLE();
+    DISPLAY_PAR_DMA->CR = 0;
+    // memory to memory transfers are only possible with FIFO enabled
+    DISPLAY_PAR_DMA->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH_0 | DMA_SxFCR_FTH_1;
+}
+
+/**
+ * @brief start a memory to memory transfer of the pixels into the display data register, does not wait for the end
+ * In memory to memory mode the DMA peripheral port is the source, so this one gets incremented
+ * while the memory port (display data register) stays fixed.
+ */
+static void UiLcdHy28_ParallelDmaStart(const uint16_t* pixel, uint32_t len)
+{
+    UiLcdHy28_ParallelDmaStop();
+
+#if defined(STM32F7) || defined(STM32H7)
+    // the DMA reads the RAM, not the data cache
+    const uint32_t addr = (uint32_t)pixel & ~31UL;
+    SCB_CleanDCache_by_Addr((uint32_t*)addr, len * sizeof(uint16_t) + ((uint32_t)pixel - addr));
+#endif
+
+    DISPLAY_PAR_DMA_IFCR = DISPLAY_PAR_DMA_IFCR_ALL;
+    DISPLAY_PAR_DMA->PAR = (uint32_t)pixel;
+#ifdef USE_GFX_RA8875
+    DISPLAY_PAR_DMA->M0AR = mchf_display.DeviceCode == 0x8875 ? (uint32_t)&LCD_RAM_RA8875 : (uint32_t)&LCD_RAM;
+#else
+    DISPLAY_PAR_DMA->M0AR = (uint32_t)&LCD_RAM;
+#endif
+    DISPLAY_PAR_DMA->NDTR = len;
+    DISPLAY_PAR_DMA->CR = DMA_SxCR_DIR_1 | DMA_SxCR_PINC | DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0 | DMA_SxCR_EN;
+}
+#endif
+
+/**
+ * @brief wait until a running DMA transfer of a pixel buffer to the display is done
+ */
+static inline void UiLcdHy28_BulkWriteDmaWait()
+{
+#ifdef USE_SPI_DMA
+    if(UiLcdHy28_SpiDisplayUsed())
+    {
+        UiLcdHy28_SpiDmaStop();
+    }
+#endif
+#ifdef USE_DISPLAY_PAR_DMA
+    if(UiLcdHy28_SpiDisplayUsed() == false)
+    {
+        UiLcdHy28_ParallelDmaStop();
+    }
+#endif
+}
+
 static void UiLcdHy28_BulkWrite(uint16_t* pixel, uint32_t len)
 {
 
@@ -1106,6 +1177,10 @@ static void UiLcdHy28_BulkWrite(uint16_t* pixel, uint32_t len)
     if(UiLcdHy28_SpiDisplayUsed() == false)
 #endif
     {
+#ifdef USE_DISPLAY_PAR_DMA
+        // a line buffer may still be on its way to the display
+        UiLcdHy28_ParallelDmaStop();
+#endif
 #ifdef USE_GFX_RA8875
     	if(mchf_display.DeviceCode==0x8875)
     	{
@@ -1138,11 +1213,9 @@ static void UiLcdHy28_BulkWrite(uint16_t* pixel, uint32_t len)
 
 static void UiLcdHy28_FinishWaitBulkWrite()
 {
+    UiLcdHy28_BulkWriteDmaWait();
     if(UiLcdHy28_SpiDisplayUsed())         // SPI enabled?
     {
-#ifdef USE_SPI_DMA
-        UiLcdHy28_SpiDmaStop();
-#endif
         UiLcdHy28_LcdSpiFinishTransfer();
     }
 }
@@ -1157,6 +1230,13 @@ static void UiLcdHy28_OpenBulkWrite(ushort x, ushort width, ushort y, ushort hei
 
 static void UiLcdHy28_CloseBulkWrite()
 {
+#ifdef USE_DISPLAY_PAR_DMA
+    // all other parallel display accesses go through the same bus, so we must not leave the DMA running
+    if(UiLcdHy28_SpiDisplayUsed() == false)
+    {
+        UiLcdHy28_ParallelDmaStop();
+    }
+#endif
 #ifdef USE_GFX_RA8875
 	if(mchf_display.DeviceCode==0x8875)
 	{
@@ -1201,10 +1281,11 @@ inline void UiLcdHy28_BulkPixel_Put(uint16_t pixel)
 
 inline void UiLcdHy28_BulkPixel_PutBuffer(uint16_t* pixel_buffer, uint32_t len)
 {
-    // We bypass the buffering if in parallel mode
-    // since as for now, it will not benefit from it.
-    // this can be changed if someone write DMA code for the parallel
-    // interface (memory to memory DMA)
+    // We bypass the buffering if in parallel mode, the CPU writes the pixels directly.
+    // The memory to memory DMA (USE_DISPLAY_PAR_DMA) is only used for line buffers
+    // from UiLcdHy28_BulkPixel_LineBufferGet: pixel_buffer belongs to the caller, may be
+    // reused as soon as we return and may be located in memory the DMA cannot read
+    // (on the H7 only __UHSDR_DMAMEM is). Waiting for the DMA would gain nothing over writing it here.
     if(UiLcdHy28_SpiDisplayUsed())         // SPI enabled?
     {
         for (uint32_t idx = 0; idx < len; idx++)
@@ -1218,6 +1299,81 @@ inline void UiLcdHy28_BulkPixel_PutBuffer(uint16_t* pixel_buffer, uint32_t len)
     }
 }
 
+static const uint16_t* linebuf_inflight = NULL;
+
+/**
+ * @brief converts a RGB565 color into the byte order in which line buffers are sent to the display
+ * Use it when building lookup tables (e.g. a palette) for pixels written into line buffers, this way
+ * we don't have to touch each pixel a second time before sending it.
+ */
+uint16_t UiLcdHy28_BulkPixel_LineBufferColor(uint16_t color)
+{
+#ifdef USE_SPI_DMA
+    if(UiLcdHy28_SpiDisplayUsed())
+    {
+        // SPI DMA sends bytes, so the LSB would go first
+        color = __REV16(color);
+    }
+#endif
+    return color;
+}
+
+/**
+ * @brief returns a pixel buffer for a line of up to PIXELBUFFERSIZE pixels, to be filled and sent with UiLcdHy28_BulkPixel_LineBufferPut
+ * The buffers are used in turn, so one line can be composed while the previous one is transferred by DMA.
+ * Pixels have to be in the byte order provided by UiLcdHy28_BulkPixel_LineBufferColor.
+ * Must only be used between UiLcdHy28_BulkPixel_OpenWrite and UiLcdHy28_BulkPixel_CloseWrite.
+ */
+uint16_t* UiLcdHy28_BulkPixel_LineBufferGet(uint32_t len)
+{
+    assert(len <= PIXELBUFFERSIZE);
+
+    if (pixelcount != 0)
+    {
+        // keep pixels from UiLcdHy28_BulkPixel_Put in order
+        UiLcdHy28_BulkPixel_BufferFlush();
+    }
+
+    uint16_t* retval = pixelbuffer[pixelbufidx];
+    UiLcdHy28_BulkPixel_BufferInit();
+
+    if (retval == linebuf_inflight)
+    {
+        UiLcdHy28_BulkWriteDmaWait();
+    }
+    return retval;
+}
+
+/**
+ * @brief sends a line buffer obtained from UiLcdHy28_BulkPixel_LineBufferGet to the display
+ * Returns once the transfer is started, the buffer must not be changed afterwards. It may be sent
+ * again (e.g. for repeated lines) until the next buffer is requested.
+ */
+void UiLcdHy28_BulkPixel_LineBufferPut(const uint16_t* line, uint32_t len)
+{
+#ifdef USE_SPI_DMA
+    if(UiLcdHy28_SpiDisplayUsed())
+    {
+        UiLcdHy28_SpiDmaStart((uint8_t*)line, len*2);
+        linebuf_inflight = line;
+    }
+    else
+#endif
+    {
+#ifdef USE_DISPLAY_PAR_DMA
+        if(UiLcdHy28_SpiDisplayUsed() == false)
+        {
+            UiLcdHy28_ParallelDmaStart(line, len);
+            linebuf_inflight = line;
+        }
+        else
+#endif
+        {
+            UiLcdHy28_BulkWrite((uint16_t*)line, len);
+        }
+    }
+}
+
 inline void UiLcdHy28_BulkPixel_OpenWrite(ushort x, ushort width, ushort y, ushort height)
 {
     UiLcdHy28_OpenBulkWrite(x, width,y,height);
@@ -1231,9 +1387,63 @@ inline void UiLcdHy28_BulkPixel_CloseWrite()
 }
 
 
+// small history of the last filled rectangles. Retained UI widgets remember the
+// fill sequence number of their last drawing and use UiLcdHy28_AreaFilledSince()
+// to find out if someone painted over them in the meantime and they have to redraw
+// completely instead of updating just the changed parts.
+// Only area clears are recorded (UiLcdHy28_LcdClear, UiLcdHy28_DrawFullRect), lines, outlines and
+// text backgrounds use the display's DrawFullRect directly. Otherwise a single scope redraw
+// would flush the whole history.
+#define LCD_FILL_HISTORY 8
+
+static struct
+{
+    uint16_t x[LCD_FILL_HISTORY];
+    uint16_t y[LCD_FILL_HISTORY];
+    uint16_t w[LCD_FILL_HISTORY];
+    uint16_t h[LCD_FILL_HISTORY];
+    uint32_t seq; // number of fills recorded so far, the newest entry is at (seq-1) % LCD_FILL_HISTORY
+} lcd_fills;
+
+static void UiLcdHy28_FillRecord(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    const uint32_t idx = lcd_fills.seq % LCD_FILL_HISTORY;
+    lcd_fills.x[idx] = x;
+    lcd_fills.y[idx] = y;
+    lcd_fills.w[idx] = w;
+    lcd_fills.h[idx] = h;
+    lcd_fills.seq++;
+}
+
+/**
+ * @returns sequence number to be passed to UiLcdHy28_AreaFilledSince() later
+ */
+uint32_t UiLcdHy28_FillSeqGet()
+{
+    return lcd_fills.seq;
+}
+
+/**
+ * Checks if a rectangle filled after the sequence number seq overlaps the given area.
+ * If more fills happened than we keep in our history, we have to assume the area was hit.
+ */
+bool UiLcdHy28_AreaFilledSince(uint32_t seq, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    bool retval = lcd_fills.seq - seq > LCD_FILL_HISTORY;
+
+    for (uint32_t s = seq; retval == false && s != lcd_fills.seq; s++)
+    {
+        const uint32_t idx = s % LCD_FILL_HISTORY;
+        retval = lcd_fills.x[idx] < x + w && x < lcd_fills.x[idx] + lcd_fills.w[idx]
+                && lcd_fills.y[idx] < y + h && y < lcd_fills.y[idx] + lcd_fills.h[idx];
+    }
+    return retval;
+}
+
 void UiLcdHy28_LcdClear(ushort Color)
 {
 	uint32_t MAX_X=mchf_display.MAX_X; uint32_t MAX_Y=mchf_display.MAX_Y;
+    UiLcdHy28_FillRecord(0, 0, MAX_X, MAX_Y);
     UiLcdHy28_OpenBulkWrite(0,MAX_X,0,MAX_Y);
 #ifdef USE_SPI_DMA
     if(UiLcdHy28_SpiDisplayUsed())
@@ -1278,6 +1488,7 @@ void UiLcdHy28_DrawColorPoint_ILI(uint16_t Xpos,uint16_t Ypos,uint16_t point)
 
 void UiLcdHy28_DrawFullRect(uint16_t Xpos, uint16_t Ypos, uint16_t Height, uint16_t Width ,uint16_t color)
 {
+    UiLcdHy28_FillRecord(Xpos, Ypos, Width, Height);
 	mchf_display.DrawFullRect(Xpos,Ypos,Height,Width,color);
 }
 
@@ -1463,16 +1674,60 @@ void UiLcdHy28_DrawStraightLine_RA8875(uint16_t x, uint16_t y, uint16_t Length,
 
 #endif
 
+/**
+ * @brief tells if the display controller can scroll a screen area vertically in our (landscape) orientation
+ * only the RA8875 can do this. The ILI932x/ILI9486 controllers scroll along the gate lines of the panel
+ * which are the columns for us, so these could only scroll horizontally.
+ */
+bool UiLcdHy28_VerticalScrollAvailable()
+{
+#ifdef USE_GFX_RA8875
+    return mchf_display.DeviceCode == 0x8875;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief defines the screen area which is scrolled by UiLcdHy28_VerticalScrollOffset
+ * does nothing if the display can't scroll
+ */
+void UiLcdHy28_VerticalScrollArea(uint16_t x, uint16_t width, uint16_t y, uint16_t height)
+{
+#ifdef USE_GFX_RA8875
+    if (UiLcdHy28_VerticalScrollAvailable() && width > 0 && height > 0)
+    {
+        UiLcdRA8875_setScrollWindow(x, x + width - 1, y, y + height - 1);
+    }
+#endif
+}
+
+/**
+ * @brief top line of the scroll area shows the display memory line y + offset (wrapping inside the area)
+ * Writing to the display memory is not affected by the offset, i.e. the caller has to map the lines itself.
+ * does nothing if the display can't scroll
+ */
+void UiLcdHy28_VerticalScrollOffset(uint16_t offset)
+{
+#ifdef USE_GFX_RA8875
+    if (UiLcdHy28_VerticalScrollAvailable())
+    {
+        UiLcdRA8875_scroll(0, offset);
+    }
+#endif
+}
+
 
 void UiLcdHy28_DrawStraightLineWidth(ushort x, ushort y, ushort Length, uint16_t Width, uchar Direction,ushort color)
 {
+    // not recorded in the fill history, lines are no area clears
     if(Direction == LCD_DIR_VERTICAL)
     {
-        UiLcdHy28_DrawFullRect(x,y,Length,Width,color);
+        mchf_display.DrawFullRect(x,y,Length,Width,color);
     }
     else
     {
-        UiLcdHy28_DrawFullRect(x,y,Width,Length,color);
+        mchf_display.DrawFullRect(x,y,Width,Length,color);
     }
 }
 void UiLcdHy28_DrawStraightLine(uint16_t x, uint16_t y, uint16_t Length, uint8_t Direction,uint16_t color)
@@ -1578,6 +1833,48 @@ static void UiLcdHy28_BulkWriteColor(uint16_t Color, uint32_t len)
 
 
 #ifdef USE_8bit_FONT
+// colors for all 256 gray levels of a 8bit font for the most recently used foreground/background pair
+static struct
+{
+    bool valid;
+    uint16_t fg;
+    uint16_t bg;
+    uint16_t shade[256];
+} glyph_shades;
+
+/**
+ * @returns table of colors for 8bit font pixel values, computed only if the colors differ from the last call
+ */
+static const uint16_t* UiLcdHy28_GlyphShadesGet(uint16_t Color, uint16_t bkColor)
+{
+    if (glyph_shades.valid == false || glyph_shades.fg != Color || glyph_shades.bg != bkColor)
+    {
+        //gray shaded font type
+        const int32_t ColBG_R=(bkColor>>11)&0x1f;
+        const int32_t ColBG_G=(bkColor>>5)&0x3f;
+        const int32_t ColBG_B=bkColor&0x1f;
+
+        const int32_t ColFG_R=((Color>>11)&0x1f) - ColBG_R; //decomposition of 16 bit color data into channels
+        const int32_t ColFG_G=((Color>>5)&0x3f)  - ColBG_G;
+        const int32_t ColFG_B=(Color&0x1f) - ColBG_B;
+
+        glyph_shades.shade[0] = bkColor;
+        for (int32_t FontD = 1; FontD < 256; FontD++)
+        {
+            //shading the foreground colour
+            int32_t ColFG_Ro=((ColFG_R*FontD)>>8) + ColBG_R;
+            int32_t ColFG_Go=((ColFG_G*FontD)>>8) + ColBG_G;
+            int32_t ColFG_Bo=((ColFG_B*FontD)>>8) + ColBG_B;
+
+            glyph_shades.shade[FontD]=(ColFG_Ro<<11)|(ColFG_Go<<5)|ColFG_Bo;    //assembly of destination colour
+        }
+        glyph_shades.fg = Color;
+        glyph_shades.bg = bkColor;
+        glyph_shades.valid = true;
+    }
+    return glyph_shades.shade;
+}
+
 static void UiLcdHy28_DrawChar_8bit(ushort x, ushort y, char symb,ushort Color, ushort bkColor,const sFONT *cf)
 {
 
@@ -1608,50 +1905,14 @@ static void UiLcdHy28_DrawChar_8bit(ushort x, ushort y, char symb,ushort Color,
     }
     else
     {
-        //gray shaded font type
-        const int32_t ColBG_R=(bkColor>>11)&0x1f;
-        const int32_t ColBG_G=(bkColor>>5)&0x3f;
-        const int32_t ColBG_B=bkColor&0x1f;
-
-        const int32_t ColFG_R=((Color>>11)&0x1f) - ColBG_R; //decomposition of 16 bit color data into channels
-        const int32_t ColFG_G=((Color>>5)&0x3f)  - ColBG_G;
-        const int32_t ColFG_B=(Color&0x1f) - ColBG_B;
-
-        uint8_t *FontData=(uint8_t*)sym_ptr->data;
+        const uint16_t* shade = UiLcdHy28_GlyphShadesGet(Color, bkColor);
+        const uint8_t *FontData=(uint8_t*)sym_ptr->data;
 
         for(uint8_t cntrY=0;cntrY<Font_H;cntrY++)
         {
             for(uint8_t cntrX=0;cntrX<Font_W;cntrX++)
             {
-                uint32_t pixel;
-                uint8_t FontD;
-
-                if(cntrY<Font_H)
-                {
-                    FontD=*FontData++;      //get one point from bitmap
-                }
-                else
-                {
-                    FontD=0;
-                }
-
-                if(FontD==0)
-                {
-                    pixel=bkColor;
-                }
-                else
-                {
-                    //shading the foreground colour
-                    int32_t ColFG_Ro=(ColFG_R*FontD)>>8;
-                    int32_t ColFG_Go=(ColFG_G*FontD)>>8;
-                    int32_t ColFG_Bo=(ColFG_B*FontD)>>8;
-                    ColFG_Ro+=ColBG_R;
-                    ColFG_Go+=ColBG_G;
-                    ColFG_Bo+=ColBG_B;
-
-                    pixel=(ColFG_Ro<<11)|(ColFG_Go<<5)|ColFG_Bo;    //assembly of destination colour
-                }
-                UiLcdHy28_BulkPixel_Put(pixel);
+                UiLcdHy28_BulkPixel_Put(shade[*FontData++]);
             }
 
             // add spacing behind the character data
@@ -1669,48 +1930,63 @@ static void UiLcdHy28_DrawChar_8bit(ushort x, ushort y, char symb,ushort Color,
 }
 #endif
 
-static void UiLcdHy28_DrawChar_1bit(ushort x, ushort y, char symb,ushort Color, ushort bkColor,const sFONT *cf)
+/**
+ * @returns pointer to the bitmap of a character in a 1bit font
+ */
+static inline const uint8_t* UiLcdHy28_Glyph1bit(char symb, const sFONT *cf)
 {
-    uint8_t   *ch = (uint8_t *)cf->table;
-
     // we get the address of the begin of the character table
     // we support one or two byte long character definitions
     // anything wider than 8 pixels uses two bytes
-    ch+=(symb - 32) * cf->Height* ((cf->Width>8) ? 2 : 1 );
+    return (const uint8_t *)cf->table + (symb - 32) * cf->Height* ((cf->Width>8) ? 2 : 1 );
+}
 
-    UiLcdHy28_OpenBulkWrite(x,cf->Width,y,cf->Height);
-    UiLcdHy28_BulkPixel_BufferInit();
+/**
+ * @returns pixel data for a character line, left most pixel is MSB
+ */
+static inline uint32_t UiLcdHy28_Glyph1bitLine(const uint8_t* ch, uint32_t i, const sFONT *cf)
+{
+    uint32_t line_data;
 
-    // we now get the pixel information line by line
-    for(uint32_t i = 0; i < cf->Height; i++)
+    // we read the current pixel line data (1 or 2 bytes)
+    if(cf->Width>8)
     {
-        uint32_t line_data; // stores pixel data for a character line, left most pixel is MSB
-
-        // we read the current pixel line data (1 or 2 bytes)
-        if(cf->Width>8)
+        if (cf->Width <= 12)
         {
-            if (cf->Width <= 12)
-            {
-                // small fonts <= 12 pixel width have left most pixel as MSB
-                // we have to reverse that
-                line_data  = ch[i*2+1]<<24;
-                line_data |= ch[i*2] << 16;
-            }
-            else
-            {
-                uint32_t interim;
-                interim  = ch[i*2+1]<<8;
-                interim |= ch[i*2];
-
-                line_data = __RBIT(interim); // rbit reverses a 32bit value bitwise
-            }
+            // small fonts <= 12 pixel width have left most pixel as MSB
+            // we have to reverse that
+            line_data  = ch[i*2+1]<<24;
+            line_data |= ch[i*2] << 16;
         }
         else
         {
-            // small fonts have left most pixel as MSB
-            // we have to reverse that
-            line_data = ch[i] << 24; // rbit reverses a 32bit value bitwise
+            uint32_t interim;
+            interim  = ch[i*2+1]<<8;
+            interim |= ch[i*2];
+
+            line_data = __RBIT(interim); // rbit reverses a 32bit value bitwise
         }
+    }
+    else
+    {
+        // small fonts have left most pixel as MSB
+        // we have to reverse that
+        line_data = ch[i] << 24; // rbit reverses a 32bit value bitwise
+    }
+    return line_data;
+}
+
+static void UiLcdHy28_DrawChar_1bit(ushort x, ushort y, char symb,ushort Color, ushort bkColor,const sFONT *cf)
+{
+    const uint8_t* ch = UiLcdHy28_Glyph1bit(symb, cf);
+
+    UiLcdHy28_OpenBulkWrite(x,cf->Width,y,cf->Height);
+    UiLcdHy28_BulkPixel_BufferInit();
+
+    // we now get the pixel information line by line
+    for(uint32_t i = 0; i < cf->Height; i++)
+    {
+        uint32_t line_data = UiLcdHy28_Glyph1bitLine(ch, i, cf);
 
         // now go through the data pixel by pixel
         // and find out if it is background or foreground
@@ -1728,6 +2004,85 @@ static void UiLcdHy28_DrawChar_1bit(ushort x, ushort y, char symb,ushort Color,
     UiLcdHy28_CloseBulkWrite();
 }
 
+// all 16 combinations of 4 pixels in the current foreground/background colors,
+// already in line buffer byte order. Lets us expand 1bit glyph lines 4 pixels at a time.
+static struct
+{
+    bool valid;
+    uint16_t fg;
+    uint16_t bg;
+    uint16_t pattern[16][4];
+} glyph_patterns;
+
+static void UiLcdHy28_GlyphPatternsSet(uint16_t Color, uint16_t bkColor)
+{
+    if (glyph_patterns.valid == false || glyph_patterns.fg != Color || glyph_patterns.bg != bkColor)
+    {
+        const uint16_t fg = UiLcdHy28_BulkPixel_LineBufferColor(Color);
+        const uint16_t bg = UiLcdHy28_BulkPixel_LineBufferColor(bkColor);
+
+        for (uint32_t nibble = 0; nibble < 16; nibble++)
+        {
+            for (uint32_t px = 0; px < 4; px++)
+            {
+                glyph_patterns.pattern[nibble][px] = (nibble & (0x08 >> px)) != 0 ? fg : bg;
+            }
+        }
+        glyph_patterns.fg = Color;
+        glyph_patterns.bg = bkColor;
+        glyph_patterns.valid = true;
+    }
+}
+
+/**
+ * @brief prints a string of a 1bit font into a single display window, line by line
+ * Characters are placed Xshift pixels apart, the last one is drawn with its full width. This is exactly what
+ * drawing the characters one by one gives us but we set up the display window only once per string and
+ * send each pixel line of the string as one (DMA) transfer.
+ * The caller has to make sure the string fits on the display without wrapping.
+ */
+static void UiLcdHy28_PrintTextLen_1bit(uint16_t x, uint16_t y, const char *str, uint16_t len, uint16_t Color, uint16_t bkColor, const sFONT *cf, uint16_t Xshift)
+{
+    // we write 4 pixels at a time, so we need up to 3 pixels headroom in the line buffer
+    const uint16_t max_len = (PIXELBUFFERSIZE - 3 - cf->Width) / Xshift + 1;
+
+    UiLcdHy28_GlyphPatternsSet(Color, bkColor);
+
+    while (len > 0)
+    {
+        const uint16_t chunk_len = len > max_len ? max_len : len;
+        const uint32_t width = (chunk_len - 1) * Xshift + cf->Width;
+
+        UiLcdHy28_BulkPixel_OpenWrite(x, width, y, cf->Height);
+
+        for(uint32_t i = 0; i < cf->Height; i++)
+        {
+            uint16_t* const line = UiLcdHy28_BulkPixel_LineBufferGet(width);
+            uint16_t* px = line;
+
+            for (uint16_t idx = 0; idx < chunk_len; idx++)
+            {
+                uint32_t line_data = UiLcdHy28_Glyph1bitLine(UiLcdHy28_Glyph1bit(str[idx], cf), i, cf);
+                const uint32_t w = idx == chunk_len - 1 ? cf->Width : Xshift;
+
+                // pixels beyond w are overwritten by the next character
+                for (uint32_t j = 0; j < w; j += 4, line_data <<= 4)
+                {
+                    memcpy(&px[j], glyph_patterns.pattern[line_data >> 28], sizeof(glyph_patterns.pattern[0]));
+                }
+                px += w;
+            }
+            UiLcdHy28_BulkPixel_LineBufferPut(line, width);
+        }
+
+        UiLcdHy28_BulkPixel_CloseWrite();
+
+        str += chunk_len;
+        len -= chunk_len;
+        x += chunk_len * Xshift;
+    }
+}
+
 void UiLcdHy28_DrawChar(ushort x, ushort y, char symb,ushort Color, ushort bkColor,const sFONT *cf)
 {
 #ifdef USE_8bit_FONT
@@ -1762,7 +2117,12 @@ static void UiLcdHy28_PrintTextLen(uint16_t XposStart, uint16_t YposStart, const
     uint16_t XposCurrent = XposStart;
     uint16_t YposCurrent = YposStart;
 
-    if (str != NULL)
+    if (str != NULL && len > 0 && cf->BitCount == 1 && XposStart + len * Xshift < MAX_X)
+    {
+        // the common case: the whole string fits into a single line
+        UiLcdHy28_PrintTextLen_1bit(XposStart, YposStart, str, len, clr_fg, clr_bg, cf, Xshift);
+    }
+    else if (str != NULL)
     {
         for (uint16_t idx = 0; idx < len; idx++)
         {
@@ -1958,7 +2318,7 @@ static void UiLcdHy28_PrintTextCenteredLen(const uint16_t XposStart,const uint16
     // we draw the part of the box not used by text.
     if (bbOffset)
     {
-        UiLcdHy28_DrawFullRect(XposStart,YposStart,bbH,bbOffset,clr_bg);
+        mchf_display.DrawFullRect(XposStart,YposStart,bbH,bbOffset,clr_bg);
     }
 
     UiLcdHy28_PrintTextLen((XposStart + bbOffset),YposStart,str, len, clr_fg,clr_bg,font);
@@ -1967,7 +2327,7 @@ static void UiLcdHy28_PrintTextCenteredLen(const uint16_t XposStart,const uint16
     // box
     if (txtW<bbW)
     {
-        UiLcdHy28_DrawFullRect(XposStart+txtW+bbOffset,YposStart,bbH,bbW-(bbOffset+txtW),clr_bg);
+        mchf_display.DrawFullRect(XposStart+txtW+bbOffset,YposStart,bbH,bbW-(bbOffset+txtW),clr_bg);
     }
 }
 
@@ -2517,6 +2877,13 @@ uint8_t UiLcdHy28_Init()
 
     mchf_display.display_type = retval;
 
+#ifdef USE_DISPLAY_PAR_DMA
+    if (retval != DISPLAY_NONE && UiLcdHy28_SpiDisplayUsed() == false)
+    {
+        UiLcdHy28_ParallelDmaInit();
+    }
+#endif
+
 #ifndef BOOTLOADER_BUILD
     switch(mchf_display.DeviceCode)
     {
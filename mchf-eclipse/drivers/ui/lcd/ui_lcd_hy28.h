@@ -168,11 +168,21 @@ void 	UiLcdHy28_DrawFullRect (ushort Xpos, ushort Ypos, ushort Height, ushort Wi
 
 void 	UiLcdHy28_DrawColorPoint(ushort x, ushort y, ushort color);
 
+uint32_t UiLcdHy28_FillSeqGet();
+bool    UiLcdHy28_AreaFilledSince(uint32_t seq, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
 void    UiLcdHy28_BulkPixel_OpenWrite(ushort x, ushort width, ushort y, ushort height);
 void    UiLcdHy28_BulkPixel_CloseWrite();
 void 	UiLcdHy28_BulkPixel_Put(uint16_t pixel);
 void    UiLcdHy28_BulkPixel_PutBuffer(uint16_t* pixel_buffer, uint32_t len);
 void    UiLcdHy28_BulkPixel_BufferFlush();
+uint16_t  UiLcdHy28_BulkPixel_LineBufferColor(uint16_t color);
+uint16_t* UiLcdHy28_BulkPixel_LineBufferGet(uint32_t len);
+void    UiLcdHy28_BulkPixel_LineBufferPut(const uint16_t* line, uint32_t len);
+
+bool    UiLcdHy28_VerticalScrollAvailable();
+void    UiLcdHy28_VerticalScrollArea(uint16_t x, uint16_t width, uint16_t y, uint16_t height);
+void    UiLcdHy28_VerticalScrollOffset(uint16_t offset);
 
 uint8_t 	UiLcdHy28_Init();
 
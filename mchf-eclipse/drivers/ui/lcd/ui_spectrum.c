@@ -13,6 +13,7 @@
  ************************************************************************************/
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include "ui_spectrum.h"
 #include "ui_lcd_hy28.h"
@@ -27,6 +28,10 @@
 #include "audio_nr.h"
 #include "psk.h"
 #include "uhsdr_math.h"
+#include "cat_driver.h"
+#ifdef USE_FT8_DECODER
+#include "ft8.h"
+#endif
 /*
 #if defined(USE_DISP_480_320) || defined(USE_EXPERIMENTAL_MULTIRES)
 #define USE_DISP_480_320_SPEC
@@ -236,6 +241,70 @@ static const scope_scaling_info_t scope_scaling_factors[SCOPE_SCALE_NUM+1] =
         { DB_SCALING_S3,            "(3S/div)   " },
 };
 
+// Band sweep: the LO is stepped across a range much wider than the IQ bandwidth, the averaged spectrum frames of each step
+// are stitched into a panorama with one power value per scope pixel, which is shown instead of the live scope.
+// Like the center frequency which was once kept for each waterfall line, each panorama pixel remembers the pass
+// it was written in, so overlapping steps of one pass are combined (max) while data of an older pass is replaced.
+typedef enum
+{
+    SWEEP_OFF = 0,
+    SWEEP_RUN,      // LO steps across the range
+    SWEEP_RESTORE,  // LO is back on the dial frequency, waiting for a clean frame to restart the spectrum averaging
+} SpectrumSweepState_t;
+
+typedef struct
+{
+    SpectrumSweepState_t state;
+    uint32_t start;         // lowest frequency of the panorama in Hz
+    uint32_t stop;          // highest frequency of the panorama in Hz
+    uint32_t dial;          // dial frequency the sweep was started on, tuning ends the sweep
+    int32_t  lo_offset;     // spectrum center frequency - LO tune frequency (magnify and translate)
+    uint32_t first;         // spectrum center frequency of the first step
+    uint32_t center;        // spectrum center frequency of the current step
+    uint32_t half;          // only this many Hz around the center of a step are used, the rest is filter skirt
+    uint32_t step;          // distance of two steps in Hz, less than half, so that the DC spike of a step is covered by its neighbors
+    uint32_t lo_freq;       // LO tune frequency set for the current step, if it changes someone else tuned
+    uint32_t retune_time;   // sysclock of the last LO change
+    uint8_t  magnify;
+    uint8_t  frames;        // spectrum frames accumulated in FFT_AVGData for the current step
+    uint8_t  pass;          // number of the current pass across the range, 0 is never used
+    bool     tuned;         // false if the oscillator wants us to wait before the next change
+    uint16_t width;         // panorama pixels
+    float32_t hz_per_pixel;
+    float32_t power[SPECTRUM_WIDTH_MAX];        // power of each panorama pixel
+    uint8_t  power_pass[SPECTRUM_WIDTH_MAX];    // pass which wrote power[], 0 = no data yet
+} SpectrumSweep_t;
+
+static SpectrumSweep_t spectrum_sweep;
+
+typedef struct
+{
+    uint8_t  fps;           // max. frames per second, 0 = stream off
+    uint8_t  reduce;        // 2^reduce FFT bins are merged into one streamed bin
+    uint8_t  seq;           // frame counter, lets the host detect lost frames
+    uint8_t  key_countdown; // delta frames until the next key frame
+    uint32_t last_time;     // sysclock of the last frame sent
+    uint32_t center;        // center frequency, span and bins of the last key frame, a change forces a new key frame
+    uint32_t span;
+    uint16_t bins;
+    int16_t  ref;           // level of code 0 in 0.5dB units, set by each key frame
+    uint8_t  last[SPECTRUM_STREAM_BINS_MAX];    // the bins as the host has them after the last frame
+    uint8_t  frame[SPECTRUM_STREAM_HEADER_LEN + SPECTRUM_STREAM_BINS_MAX + 1];
+} SpectrumStream_t;
+
+static SpectrumStream_t spectrum_stream;
+
+#ifdef USE_FT8_DECODER
+// in FT8 mode the decoded messages of the last slot replace scope and waterfall
+typedef struct
+{
+    uint32_t slot_count;    // ft8_result.slot_count of the list on screen
+    bool     valid;         // false if the list has to be drawn again, e.g. after the area was used by a menu
+} SpectrumFt8List_t;
+
+static SpectrumFt8List_t spectrum_ft8;
+#endif
+
 static void     UiSpectrum_DrawFrequencyBar();
 static void		UiSpectrum_CalculateDBm();
 
@@ -370,6 +439,33 @@ static void UiSpectrum_UpdateSpectrumPixelParameters()
 			0.187912223,0.185518832,0.183137304,0.180767729,0.178410196,0.176064795,0.173731614,0.17141074,0.169102262,0.166806267,0.16452284,0.162252069,0.159994038,0.157748834,0.15551654,0.153297242,0.151091022,0.148897964,0.146718151,0.144551664,0.142398586,0.140258998,0.138132981,0.136020614,0.133921978,0.131837151,0.129766213,0.127709241,0.125666312,0.123637505,0.121622896,0.11962256,0.117636572,0.115665009,0.113707945,0.111765452,0.109837605,0.107924475,0.106026136,0.104142659,0.102274115,0.100420575,0.098582108,0.096758783,0.09495067,0.093157837,0.091380351,0.089618279,0.087871689,0.086140645,0.084425213,0.082725458,0.081041443,0.079373234,0.077720891,0.076084478,0.074464057,0.072859688,0.071271432,0.069699349,0.068143498,0.066603939,0.065080728,0.063573924,0.062083583,0.060609762,0.059152516,0.0577119,0.056287968,0.054880775,0.053490372,0.052116814,0.050760151,0.049420435,0.048097716,0.046792044,0.045503469,0.044232039,0.042977801,0.041740804,0.040521094,0.039318717,0.038133718,0.036966142,0.035816033,0.034683435,0.03356839,0.03247094,0.031391127,0.030328991,0.029284572,0.028257911,0.027249045,0.026258012,0.025284851,0.024329597,0.023392287,0.022472956,0.021571639,0.020688369,0.019823181,0.018976107,0.018147178,0.017336426,0.016543882,0.015769575,0.015013535,0.01427579,0.013556368,0.012855296,0.012172601,0.011508308,0.010862443,0.010235029,0.009626091,0.009035651,0.008463732,0.007910355,0.007375542,0.006859311,0.006361684,0.005882678,0.005422311,0.004980602,0.004557566,0.00415322,0.003767578,0.003400657,0.003052468,0.002723026,0.002412342,0.002120429,0.001847298,0.001592958,0.00135742,0.001140693,0.000942783,0.0007637,0.00060345,0.000462038,0.00033947,0.000235751,0.000150885,8.48748E-05,3.77227E-05,9.43077E-06,0};
 #endif
 
+#if !defined(USE_PREDEFINED_WINDOW_DATA) || FFT_IQ_BUFF_LEN > 1024
+// Hann window for the FFT lengths without predefined coefficients, calculated whenever the FFT length changes
+#define USE_CALCULATED_HANN_WINDOW
+static __MCHF_SPECIALMEM float32_t hann_window_calc[FFT_IQ_BUFF_LEN];
+#endif
+
+/**
+ * @brief Sets sd.hann_window to the Hann window coefficients for sd.fft_iq_len samples
+ */
+static void UiSpectrum_InitHannWindow()
+{
+#ifdef USE_PREDEFINED_WINDOW_DATA
+    if (sd.fft_iq_len == 512 || sd.fft_iq_len == 1024)
+    {
+        sd.hann_window = sd.fft_iq_len==512?von_Hann_512:von_Hann_1024;
+        return;
+    }
+#endif
+#ifdef USE_CALCULATED_HANN_WINDOW
+    for(int i = 0; i < sd.fft_iq_len; i++)
+    {
+        hann_window_calc[i] = 0.5 * (1 - arm_cos_f32(PI*2 * (float32_t)i / (float32_t)(sd.fft_iq_len-1)));
+    }
+    sd.hann_window = hann_window_calc;
+#endif
+}
+
 static void UiSpectrum_FFTWindowFunction(char mode)
 {
 
@@ -399,20 +495,8 @@ static void UiSpectrum_FFTWindowFunction(char mode)
         break;
 
     case FFT_WINDOW_HANN:			// Raised Cosine Window (non zero-phase version) - This has the best sidelobe rejection of what is here, but not as narrow as Hamming.
-#ifndef USE_PREDEFINED_WINDOW_DATA
-    	for(int i = 0; i < sd.fft_iq_len; i++)
-    	{
-    		sd.FFT_Samples[i] = 0.5 * (float32_t)((1 - (arm_cos_f32(PI*2 * (float32_t)i / (float32_t)(sd.fft_iq_len-1)))) * sd.FFT_Samples[i]);
-    	}
-#else
-    	{
-    		const float32_t* WindowCoefficients= sd.fft_iq_len==512?von_Hann_512:von_Hann_1024;
-    		for(int i = 0; i < sd.fft_iq_len; i++)
-    		{
-    			sd.FFT_Samples[i] *= WindowCoefficients[i];
-    		}
-    	}
-#endif
+        // coefficients are set up with the FFT length in UiSpectrum_InitSpectrumDisplayData
+        arm_mult_f32(sd.FFT_Samples, (float32_t*)sd.hann_window, sd.FFT_Samples, sd.fft_iq_len);
         break;
 
     case FFT_WINDOW_HAMMING:		// Another Raised Cosine window - This is the narrowest with reasonably good sidelobe rejection.
@@ -443,7 +527,11 @@ static void UiSpectrum_FFTWindowFunction(char mode)
 static void UiSpectrum_SpectrumTopBar_GetText(char* wfbartext)
 {
 
-    if(is_waterfallmode() && is_scopemode())           // dual waterfall
+    if(spectrum_sweep.state == SWEEP_RUN)
+    {
+        sprintf(wfbartext,"Sweep %lu-%lukHz",spectrum_sweep.start/1000, (spectrum_sweep.stop + 999)/1000);
+    }
+    else if(is_waterfallmode() && is_scopemode())           // dual waterfall
     {
         sprintf(wfbartext,"Dual%s < Magnify %2ux >",scope_scaling_factors[ts.spectrum_db_scale].label, (1<<sd.magnify));
     }
@@ -664,10 +752,16 @@ static void UiSpectrum_CreateDrawArea()
     //show highlighted filter bandwidth on the spectrum
     sd.old_left_filter_border_pos=slayout.scope.x;
     sd.old_right_filter_border_pos=slayout.scope.w+slayout.scope.x;
+    sd.signals_marker_num = 0;
 }
 
 void UiSpectrum_Clear()
 {
+#ifdef USE_FT8_DECODER
+    spectrum_ft8.valid = false;
+#endif
+    // everything else drawn into the spectrum area expects an unscrolled display
+    UiSpectrum_WaterfallScrollReset();
     UiLcdHy28_DrawFullRect(slayout.full.x, slayout.full.y, slayout.full.h, slayout.full.w, Black);	// Clear screen under spectrum scope by drawing a single, black block (faster with SPI!)
     ts.VirtualKeysShown_flag=false;	//if virtual keypad was shown, switch it off
 }
@@ -960,30 +1054,59 @@ static void UiSpectrum_InitSpectrumDisplayData()
     // Init publics
     sd.state 		= 0;
     sd.samp_ptr 	= 0;
+    sd.welch_segments = 0;
     sd.enabled		= 0;
     ts.dial_moved	= 0;
     sd.RedrawType   = 0;
 
+    uint16_t spec_len;
     switch(disp_resolution)
     {
 
     case RESOLUTION_320_240:
-    	sd.spec_len = 256;
-    	sd.fft_iq_len = 512;
-    	sd.cfft_instance = &arm_cfft_sR_f32_len256;
+    	spec_len = 256;
     	break;
     case RESOLUTION_480_320:
-    	sd.spec_len = 512;
-    	sd.fft_iq_len = 1024;
-    	sd.cfft_instance = &arm_cfft_sR_f32_len512;
-    	break;
     case RESOLUTION_800_480:	//FIXME: fill with correct values (move to layouts.c ??)
-    	sd.spec_len = 512;
-    	sd.fft_iq_len = 1024;
-    	sd.cfft_instance = &arm_cfft_sR_f32_len512;
+    default:
+    	spec_len = 512;
     	break;
     }
 
+    // the user may ask for a longer FFT for a finer resolution, the display size gives the minimum
+    if (ts.spectrum_fft_size > SPECTRUM_FFT_SIZE_MAX)
+    {
+        ts.spectrum_fft_size = SPECTRUM_FFT_SIZE_DEFAULT;
+    }
+    if ((SPECTRUM_FFT_LEN_MIN << ts.spectrum_fft_size) > spec_len)
+    {
+        spec_len = SPECTRUM_FFT_LEN_MIN << ts.spectrum_fft_size;
+    }
+
+    switch(spec_len)
+    {
+    case 256:
+        sd.cfft_instance = &arm_cfft_sR_f32_len256;
+        break;
+#ifdef USE_SPECTRUM_FFT_2048
+    case 1024:
+        sd.cfft_instance = &arm_cfft_sR_f32_len1024;
+        break;
+    case 2048:
+        sd.cfft_instance = &arm_cfft_sR_f32_len2048;
+        break;
+#endif
+    case 512:
+    default:
+        spec_len = 512;
+        sd.cfft_instance = &arm_cfft_sR_f32_len512;
+        break;
+    }
+
+    sd.spec_len = spec_len;
+    sd.fft_iq_len = 2 * spec_len;
+    UiSpectrum_InitHannWindow();
+
 
     sd.agc_rate = ((float32_t)ts.spectrum_agc_rate) / SPECTRUM_AGC_SCALING;	// calculate agc rate
     //
@@ -1020,6 +1143,12 @@ static void UiSpectrum_InitSpectrumDisplayData()
     // Load "top" color of palette (the 65th) with that to be used for the center grid color
     sd.waterfall_colours[NUMBER_WATERFALL_COLOURS] = sd.scope_centre_grid_colour_active;
 
+    // the palette is only used to fill the LCD line buffers, so we convert it once to the byte order these are sent in
+    for (uint16_t idx = 0; idx < NUMBER_WATERFALL_COLOURS + 1; idx++)
+    {
+        sd.waterfall_colours[idx] = UiLcdHy28_BulkPixel_LineBufferColor(sd.waterfall_colours[idx]);
+    }
+
     if (ts.spectrum_db_scale >= SCOPE_SCALE_NUM)
     {
     	ts.spectrum_db_scale = DB_DIV_ADJUST_DEFAULT;
@@ -1038,68 +1167,345 @@ static void UiSpectrum_InitSpectrumDisplayData()
     sd.scope_ystart = slayout.scope.y;
     sd.scope_size = slayout.scope.h;
     sd.wfall_ystart = slayout.wfall.y;
-    sd.wfall_size = slayout.wfall.h;
 
-    // now make sure we fit in
-    // please note, this works only if we have enough memory for have the lines
-    // otherwise we will reduce size of displayed waterfall
-    if((sd.wfall_size * slayout.scope.w) > sizeof(sd.waterfall))
+
+    for (uint16_t idx = 0; idx < slayout.scope.w; idx++)
+    {
+        sd.Old_PosData[idx] = sd.scope_ystart + sd.scope_size;
+    }
+
+    sd.wfall_contrast = (float)ts.waterfall.contrast / 100.0;		// calculate scaling for contrast
+
+    for (uint16_t marker_idx = 0; marker_idx < SPECTRUM_MAX_MARKER; marker_idx++)
     {
-        //sd.doubleWaterfallLine = 1;
+        sd.marker_line_pos_prev[marker_idx] = 0xffff; // off screen
+    }
+
+    sd.enabled		= 1;
+}
+
+/**
+ * @brief puts the hardware scrolled waterfall back to an unscrolled display, next waterfall update redraws all lines
+ */
+void UiSpectrum_WaterfallScrollReset()
+{
+    sd.wfall_scroll_valid = false;
+    sd.wfall_scroll_offset = 0;
+    UiLcdHy28_VerticalScrollOffset(0);
+    UiLcdHy28_VerticalScrollArea(slayout.wfall.x, slayout.wfall.w, slayout.wfall.y, slayout.wfall.h);
+}
+
+// The waterfall lines are kept in a compressed history which holds much more than a screen full of lines,
+// so that earlier activity can be reviewed (long press on the waterfall, then touch lower/upper half to page).
+//
+// Each line is quantized to 4 bit (16 of the 64 palette colors) and run length coded:
+//   code byte < 0xf0 : run of (code >> 4) + 1 pixels with value code & 0x0f
+//   code byte >= 0xf0: (code & 0x0f) + 1 bytes follow, each holding 2 literal pixels (low nibble first)
+// The newest line is always stored as is; once the next line comes in, it is recoded as xor against
+// that newer line if this is shorter (same center frequency only). Lines are read from newest to oldest
+// when drawing, so a delta line can always be resolved from the line drawn just before it.
+//
+// Stored line: [hdr 2][center freq 4][time 2][code bytes][hdr 2], hdr is the code length, bit 15 set for delta lines.
+// The trailing copy of the header allows walking backwards from the newest line.
+#ifndef WATERFALL_HISTORY_SIZE
+    #define WATERFALL_HISTORY_SIZE ((WATERFALL_HEIGHT+10)*(256+4)) // same amount of memory the uncompressed waterfall buffer used
+#endif
+
+#define WFALL_HIST_DELTA        0x8000
+#define WFALL_HIST_LEN_MASK     0x7fff
+#define WFALL_HIST_OVERHEAD     10
+#define WFALL_HIST_CODE_MAX     (SPECTRUM_WIDTH_MAX + 1) // worst case is one code byte per pixel
+
+typedef struct
+{
+    uint32_t head;      // buffer index where the next line is written
+    uint32_t tail;      // buffer index of the oldest line
+    uint32_t used;      // bytes in use
+    uint32_t rows;      // number of stored lines
+    uint16_t width;     // pixels per line
+    uint16_t newest_len;    // code length of the newest line
+    uint32_t newest_freq;
+    uint16_t newest_time;
+    uint8_t  newest[SPECTRUM_WIDTH_MAX];    // 4 bit values of the newest line
+
+    bool     active;    // history review mode, the waterfall does not move
+    bool     redraw;    // view changed, draw all lines
+    uint32_t view;      // lines between the newest line and the top line on screen
+} WaterfallHistory_t;
+
+typedef struct
+{
+    uint32_t pos;       // buffer index behind the next (older) line to read
+    uint32_t left;      // lines left to read
+    uint32_t freq;      // center frequency of the line in px
+    uint16_t time;      // time stamp (seconds) of the line in px
+    uint8_t  px[SPECTRUM_WIDTH_MAX];
+} WaterfallHistoryReader_t;
+
+static WaterfallHistory_t wfall_hist;
+static WaterfallHistoryReader_t wfall_hist_rd;
+static __MCHF_SPECIALMEM uint8_t wfall_hist_data[WATERFALL_HISTORY_SIZE];
+
+static void UiSpectrum_WaterfallHistoryWrite(uint32_t idx, const void* src, uint32_t len)
+{
+    const uint32_t first = (len < WATERFALL_HISTORY_SIZE - idx) ? len : WATERFALL_HISTORY_SIZE - idx;
+    memcpy(&wfall_hist_data[idx], src, first);
+    memcpy(&wfall_hist_data[0], (const uint8_t*)src + first, len - first);
+}
+
+static void UiSpectrum_WaterfallHistoryRead(uint32_t idx, void* dst, uint32_t len)
+{
+    const uint32_t first = (len < WATERFALL_HISTORY_SIZE - idx) ? len : WATERFALL_HISTORY_SIZE - idx;
+    memcpy(dst, &wfall_hist_data[idx], first);
+    memcpy((uint8_t*)dst + first, &wfall_hist_data[0], len - first);
+}
+
+static inline uint32_t UiSpectrum_WaterfallHistoryIdx(uint32_t idx, int32_t offset)
+{
+    return (idx + WATERFALL_HISTORY_SIZE + offset) % WATERFALL_HISTORY_SIZE;
+}
 
+/**
+ * @brief run length codes a line of 4 bit pixel values
+ * @returns number of code bytes
+ */
+static uint16_t UiSpectrum_WaterfallHistoryEncode(const uint8_t* px, uint16_t width, uint8_t* code)
+{
+    uint16_t len = 0;
+
+    for (uint16_t i = 0; i < width;)
+    {
+        uint16_t run = 1;
+        while (i + run < width && run < 15 && px[i + run] == px[i])
+        {
+            run++;
+        }
 
-        if (sd.wfall_size/2 * slayout.scope.w > sizeof(sd.waterfall))
+        if (run >= 3 || i + run == width)
         {
-            // we caculate how many lines we can do with the amount of memory
-            // and adjust displayed line count accordingly.
-            sd.wfall_size = sizeof(sd.waterfall)/(slayout.scope.w);
-            // FIXME: Notify user of issue
-            // if memory is too small even with doubled
-            // lines
+            code[len++] = ((run - 1) << 4) | px[i];
+            i += run;
         }
         else
         {
-            sd.wfall_size /= 2;
+            // collect pixel pairs until a run starts
+            uint16_t lit = len++;
+            uint8_t pairs = 0;
+            do
+            {
+                const uint8_t hi = (i + 1 < width) ? px[i + 1] : 0;
+                code[len++] = px[i] | (hi << 4);
+                i += 2;
+                pairs++;
+            } while (pairs < 16 && i + 2 < width && !(px[i] == px[i+1] && px[i] == px[i+2]));
+            code[lit] = 0xf0 | (pairs - 1);
         }
     }
- /*   else
+    return len;
+}
+
+/**
+ * @brief decodes a line into px, delta lines are xor-ed into the previous content of px
+ */
+static void UiSpectrum_WaterfallHistoryDecode(const uint8_t* code, uint16_t len, uint8_t* px, uint16_t width, bool delta)
+{
+    uint16_t i = 0;
+    for (const uint8_t* code_end = code + len; code < code_end && i < width; code++)
     {
-        sd.repeatWaterfallLine = 0;
-    }*/
+        if (*code < 0xf0)
+        {
+            const uint8_t val = *code & 0x0f;
+            for (uint16_t run = (*code >> 4) + 1; run && i < width; run--, i++)
+            {
+                px[i] = delta ? px[i] ^ val : val;
+            }
+        }
+        else
+        {
+            for (uint16_t pairs = (*code & 0x0f) + 1; pairs && code + 1 < code_end; pairs--)
+            {
+                code++;
+                for (uint8_t val = *code, n = 0; n < 2 && i < width; n++, i++, val >>= 4)
+                {
+                    px[i] = delta ? px[i] ^ (val & 0x0f) : (val & 0x0f);
+                }
+            }
+        }
+    }
+}
 
-    sd.repeatWaterfallLine = slayout.wfall.h/(sd.wfall_size);
+static void UiSpectrum_WaterfallHistoryPutLine(uint16_t hdr, uint32_t freq, uint16_t time, const uint8_t* code)
+{
+    const uint16_t len = hdr & WFALL_HIST_LEN_MASK;
+    const uint32_t size = len + WFALL_HIST_OVERHEAD;
 
-    //no need for this variable because we have slayout.wfall.h
-    //sd.wfall_disp_lines = sd.wfall_size * (sd.doubleWaterfallLine==true? 2:1);
+    // drop the oldest lines until the new one fits
+    while (wfall_hist.rows != 0 && wfall_hist.used + size > WATERFALL_HISTORY_SIZE)
+    {
+        uint16_t old_hdr;
+        UiSpectrum_WaterfallHistoryRead(wfall_hist.tail, &old_hdr, sizeof(old_hdr));
+        const uint32_t old_size = (old_hdr & WFALL_HIST_LEN_MASK) + WFALL_HIST_OVERHEAD;
+        wfall_hist.tail = UiSpectrum_WaterfallHistoryIdx(wfall_hist.tail, old_size);
+        wfall_hist.used -= old_size;
+        wfall_hist.rows--;
+    }
 
+    uint32_t idx = wfall_hist.head;
+    UiSpectrum_WaterfallHistoryWrite(idx, &hdr, sizeof(hdr));
+    idx = UiSpectrum_WaterfallHistoryIdx(idx, sizeof(hdr));
+    UiSpectrum_WaterfallHistoryWrite(idx, &freq, sizeof(freq));
+    idx = UiSpectrum_WaterfallHistoryIdx(idx, sizeof(freq));
+    UiSpectrum_WaterfallHistoryWrite(idx, &time, sizeof(time));
+    idx = UiSpectrum_WaterfallHistoryIdx(idx, sizeof(time));
+    UiSpectrum_WaterfallHistoryWrite(idx, code, len);
+    idx = UiSpectrum_WaterfallHistoryIdx(idx, len);
+    UiSpectrum_WaterfallHistoryWrite(idx, &hdr, sizeof(hdr));
+
+    wfall_hist.head = UiSpectrum_WaterfallHistoryIdx(wfall_hist.head, size);
+    wfall_hist.used += size;
+    wfall_hist.rows++;
+}
 
-    for (uint16_t idx = 0; idx < slayout.scope.w; idx++)
+/**
+ * @brief adds a line of 4 bit pixel values to the history
+ */
+static void UiSpectrum_WaterfallHistoryPush(const uint8_t* px, uint16_t width, uint32_t freq)
+{
+    static uint8_t code[WFALL_HIST_CODE_MAX];
+    const uint16_t time = ts.sysclock / 100;
+
+    if (width != wfall_hist.width)
     {
-        sd.Old_PosData[idx] = sd.scope_ystart + sd.scope_size;
+        UiSpectrum_WaterfallClearData();
+        wfall_hist.width = width;
     }
 
-    sd.wfall_contrast = (float)ts.waterfall.contrast / 100.0;		// calculate scaling for contrast
+    if (wfall_hist.rows != 0 && wfall_hist.newest_freq == freq)
+    {
+        // newest line becomes the line before the new one, store it as difference if this is shorter
+        for (uint16_t i = 0; i < width; i++)
+        {
+            wfall_hist.newest[i] ^= px[i];
+        }
+        const uint16_t len = UiSpectrum_WaterfallHistoryEncode(wfall_hist.newest, width, code);
+        if (len < wfall_hist.newest_len)
+        {
+            const uint32_t size = wfall_hist.newest_len + WFALL_HIST_OVERHEAD;
+            wfall_hist.head = UiSpectrum_WaterfallHistoryIdx(wfall_hist.head, -(int32_t)size);
+            wfall_hist.used -= size;
+            wfall_hist.rows--;
+            UiSpectrum_WaterfallHistoryPutLine(len | WFALL_HIST_DELTA, wfall_hist.newest_freq, wfall_hist.newest_time, code);
+        }
+    }
 
-    for (uint16_t marker_idx = 0; marker_idx < SPECTRUM_MAX_MARKER; marker_idx++)
+    wfall_hist.newest_len = UiSpectrum_WaterfallHistoryEncode(px, width, code);
+    wfall_hist.newest_freq = freq;
+    wfall_hist.newest_time = time;
+    memcpy(wfall_hist.newest, px, width);
+    UiSpectrum_WaterfallHistoryPutLine(wfall_hist.newest_len, freq, time, code);
+
+    if (wfall_hist.active && wfall_hist.view + 1 < wfall_hist.rows)
     {
-        sd.marker_line_pos_prev[marker_idx] = 0xffff; // off screen
+        wfall_hist.view++; // keep the reviewed lines in place
     }
+}
 
-    sd.enabled		= 1;
+static void UiSpectrum_WaterfallHistoryReaderStart(WaterfallHistoryReader_t* rd)
+{
+    rd->pos = wfall_hist.head;
+    rd->left = wfall_hist.rows;
+}
+
+/**
+ * @brief decodes the next older line into rd->px
+ * @returns false if there are no more lines
+ */
+static bool UiSpectrum_WaterfallHistoryReaderPrev(WaterfallHistoryReader_t* rd)
+{
+    static uint8_t code[WFALL_HIST_CODE_MAX];
+    bool retval = false;
+
+    if (rd->left != 0)
+    {
+        uint16_t hdr;
+        UiSpectrum_WaterfallHistoryRead(UiSpectrum_WaterfallHistoryIdx(rd->pos, -(int32_t)sizeof(hdr)), &hdr, sizeof(hdr));
+        const uint16_t len = hdr & WFALL_HIST_LEN_MASK;
+        rd->pos = UiSpectrum_WaterfallHistoryIdx(rd->pos, -(int32_t)(len + WFALL_HIST_OVERHEAD));
+
+        uint32_t idx = UiSpectrum_WaterfallHistoryIdx(rd->pos, sizeof(hdr));
+        UiSpectrum_WaterfallHistoryRead(idx, &rd->freq, sizeof(rd->freq));
+        idx = UiSpectrum_WaterfallHistoryIdx(idx, sizeof(rd->freq));
+        UiSpectrum_WaterfallHistoryRead(idx, &rd->time, sizeof(rd->time));
+        idx = UiSpectrum_WaterfallHistoryIdx(idx, sizeof(rd->time));
+        UiSpectrum_WaterfallHistoryRead(idx, code, len);
+
+        UiSpectrum_WaterfallHistoryDecode(code, len, rd->px, wfall_hist.width, (hdr & WFALL_HIST_DELTA) != 0);
+        rd->left--;
+        retval = true;
+    }
+    return retval;
+}
+
+bool UiSpectrum_WaterfallHistoryActive()
+{
+    return wfall_hist.active;
+}
+
+/**
+ * @brief enters waterfall history review half a waterfall height back in time, or returns to the live waterfall
+ */
+void UiSpectrum_WaterfallHistoryToggle()
+{
+    if (wfall_hist.active)
+    {
+        wfall_hist.active = false;
+        wfall_hist.view = 0;
+        sd.wfall_scroll_valid = false;
+    }
+    else if (is_waterfallmode() && slayout.wfall.h != 0)
+    {
+        wfall_hist.active = true;
+        wfall_hist.view = 0;
+        UiSpectrum_WaterfallHistoryPage(1);
+    }
+}
+
+/**
+ * @brief moves the reviewed part of the waterfall history by half a waterfall height per page
+ * @param pages positive moves back in time, negative towards the newest line. Going past the newest line ends the review.
+ */
+void UiSpectrum_WaterfallHistoryPage(int32_t pages)
+{
+    if (wfall_hist.active)
+    {
+        const int32_t max_view = wfall_hist.rows > slayout.wfall.h ? wfall_hist.rows - slayout.wfall.h : 0;
+        int32_t view = (int32_t)wfall_hist.view + pages * (slayout.wfall.h / 2);
+
+        if (view < 0 && wfall_hist.view == 0)
+        {
+            UiSpectrum_WaterfallHistoryToggle();
+        }
+        else
+        {
+            wfall_hist.view = view < 0 ? 0 : (view > max_view ? max_view : view);
+            wfall_hist.redraw = true;
+        }
+    }
 }
 
 void UiSpectrum_WaterfallClearData()
 {
-    // this assume sd.watefall being an array, not a pointer to one!
-    memset(sd.waterfall,0, sizeof(sd.waterfall));
-    memset(sd.waterfall_frequencies,0,sizeof(sd.waterfall_frequencies));
+    wfall_hist.head = 0;
+    wfall_hist.tail = 0;
+    wfall_hist.used = 0;
+    wfall_hist.rows = 0;
+    wfall_hist.view = 0;
+    wfall_hist.redraw = wfall_hist.active;
 }
 
 
 static void UiSpectrum_DrawWaterfall()
 {
-    sd.wfall_line %= sd.wfall_size; // make sure that the circular buffer is clipped to the size of the display area
-
     // Contrast:  100 = 1.00 multiply factor:  125 = multiply by 1.25 - "sd.wfall_contrast" already converted to 100=1.00
     arm_scale_f32(sd.FFT_Samples, sd.wfall_contrast, sd.FFT_Samples, sd.spec_len);
 
@@ -1114,8 +1520,8 @@ static void UiSpectrum_DrawWaterfall()
     }
 
     // After the above manipulation, clip the result to make sure that it is within the range of the palette table
-    //for(uint16_t i = 0; i < sd.spec_len; i++)
-    uint8_t  * const waterfallline_ptr = &sd.waterfall[sd.wfall_line*slayout.wfall.w];
+    // and store it with 4 bit resolution in the history. We use the reader buffer, it is refilled when drawing anyway.
+    uint8_t* const waterfallline_ptr = wfall_hist_rd.px;
 
     for(uint16_t i = 0; i < slayout.wfall.w; i++)
     {
@@ -1124,148 +1530,222 @@ static void UiSpectrum_DrawWaterfall()
             sd.FFT_Samples[i] = NUMBER_WATERFALL_COLOURS - 1;   // yes - clip it
         }
 
-        waterfallline_ptr[i] = sd.FFT_Samples[i]; // save the manipulated value in the circular waterfall buffer
-    }
-
-    sd.waterfall_frequencies[sd.wfall_line] = sd.FFT_frequency;
-    static uint8_t doubleLineStart=0;
-
-	// Draw lines from buffer
-    doubleLineStart--;			//changing the size of repeat of first line (for low RAM devices) to make it look more smooth
-    if(doubleLineStart==0xff)
-    {
-    	doubleLineStart=sd.repeatWaterfallLine;
-    	sd.wfall_line++;        // bump to the next line in the circular buffer for next go-around
+        waterfallline_ptr[i] = (uint8_t)sd.FFT_Samples[i] >> 2;
     }
 
-    uint32_t lptr = sd.wfall_line;      // get current line of "bottom" of waterfall in circular buffer
+    UiSpectrum_WaterfallHistoryPush(waterfallline_ptr, slayout.wfall.w, sd.FFT_frequency);
 
     sd.wfall_line_update++;                                 // update waterfall line count
     sd.wfall_line_update %= ts.waterfall.vert_step_size;    // clip it to number of lines per iteration
 
     if(!sd.wfall_line_update)                               // if it's count is zero, it's time to move the waterfall up
     {
-    	    // can't use modulo here, doesn't work if we use uint16_t,
-    	    // since it 0-1 == 65536 and not -1 (it is an unsigned integer after all)
-    	    lptr = lptr?lptr-1 : sd.wfall_size-1;
-
-        lptr %= sd.wfall_size;      // do modulus limit of spectrum high
+        const int32_t cur_center_hz = sd.FFT_frequency;
 
-        // set up LCD for bulk write, limited only to area of screen with waterfall display.  This allow data to start from the
-        // bottom-left corner and advance to the right and up to the next line automatically without ever needing to address
-        // the location of any of the display data - as long as we "blindly" write precisely the correct number of pixels per
-        // line and the number of lines.
+        // Since the last update everything moved down by vert_step_size lines. If the display can scroll and
+        // the old lines would be drawn exactly as they are on screen (same center frequency, same markers),
+        // we let the display controller move them and just draw the new lines at the top.
+        // Otherwise we redraw all lines.
+        uint16_t lines_to_draw = slayout.wfall.h;
 
-        UiLcdHy28_BulkPixel_OpenWrite(slayout.wfall.x, slayout.wfall.w, slayout.wfall.y, slayout.wfall.h);
+        bool scroll_ok = sd.wfall_scroll_valid
+                && sd.wfall_scroll_center_hz == cur_center_hz
+                && sd.wfall_scroll_marker_num == sd.marker_num;
 
-        uint16_t spectrum_pixel_buf[slayout.wfall.w];
+        for (uint16_t idx = 0; scroll_ok && idx < sd.marker_num; idx++)
+        {
+            scroll_ok = sd.wfall_scroll_marker_pos[idx] == marker_line_pixel_pos[idx];
+        }
 
-        const int32_t cur_center_hz = sd.FFT_frequency;
+        // in history review the lines on screen stay where they are, we draw only if the view or what the lines are based on changed
+        const bool history = wfall_hist.active;
+        if (history)
+        {
+            if (scroll_ok && wfall_hist.redraw == false)
+            {
+                lines_to_draw = 0;
+            }
+            else if (sd.wfall_scroll_offset != 0)
+            {
+                UiSpectrum_WaterfallScrollReset();
+            }
+        }
+        else if (scroll_ok && ts.waterfall.vert_step_size < slayout.wfall.h)
+        {
+            lines_to_draw = ts.waterfall.vert_step_size;
+            sd.wfall_scroll_offset = (sd.wfall_scroll_offset + slayout.wfall.h - lines_to_draw) % slayout.wfall.h;
+            UiLcdHy28_VerticalScrollOffset(sd.wfall_scroll_offset);
+        }
 
-        uint8_t doubleLine=doubleLineStart;
+        // screen line lcnt of the waterfall is stored in display memory line (sd.wfall_scroll_offset + lcnt) % slayout.wfall.h
+        // so we have to start a second bulk write at the top of the waterfall area once we reach that wrap point.
+        // without scrolling the offset stays 0 and we draw everything in one go.
+        const uint16_t lcnt_wrap = slayout.wfall.h - sd.wfall_scroll_offset;
 
-        // we update the display unless there is a ptt request, in this case we skip to the end.
-        for(uint16_t lcnt = 0; ts.ptt_req == false && lcnt < slayout.wfall.h;)                 // set up counter for number of lines defining height of waterfall
+        // skip the lines newer than the reviewed part of the history, we have to decode them nevertheless
+        // since older lines may be stored as difference to them
+        WaterfallHistoryReader_t* const rd = &wfall_hist_rd;
+        UiSpectrum_WaterfallHistoryReaderStart(rd);
+        for (uint32_t skip = history ? wfall_hist.view : 0; skip && lines_to_draw; skip--)
         {
-            uint8_t  * const waterfallline_ptr = &sd.waterfall[lptr*slayout.wfall.w];
-
+            UiSpectrum_WaterfallHistoryReaderPrev(rd);
+        }
 
-            const int32_t line_center_hz = sd.waterfall_frequencies[lptr];
+        uint16_t lcnt = 0;
+        uint16_t top_time = 0;
 
-            // if our old_center is lower than cur_center_hz -> find start idx in waterfall_line, end_idx is line end, and pad with black pixels;
-            // if our old_center is higher than cur_center_hz -> find start pixel x in end_idx is line end, first pad with black pixels until this point and then use pixel buffer;
-            // if identical -> well, no padding.
-            const int32_t diff_centers = (line_center_hz - cur_center_hz);
-            int32_t offset_pixel = diff_centers/sd.hz_per_pixel;
-            uint16_t pixel_start, pixel_count, left_padding_count, right_padding_count;
+        if (lines_to_draw != 0)
+        {
+            // set up LCD for bulk write, limited only to area of screen with waterfall display.  This allow data to start from the
+            // bottom-left corner and advance to the right and up to the next line automatically without ever needing to address
+            // the location of any of the display data - as long as we "blindly" write precisely the correct number of pixels per
+            // line and the number of lines.
 
+            UiLcdHy28_BulkPixel_OpenWrite(slayout.wfall.x, slayout.wfall.w, slayout.wfall.y + sd.wfall_scroll_offset, lines_to_draw < lcnt_wrap ? lines_to_draw : lcnt_wrap);
 
-            // here we actually create a single line pixel by pixel.
+            const uint16_t black = UiLcdHy28_BulkPixel_LineBufferColor(Black);
 
-            if (offset_pixel >= slayout.wfall.w || offset_pixel <= -slayout.wfall.w)
-            {
-                offset_pixel = slayout.wfall.w-1;
-            }
-            if (offset_pixel <= 0)
+            // the 16 stored levels spread over the full palette
+            uint16_t colours[16];
+            for (uint16_t idx = 0; idx < 16; idx++)
             {
-                                // we have to start -offset_pixel later and then pad with black
-                left_padding_count = 0;
-                pixel_start = -offset_pixel;
-                right_padding_count = -offset_pixel;
-                pixel_count = slayout.wfall.w + offset_pixel;
+                colours[idx] = sd.waterfall_colours[(idx << 2) | (idx >> 2)];
             }
-            else
+
+            // we update the display unless there is a ptt request, in this case we skip to the end.
+            while(ts.ptt_req == false && lcnt < lines_to_draw)                 // set up counter for number of lines defining height of waterfall
             {
-                // we to start with offset_pixel black padding  and then draw the pixels until we reach spectrum width
-                left_padding_count = offset_pixel;
-                pixel_start = 0;
-                right_padding_count = 0;
-                pixel_count = slayout.wfall.w - offset_pixel;
-            }
+                // we compose the line directly in the LCD driver's line buffer while the previous line is still being transferred
+                uint16_t* const spectrum_pixel_buf = UiLcdHy28_BulkPixel_LineBufferGet(slayout.wfall.w);
+                uint16_t* pixel_buf_ptr = &spectrum_pixel_buf[0];
 
+                if (UiSpectrum_WaterfallHistoryReaderPrev(rd) == false)
+                {
+                    // history does not reach back that far
+                    for(uint16_t i = 0; i < slayout.wfall.w; i++)
+                    {
+                        *pixel_buf_ptr++ = black;
+                    }
+                }
+                else
+                {
+                    if (lcnt == 0)
+                    {
+                        top_time = rd->time;
+                    }
 
-            uint16_t* pixel_buf_ptr = &spectrum_pixel_buf[0];
+                    const int32_t line_center_hz = rd->freq;
 
-            // fill from the left border with black pixels
-            for(uint16_t i = 0; i < left_padding_count; i++)
-            {
-                *pixel_buf_ptr++ = Black;
-            }
+                    // if our old_center is lower than cur_center_hz -> find start idx in waterfall_line, end_idx is line end, and pad with black pixels;
+                    // if our old_center is higher than cur_center_hz -> find start pixel x in end_idx is line end, first pad with black pixels until this point and then use pixel buffer;
+                    // if identical -> well, no padding.
+                    const int32_t diff_centers = (line_center_hz - cur_center_hz);
+                    int32_t offset_pixel = diff_centers/sd.hz_per_pixel;
+                    uint16_t pixel_start, pixel_count, left_padding_count, right_padding_count;
 
-            for(uint16_t idx = pixel_start, i = 0; i < pixel_count; i++,idx++)
-            {
-                *pixel_buf_ptr++ = sd.waterfall_colours[waterfallline_ptr[idx]];    // write to memory using waterfall color from palette
-            }
 
-            // fill to the right border with black pixels
-            for(uint16_t i = 0; i < right_padding_count; i++)
-            {
-                *pixel_buf_ptr++ = Black;
-            }
+                    // here we actually create a single line pixel by pixel.
 
-            for (uint16_t idx = 0; idx < sd.marker_num; idx ++)
-            {
-                // Place center line marker on screen:  Location [64] (the 65th) of the palette is reserved is a special color reserved for this
-                if (marker_line_pixel_pos[idx] < slayout.wfall.w)
-                {
-                    spectrum_pixel_buf[marker_line_pixel_pos[idx]] = sd.waterfall_colours[NUMBER_WATERFALL_COLOURS];
-                }
-            }
+                    if (offset_pixel >= slayout.wfall.w || offset_pixel <= -slayout.wfall.w)
+                    {
+                        offset_pixel = slayout.wfall.w-1;
+                    }
+                    if (offset_pixel <= 0)
+                    {
+                        // we have to start -offset_pixel later and then pad with black
+                        left_padding_count = 0;
+                        pixel_start = -offset_pixel;
+                        right_padding_count = -offset_pixel;
+                        pixel_count = slayout.wfall.w + offset_pixel;
+                    }
+                    else
+                    {
+                        // we to start with offset_pixel black padding  and then draw the pixels until we reach spectrum width
+                        left_padding_count = offset_pixel;
+                        pixel_start = 0;
+                        right_padding_count = 0;
+                        pixel_count = slayout.wfall.w - offset_pixel;
+                    }
 
+                    // fill from the left border with black pixels
+                    for(uint16_t i = 0; i < left_padding_count; i++)
+                    {
+                        *pixel_buf_ptr++ = black;
+                    }
+
+                    for(uint16_t idx = pixel_start, i = 0; i < pixel_count; i++,idx++)
+                    {
+                        *pixel_buf_ptr++ = colours[rd->px[idx]];    // write to memory using waterfall color from palette
+                    }
 
+                    // fill to the right border with black pixels
+                    for(uint16_t i = 0; i < right_padding_count; i++)
+                    {
+                        *pixel_buf_ptr++ = black;
+                    }
+                }
 
-            for(;doubleLine<sd.repeatWaterfallLine+1;doubleLine++)
-            {
-                UiLcdHy28_BulkPixel_PutBuffer(spectrum_pixel_buf, slayout.wfall.w);
-                lcnt++;
-                if(lcnt==slayout.wfall.h)	//preventing the window overlap if doubling oversize the display window
+                for (uint16_t idx = 0; idx < sd.marker_num; idx ++)
+                {
+                    // Place center line marker on screen:  Location [64] (the 65th) of the palette is reserved is a special color reserved for this
+                    if (marker_line_pixel_pos[idx] < slayout.wfall.w)
+                    {
+                        spectrum_pixel_buf[marker_line_pixel_pos[idx]] = sd.waterfall_colours[NUMBER_WATERFALL_COLOURS];
+                    }
+                }
+
+                if (lcnt == lcnt_wrap)
                 {
-                	break;
+                    UiLcdHy28_BulkPixel_CloseWrite();
+                    UiLcdHy28_BulkPixel_OpenWrite(slayout.wfall.x, slayout.wfall.w, slayout.wfall.y, lines_to_draw - lcnt);
                 }
+                UiLcdHy28_BulkPixel_LineBufferPut(spectrum_pixel_buf, slayout.wfall.w);
+                lcnt++;
             }
-            doubleLine=0;
-            lptr = lptr?lptr-1 : sd.wfall_size-1;
-            lptr %= sd.wfall_size;              // clip to display height
 
-        }
 
+            UiLcdHy28_BulkPixel_CloseWrite();                   // we are done updating the display - return to normal full-screen mode
+        }
 
-        UiLcdHy28_BulkPixel_CloseWrite();                   // we are done updating the display - return to normal full-screen mode
+        if (history)
+        {
+            if (lcnt == lines_to_draw && lcnt != 0)
+            {
+                // tell the user how old the top line on screen is
+                char txt[12];
+                snprintf(txt, sizeof(txt), "-%us", (unsigned int)(uint16_t)(ts.sysclock / 100 - top_time));
+                UiLcdHy28_PrintText(slayout.wfall.x + 2, slayout.wfall.y + 2, txt, White, Black, 0);
+                wfall_hist.redraw = false;
+            }
+            // we have to redraw all lines once the review ends
+            sd.wfall_scroll_valid = lcnt == lines_to_draw;
+        }
+        else
+        {
+            // remember what the lines on screen are based on, if we did not finish drawing them, we have to redraw all next time
+            sd.wfall_scroll_valid = UiLcdHy28_VerticalScrollAvailable() && lcnt == lines_to_draw;
+        }
+        sd.wfall_scroll_center_hz = cur_center_hz;
+        sd.wfall_scroll_marker_num = sd.marker_num;
+        for (uint16_t idx = 0; idx < sd.marker_num; idx++)
+        {
+            sd.wfall_scroll_marker_pos[idx] = marker_line_pixel_pos[idx];
+        }
     }
 
 }
 
-static float32_t  UiSpectrum_ScaleFFTValue(const float32_t value, float32_t* min_p)
+/**
+ * @brief reverses the order of the len elements in buf in place
+ */
+static void UiSpectrum_ReverseBins(float32_t buf[], uint16_t len)
 {
-    float32_t sig = sd.display_offset + Math_log10f_fast(value) * sd.db_scale;     // take FFT data, do a log10 and multiply it to scale 10dB (fixed)
-    // apply "AGC", vertical "sliding" offset (or brightness for waterfall)
-
-    if (sig < *min_p)
+    for (uint16_t lo = 0, hi = len - 1; lo < hi; lo++, hi--)
     {
-        *min_p = sig;
+        const float32_t tmp = buf[lo];
+        buf[lo] = buf[hi];
+        buf[hi] = tmp;
     }
-
-    return  (sig < 1)? 1 : sig;
 }
 
 static void UiSpectrum_ScaleFFT(float32_t dest[], float32_t source[], float32_t* min_p )
@@ -1273,22 +1753,36 @@ static void UiSpectrum_ScaleFFT(float32_t dest[], float32_t source[], float32_t*
     // not an in-place algorithm
     assert(dest != source);
 
-    for(uint16_t i = 0; i < (sd.spec_len/2); i++)
+    // source holds power values (squared magnitudes), 10*log10(p) == 20*log10(|X|),
+    // so we use half the dB/div scaling which is meant for magnitudes
+    const float32_t db_scale = sd.db_scale / 2;
+    const uint16_t half = sd.spec_len / 2;
+
+    // take FFT data, do a log10 and multiply it to scale 10dB (fixed)
+    // apply "AGC", vertical "sliding" offset (or brightness for waterfall)
+    // log10(x) = log2(x) * log10(2), so the whole line is a single block call
+    Math_log2f_fast_block(source, dest, db_scale * MATH_LOG10_2, sd.display_offset, sd.spec_len);
+
+    // the display wants both halves of the FFT output in reversed order
+    // dest[len-1-i] = src[i+half] for i < half, dest[len-1-i] = src[i-half] for i >= half
+    UiSpectrum_ReverseBins(&dest[0], half);
+    UiSpectrum_ReverseBins(&dest[half], half);
+
+    float32_t min_val;
+    uint32_t min_idx;
+    arm_min_f32(dest, sd.spec_len, &min_val, &min_idx);
+    if (min_val < *min_p)
     {
-        dest[sd.spec_len - i - 1] = UiSpectrum_ScaleFFTValue(source[i + sd.spec_len/2], min_p);
-        // take FFT data, do a log10 and multiply it to scale 10dB (fixed)
-        // apply "AGC", vertical "sliding" offset (or brightness for waterfall)
+        *min_p = min_val;
     }
 
-
-    for(uint16_t i = (sd.spec_len/2); i < (sd.spec_len); i++)
+    for(uint16_t i = 0; i < sd.spec_len; i++)
     {
-        // build right half of spectrum data
-        dest[sd.spec_len - i - 1] = UiSpectrum_ScaleFFTValue(source[i - sd.spec_len/2], min_p);
-        // take FFT data, do a log10 and multiply it to scale 10dB (fixed)
-        // apply "AGC", vertical "sliding" offset (or brightness for waterfall)
+        if (dest[i] < 1)
+        {
+            dest[i] = 1;
+        }
     }
-
 }
 
 /**
@@ -1338,6 +1832,908 @@ static void UiSpectrum_ScaleFFT2SpectrumWidth(float32_t samples[], uint16_t from
     while(idx_new < to_len);
 }
 
+// the FFT data is stored with the upper half of the spectrum first, display bin idx is fft bin (spec_len*3/2 - 1 - idx) % spec_len
+// see UiSpectrum_ScaleFFT
+static inline float32_t UiSpectrum_AvgDataDisplayBin(uint16_t idx)
+{
+    const uint16_t half = sd.spec_len / 2;
+    return sd.FFT_AVGData[idx < half ? half - 1 - idx : sd.spec_len - 1 - idx + half];
+}
+
+#define SPECTRUM_NF_BLOCK 8 // noise floor is tracked against the minimum of 3 blocks of this many bins around a bin
+#define SPECTRUM_NF_SETTLE_FRAMES 20 // frames to average the noise floor after initialization
+
+/**
+ * @brief minimum of the display bins of the block around idx and its neighbor blocks, this is where the noise
+ * floor of bin idx is pulled to. Signals narrower than a block do not affect it.
+ */
+static inline float32_t UiSpectrum_NoiseFloorTarget(const float32_t block_min[], uint16_t blocks, uint16_t idx)
+{
+    const uint16_t block = idx / SPECTRUM_NF_BLOCK;
+    float32_t target = block_min[block];
+    if (block > 0 && block_min[block - 1] < target)
+    {
+        target = block_min[block - 1];
+    }
+    if (block < blocks - 1 && block_min[block + 1] < target)
+    {
+        target = block_min[block + 1];
+    }
+    return target;
+}
+
+/**
+ * @brief adds a detected peak to the signal list or updates the matching entry
+ */
+static void UiSpectrum_SignalUpdate(uint32_t freq, float32_t snr, uint32_t tolerance)
+{
+    const uint32_t now = ts.sysclock;
+    int32_t match = -1;
+    uint32_t match_dist = tolerance + 1;
+    int32_t weakest = -1;
+
+    for (int32_t idx = 0; idx < sd.signals_num; idx++)
+    {
+        const uint32_t dist = sd.signals[idx].freq > freq ? sd.signals[idx].freq - freq : freq - sd.signals[idx].freq;
+        if (dist < match_dist && sd.signals[idx].last_seen != now)
+        {
+            match = idx;
+            match_dist = dist;
+        }
+        if (weakest < 0 || sd.signals[idx].snr < sd.signals[weakest].snr)
+        {
+            weakest = idx;
+        }
+    }
+
+    if (match < 0)
+    {
+        if (sd.signals_num < SPECTRUM_SIGNALS_MAX)
+        {
+            match = sd.signals_num++;
+        }
+        else if (sd.signals[weakest].snr < snr)
+        {
+            match = weakest;
+        }
+
+        if (match >= 0)
+        {
+            sd.signals[match].first_seen = now;
+        }
+    }
+
+    if (match >= 0)
+    {
+        // keep the list sorted by frequency
+        SpectrumSignal_t sig = { .freq = freq, .snr = snr, .first_seen = sd.signals[match].first_seen, .last_seen = now };
+        for (; match > 0 && sd.signals[match - 1].freq > freq; match--)
+        {
+            sd.signals[match] = sd.signals[match - 1];
+        }
+        for (; match < sd.signals_num - 1 && sd.signals[match + 1].freq < freq; match++)
+        {
+            sd.signals[match] = sd.signals[match + 1];
+        }
+        sd.signals[match] = sig;
+    }
+}
+
+/**
+ * @brief tracks the noise floor of each spectrum bin and maintains the list of active signals in sd.signals
+ *
+ * The noise floor of a bin follows the minimum of the surrounding bins, falling fast and rising by about 1dB/s,
+ * so neither narrow signals nor short wide ones (speech) pull it up. sd.signals_nf_bias scales it to the mean
+ * noise level. Peaks exceeding this level by ts.spectrum_signal_thresh are signals, one per contiguous range of bins
+ * above the threshold, their frequency is interpolated from the neighbor bins. Signals not seen for
+ * SPECTRUM_SIGNAL_HOLD_TICKS are dropped.
+ * This runs once per spectrum frame, the effort is a few operations per bin plus a little per peak.
+ */
+static void UiSpectrum_DetectSignals()
+{
+    if (ts.spectrum_signal_thresh == 0)
+    {
+        sd.signals_num = 0;
+        sd.signals_nf_len = 0;
+    }
+    else if (ts.txrx_mode == TRX_MODE_RX)
+    {
+        const uint16_t len = sd.spec_len;
+        const uint16_t blocks = len / SPECTRUM_NF_BLOCK;
+        const uint32_t now = ts.sysclock;
+        const float32_t bin_hz = IQ_SAMPLE_RATE_F / (len * (1 << sd.magnify));
+        float32_t* const nf = sd.FFT_NoiseFloor;
+
+        float32_t block_min[SPEC_BUFF_LEN / SPECTRUM_NF_BLOCK];
+        for (uint16_t block = 0, idx = 0; block < blocks; block++)
+        {
+            block_min[block] = UiSpectrum_AvgDataDisplayBin(idx++);
+            for (uint16_t end = idx + SPECTRUM_NF_BLOCK - 1; idx < end; idx++)
+            {
+                const float32_t p = UiSpectrum_AvgDataDisplayBin(idx);
+                if (p < block_min[block])
+                {
+                    block_min[block] = p;
+                }
+            }
+        }
+
+        // bins without a valid noise floor, e.g. after tuning, start from the target value
+        uint16_t init_start = 0, init_end = 0;
+
+        if (sd.signals_nf_len != len || sd.signals_nf_magnify != sd.magnify)
+        {
+            init_end = len;
+            sd.signals_nf_bias = 2.0;
+            sd.signals_nf_settle = SPECTRUM_NF_SETTLE_FRAMES;
+            sd.signals_nf_len = len;
+            sd.signals_nf_magnify = sd.magnify;
+            sd.signals_nf_frequency = sd.FFT_frequency;
+            sd.signals_nf_time = now;
+        }
+        else if (sd.signals_nf_frequency != sd.FFT_frequency)
+        {
+            // tuned, move the noise floor with the spectrum
+            const int32_t shift = roundf((int32_t)(sd.FFT_frequency - sd.signals_nf_frequency) / bin_hz);
+            if (shift >= len || shift <= -len)
+            {
+                init_end = len;
+                sd.signals_nf_frequency = sd.FFT_frequency;
+            }
+            else if (shift > 0)
+            {
+                memmove(&nf[0], &nf[shift], (len - shift) * sizeof(nf[0]));
+                init_start = len - shift;
+                init_end = len;
+                sd.signals_nf_frequency += roundf(shift * bin_hz);
+            }
+            else if (shift < 0)
+            {
+                memmove(&nf[-shift], &nf[0], (len + shift) * sizeof(nf[0]));
+                init_end = -shift;
+                sd.signals_nf_frequency += roundf(shift * bin_hz);
+            }
+        }
+
+        for (uint16_t idx = init_start; idx < init_end; idx++)
+        {
+            nf[idx] = UiSpectrum_NoiseFloorTarget(block_min, blocks, idx);
+        }
+
+        const uint32_t ticks = now - sd.signals_nf_time;
+        const float32_t rise = 1.0 + 0.0023 * (ticks < 100 ? ticks : 100);
+        const float32_t fall = 0.8;
+        sd.signals_nf_time = now;
+
+        if (sd.signals_nf_settle != 0)
+        {
+            // the first frames after (re)initialization are averaged to get a usable start value,
+            // a single frame is too noisy. We do not detect anything meanwhile.
+            sd.signals_nf_settle--;
+            for (uint16_t idx = 0; idx < len; idx++)
+            {
+                nf[idx] += 0.25 * (UiSpectrum_NoiseFloorTarget(block_min, blocks, idx) - nf[idx]);
+            }
+            return;
+        }
+
+        static uint8_t thresh_db = 0;
+        static float32_t thresh = 1.0;
+        if (thresh_db != ts.spectrum_signal_thresh)
+        {
+            thresh_db = ts.spectrum_signal_thresh;
+            thresh = Math_exp10f_fast(thresh_db / 10.0);
+        }
+        const float32_t peak_level = sd.signals_nf_bias * thresh;
+        float32_t noise_ratio_sum = 0;
+        uint16_t noise_bins = 0;
+
+        const uint32_t tolerance = bin_hz * 2 < 20 ? 20 : bin_hz * 2;
+        int32_t peak = -1;
+        float32_t peak_p = 0;
+
+        for (int32_t idx = 0; idx <= len; idx++)
+        {
+            const float32_t p = idx < len ? UiSpectrum_AvgDataDisplayBin(idx) : 0;
+
+            if (idx < len && p > nf[idx] * peak_level)
+            {
+                if (p > peak_p)
+                {
+                    peak = idx;
+                    peak_p = p;
+                }
+            }
+            else if (peak >= 0)
+            {
+                // end of a range of bins above the threshold, interpolate the peak frequency
+                // from the neighbor magnitudes (Jacobsen, see UiSpectrum_CalculateSnap)
+                float32_t delta = 0;
+                if (peak > 0 && peak < len - 1)
+                {
+                    const float32_t m1 = sqrtf(UiSpectrum_AvgDataDisplayBin(peak - 1));
+                    const float32_t m2 = sqrtf(peak_p);
+                    const float32_t m3 = sqrtf(UiSpectrum_AvgDataDisplayBin(peak + 1));
+                    delta = 1.36 * (m3 - m1) / (m1 + m2 + m3);
+                }
+                const uint32_t freq = sd.FFT_frequency + (int32_t)roundf((peak + delta + 0.5 - len / 2) * bin_hz);
+                UiSpectrum_SignalUpdate(freq, 10 * Math_log10f_fast(peak_p / (nf[peak] * sd.signals_nf_bias)), tolerance);
+                peak = -1;
+                peak_p = 0;
+            }
+
+            if (idx < len)
+            {
+                if (peak < 0)
+                {
+                    noise_ratio_sum += p / nf[idx];
+                    noise_bins++;
+                }
+                nf[idx] *= UiSpectrum_NoiseFloorTarget(block_min, blocks, idx) < nf[idx] ? fall : rise;
+            }
+        }
+
+        if (noise_bins != 0)
+        {
+            sd.signals_nf_bias += 0.1 * (noise_ratio_sum / noise_bins - sd.signals_nf_bias);
+        }
+
+        // remove the signals we have not seen for a while
+        uint8_t num = 0;
+        for (uint8_t idx = 0; idx < sd.signals_num; idx++)
+        {
+            if (now - sd.signals[idx].last_seen <= SPECTRUM_SIGNAL_HOLD_TICKS)
+            {
+                sd.signals[num++] = sd.signals[idx];
+            }
+        }
+        sd.signals_num = num;
+    }
+}
+
+/**
+ * @brief shows the detected signals as small markers in the top line of the scope
+ */
+static void UiSpectrum_DrawSignalMarkers()
+{
+    const uint16_t y = sd.scope_ystart;
+    const uint16_t marker_w = 3;
+    uint16_t marker_x[SPECTRUM_SIGNALS_MAX];
+    uint8_t num = 0;
+
+    for (uint8_t idx = 0; idx < sd.signals_num; idx++)
+    {
+        const float32_t pos = slayout.scope.w / 2 - 0.5 + (int32_t)(sd.signals[idx].freq - sd.FFT_frequency) / sd.hz_per_pixel;
+        if (pos >= 1 && pos < slayout.scope.w - 1)
+        {
+            marker_x[num++] = slayout.scope.x + (uint16_t)pos - 1;
+        }
+    }
+
+    // the top line may be a horizontal grid line
+    bool on_grid = false;
+    for (uint16_t idx = 0; idx < sd.upper_horiz_gridline; idx++)
+    {
+        on_grid |= sd.horz_grid_id[idx] == y;
+    }
+    const uint16_t clr_bg = on_grid ? sd.scope_grid_colour_active : Black;
+
+    for (uint8_t idx = 0; idx < sd.signals_marker_num; idx++)
+    {
+        bool keep = false;
+        for (uint8_t new_idx = 0; keep == false && new_idx < num; new_idx++)
+        {
+            keep = marker_x[new_idx] == sd.signals_marker_x[idx];
+        }
+        if (keep == false)
+        {
+            UiLcdHy28_DrawStraightLine(sd.signals_marker_x[idx], y, marker_w, LCD_DIR_HORIZONTAL, clr_bg);
+        }
+    }
+
+    for (uint8_t idx = 0; idx < num; idx++)
+    {
+        bool drawn = false;
+        for (uint8_t old_idx = 0; drawn == false && old_idx < sd.signals_marker_num; old_idx++)
+        {
+            drawn = marker_x[idx] == sd.signals_marker_x[old_idx];
+        }
+        if (drawn == false)
+        {
+            UiLcdHy28_DrawStraightLine(marker_x[idx], y, marker_w, LCD_DIR_HORIZONTAL, Yellow);
+        }
+        sd.signals_marker_x[idx] = marker_x[idx];
+    }
+    sd.signals_marker_num = num;
+}
+
+/**
+ * @returns true if nothing else (menu, memory display, virtual keys, resize) uses the spectrum area
+ */
+static bool UiSpectrum_IsRedrawActive()
+{
+    return (ts.menu_mode == false)
+            && (sd.enabled == true)
+            && (ts.mem_disp == false)
+            && (ts.SpectrumResize_flag == false)
+            && (ts.VirtualKeysShown_flag ==false);
+}
+
+#define SPECTRUM_SWEEP_GENERIC_SPAN     200000  // Hz, used for the band span outside of the ham bands
+#define SPECTRUM_SWEEP_DC_BINS          3       // bins on each side of the LO which are not used (DC spike)
+
+static const uint32_t spectrum_sweep_spans[SPECTRUM_SWEEP_SPAN_MAX + 1] = { 0, 100000, 200000, 500000, 1000000 };
+
+bool UiSpectrum_SweepActive()
+{
+    return spectrum_sweep.state == SWEEP_RUN;
+}
+
+/**
+ * @brief frequency in the middle of the panorama pixel x, only meaningful while the sweep is active
+ */
+uint32_t UiSpectrum_SweepFrequencyAt(uint16_t x)
+{
+    return spectrum_sweep.start + (uint32_t)((x + 0.5) * spectrum_sweep.hz_per_pixel);
+}
+
+static void UiSpectrum_SweepTune()
+{
+    const uint32_t lo_freq = spectrum_sweep.center - spectrum_sweep.lo_offset;
+
+    RadioManagement_TxRxSwitching_Disable();
+    spectrum_sweep.tuned = RadioManagement_ChangeSweepFrequency(lo_freq);
+    RadioManagement_TxRxSwitching_Enable();
+
+    if (spectrum_sweep.tuned)
+    {
+        spectrum_sweep.lo_freq = lo_freq;
+        spectrum_sweep.retune_time = ts.sysclock;
+        spectrum_sweep.frames = 0;
+        // audio is of no use while we hop around, keep it muted
+        RadioManagement_MuteTemporarilyRxAudio();
+    }
+}
+
+/**
+ * @returns true if the spectrum frame just finished was taken completely after the last LO change plus the settle time
+ */
+static bool UiSpectrum_SweepFrameIsClean()
+{
+    // time to fill the ring buffer with new samples, in zoom mode these come in at the decimated rate
+    const int32_t ring_ticks = (((uint32_t)sd.spec_len << sd.magnify) * 100) / IQ_SAMPLE_RATE + 1;
+
+    return (int32_t)(sd.welch_frame_start - spectrum_sweep.retune_time) > ring_ticks + ts.spectrum_sweep_settle;
+}
+
+/**
+ * @brief puts the averaged power of the current step into the panorama pixels it covers
+ */
+static void UiSpectrum_SweepStitch()
+{
+    const uint16_t len = sd.spec_len;
+    const float32_t bin_hz = IQ_SAMPLE_RATE_F / (len * (1 << sd.magnify));
+    const float32_t bins_per_pixel = spectrum_sweep.hz_per_pixel / bin_hz;
+    const float32_t gain = 1.0 / spectrum_sweep.frames;
+
+    // positions are counted in display bins, bin b covers [b, b+1)
+    const float32_t dc_pos = (int32_t)(spectrum_sweep.lo_freq - spectrum_sweep.center) / bin_hz + len / 2;
+    const float32_t start_pos = (int32_t)(spectrum_sweep.start - spectrum_sweep.center) / bin_hz + len / 2;
+
+    // only pixels completely inside the used part of the step
+    const int32_t low = spectrum_sweep.center - spectrum_sweep.half - spectrum_sweep.start;
+    int32_t x_start = ceilf(low / spectrum_sweep.hz_per_pixel);
+    int32_t x_end = floorf((low + 2 * (int32_t)spectrum_sweep.half) / spectrum_sweep.hz_per_pixel);
+
+    if (x_start < 0)
+    {
+        x_start = 0;
+    }
+    if (x_end > spectrum_sweep.width)
+    {
+        x_end = spectrum_sweep.width;
+    }
+
+    for (int32_t x = x_start; x < x_end; x++)
+    {
+        const float32_t pos = start_pos + x * bins_per_pixel;
+        int32_t b_start = floorf(pos);
+        int32_t b_end = ceilf(pos + bins_per_pixel);
+
+        if (b_start < 0)
+        {
+            b_start = 0;
+        }
+        if (b_end <= b_start)
+        {
+            b_end = b_start + 1;
+        }
+        if (b_end > len)
+        {
+            b_end = len;
+        }
+
+        // max of the bins, so that narrow signals are not lost in wide pixels
+        float32_t p = 0;
+        for (int32_t b = b_start; b < b_end; b++)
+        {
+            if (fabsf(b + 0.5f - dc_pos) >= SPECTRUM_SWEEP_DC_BINS)
+            {
+                const float32_t p_bin = UiSpectrum_AvgDataDisplayBin(b) * gain;
+                if (p_bin > p)
+                {
+                    p = p_bin;
+                }
+            }
+        }
+
+        if (p > 0)
+        {
+            if (spectrum_sweep.power_pass[x] != spectrum_sweep.pass || p > spectrum_sweep.power[x])
+            {
+                spectrum_sweep.power[x] = p;
+            }
+            spectrum_sweep.power_pass[x] = spectrum_sweep.pass;
+        }
+    }
+}
+
+static void UiSpectrum_SweepStart()
+{
+    const uint32_t dial = df.tune_new;
+    uint32_t span = spectrum_sweep_spans[ts.spectrum_sweep_span];
+    uint32_t start = 0;
+
+    if (ts.spectrum_sweep_span == SPECTRUM_SWEEP_SPAN_BAND)
+    {
+        const BandInfo* band = RadioManagement_GetBand(dial);
+        if (RadioManagement_IsGenericBand(band))
+        {
+            span = SPECTRUM_SWEEP_GENERIC_SPAN;
+        }
+        else
+        {
+            start = band->tune;
+            span = band->size;
+        }
+    }
+    if (start == 0)
+    {
+        start = dial > span / 2 ? dial - span / 2 : 0;
+    }
+
+    // we use 80% of the IQ bandwidth and step by 35% of it, so each part of the range is seen at least twice
+    const uint32_t iq_span = IQ_SAMPLE_RATE >> sd.magnify;
+
+    spectrum_sweep.start = start;
+    spectrum_sweep.stop = start + span;
+    spectrum_sweep.dial = dial;
+    spectrum_sweep.lo_offset = sd.FFT_frequency - ts.tune_freq;
+    spectrum_sweep.half = (iq_span * 2) / 5;
+    spectrum_sweep.step = (iq_span * 7) / 20;
+    spectrum_sweep.first = span > 2 * spectrum_sweep.half ? start + spectrum_sweep.half : start + span / 2;
+    spectrum_sweep.center = spectrum_sweep.first;
+    spectrum_sweep.magnify = sd.magnify;
+    spectrum_sweep.pass = 1;
+    spectrum_sweep.width = slayout.scope.w;
+    spectrum_sweep.hz_per_pixel = (float32_t)span / spectrum_sweep.width;
+    memset(spectrum_sweep.power_pass, 0, sizeof(spectrum_sweep.power_pass));
+
+    spectrum_sweep.state = SWEEP_RUN;
+    sd.signals_num = 0;
+    UiSpectrum_SweepTune();
+
+    if (UiSpectrum_IsRedrawActive())
+    {
+        UiSpectrum_Init(); // title, frequency bar and an empty scope for the panorama
+    }
+}
+
+static void UiSpectrum_SweepStop()
+{
+    spectrum_sweep.state = SWEEP_RESTORE;
+    spectrum_sweep.retune_time = ts.sysclock;
+
+    RadioManagement_TxRxSwitching_Disable();
+    RadioManagement_ChangeFrequency(false, df.tune_new, ts.txrx_mode);
+    RadioManagement_TxRxSwitching_Enable();
+
+    // the noise floor of the signal detection starts again from scratch
+    sd.signals_nf_len = 0;
+
+    if (UiSpectrum_IsRedrawActive())
+    {
+        UiSpectrum_Init();
+    }
+}
+
+/**
+ * @brief starts the band sweep across the range selected in the menu, or stops it if it is active.
+ * Only in RX with the scope enabled.
+ */
+void UiSpectrum_SweepToggle()
+{
+    if (spectrum_sweep.state == SWEEP_RUN)
+    {
+        UiSpectrum_SweepStop();
+    }
+    else if (is_scopemode() && ts.txrx_mode == TRX_MODE_RX && ts.tune == false)
+    {
+        UiSpectrum_SweepStart();
+    }
+}
+
+/**
+ * @brief called for each finished spectrum frame while the band sweep is not off, the frame is used only by the sweep
+ */
+static void UiSpectrum_SweepFrame()
+{
+    if (spectrum_sweep.state == SWEEP_RESTORE)
+    {
+        if (ts.tune_freq != ts.tune_freq_req)
+        {
+            // the LO change back to the dial frequency is still pending
+            spectrum_sweep.retune_time = ts.sysclock;
+        }
+        else if (UiSpectrum_SweepFrameIsClean())
+        {
+            // restart the averaging of the live spectrum with a clean frame
+            arm_copy_f32(sd.FFT_MagData, sd.FFT_AVGData, sd.spec_len);
+            spectrum_sweep.state = SWEEP_OFF;
+        }
+    }
+    else if (ts.txrx_mode != TRX_MODE_RX || ts.tune || df.tune_new != spectrum_sweep.dial
+            || sd.magnify != spectrum_sweep.magnify || slayout.scope.w != spectrum_sweep.width
+            || (spectrum_sweep.tuned && ts.tune_freq != spectrum_sweep.lo_freq))
+    {
+        // the user or someone else tuned or changed the spectrum, the sweep is over
+        UiSpectrum_SweepStop();
+    }
+    else if (spectrum_sweep.tuned == false)
+    {
+        UiSpectrum_SweepTune();
+    }
+    else if (UiSpectrum_SweepFrameIsClean())
+    {
+        if (spectrum_sweep.frames == 0)
+        {
+            arm_copy_f32(sd.FFT_MagData, sd.FFT_AVGData, sd.spec_len);
+        }
+        else
+        {
+            arm_add_f32(sd.FFT_MagData, sd.FFT_AVGData, sd.FFT_AVGData, sd.spec_len);
+        }
+        spectrum_sweep.frames++;
+
+        if (spectrum_sweep.frames >= ts.spectrum_sweep_frames)
+        {
+            UiSpectrum_SweepStitch();
+
+            if (spectrum_sweep.center + spectrum_sweep.half >= spectrum_sweep.stop)
+            {
+                // range done, next pass
+                spectrum_sweep.pass = spectrum_sweep.pass == UINT8_MAX ? 1 : spectrum_sweep.pass + 1;
+                spectrum_sweep.center = spectrum_sweep.first;
+            }
+            else
+            {
+                spectrum_sweep.center += spectrum_sweep.step;
+                if (spectrum_sweep.center + spectrum_sweep.half > spectrum_sweep.stop)
+                {
+                    spectrum_sweep.center = spectrum_sweep.stop - spectrum_sweep.half;
+                }
+            }
+            UiSpectrum_SweepTune();
+        }
+    }
+}
+
+/**
+ * @brief draws the panorama into the scope area, the weakest pixel is at the bottom, the dB/div setting of the scope applies
+ */
+static void UiSpectrum_DrawSweep()
+{
+    const uint16_t spec_height_limit = sd.scope_size - 1;
+    const uint16_t spec_top_y = sd.scope_ystart + sd.scope_size;
+    // sd.db_scale includes the gain correction for the downscaling of the live spectrum, the panorama has none
+    const float32_t db_scale = sd.db_scale * sd.spec_len / slayout.scope.w / 2;
+
+    uint32_t clr_scope;
+    UiMenu_MapColors(ts.scope_trace_colour, NULL, &clr_scope);
+
+    float32_t floor_power = 0;
+    for (uint16_t idx = 0; idx < spectrum_sweep.width; idx++)
+    {
+        if (spectrum_sweep.power_pass[idx] != 0 && (floor_power == 0 || spectrum_sweep.power[idx] < floor_power))
+        {
+            floor_power = spectrum_sweep.power[idx];
+        }
+    }
+    const float32_t floor_log = floor_power > 0 ? Math_log10f_fast(floor_power) : 0;
+
+    // heights of all pixels in one go, sd.FFT_Samples is free at this stage of the redraw (no ScaleFFT while sweeping)
+    float32_t* heights = sd.FFT_Samples;
+    Math_log2f_fast_block(spectrum_sweep.power, heights, db_scale * MATH_LOG10_2, 1 - floor_log * db_scale, spectrum_sweep.width);
+
+    // the dial frequency is marked like the carrier line of the live scope
+    const int32_t dial_x = (int32_t)(RadioManagement_GetRXDialFrequency() - spectrum_sweep.start) / spectrum_sweep.hz_per_pixel;
+    const uint16_t marker_x = (dial_x >= 0 && dial_x < spectrum_sweep.width) ? slayout.scope.x + dial_x : 0xffff;
+
+    if (marker_x != sd.marker_line_pos_prev[0] && sd.marker_line_pos_prev[0] != 0xffff)
+    {
+        UiSpectrum_ScopeStandard_UpdateVerticalDataLine(sd.marker_line_pos_prev[0], spec_top_y - spec_height_limit, spec_top_y, clr_scope, Black, false);
+        sd.Old_PosData[sd.marker_line_pos_prev[0] - slayout.scope.x] = spec_top_y;
+    }
+    sd.marker_line_pos_prev[0] = marker_x;
+
+    // we stop if there is a ptt_request and go straight out of the display update
+    for(uint16_t x = slayout.scope.x, idx = 0; ts.ptt_req == false && idx < spectrum_sweep.width; x++, idx++)
+    {
+        const float32_t height = spectrum_sweep.power_pass[idx] != 0 ? heights[idx] : 0;
+        const uint16_t y_height = height < spec_height_limit ? height : spec_height_limit;
+        const uint16_t y_new_pos = spec_top_y - y_height;
+        const uint16_t y_old_pos = sd.Old_PosData[idx];
+        sd.Old_PosData[idx] = y_new_pos;
+
+        if (x == marker_x)
+        {
+            if (y_height < spec_height_limit)
+            {
+                UiLcdHy28_DrawStraightLine(x, spec_top_y - spec_height_limit, spec_height_limit - y_height, LCD_DIR_VERTICAL, sd.scope_centre_grid_colour_active);
+            }
+            if (y_height > 0)
+            {
+                UiLcdHy28_DrawStraightLine(x, y_new_pos, y_height, LCD_DIR_VERTICAL, clr_scope);
+            }
+        }
+        else
+        {
+            UiSpectrum_ScopeStandard_UpdateVerticalDataLine(x, y_old_pos, y_new_pos, clr_scope, Black, false);
+        }
+    }
+}
+
+#ifdef USE_FT8_DECODER
+/**
+ * @brief shows the messages decoded in the last FT8 slot below the title, one "snr freq text" line each, CQ calls in green
+ * Redraws only if there is a new decode result or the list was overwritten.
+ */
+static void UiSpectrum_DrawFt8List()
+{
+    if (spectrum_ft8.valid == false || spectrum_ft8.slot_count != ft8_result.slot_count)
+    {
+        spectrum_ft8.valid = true;
+        spectrum_ft8.slot_count = ft8_result.slot_count;
+
+        const uint16_t x = slayout.scope.x;
+        const uint16_t y = slayout.scope.y;
+        const uint16_t w = slayout.scope.w;
+        const uint16_t h = slayout.draw.y + slayout.draw.h - y;
+        const uint16_t line_h = UiLcdHy28_TextHeight(0) + 2;
+        // font 0 is a fixed width font
+        const uint16_t chars = (w - 4) / UiLcdHy28_TextWidth("0", 0);
+
+        UiLcdHy28_DrawFullRect(x, y, h, w, Black);
+
+        char txt[FT8_TEXT_LEN + 16];
+        if (ft8_result.slot_count == 0)
+        {
+            snprintf(txt, sizeof(txt), "FT8: waiting for the end of a slot");
+        }
+        else
+        {
+            snprintf(txt, sizeof(txt), "FT8 slot :%02u  %u decoded%s", ft8_result.slot_second, ft8_result.count,
+                    ft8_result.overruns ? "  overruns!" : "");
+        }
+        txt[chars < sizeof(txt) ? chars : sizeof(txt) - 1] = '\0';
+        UiLcdHy28_PrintText(x + 2, y + 1, txt, Grey, Black, 0);
+
+        uint16_t line_y = y + 1 + line_h;
+        for (uint8_t idx = 0; idx < ft8_result.count && line_y + line_h <= y + h; idx++, line_y += line_h)
+        {
+            const ft8_message_t* msg = &ft8_result.messages[idx];
+            snprintf(txt, sizeof(txt), "%+03d %4u %s", msg->snr, msg->freq, msg->text);
+            txt[chars < sizeof(txt) ? chars : sizeof(txt) - 1] = '\0';
+            UiLcdHy28_PrintText(x + 2, line_y, txt, strncmp(msg->text, "CQ ", 3) == 0 ? Green : White, Black, 0);
+        }
+    }
+}
+#endif
+
+/**
+ * @brief 2^n of the FFT bins are merged into one streamed bin, at least as many as needed to stay within SPECTRUM_STREAM_BINS_MAX
+ */
+static uint8_t UiSpectrum_StreamReduce()
+{
+    uint8_t reduce = spectrum_stream.reduce;
+    while ((sd.spec_len >> reduce) > SPECTRUM_STREAM_BINS_MAX)
+    {
+        reduce++;
+    }
+    return reduce;
+}
+
+/**
+ * @brief start, stop or change the spectrum stream to the host (CAT interface)
+ * @param fps max. number of frames per second, 0 stops the stream, limited to SPECTRUM_STREAM_FPS_MAX
+ * @param reduce 2^reduce bins are merged into one streamed bin, limited to SPECTRUM_STREAM_REDUCE_MAX
+ * @returns number of bins per frame, 0 if the stream is off
+ */
+uint16_t UiSpectrum_StreamConfigure(uint8_t fps, uint8_t reduce)
+{
+    spectrum_stream.fps = fps < SPECTRUM_STREAM_FPS_MAX ? fps : SPECTRUM_STREAM_FPS_MAX;
+    spectrum_stream.reduce = reduce < SPECTRUM_STREAM_REDUCE_MAX ? reduce : SPECTRUM_STREAM_REDUCE_MAX;
+    spectrum_stream.bins = 0; // the next frame will be a key frame
+
+    return spectrum_stream.fps != 0 ? sd.spec_len >> UiSpectrum_StreamReduce() : 0;
+}
+
+uint8_t UiSpectrum_StreamRate()
+{
+    return spectrum_stream.fps;
+}
+
+static uint8_t UiSpectrum_StreamCode(float32_t level, int16_t ref)
+{
+    const float32_t code = level - ref + 0.5f;
+    return code < 0 ? 0 : (code > 255 ? 255 : (uint8_t)code);
+}
+
+/**
+ * @brief sends the averaged spectrum to the host if the stream is on and a frame is due
+ *
+ * Frames are sent unsolicited on the CAT interface, all values little endian:
+ *  0  'U' 'S'
+ *  2  'K' key frame: payload are the bins as 8 bit codes
+ *     'D' delta frame: payload bytes 0x80 | (n-1) skip n unchanged bins, other bytes are a 7 bit signed change of one bin
+ *  3  frame counter
+ *  4  center frequency in Hz (4 bytes)
+ *  8  span in Hz (4 bytes)
+ * 12  number of bins (2 bytes), lowest frequency first
+ * 14  level of code 0 in 0.5dB units (2 bytes, signed), a code step is 0.5dB, same reference as the scope
+ * 16  payload length (2 bytes)
+ * 18  payload, followed by the 8 bit sum of all bytes before it
+ *
+ * Frames are skipped if the host does not read fast enough, the frame counter shows that,
+ * a lost delta frame leaves errors until the next key frame.
+ */
+static void UiSpectrum_StreamFrame()
+{
+    SpectrumStream_t* const st = &spectrum_stream;
+
+    if (st->fps == 0 || ts.sysclock - st->last_time < 100 / st->fps)
+    {
+        return;
+    }
+    if (CatDriver_GetInterfaceState() != CAT_CONNECTED)
+    {
+        // the host is gone, a new one has to ask for the stream again
+        st->fps = 0;
+        return;
+    }
+
+    const uint8_t reduce = UiSpectrum_StreamReduce();
+    const uint16_t bins = sd.spec_len >> reduce;
+    const uint16_t half = sd.spec_len / 2;
+    const uint32_t span = IQ_SAMPLE_RATE >> sd.magnify;
+
+    // no room for a key frame, the host does not keep up, try again with the next spectrum
+    if (CatDriver_StreamSpace() < SPECTRUM_STREAM_HEADER_LEN + bins + 1)
+    {
+        return;
+    }
+
+    // levels in 0.5dB units in display order, merged bins take the strongest one
+    float32_t* const level = sd.FFT_Samples;
+    for (uint16_t k = 0, d = 0; k < bins; k++)
+    {
+        float32_t p = 0;
+        for (uint16_t m = 0; m < (1 << reduce); m++, d++)
+        {
+            const float32_t v = sd.FFT_AVGData[d < half ? half - 1 - d : sd.spec_len - 1 - d + half];
+            if (v > p)
+            {
+                p = v;
+            }
+        }
+        level[k] = p;
+    }
+    Math_log2f_fast_block(level, level, 20 * MATH_LOG10_2, 0, bins);
+
+    uint8_t* const payload = &st->frame[SPECTRUM_STREAM_HEADER_LEN];
+    uint16_t len = 0;
+    bool key = st->key_countdown == 0 || st->bins != bins || st->center != sd.FFT_frequency || st->span != span;
+
+    if (key == false)
+    {
+        // changes beyond 7 bit are caught up in the next frames, last[] always holds what the host has
+        uint16_t run = 0;
+        for (uint16_t k = 0; k < bins && len < bins; k++)
+        {
+            int32_t diff = UiSpectrum_StreamCode(level[k], st->ref) - st->last[k];
+            if (diff >= -SPECTRUM_STREAM_DEADBAND && diff <= SPECTRUM_STREAM_DEADBAND)
+            {
+                if (++run == 128)
+                {
+                    payload[len++] = 0xff;
+                    run = 0;
+                }
+            }
+            else
+            {
+                if (run != 0)
+                {
+                    payload[len++] = 0x80 | (run - 1);
+                    run = 0;
+                }
+                diff = diff < -64 ? -64 : (diff > 63 ? 63 : diff);
+                st->last[k] += diff;
+                payload[len++] = diff & 0x7f;
+            }
+        }
+        if (run != 0 && len < bins)
+        {
+            payload[len++] = 0x80 | (run - 1);
+        }
+        // a noisy spectrum may not get smaller by delta encoding
+        key = len >= bins;
+        st->key_countdown--;
+    }
+
+    if (key)
+    {
+        // code 0 is 6dB below the weakest bin, leaves room for the floor to move until the next key frame
+        float32_t level_min;
+        uint32_t level_min_idx;
+        arm_min_f32(level, bins, &level_min, &level_min_idx);
+        st->ref = floorf(level_min) - 12;
+
+        for (uint16_t k = 0; k < bins; k++)
+        {
+            payload[k] = st->last[k] = UiSpectrum_StreamCode(level[k], st->ref);
+        }
+        len = bins;
+        st->key_countdown = SPECTRUM_STREAM_KEY_INTERVAL;
+        st->center = sd.FFT_frequency;
+        st->span = span;
+        st->bins = bins;
+    }
+
+    uint8_t* const h = st->frame;
+    h[0] = 'U';
+    h[1] = 'S';
+    h[2] = key ? 'K' : 'D';
+    h[3] = st->seq++;
+    h[4] = sd.FFT_frequency;
+    h[5] = sd.FFT_frequency >> 8;
+    h[6] = sd.FFT_frequency >> 16;
+    h[7] = sd.FFT_frequency >> 24;
+    h[8] = span;
+    h[9] = span >> 8;
+    h[10] = span >> 16;
+    h[11] = span >> 24;
+    h[12] = bins;
+    h[13] = bins >> 8;
+    h[14] = (uint16_t)st->ref;
+    h[15] = (uint16_t)st->ref >> 8;
+    h[16] = len;
+    h[17] = len >> 8;
+
+    uint8_t sum = 0;
+    for (uint16_t idx = 0; idx < SPECTRUM_STREAM_HEADER_LEN + len; idx++)
+    {
+        sum += h[idx];
+    }
+    payload[len] = sum;
+
+    if (CatDriver_StreamPutData(st->frame, SPECTRUM_STREAM_HEADER_LEN + len + 1) == false)
+    {
+        // the host did not get it, start over with a key frame
+        st->bins = 0;
+    }
+    st->last_time = ts.sysclock;
+}
+
 // Spectrum Display code rewritten by C. Turner, KA7OEI, September 2014, May 2015
 // Waterfall Display code written by C. Turner, KA7OEI, May 2015 entirely from "scratch"
 // - which is to say that I did not borrow any of it
@@ -1349,17 +2745,37 @@ static void UiSpectrum_ScaleFFT2SpectrumWidth(float32_t samples[], uint16_t from
  */
 static void UiSpectrum_RedrawSpectrum()
 {
-	bool is_RedrawActive=(ts.menu_mode == false)					//if this flag is false we do only dBm calculation (for S-meter and tune helper)
-						&& (sd.enabled == true)
-						&& (ts.mem_disp == false)
-						&& (ts.SpectrumResize_flag == false)
-						&& (ts.VirtualKeysShown_flag ==false);
+	bool is_RedrawActive=UiSpectrum_IsRedrawActive();			//if this flag is false we do only dBm calculation (for S-meter and tune helper)
 
 
     // Process implemented as state machine
     switch(sd.state)
     {
     case 0:
+    {
+        // Welch method: the spectrum frame is the average of several overlapping, windowed FFT segments.
+        // A new segment is started only if enough new samples have arrived in the ring buffer
+        // for the configured overlap, so we don't waste cycles transforming (almost) the same data again
+        // just because we are called often.
+        const uint32_t samp_count = sd.samp_count;
+        const uint32_t hop = (sd.spec_len * (4 - ts.spectrum_welch_overlap)) / 4;
+
+        if (samp_count - sd.welch_samp_count < hop)
+        {
+            // in zoom mode samples arrive slowly, we finish the frame with what we have
+            // once its time budget is used up, otherwise S-Meter and scope would get sluggish
+            if (sd.welch_segments != 0 && ts.sysclock - sd.welch_frame_start >= SPECTRUM_WELCH_FRAME_TICKS)
+            {
+                sd.state = 3;
+            }
+            break;
+        }
+        sd.welch_samp_count = samp_count;
+        if (sd.welch_segments == 0)
+        {
+            sd.welch_frame_start = ts.sysclock;
+        }
+
         sd.reading_ringbuffer = true;
         __DSB();
         // we make sure the interrupt sees this variable value by ensure all memory operations have been done
@@ -1378,7 +2794,8 @@ static void UiSpectrum_RedrawSpectrum()
 
         sd.state++;
         break;
-    case 1:		// Do FFT and calculate complex magnitude
+    }
+    case 1:		// Do FFT
     {
         arm_cfft_f32(sd.cfft_instance, sd.FFT_Samples,0,1);	// Do FFT
         sd.state++;
@@ -1386,8 +2803,34 @@ static void UiSpectrum_RedrawSpectrum()
     }
     case 2:
     {
-        // Calculate magnitude
-        arm_cmplx_mag_f32( sd.FFT_Samples, sd.FFT_MagData ,sd.spec_len);
+        // Calculate power and accumulate it for the Welch average,
+        // we never need the magnitude itself, so there is no square root here
+        if (sd.welch_segments == 0)
+        {
+            arm_cmplx_mag_squared_f32(sd.FFT_Samples, sd.FFT_MagData, sd.spec_len);
+        }
+        else
+        {
+            // in place is okay, the output index never overtakes the input index
+            arm_cmplx_mag_squared_f32(sd.FFT_Samples, sd.FFT_Samples, sd.spec_len);
+            arm_add_f32(sd.FFT_Samples, sd.FFT_MagData, sd.FFT_MagData, sd.spec_len);
+        }
+        sd.welch_segments++;
+
+        // get the next segment unless we have all of them for this frame
+        sd.state = sd.welch_segments < ts.spectrum_welch_avg ? 0 : 3;
+        break;
+    }
+
+    //  Low-pass filter power data
+    case 3:
+    {
+        if (sd.welch_segments > 1)
+        {
+            arm_scale_f32(sd.FFT_MagData, 1.0 / sd.welch_segments, sd.FFT_MagData, sd.spec_len);
+        }
+        sd.welch_segments = 0;
+
         // FIXME:
 
         // just for debugging purposes
@@ -1398,7 +2841,8 @@ static void UiSpectrum_RedrawSpectrum()
         	{
         	for(int bindx = 0; bindx < nr_params.NR_FFT_L / 2; bindx++)
         	{
-        		sd.FFT_MagData[(nr_params.NR_FFT_L / 2 - 1) - bindx] = NR2.Hk[bindx] * 150.0;
+        		const float32_t gain_mag = NR2.Hk[bindx] * 150.0;
+        		sd.FFT_MagData[(nr_params.NR_FFT_L / 2 - 1) - bindx] = gain_mag * gain_mag;
         	}
         	}
         	/*        	else
@@ -1420,17 +2864,26 @@ static void UiSpectrum_RedrawSpectrum()
         	// set all other pixels to a low value
         	for(int bindx = nr_params.NR_FFT_L / 2; bindx < sd.spec_len; bindx++)
         	{
-        		sd.FFT_MagData[bindx] = 10.0;
+        		sd.FFT_MagData[bindx] = 10000.0; // FFT_MagData is power, this is the former magnitude of 100
         	}
         }
 
-        sd.state++;
-        break;
-    }
+        if (spectrum_sweep.state != SWEEP_OFF)
+        {
+            // frames taken during the band sweep are for the panorama only, the live spectrum, S-Meter
+            // and signal detection pause. Nothing to scale, the panorama is drawn directly when due.
+            UiSpectrum_SweepFrame();
+            if (spectrum_sweep.state == SWEEP_RUN && is_RedrawActive && (sd.RedrawType & Redraw_SCOPE))
+            {
+                sd.state = 5;
+            }
+            else
+            {
+                sd.state = 0;
+            }
+            break;
+        }
 
-    //  Low-pass filter amplitude magnitude data
-    case 3:
-    {
     	float32_t filt_factor = 1/(float)ts.spectrum_filter;		// use stored filter setting inverted to allow multiplication
         arm_scale_f32(sd.FFT_AVGData, filt_factor, sd.FFT_Samples, sd.spec_len);	// get scaled version of previous data
         arm_sub_f32(sd.FFT_AVGData, sd.FFT_Samples, sd.FFT_AVGData, sd.spec_len);	// subtract scaled information from old, average data
@@ -1446,6 +2899,26 @@ static void UiSpectrum_RedrawSpectrum()
         }
 
         UiSpectrum_CalculateDBm();
+        UiSpectrum_DetectSignals();
+        UiSpectrum_StreamFrame();
+
+#ifdef USE_FT8_DECODER
+        if (is_demod_ft8())
+        {
+            // scope, waterfall and frequency bar are inactive, the area shows the decoded messages
+            if (is_RedrawActive)
+            {
+                UiSpectrum_DrawFt8List();
+            }
+            else
+            {
+                spectrum_ft8.valid = false;
+            }
+            sd.RedrawType = 0;
+            sd.state = 0;
+            break;
+        }
+#endif
 
         if (is_RedrawActive)
         {   //continue if there is no objection to display spectrum or waterfall
@@ -1492,10 +2965,18 @@ static void UiSpectrum_RedrawSpectrum()
     	{
     		if(sd.RedrawType&Redraw_SCOPE)
     		{
-    			UiSpectrum_DrawScope(sd.Old_PosData, sd.FFT_Samples);
+    			if (spectrum_sweep.state == SWEEP_RUN)
+    			{
+    				UiSpectrum_DrawSweep();
+    			}
+    			else
+    			{
+    				UiSpectrum_DrawScope(sd.Old_PosData, sd.FFT_Samples);
+    				UiSpectrum_DrawSignalMarkers();
+    			}
     		}
 
-    		if(sd.RedrawType&Redraw_WATERFALL)
+    		if((sd.RedrawType&Redraw_WATERFALL) && spectrum_sweep.state != SWEEP_RUN)
     		{
     			UiSpectrum_DrawWaterfall();
     		}
@@ -1621,7 +3102,11 @@ void UiSpectrum_CalculateDisplayFilterBW(float32_t* width_pixel_, float32_t* lef
 void UiSpectrum_DisplayFilterBW()
 {
 
-    if((ts.menu_mode == 0) && (ts.VirtualKeysShown_flag == 0))
+    if((ts.menu_mode == 0) && (ts.VirtualKeysShown_flag == 0)
+#ifdef USE_FT8_DECODER
+            && (is_demod_ft8() == false) // the FT8 message list covers the graticule
+#endif
+    )
     {// bail out if in menu mode
         // Update screen indicator - first get the width and center-frequency offset of the currently-selected filter
 
@@ -1650,7 +3135,37 @@ static void UiSpectrum_DrawFrequencyBar()
 
     UiSpectrum_UpdateSpectrumPixelParameters();
 
-    if (ts.spectrum_freqscale_colour != SPEC_BLACK)     // don't bother updating frequency scale if it is black (invisible)!
+    if (ts.spectrum_freqscale_colour != SPEC_BLACK && spectrum_sweep.state == SWEEP_RUN)
+    {
+        // band sweep panorama: frequency in kHz at both borders and every other vertical grid line
+        uint32_t  clr;
+        UiMenu_MapColors(ts.spectrum_freqscale_colour,NULL, &clr);
+
+        const uint8_t graticule_font = 4;
+        const uint16_t number_width = UiLcdHy28_TextWidth("      ",graticule_font);
+        const uint16_t pos_number_y = (slayout.graticule.y +  (slayout.graticule.h - UiLcdHy28_TextHeight(graticule_font))/2);
+        const int grid_count = pos_spectrum->SCOPE_GRID_VERT_COUNT;
+
+        for (int idx = 0; idx <= grid_count; idx += 2)
+        {
+            const uint16_t pos = idx == 0 ? 0 : (idx == grid_count ? slayout.scope.w - 1 : sd.vert_grid_id[idx-1]);
+            snprintf(txt,16, "%lu", (UiSpectrum_SweepFrequencyAt(pos) + 500) / 1000);
+
+            if (idx == 0) // left border
+            {
+                UiLcdHy28_PrintText( slayout.graticule.x + pos, pos_number_y,txt,clr,Black,graticule_font);
+            }
+            else if (idx == grid_count) // right border
+            {
+                UiLcdHy28_PrintTextRight( slayout.graticule.x + pos, pos_number_y,txt,clr,Black,graticule_font);
+            }
+            else
+            {
+                UiLcdHy28_PrintTextCentered(slayout.graticule.x +  pos - number_width/2,pos_number_y, number_width,txt,clr,Black,graticule_font);
+            }
+        }
+    }
+    else if (ts.spectrum_freqscale_colour != SPEC_BLACK)     // don't bother updating frequency scale if it is black (invisible)!
     {
         float32_t grat = 6.0f / (float32_t)(1 << sd.magnify);
 
@@ -1761,7 +3276,7 @@ void UiSpectrum_Redraw()
             if(ts.waterfall.speed > 0)  // is it time to update the scan, or is this scope to be disabled?
             {
                 //ts.waterfall.scheduler = (ts.waterfall.speed)*(sd.doubleWaterfallLine?50:25); // we need to use half the speed if in double line drawing mode
-            	ts.waterfall.scheduler = (ts.waterfall.speed)*(10*(sd.repeatWaterfallLine)); // we need to use half the speed if in double line drawing mode
+            	ts.waterfall.scheduler = (ts.waterfall.speed)*10;
                 sd.RedrawType|=Redraw_WATERFALL;
             }
         }
@@ -2001,8 +3516,12 @@ static void UiSpectrum_CalculateDBm()
     if( ts.txrx_mode == TRX_MODE_RX)
     {
         const float32_t slope = 19.8; // 19.6; --> empirical values derived from measurements by DL8MBY, 2016/06/30, Thanks!
-        const float32_t cons = ts.dbm_constant - 225 - (sd.fft_iq_len == 1024?3:0);
-        // the last term is for correcting the dbm value when a twice as large fft is being used (512 vs. 256)
+        float32_t cons = ts.dbm_constant - 225;
+        // correct the dbm value by 3dB for each doubling of the fft length above 256
+        for (uint16_t len = 512; len < sd.fft_iq_len; len *= 2)
+        {
+            cons -= 3;
+        }
         const int buff_len_int = sd.fft_iq_len;
         const float32_t buff_len = buff_len_int;
 
@@ -2083,11 +3602,11 @@ static void UiSpectrum_CalculateDBm()
 
         for(int32_t i = 0; i < (buff_len_int/4); i++)
         {
-            sd.FFT_Samples[sd.spec_len - i - 1] = sd.FFT_MagData[i + buff_len_int/4] * SCOPE_PREAMP_GAIN;	// get data
+            sd.FFT_Samples[sd.spec_len - i - 1] = sqrtf(sd.FFT_MagData[i + buff_len_int/4]) * SCOPE_PREAMP_GAIN;	// get data
         }
         for(int32_t i = buff_len_int/4; i < (buff_len_int/2); i++)
         {
-            sd.FFT_Samples[sd.spec_len - i - 1] = sd.FFT_MagData[i - buff_len_int/4] * SCOPE_PREAMP_GAIN;	// get data
+            sd.FFT_Samples[sd.spec_len - i - 1] = sqrtf(sd.FFT_MagData[i - buff_len_int/4]) * SCOPE_PREAMP_GAIN;	// get data
         }
 
         // here would be the right place to start with the SNAP mode!
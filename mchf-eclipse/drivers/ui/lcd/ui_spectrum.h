@@ -35,6 +35,15 @@ void UiSpectrum_Init();
 void UiSpectrum_Clear();
 void UiSpectrum_Redraw();
 void UiSpectrum_WaterfallClearData();
+void UiSpectrum_WaterfallScrollReset();
+bool UiSpectrum_WaterfallHistoryActive();
+void UiSpectrum_WaterfallHistoryToggle();
+void UiSpectrum_WaterfallHistoryPage(int32_t pages);
+bool UiSpectrum_SweepActive();
+void UiSpectrum_SweepToggle();
+uint32_t UiSpectrum_SweepFrequencyAt(uint16_t x);
+uint16_t UiSpectrum_StreamConfigure(uint8_t fps, uint8_t reduce);
+uint8_t UiSpectrum_StreamRate();
 void UiSpectrum_CalculateDisplayFilterBW(float32_t* width_pixel_, float32_t* left_filter_border_pos_);
 void UiSpectrum_DisplayFilterBW();
 
@@ -143,6 +152,47 @@ enum
 #define SPECTRUM_FILTER_MIN			1	// minimum filter setting
 #define	SPECTRUM_FILTER_MAX			20	// maximum filter setting
 #define SPECTRUM_FILTER_DEFAULT		4	// default filter setting
+
+#define SPECTRUM_WELCH_OVERLAP_MAX		3	// overlap is set in quarters of the FFT length, 3 -> 75%
+#define SPECTRUM_WELCH_OVERLAP_DEFAULT	2	// 50% overlap
+#define SPECTRUM_WELCH_AVG_MIN			1	// 1 -> no averaging, one FFT per spectrum frame
+#define SPECTRUM_WELCH_AVG_MAX			8
+#define SPECTRUM_WELCH_AVG_DEFAULT		4
+#define SPECTRUM_WELCH_FRAME_TICKS		5	// a spectrum frame is finished after this many sysclock ticks (10ms) even if not all segments are in
+
+#define SPECTRUM_FFT_LEN_MIN			256	// spectrum FFT length is SPECTRUM_FFT_LEN_MIN << ts.spectrum_fft_size
+#define SPECTRUM_FFT_SIZE_DEFAULT		0	// smallest FFT which covers the display width
+#if SPEC_BUFF_LEN >= 2048
+#define SPECTRUM_FFT_SIZE_MAX			3	// 2048 points
+#else
+#define SPECTRUM_FFT_SIZE_MAX			1	// 512 points
+#endif
+
+#define SPECTRUM_SIGNALS_MAX			16	// number of signals tracked by the signal detection
+#define SPECTRUM_SIGNAL_THRESH_DEFAULT	0	// signal detection off
+#define SPECTRUM_SIGNAL_THRESH_MIN		6	// dB above the noise floor a peak needs to count as signal
+#define SPECTRUM_SIGNAL_THRESH_MAX		40
+#define SPECTRUM_SIGNAL_HOLD_TICKS		100	// a signal is dropped from the list if not seen for this many sysclock ticks (10ms)
+
+#define SPECTRUM_SWEEP_SPAN_BAND		0	// band sweep covers the band of the dial frequency
+#define SPECTRUM_SWEEP_SPAN_MAX			4	// 100kHz, 200kHz, 500kHz, 1MHz around the dial frequency
+#define SPECTRUM_SWEEP_SPAN_DEFAULT		SPECTRUM_SWEEP_SPAN_BAND
+#define SPECTRUM_SWEEP_FRAMES_MIN		1	// spectrum frames averaged for each step of the band sweep
+#define SPECTRUM_SWEEP_FRAMES_MAX		16
+#define SPECTRUM_SWEEP_FRAMES_DEFAULT	2
+#define SPECTRUM_SWEEP_SETTLE_MAX		20	// sysclock ticks (10ms) to wait after each LO step of the band sweep
+#define SPECTRUM_SWEEP_SETTLE_DEFAULT	2
+
+#define SPECTRUM_STREAM_FPS_MAX			25	// max. spectrum frames per second sent to the host
+#define SPECTRUM_STREAM_REDUCE_MAX		3	// up to 2^n adjacent bins are merged into one streamed bin
+#if SPEC_BUFF_LEN > 1024
+#define SPECTRUM_STREAM_BINS_MAX		1024	// larger FFTs are always reduced, a key frame has to fit into the USB buffer
+#else
+#define SPECTRUM_STREAM_BINS_MAX		SPEC_BUFF_LEN
+#endif
+#define SPECTRUM_STREAM_HEADER_LEN		18	// bytes before the payload of a stream frame, a checksum byte follows the payload
+#define SPECTRUM_STREAM_KEY_INTERVAL	50	// a key frame (all bins) after this many delta frames, lets a host join a running stream
+#define SPECTRUM_STREAM_DEADBAND		1	// changes of a bin up to this many 0.5dB steps are not sent in delta frames
 //
 #define	SPECTRUM_SCOPE_AGC_MIN				1	// minimum spectrum scope AGC rate setting
 #define	SPECTRUM_SCOPE_AGC_MAX				50	// maximum spectrum scope AGC rate setting
@@ -185,20 +235,48 @@ enum
     #define SPECTRUM_WIDTH_MAX 480
 #endif
 
+// detected signal, see UiSpectrum_DetectSignals
+typedef struct
+{
+    uint32_t  freq;         // frequency in Hz of the peak
+    float32_t snr;          // dB above the noise floor
+    uint32_t  first_seen;   // ts.sysclock when the signal was first detected
+    uint32_t  last_seen;    // ts.sysclock when the signal was last detected
+} SpectrumSignal_t;
+
 // Spectrum display
 typedef struct SpectrumDisplay
 {
     // Samples buffer
     float32_t   FFT_RingBuffer[FFT_IQ_BUFF_LEN];
     float32_t   FFT_Samples[FFT_IQ_BUFF_LEN];
-    float32_t   FFT_MagData[SPEC_BUFF_LEN];
+    float32_t   FFT_MagData[SPEC_BUFF_LEN];     // Welch averaged power spectrum (squared magnitudes) of the last spectrum frame
     float32_t   FFT_AVGData[SPEC_BUFF_LEN];     // IIR low-pass filtered FFT buffer data
     uint32_t    FFT_frequency; // center frequency of stored FFT
+    float32_t   FFT_NoiseFloor[SPEC_BUFF_LEN];  // noise floor estimate per bin in display order, running minimum of FFT_AVGData
+
+    // signal detection
+    uint32_t    signals_nf_frequency;   // center frequency the noise floor bins belong to
+    uint32_t    signals_nf_time;        // ts.sysclock of the last noise floor update
+    float32_t   signals_nf_bias;        // mean noise level relative to the noise floor estimate
+    uint16_t    signals_nf_len;         // spec_len of the noise floor data, 0 if it has to be initialized
+    uint8_t     signals_nf_magnify;
+    uint8_t     signals_nf_settle;      // frames left until the noise floor estimate is usable
+    uint8_t     signals_num;            // number of valid entries in signals
+    SpectrumSignal_t signals[SPECTRUM_SIGNALS_MAX];     // active signals, sorted by frequency
+    uint16_t    signals_marker_x[SPECTRUM_SIGNALS_MAX]; // screen x of the signal markers shown on top of the scope
+    uint8_t     signals_marker_num;
     // scope pixel data
     uint16_t    Old_PosData[SPECTRUM_WIDTH_MAX];
 
     // Current data ptr
     uint32_t   samp_ptr;
+    volatile uint32_t samp_count;   // complex samples put into the ring buffer so far, used to schedule the FFT segments
+
+    // Welch averaging of overlapped FFT segments
+    uint32_t    welch_samp_count;   // samp_count when the last segment was taken from the ring buffer
+    uint32_t    welch_frame_start;  // ts.sysclock when the first segment of the current frame was taken
+    uint8_t     welch_segments;     // segments accumulated in FFT_MagData for the current frame
     volatile bool    reading_ringbuffer;
     // if the user level code wants to read the ring buffer
     // simply set this, and the audio driver will stop writing
@@ -228,6 +306,7 @@ typedef struct SpectrumDisplay
     uint16_t    spec_len;
     uint16_t    fft_iq_len;
     const arm_cfft_instance_f32 * cfft_instance;
+    const float32_t* hann_window;   // Hann window coefficients for fft_iq_len samples
 
     float   display_offset;     // "vertical" offset for spectral scope, gain adjust for waterfall
     float   agc_rate;           // this holds AGC rate for the Spectrum Display
@@ -236,18 +315,18 @@ typedef struct SpectrumDisplay
     ushort  wfall_line_update;  // used to set the number of lines per update on the waterfall
     float   wfall_contrast;     // used to adjust the contrast of the waterfall display
 
-    uint16_t waterfall_colours[NUMBER_WATERFALL_COLOURS+1];  // palette of colors for waterfall data
-    // uint8_t (*waterfall)[SPECTRUM_WIDTH];	//pointer to waterfall memory
-    uint8_t repeatWaterfallLine;				//line repeating count for waterfall size grater than number of data lines in waterfall array
-    // uint8_t  waterfall[WATERFALL_MAX_LINES*SPECTRUM_WIDTH];    // circular buffer used for storing waterfall data - remember to increase this if the waterfall is made larger!
-    uint8_t  waterfall[(WATERFALL_HEIGHT+10)*256];    // circular buffer used for storing waterfall data - remember to increase this if the waterfall is made larger!
-    uint32_t waterfall_frequencies[(WATERFALL_HEIGHT+10)]; // we reserve hopefully enough frequency stores here. We store for each line in waterfall the center frequency of it.
+    uint16_t waterfall_colours[NUMBER_WATERFALL_COLOURS+1];  // palette of colors for waterfall data, in LCD line buffer byte order
+    // the waterfall lines are kept in a compressed history store in ui_spectrum.c, see WATERFALL_HISTORY_SIZE
     //uint8_t wfall_DrawDirection;	//0=upward (water fountain), 1=downward (real waterfall)
-    uint32_t wfall_line;        // pointer to current line of waterfall data
-    uint32_t wfall_size;        // vertical size of the waterfall data (number of stored fft results)
-    //uint16_t wfall_disp_lines;        // vertical size of the waterfall on display
     uint32_t wfall_ystart;
 
+    // hardware scrolled waterfall, only the new lines are drawn as long as the old ones would look the same
+    bool     wfall_scroll_valid;        // display content matches wfall_scroll_center_hz/marker pos, so we may scroll
+    uint16_t wfall_scroll_offset;       // display memory line (relative to waterfall top) shown at the top of the waterfall
+    int32_t  wfall_scroll_center_hz;    // center frequency used for drawing the lines on screen
+    uint16_t wfall_scroll_marker_pos[SPECTRUM_MAX_MARKER]; // marker pixel positions used for drawing the lines on screen
+    uint16_t wfall_scroll_marker_num;
+
     uint32_t scope_size;
     uint32_t scope_ystart;
 
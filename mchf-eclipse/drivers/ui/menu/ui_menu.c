@@ -684,6 +684,30 @@ const char* UiMenu_GetSystemInfo(uint32_t* m_clr_ptr, int info_item)
         snprintf(out,32, "%s", TRX_HW_LIC);
     }
     break;
+#endif
+#ifdef USE_FREEDV
+    case INFO_FREEDV_MEM:
+    {
+        // used kB per mode ("--" if not used yet) and the available arena size
+        int len = 0;
+        for (int idx = 0; idx < freedv_modes_num && len < 32; idx++)
+        {
+            uint32_t used = FreeDV_GetArenaHighWater(idx);
+            if (used != 0)
+            {
+                len += snprintf(&out[len], 32 - len, "%s:%ld ", freedv_modes[idx].name, (used + 1023)/1024);
+            }
+            else
+            {
+                len += snprintf(&out[len], 32 - len, "%s:-- ", freedv_modes[idx].name);
+            }
+        }
+        if (len < 32)
+        {
+            snprintf(&out[len], 32 - len, "/%d", FDV_ARENA_SIZE/1024);
+        }
+    }
+    break;
 #endif
     default:
         outs = "NO INFO";
@@ -2050,6 +2074,91 @@ void UiMenu_UpdateItem(uint16_t select, MenuProcessingMode_t mode, int pos, int
                                              );
         snprintf(options,32, "  %u", ts.spectrum_filter);
         break;
+    case MENU_SPECTRUM_WELCH_OVERLAP: // overlap of the spectrum FFT segments
+        var_change = UiDriverMenuItemChangeUInt8(var, mode, &ts.spectrum_welch_overlap,
+                                              0,
+                                              SPECTRUM_WELCH_OVERLAP_MAX,
+                                              SPECTRUM_WELCH_OVERLAP_DEFAULT,
+                                              1
+                                             );
+        snprintf(options,32, "%3u%%", ts.spectrum_welch_overlap * 25);
+        break;
+    case MENU_SPECTRUM_WELCH_AVG: // number of averaged spectrum FFT segments
+        var_change = UiDriverMenuItemChangeUInt8(var, mode, &ts.spectrum_welch_avg,
+                                              SPECTRUM_WELCH_AVG_MIN,
+                                              SPECTRUM_WELCH_AVG_MAX,
+                                              SPECTRUM_WELCH_AVG_DEFAULT,
+                                              1
+                                             );
+        snprintf(options,32, "  %u", ts.spectrum_welch_avg);
+        break;
+    case MENU_SPECTRUM_FFT_SIZE: // minimum length of the spectrum FFT
+        var_change = UiDriverMenuItemChangeUInt8(var, mode, &ts.spectrum_fft_size,
+                                              0,
+                                              SPECTRUM_FFT_SIZE_MAX,
+                                              SPECTRUM_FFT_SIZE_DEFAULT,
+                                              1
+                                             );
+        snprintf(options,32, "%5u", SPECTRUM_FFT_LEN_MIN << ts.spectrum_fft_size);
+        if (var_change)
+        {
+            UiDriver_SpectrumChangeLayoutParameters();
+        }
+        break;
+    case MENU_SPECTRUM_SIGNAL_THRESH: // signal detection threshold
+    {
+        const uint8_t thresh_prev = ts.spectrum_signal_thresh;
+        var_change = UiDriverMenuItemChangeUInt8(var, mode, &ts.spectrum_signal_thresh,
+                                              0,
+                                              SPECTRUM_SIGNAL_THRESH_MAX,
+                                              SPECTRUM_SIGNAL_THRESH_DEFAULT,
+                                              1
+                                             );
+        // values below the minimum are skipped, we go straight from OFF to the minimum and back
+        if (ts.spectrum_signal_thresh != 0 && ts.spectrum_signal_thresh < SPECTRUM_SIGNAL_THRESH_MIN)
+        {
+            ts.spectrum_signal_thresh = thresh_prev < ts.spectrum_signal_thresh ? SPECTRUM_SIGNAL_THRESH_MIN : 0;
+        }
+        if (ts.spectrum_signal_thresh == 0)
+        {
+            strcpy(options, "  OFF");
+        }
+        else
+        {
+            snprintf(options,32, " %2udB", ts.spectrum_signal_thresh);
+        }
+        break;
+    }
+    case MENU_SPECTRUM_SWEEP_SPAN: // band sweep range
+    {
+        static const char* sweep_span_names[SPECTRUM_SWEEP_SPAN_MAX + 1] = { "  BAND", "100kHz", "200kHz", "500kHz", "  1MHz" };
+        var_change = UiDriverMenuItemChangeUInt8(var, mode, &ts.spectrum_sweep_span,
+                                              0,
+                                              SPECTRUM_SWEEP_SPAN_MAX,
+                                              SPECTRUM_SWEEP_SPAN_DEFAULT,
+                                              1
+                                             );
+        strcpy(options, sweep_span_names[ts.spectrum_sweep_span]);
+        break;
+    }
+    case MENU_SPECTRUM_SWEEP_FRAMES: // spectrum frames per band sweep step
+        var_change = UiDriverMenuItemChangeUInt8(var, mode, &ts.spectrum_sweep_frames,
+                                              SPECTRUM_SWEEP_FRAMES_MIN,
+                                              SPECTRUM_SWEEP_FRAMES_MAX,
+                                              SPECTRUM_SWEEP_FRAMES_DEFAULT,
+                                              1
+                                             );
+        snprintf(options,32, "  %2u", ts.spectrum_sweep_frames);
+        break;
+    case MENU_SPECTRUM_SWEEP_SETTLE: // band sweep settle time
+        var_change = UiDriverMenuItemChangeUInt8(var, mode, &ts.spectrum_sweep_settle,
+                                              0,
+                                              SPECTRUM_SWEEP_SETTLE_MAX,
+                                              SPECTRUM_SWEEP_SETTLE_DEFAULT,
+                                              1
+                                             );
+        snprintf(options,32, "%3ums", ts.spectrum_sweep_settle * 10);
+        break;
     case MENU_SCOPE_TRACE_COLOUR:   // spectrum scope trace colour
         var_change = UiDriverMenuItemChangeUInt8(var, mode, &ts.scope_trace_colour,
                                               0,
@@ -4177,6 +4286,14 @@ void UiMenu_UpdateItem(uint16_t select, MenuProcessingMode_t mode, int pos, int
          var_change = UiDriverMenuItemChangeEnableOnOffBool(var, mode, &cw_decoder_config.use_3_goertzels,0,options,&clr);
     	 break;
 
+     case MENU_CW_DECODER_USE_ADAPTIVE:
+         var_change = UiDriverMenuItemChangeEnableOnOffBool(var, mode, &cw_decoder_config.use_adaptive,0,options,&clr);
+         if (var_change)
+         {
+             CwDecode_Filter_Set(); // start timing estimation from scratch
+         }
+    	 break;
+
      case MENU_CW_DECODER_SHOW_CW_LED:
          var_change = UiDriverMenuItemChangeEnableOnOffBool(var, mode, &cw_decoder_config.show_CW_LED,0,options,&clr);
          if (cw_decoder_config.show_CW_LED == false)
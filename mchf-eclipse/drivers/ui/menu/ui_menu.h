@@ -63,6 +63,9 @@ enum MENU_INFO_ITEM
     INFO_HWLICENCE,
     INFO_CODEC,
     INFO_CODEC_TWINPEAKS,
+#ifdef USE_FREEDV
+    INFO_FREEDV_MEM,
+#endif
 };
 
 const char* UiMenu_GetSystemInfo(uint32_t* m_clr_ptr, int info_item);
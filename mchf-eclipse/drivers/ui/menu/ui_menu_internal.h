@@ -64,12 +64,20 @@ enum
 	MENU_CW_DECODER_NOISECANCEL,
 	MENU_CW_DECODER_SPIKECANCEL,
 	MENU_CW_DECODER_USE_3_GOERTZEL,
+	MENU_CW_DECODER_USE_ADAPTIVE,
 	MENU_CW_DECODER_SNAP_ENABLE,
 	MENU_CW_DECODER_SHOW_CW_LED,
     MENU_TCXO_MODE,
     MENU_TCXO_C_F,
     MENU_SCOPE_SPEED,
     MENU_SPECTRUM_FILTER_STRENGTH,
+    MENU_SPECTRUM_WELCH_OVERLAP,
+    MENU_SPECTRUM_WELCH_AVG,
+    MENU_SPECTRUM_FFT_SIZE,
+    MENU_SPECTRUM_SIGNAL_THRESH,
+    MENU_SPECTRUM_SWEEP_SPAN,
+    MENU_SPECTRUM_SWEEP_FRAMES,
+    MENU_SPECTRUM_SWEEP_SETTLE,
     MENU_SCOPE_TRACE_COLOUR,
     MENU_SCOPE_TRACE_HL_COLOUR,
 	MENU_SCOPE_BACKGROUND_HL_COLOUR,
@@ -230,6 +230,13 @@ const MenuDescriptor displayGroup[] =
     { MENU_DISPLAY, MENU_ITEM, CONFIG_DISP_FILTER_BANDWIDTH, NULL, "Filter BW Display", UiMenuDesc("Colour of the horizontal Filter Bandwidth indicator bar.") },
     { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_SIZE, NULL, "Spectrum Size", UiMenuDesc("Change height of spectrum display") },
     { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_FILTER_STRENGTH, NULL, "Spectrum Filter", UiMenuDesc("Lowpass filter for the spectrum FFT. Low values: fast and nervous spectrum; High values: slow and calm spectrum.") },
+    { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_WELCH_OVERLAP, NULL, "Spectrum FFT Overlap", UiMenuDesc("Overlap of consecutive spectrum FFTs. Higher overlap uses more of the received signal for averaging but needs more FFTs per second.") },
+    { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_WELCH_AVG, NULL, "Spectrum FFT Average", UiMenuDesc("Number of overlapping FFTs which are power averaged into one spectrum frame before the Spectrum Filter is applied. Higher values give a smoother noise floor.") },
+    { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_FFT_SIZE, NULL, "Spectrum FFT Size", UiMenuDesc("Minimum number of spectrum FFT points. More points give a finer frequency resolution, especially with magnify, but the spectrum updates slower. The display size may require more points than selected.") },
+    { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_SIGNAL_THRESH, NULL, "Signal Detect Thresh", UiMenuDesc("Signals this many dB above the noise floor are marked on top of the scope and listed via CAT. OFF disables the signal detection.") },
+    { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_SWEEP_SPAN, NULL, "Band Sweep Span", UiMenuDesc("Range of the band sweep, started and stopped with a long press on the scope. BAND sweeps the band of the dial frequency, the other settings a range around the dial frequency. Touch the panorama to tune there.") },
+    { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_SWEEP_FRAMES, NULL, "Band Sweep Frames", UiMenuDesc("Number of spectrum frames averaged for each step of the band sweep. More frames give a smoother panorama but a slower sweep.") },
+    { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_SWEEP_SETTLE, NULL, "Band Sweep Settle", UiMenuDesc("Time to wait after each oscillator step of the band sweep before spectrum frames are taken. Increase if the panorama shows steps or spikes at the step borders.") },
     { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_FREQSCALE_COLOUR, NULL, "Spec FreqScale Colour", UiMenuDesc("Colour of the small frequency digits under the spectrum display.") },
     { MENU_DISPLAY, MENU_ITEM, MENU_SPECTRUM_CENTER_LINE_COLOUR, NULL, "TX Carrier Colour", UiMenuDesc("Colour of the vertical line indicating the TX carrier frequency in the spectrum or waterdall display.") },
 //    { MENU_DISPLAY, MENU_ITEM, CONFIG_SPECTRUM_FFT_WINDOW_TYPE, NULL, "Spectrum FFT Wind.", UiMenuDesc("Selects the window algorithm for the spectrum FFT. For low spectral leakage, Hann, Hamming or Blackman window is recommended.") },
@@ -282,6 +289,7 @@ const MenuDescriptor cwGroup[] =
     { MENU_CW, MENU_ITEM, MENU_CW_DECODER_NOISECANCEL, NULL,"Noise cancel", UiMenuDesc("Enable/disable noise canceler for CW decoder") },
     { MENU_CW, MENU_ITEM, MENU_CW_DECODER_SPIKECANCEL, NULL,"Spike cancel", UiMenuDesc("Enable/disable spike canceler or short cancel for CW decoder") },
     { MENU_CW, MENU_ITEM, MENU_CW_DECODER_USE_3_GOERTZEL, NULL,"AGC for decoder", UiMenuDesc("Enable/disable AGC for CW decoder") },
+    { MENU_CW, MENU_ITEM, MENU_CW_DECODER_USE_ADAPTIVE, NULL,"Adaptive decoder", UiMenuDesc("Use matched filter signal detection and automatic speed tracking instead of signal threshold, noise and spike cancel") },
     { MENU_CW, MENU_ITEM, MENU_CW_DECODER_SHOW_CW_LED, NULL,"show CW LED", UiMenuDesc("Enable/disable LED for CW decoder") },
 	{ MENU_CW, MENU_STOP, 0, NULL, NULL, UiMenuDesc("") }
 };
@@ -404,6 +412,9 @@ const MenuDescriptor infoGroup[] =
     { MENU_SYSINFO, MENU_INFO, INFO_RFBOARD, NULL,"RF Board", UiMenuDesc("Displays the detected RF Board hardware identification.") },
     { MENU_SYSINFO, MENU_INFO, INFO_CODEC, NULL,"Audio Codec Presence", UiMenuDesc("Audio Codec I2C communication successfully tested? This is not a full test of the Audio Codec functionality, it only reports if I2C communication reported no problem talking to the codec.") },
     { MENU_SYSINFO, MENU_INFO, INFO_CODEC_TWINPEAKS, NULL,"Audio Codec Twinpeaks Corr.", UiMenuDesc("In some cases the audio codec needs to be restarted to produce correct IQ. The IQ auto correction detects this. If this fixes the problem, Done is displayed, Failed otherwise") },
+#ifdef USE_FREEDV
+    { MENU_SYSINFO, MENU_INFO, INFO_FREEDV_MEM, NULL,"FreeDV Memory (kB)", UiMenuDesc("Maximum memory used by each FreeDV mode since power on and the size of the statically reserved FreeDV memory.") },
+#endif
     { MENU_SYSINFO, MENU_INFO, INFO_VBAT, NULL,"Backup RAM Battery", UiMenuDesc("Battery Support for Backup RAM present?") },
     { MENU_SYSINFO, MENU_INFO, INFO_RTC, NULL,"Real Time Clock", UiMenuDesc("Battery Supported Real Time Clock present?") },
     { MENU_SYSINFO, MENU_INFO, INFO_LICENCE, NULL,"FW license", UiMenuDesc("Display license of firmware") },
@@ -294,6 +294,9 @@ const digital_mode_desc_t digimodes[DigitalMode_Num_Modes] =
 #endif
     { "RTTY"    , true },
     { "BPSK"    , true },
+#ifdef USE_FT8_DECODER
+    { "FT8"     , true },
+#endif
 };
 
 static void RadioManagement_SetCouplingForFrequency(uint32_t freq);
@@ -728,6 +731,41 @@ bool RadioManagement_ChangeFrequency(bool force_update, uint32_t dial_freq,uint8
     return lo_change_pending == false;
 }
 
+/**
+ * @brief tunes the LO to a frequency without relation to the dial frequency, used by the band sweep of the spectrum display.
+ * Small steps use the fast path of the oscillator (e.g. Si570 small frequency change without DCO freeze).
+ * The next RadioManagement_ChangeFrequency() call brings the LO back to the dial frequency.
+ * @param tune_freq LO tune frequency in Hz
+ * @returns true if the change was executed (if it was not tunable, ts.tune_freq is unchanged), false if it has to be repeated later
+ */
+bool RadioManagement_ChangeSweepFrequency(uint32_t tune_freq)
+{
+    bool retval = false;
+
+    if(ts.sysclock-ts.last_tuning > 5 || ts.last_tuning == 0)     // prevention for SI570 crash due too fast frequency changes
+    {
+        retval = true;
+
+        if (osc->prepareNextFrequency(tune_freq, df.temp_factor) != OSC_TUNE_IMPOSSIBLE)
+        {
+            ts.last_tuning = ts.sysclock;
+
+            Oscillator_ResultCodes_t lo_exec_result = osc->changeToNextFrequency();
+
+            if (lo_exec_result == OSC_OK || lo_exec_result == OSC_TUNE_LIMITED)
+            {
+                // we keep the requested frequency in sync, otherwise the main loop would tune back immediately
+                ts.tune_freq = tune_freq;
+                ts.tune_freq_req = tune_freq;
+
+                RadioManagement_SetHWFiltersForFrequency(tune_freq);
+                AudioManagement_CalcIqPhaseGainAdjust(tune_freq);
+            }
+        }
+    }
+    return retval;
+}
+
 /**
  * @brief temporary muting of the receiver when making changes which may cause audible pops etc., unmuting happens some 10s of milliseconds automatically later
  *
@@ -934,6 +972,13 @@ void RadioManagement_SwitchTxRx(uint8_t txrx_mode, bool tune_mode)
         {
         	Psk_Modulator_PrepareTx();
         }
+#ifdef USE_FT8_DECODER
+        if (is_demod_ft8())
+        {
+            // receive only mode
+            tx_ok = false;
+        }
+#endif
     }
 
     uint8_t txrx_mode_final = tx_ok?txrx_mode:TRX_MODE_RX;
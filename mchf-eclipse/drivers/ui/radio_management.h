@@ -287,6 +287,9 @@ typedef enum
 #endif
     DigitalMode_RTTY,
     DigitalMode_BPSK,
+#ifdef USE_FT8_DECODER
+    DigitalMode_FT8,
+#endif
     DigitalMode_Num_Modes
 } digital_modes_t;
 
@@ -333,6 +336,7 @@ bool RadioManagement_Tune(bool tune);
 bool RadioManagement_UpdatePowerAndVSWR();
 void RadioManagement_ChangeCodec(uint32_t codec, bool enableCodec);
 bool RadioManagement_ChangeFrequency(bool force_update, uint32_t dial_freq,uint8_t txrx_mode);
+bool RadioManagement_ChangeSweepFrequency(uint32_t tune_freq);
 void RadioManagement_HandlePttOnOff();
 void RadioManagement_MuteTemporarilyRxAudio();
 
@@ -383,6 +387,13 @@ inline bool is_demod_psk()
 	return ts.dmod_mode == DEMOD_DIGI && ts.digital_mode == DigitalMode_BPSK;
 }
 
+#ifdef USE_FT8_DECODER
+inline bool is_demod_ft8()
+{
+	return ts.dmod_mode == DEMOD_DIGI && ts.digital_mode == DigitalMode_FT8;
+}
+#endif
+
 inline void RadioManagement_TxRxSwitching_Disable()
 {
     ts.txrx_switching_enabled = false;
@@ -274,6 +274,13 @@ const ConfigEntryDescriptor ConfigEntryInfo[] =
 	{ ConfigEntry_UInt8x2, EEPROM_SMETER_ALPHAS,&sm.config.alphaCombined,CONFIG_UINT8x2_COMBINE(SMETER_ALPHA_ATTACK_DEFAULT, SMETER_ALPHA_DECAY_DEFAULT), CONFIG_UINT8x2_COMBINE(SMETER_ALPHA_MIN, SMETER_ALPHA_MIN), CONFIG_UINT8x2_COMBINE(SMETER_ALPHA_MAX,SMETER_ALPHA_MAX) },
     { ConfigEntry_UInt8, EEPROM_VSWR_PROTECTION_THRESHOLD,&ts.vswr_protection_threshold,1,1,10},
 	{ ConfigEntry_UInt16, EEPROM_EXPFLAGS1,&ts.expflags1,EXPFLAGS1_CONFIG_DEFAULT,0,0xffff},
+    { ConfigEntry_UInt8, EEPROM_SPECTRUM_WELCH_OVERLAP,&ts.spectrum_welch_overlap,SPECTRUM_WELCH_OVERLAP_DEFAULT,0,SPECTRUM_WELCH_OVERLAP_MAX},
+    { ConfigEntry_UInt8, EEPROM_SPECTRUM_WELCH_AVG,&ts.spectrum_welch_avg,SPECTRUM_WELCH_AVG_DEFAULT,SPECTRUM_WELCH_AVG_MIN,SPECTRUM_WELCH_AVG_MAX},
+    { ConfigEntry_UInt8, EEPROM_SPECTRUM_FFT_SIZE,&ts.spectrum_fft_size,SPECTRUM_FFT_SIZE_DEFAULT,0,SPECTRUM_FFT_SIZE_MAX},
+    { ConfigEntry_UInt8, EEPROM_SPECTRUM_SIGNAL_THRESH,&ts.spectrum_signal_thresh,SPECTRUM_SIGNAL_THRESH_DEFAULT,0,SPECTRUM_SIGNAL_THRESH_MAX},
+    { ConfigEntry_UInt8, EEPROM_SPECTRUM_SWEEP_SPAN,&ts.spectrum_sweep_span,SPECTRUM_SWEEP_SPAN_DEFAULT,0,SPECTRUM_SWEEP_SPAN_MAX},
+    { ConfigEntry_UInt8, EEPROM_SPECTRUM_SWEEP_FRAMES,&ts.spectrum_sweep_frames,SPECTRUM_SWEEP_FRAMES_DEFAULT,SPECTRUM_SWEEP_FRAMES_MIN,SPECTRUM_SWEEP_FRAMES_MAX},
+    { ConfigEntry_UInt8, EEPROM_SPECTRUM_SWEEP_SETTLE,&ts.spectrum_sweep_settle,SPECTRUM_SWEEP_SETTLE_DEFAULT,0,SPECTRUM_SWEEP_SETTLE_MAX},
 	
     // the entry below MUST be the last entry, and only at the last position Stop is allowed
     {
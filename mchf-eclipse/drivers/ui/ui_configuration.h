@@ -608,7 +608,14 @@ void		UiConfiguration_UpdateMacroCap(void);
 #define EEPROM_TX_IQ_10M_UP_PHASE_BALANCE_TRANS_OFF	425
 #define EEPROM_VSWR_PROTECTION_THRESHOLD            426
 #define EEPROM_EXPFLAGS1                            427     // Flags for options in Debug/Expert menu - see variable "expflags1"
-#define EEPROM_FIRST_UNUSED                         428		// change this if new value ids are introduced, must be correct at any time
+#define EEPROM_SPECTRUM_WELCH_OVERLAP               428     // overlap of consecutive spectrum FFT segments in quarters
+#define EEPROM_SPECTRUM_WELCH_AVG                   429     // number of spectrum FFT segments averaged per spectrum frame
+#define EEPROM_SPECTRUM_FFT_SIZE                    430     // spectrum FFT length as log2(length/256)
+#define EEPROM_SPECTRUM_SIGNAL_THRESH               431     // signal detection threshold in dB, 0 = off
+#define EEPROM_SPECTRUM_SWEEP_SPAN                  432     // band sweep range, 0 = band of the dial frequency
+#define EEPROM_SPECTRUM_SWEEP_FRAMES                433     // spectrum frames per band sweep step
+#define EEPROM_SPECTRUM_SWEEP_SETTLE                434     // settle time after each band sweep step in 10ms
+#define EEPROM_FIRST_UNUSED                         435		// change this if new value ids are introduced, must be correct at any time
 
 #define MAX_VAR_ADDR (EEPROM_FIRST_UNUSED - 1)
 
@@ -60,6 +60,7 @@
 #include "rtty.h"
 #include "cw_decoder.h"
 #include "psk.h"
+#include "ft8.h"
 
 #include "audio_convolution.h"
 #include "audio_agc.h"
@@ -994,6 +995,41 @@ void UiDriver_DrawFButtonLabel(uint8_t button_num, const char* label, uint32_t l
 			label_color, Black, 0);
 }
 
+// retained state of the encoder boxes, used to skip redrawing the parts which did not change
+#define ENC_BOX_ROWS 2
+#define ENC_BOX_COLS 3
+#define ENC_BOX_TEXT_LEN 8
+
+typedef struct
+{
+    bool valid;
+    bool active;
+    uint32_t color;
+    uint32_t fill_seq; // LCD fill sequence number at the time of our last drawing
+    char label[ENC_BOX_TEXT_LEN];
+    char value[ENC_BOX_TEXT_LEN];
+} EncoderBoxState;
+
+static EncoderBoxState enc_boxes[ENC_BOX_ROWS][ENC_BOX_COLS];
+
+/**
+ * Copies str into the retained state buffer if it fits
+ * @returns true if str fits and differs from the retained text
+ */
+static bool UiDriver_EncoderBoxTextChanged(char* retained, const char* str, bool* cacheable)
+{
+    bool retval = strncmp(retained, str, ENC_BOX_TEXT_LEN) != 0;
+    if (strlen(str) < ENC_BOX_TEXT_LEN)
+    {
+        strcpy(retained, str);
+    }
+    else
+    {
+        *cacheable = false;
+    }
+    return retval;
+}
+
 void UiDriver_EncoderDisplay(const uint8_t row, const uint8_t column, const char *label, bool encoder_active,
 		const char temp[5], uint32_t color)
 {
@@ -1004,23 +1040,65 @@ void UiDriver_EncoderDisplay(const uint8_t row, const uint8_t column, const char
 	uint32_t bg_color = encoder_active?Orange:Grey;
 	uint32_t brdr_color = encoder_active?Orange:Grey;
 
+	uint16_t box_x, box_y, label_x, label_y, value_x, value_y;
+
 	if(ts.Layout->ENCODER_MODE==MODE_HORIZONTAL)
 	{
-		UiLcdHy28_DrawEmptyRect(ts.Layout->ENCODER_IND.x + ENC_COL_W *2 * column + row *ENC_COL_W+column*Xspacing, ts.Layout->ENCODER_IND.y , ENC_ROW_H - 2, ENC_COL_W - 2, brdr_color);
-		UiLcdHy28_PrintTextCentered((ts.Layout->ENCODER_IND.x + 1 + ENC_COL_W * 2 * column + row *ENC_COL_W+column*Xspacing), (ts.Layout->ENCODER_IND.y + 1),ENC_COL_W - 3, label,
-				label_color, bg_color, 0);
-		UiLcdHy28_PrintTextRight((ts.Layout->ENCODER_IND.x + ENC_COL_W - 4 + ENC_COL_W * 2 * column+ row *ENC_COL_W+column*Xspacing), (ts.Layout->ENCODER_IND.y + 1 + ENC_ROW_2ND_OFF), temp,
-				color, Black, 0);
+	    box_x = ts.Layout->ENCODER_IND.x + ENC_COL_W *2 * column + row *ENC_COL_W+column*Xspacing;
+	    box_y = ts.Layout->ENCODER_IND.y;
+	    label_x = ts.Layout->ENCODER_IND.x + 1 + ENC_COL_W * 2 * column + row *ENC_COL_W+column*Xspacing;
+	    label_y = ts.Layout->ENCODER_IND.y + 1;
+	    value_x = ts.Layout->ENCODER_IND.x + ENC_COL_W - 4 + ENC_COL_W * 2 * column+ row *ENC_COL_W+column*Xspacing;
+	    value_y = ts.Layout->ENCODER_IND.y + 1 + ENC_ROW_2ND_OFF;
 	}
 	else
 	{
-		UiLcdHy28_DrawEmptyRect(ts.Layout->ENCODER_IND.x + ENC_COL_W * column, ts.Layout->ENCODER_IND.y + row * ENC_ROW_H, ENC_ROW_H - 2, ENC_COL_W - 2, brdr_color);
-		UiLcdHy28_PrintTextCentered((ts.Layout->ENCODER_IND.x + 1 + ENC_COL_W * column), (ts.Layout->ENCODER_IND.y + 1 + row * ENC_ROW_H),ENC_COL_W - 3, label,
-				label_color, bg_color, 0);
-		UiLcdHy28_PrintTextRight((ts.Layout->ENCODER_IND.x + ENC_COL_W - 4 + ENC_COL_W * column), (ts.Layout->ENCODER_IND.y + 1 + row * ENC_ROW_H + ENC_ROW_2ND_OFF), temp,
-				color, Black, 0);
+	    box_x = ts.Layout->ENCODER_IND.x + ENC_COL_W * column;
+	    box_y = ts.Layout->ENCODER_IND.y + row * ENC_ROW_H;
+	    label_x = ts.Layout->ENCODER_IND.x + 1 + ENC_COL_W * column;
+	    label_y = ts.Layout->ENCODER_IND.y + 1 + row * ENC_ROW_H;
+	    value_x = ts.Layout->ENCODER_IND.x + ENC_COL_W - 4 + ENC_COL_W * column;
+	    value_y = ts.Layout->ENCODER_IND.y + 1 + row * ENC_ROW_H + ENC_ROW_2ND_OFF;
+	}
+
+	bool draw_box = true;
+	bool draw_value = true;
+	EncoderBoxState* box = NULL;
+
+	if (row < ENC_BOX_ROWS && column < ENC_BOX_COLS)
+	{
+	    box = &enc_boxes[row][column];
+
+	    // a box is only trusted if nobody filled its area since we have drawn it
+	    bool cacheable = true;
+	    const bool valid = box->valid && UiLcdHy28_AreaFilledSince(box->fill_seq, box_x, box_y, ENC_COL_W, ENC_ROW_H) == false;
+
+	    const bool label_changed = UiDriver_EncoderBoxTextChanged(box->label, label, &cacheable);
+	    const bool value_changed = UiDriver_EncoderBoxTextChanged(box->value, temp, &cacheable);
+
+	    draw_box = valid == false || label_changed || box->active != encoder_active;
+	    draw_value = valid == false || value_changed || box->color != color;
+
+	    box->active = encoder_active;
+	    box->color = color;
+	    box->valid = cacheable;
 	}
 
+	if (draw_box)
+	{
+	    UiLcdHy28_DrawEmptyRect(box_x, box_y, ENC_ROW_H - 2, ENC_COL_W - 2, brdr_color);
+	    UiLcdHy28_PrintTextCentered(label_x, label_y, ENC_COL_W - 3, label, label_color, bg_color, 0);
+	}
+	if (draw_value)
+	{
+	    UiLcdHy28_PrintTextRight(value_x, value_y, temp, color, Black, 0);
+	}
+
+	if (box != NULL)
+	{
+	    // taken after our own drawing, so that it does not count as painting over the box
+	    box->fill_seq = UiLcdHy28_FillSeqGet();
+	}
 }
 
 
@@ -1328,6 +1406,12 @@ void UiDriver_ModeSpecificDisplayClear(uint8_t dmod_mode, uint8_t digital_mode)
 			UiDriver_TextMsgClear();
 			UiSpectrum_InitCwSnapDisplay(false);
 			break;
+#ifdef USE_FT8_DECODER
+		case DigitalMode_FT8:
+			UiDriver_TextMsgClear();
+			UiSpectrum_Init(); // scope and waterfall again instead of the message list
+			break;
+#endif
 		default:
 			break;
 		}
@@ -1377,6 +1461,12 @@ void UiDriver_ModeSpecificDisplayPrepare(uint8_t dmod_mode, uint8_t digital_mode
 		    	UiSpectrum_InitCwSnapDisplay(true);
 		    }
 			break;
+#ifdef USE_FT8_DECODER
+		case DigitalMode_FT8:
+			UiDriver_TextMsgClear();
+			Ft8_Decoder_Init();
+			break;
+#endif
 		default:
 			break;
 		}
@@ -1570,6 +1660,11 @@ void UiDriver_DisplayDemodMode()
 		case DigitalMode_BPSK:
 			txt = ts.digi_lsb?"PSK-L":"PSK-U";
 			break;
+#ifdef USE_FT8_DECODER
+		case DigitalMode_FT8:
+			txt = "FT8";
+			break;
+#endif
 		default:
 			txt = ts.digi_lsb?"DI-L":"DI-U";
 		}
@@ -2185,6 +2280,7 @@ typedef struct MeterState_s
 {
 	uint8_t last;
 	uint8_t last_warn;
+	uint32_t fill_seq; // LCD fill sequence number at the time of our last drawing
 } MeterState;
 
 static MeterState meters[METER_NUM];
@@ -2226,12 +2322,30 @@ static void UiDriver_UpdateMeter(uchar val, uchar warn, uint32_t color_norm, uin
 	}
 
 
-	if(val != meters[meterId].last || from_warn != 255)
+	// the code below is responsible for location and size of the dash segments
+	// and the drawing
+
+	// which of the 2 positions our bar will have
+	const uint16_t ypos = meterId==METER_TOP?(ts.Layout->SM_IND.y + 28):(ts.Layout->SM_IND.y + 51 - BTM_MINUS);
+	// segment line
+	const uint8_t v_s = 3; // segment length
+	const uint16_t xpos = ts.Layout->SM_IND.x + 18;
+
+	// if our bar was cleared since our last update, none of our segments are left on the screen
+	// segment i is 3 pixels wide at xpos + i*(v_s + 2), segment 0 is never drawn
+	const bool redraw_all = UiLcdHy28_AreaFilledSince(meters[meterId].fill_seq, xpos + (v_s + 2), ypos - v_s, (SMETER_MAX_LEVEL - 1) * (v_s + 2) + 3, v_s);
+
+	if(val != meters[meterId].last || from_warn != 255 || redraw_all)
 	{
 	    uint8_t from, to;
 
 		// decide if we need to draw more boxes or delete some
-		if (val > meters[meterId].last)
+		if (redraw_all)
+		{
+			from = 0;
+			to = SMETER_MAX_LEVEL+1;
+		}
+		else if (val > meters[meterId].last)
 		{
 			// we will draw more active boxes
 			from = meters[meterId].last;
@@ -2258,14 +2372,6 @@ static void UiDriver_UpdateMeter(uchar val, uchar warn, uint32_t color_norm, uin
 	    uint32_t col = color_norm;
 	    // at start: use the requested value color
 
-	    // the code below is responsible for location and size of the dash segments
-        // and the drawing
-
-        // which of the 2 positions our bar will have
-        const uint16_t ypos = meterId==METER_TOP?(ts.Layout->SM_IND.y + 28):(ts.Layout->SM_IND.y + 51 - BTM_MINUS);
-        // segment line
-        const uint8_t v_s = 3; // segment length
-
 		for(int i = from; i < to; i++)
 		{
 			if (i>val)
@@ -2277,12 +2383,13 @@ static void UiDriver_UpdateMeter(uchar val, uchar warn, uint32_t color_norm, uin
 				col = Red2;                 // yes - display values above that color in red
 			}
 
-			UiLcdHy28_DrawStraightLineTriple(((ts.Layout->SM_IND.x + 18) + i*(v_s + 2)),(ypos - v_s),v_s,LCD_DIR_VERTICAL,col);
+			UiLcdHy28_DrawStraightLineTriple((xpos + i*(v_s + 2)),(ypos - v_s),v_s,LCD_DIR_VERTICAL,col);
 		}
 
 		meters[meterId].last = val;
 		meters[meterId].last_warn = warn;
 	}
+	meters[meterId].fill_seq = UiLcdHy28_FillSeqGet();
 }
 
 
@@ -2544,6 +2651,79 @@ void UiDriver_UpdateFrequency(bool force_update, enum UpdateFrequencyMode_t mode
 
 
 
+// retained state of the frequency displays. We identify a display by its position and font,
+// so the SAM carrier display and the secondary frequency display share the same state if they use the same place.
+#define FREQ_DISP_NUM 4
+#define FREQ_DISP_HIDDEN 0xff // digit is not shown (drawn in black)
+
+typedef struct
+{
+    bool valid;
+    uint16_t x;
+    uint16_t y;
+    uint8_t font;
+    uint16_t color;
+    uint32_t fill_seq; // LCD fill sequence number at the time of our last drawing
+    UiArea_t area;
+    uint8_t digits[MAX_DIGITS]; // shown digit value or FREQ_DISP_HIDDEN
+} FreqDisplayState;
+
+static FreqDisplayState freq_disps[FREQ_DISP_NUM];
+
+static bool UiDriver_AreaOverlap(const UiArea_t* a, const UiArea_t* b)
+{
+    return a->x < b->x + b->w && b->x < a->x + a->w && a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+/**
+ * Finds the retained state for a frequency display at the given position, takes over the least recently used one if none exists.
+ * The state is invalidated if someone painted over the display area since our last update, either by a filling the
+ * area or by drawing another frequency display over it.
+ */
+static FreqDisplayState* UiDriver_FreqDisplayStateGet(uint16_t x, uint16_t y, uint8_t font, const UiArea_t* area)
+{
+    static uint8_t next_free;
+
+    FreqDisplayState* retval = NULL;
+    for (int i = 0; i < FREQ_DISP_NUM && retval == NULL; i++)
+    {
+        if (freq_disps[i].x == x && freq_disps[i].y == y && freq_disps[i].font == font)
+        {
+            retval = &freq_disps[i];
+        }
+    }
+
+    if (retval == NULL)
+    {
+        retval = &freq_disps[next_free];
+        next_free = (next_free + 1) % FREQ_DISP_NUM;
+        retval->valid = false;
+        retval->x = x;
+        retval->y = y;
+        retval->font = font;
+    }
+
+    if (retval->valid && UiLcdHy28_AreaFilledSince(retval->fill_seq, area->x, area->y, area->w, area->h))
+    {
+        retval->valid = false;
+    }
+
+    for (int i = 0; i < FREQ_DISP_NUM; i++)
+    {
+        if (&freq_disps[i] != retval && UiDriver_AreaOverlap(&freq_disps[i].area, area))
+        {
+            freq_disps[i].valid = false;
+        }
+    }
+
+    retval->area = *area;
+    return retval;
+}
+
+/**
+ * Draws the frequency as digits with dots between the groups of 3 digits. Only digits and dots
+ * which differ from what is already on the screen are drawn, this is what keeps fast tuning cheap.
+ */
 static void UiDriver_UpdateFreqDisplay(uint32_t dial_freq, uint32_t pos_x_loc, uint32_t pos_y_loc, uint16_t color, uint8_t digit_font)
 {
     uint8_t digits[MAX_DIGITS];
@@ -2567,20 +2747,36 @@ static void UiDriver_UpdateFreqDisplay(uint32_t dial_freq, uint32_t pos_x_loc, u
 
     const uint16_t x_right = pos_x_loc + (9* font_width);
 
+    const int16_t area_x = x_right - ((MAX_DIGITS - 1) / 3) * group_space - 2 * font_width;
+    const UiArea_t area =
+    {
+            .x = area_x < 0 ? 0 : area_x,
+            .y = pos_y_loc,
+            .w = x_right + font_width - (area_x < 0 ? 0 : area_x),
+            .h = UiLcdHy28_TextHeight(digit_font)
+    };
+
+    FreqDisplayState* disp = UiDriver_FreqDisplayStateGet(pos_x_loc, pos_y_loc, digit_font, &area);
+    const bool redraw_all = disp->valid == false || disp->color != color;
+
     for (uint32_t idx = 3; idx < MAX_DIGITS; idx+=3)
     {
         bool noshow = last_non_zero < idx;
+        bool noshow_old = disp->digits[idx] == FREQ_DISP_HIDDEN;
         int digit_group = idx / 3; // we group every 3 digits
 
-        digit[0] = '.';
-        uint32_t dot_clr = noshow?Black:color;
-        if (digit_font != 5)
+        if (redraw_all || noshow != noshow_old)
         {
-            UiLcdHy28_PrintText(x_right - (digit_group * group_space) + font_width/2 + 1  ,pos_y_loc,digit,dot_clr,Black,digit_font);
-        }
-        else
-        {
-            UiLcdHy28_PrintText(x_right - (digit_group * group_space) + font_width ,pos_y_loc,digit,dot_clr,Black,digit_font);
+            digit[0] = '.';
+            uint32_t dot_clr = noshow?Black:color;
+            if (digit_font != 5)
+            {
+                UiLcdHy28_PrintText(x_right - (digit_group * group_space) + font_width/2 + 1  ,pos_y_loc,digit,dot_clr,Black,digit_font);
+            }
+            else
+            {
+                UiLcdHy28_PrintText(x_right - (digit_group * group_space) + font_width ,pos_y_loc,digit,dot_clr,Black,digit_font);
+            }
         }
     }
 
@@ -2590,12 +2786,22 @@ static void UiDriver_UpdateFreqDisplay(uint32_t dial_freq, uint32_t pos_x_loc, u
         int digit_idx = idx % 3;
 
         bool noshow = idx > last_non_zero;
-        // don't show leading zeros, except for the 0th digits
-        digit[0] = noshow?'0':0x30 + (digits[idx] & 0x0F);
-        uint32_t digit_clr = noshow?Black:color;
-        // Update segment
-        UiLcdHy28_PrintText(x_right -  digit_idx * font_width - (digit_group * group_space), pos_y_loc, digit, digit_clr, Black, digit_font);
+        const uint8_t shown = noshow?FREQ_DISP_HIDDEN:digits[idx];
+
+        if (redraw_all || disp->digits[idx] != shown)
+        {
+            // don't show leading zeros, except for the 0th digits
+            digit[0] = noshow?'0':0x30 + (digits[idx] & 0x0F);
+            uint32_t digit_clr = noshow?Black:color;
+            // Update segment
+            UiLcdHy28_PrintText(x_right -  digit_idx * font_width - (digit_group * group_space), pos_y_loc, digit, digit_clr, Black, digit_font);
+        }
+        disp->digits[idx] = shown;
     }
+
+    disp->color = color;
+    disp->valid = true;
+    disp->fill_seq = UiLcdHy28_FillSeqGet();
 }
 
 //*----------------------------------------------------------------------------
@@ -4478,7 +4684,7 @@ static void UiDriver_DisplayModulationType()
 #if defined(USE_FREEDV)
 	    if  (ts.digital_mode == DigitalMode_FreeDV)
 	    {
-	        txt = freedv_modes[freedv_conf.mode].label;
+	        txt = FreeDV_GetModeLabel();
 	    }
 	    else
 #endif
@@ -6381,13 +6587,39 @@ void UiAction_CheckSpectrumTouchActions()
 			return;
 		}
 	}
+
+	if(UiDriver_CheckTouchRegion(&sd.Slayout->wfall)				//start or end the review of the waterfall history
+			&&ts.txrx_mode == TRX_MODE_RX)
+	{
+		UiSpectrum_WaterfallHistoryToggle();
+	}
+
+	if(UiDriver_CheckTouchRegion(&sd.Slayout->scope)				//start or end the band sweep
+			&&ts.txrx_mode == TRX_MODE_RX)
+	{
+		UiSpectrum_SweepToggle();
+	}
 }
 
 //SpectrumVirtualKeys_flag
 
 void UiAction_ChangeFrequencyByTouch()
 {
-	if (ts.frequency_lock == false)
+	if (UiSpectrum_WaterfallHistoryActive() && UiDriver_CheckTouchRegion(&sd.Slayout->wfall))
+	{
+		// while reviewing the waterfall history, lower half goes back in time, upper half forward
+		UiSpectrum_WaterfallHistoryPage(ts.tp->hr_y > sd.Slayout->wfall.y + sd.Slayout->wfall.h/2 ? 1 : -1);
+	}
+	else if (UiSpectrum_SweepActive() && UiDriver_CheckTouchRegion(&sd.Slayout->scope))
+	{
+		// tune to the touched frequency of the band sweep panorama (to 1kHz), this ends the sweep
+		if (ts.frequency_lock == false && ts.tp->hr_x >= sd.Slayout->scope.x)
+		{
+			df.tune_new = ((UiSpectrum_SweepFrequencyAt(ts.tp->hr_x - sd.Slayout->scope.x) + 500) / 1000) * 1000;
+			UiDriver_FrequencyUpdateLOandDisplay(true);
+		}
+	}
+	else if (ts.frequency_lock == false)
 	{
 		int step = 500;				// adjust to 500Hz
 
@@ -7410,6 +7642,14 @@ void UiDriver_TaskHandler_MainTasks()
 
 	UiSpectrum_Redraw();
 
+#ifdef USE_FT8_DECODER
+	if (is_demod_ft8())
+	{
+		// does only a small slice of work per call, the audio is captured in the interrupt
+		Ft8_HandleDecoder();
+	}
+#endif
+
 	// Expect the code below to be executed around every 40 - 80ms.
 	// The exact time between two calls is unknown and varies with different
 	// display options  (waterfall/scope, DSP settings etc.)
@@ -107,6 +107,8 @@ uint8_t UserTxBufferFS   [APP_TX_DATA_SIZE];
 uint32_t CDC_Tx_PtrIn  = 0;
 uint32_t CDC_Tx_PtrOut = 0;
 uint32_t CDC_Tx_Length  = 0;
+// bytes of the packet handed to the IN endpoint, CDC_Tx_PtrOut is already past them
+static volatile uint32_t CDC_Tx_InFlight = 0;
 
 uint8_t  CDC_Tx_State = 0;
 
@@ -352,6 +354,24 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
   return result;
 }
 
+/**
+  * @brief  CDC_Transmit_Free_FS
+  *         Number of bytes which can be passed to CDC_Transmit_FS without
+  *         overwriting data not yet sent. CDC_Transmit_FS does not check this itself,
+  *         so callers sending larger blocks have to.
+  * @retval free bytes in the transmit buffer
+  */
+uint32_t CDC_Transmit_Free_FS(void)
+{
+    // CDC_Tx_PtrOut may be APP_TX_DATA_SIZE until the next transfer wraps it, the modulo takes care of that
+    // CDC_Tx_PtrOut has to be read before CDC_Tx_InFlight: CDC_InitiateTransmit sets them in the opposite order,
+    // so if the USB interrupt gets in between, we overestimate the used room, never underestimate it
+    const uint32_t ptr_out = CDC_Tx_PtrOut;
+    const uint32_t used = (CDC_Tx_PtrIn + APP_TX_DATA_SIZE - ptr_out) % APP_TX_DATA_SIZE + CDC_Tx_InFlight;
+    // one byte is always kept free, a completely filled buffer would look empty
+    return used < APP_TX_DATA_SIZE - 1 ? APP_TX_DATA_SIZE - 1 - used : 0;
+}
+
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
@@ -376,6 +396,7 @@ static void CDC_InitiateTransmit(USBD_HandleTypeDef *pdev)
         USB_Tx_ptr = CDC_Tx_PtrOut;
         USB_Tx_length = CDC_DATA_FS_IN_PACKET_SIZE;
 
+        CDC_Tx_InFlight = USB_Tx_length;
         CDC_Tx_PtrOut += CDC_DATA_FS_IN_PACKET_SIZE;
         CDC_Tx_Length -= CDC_DATA_FS_IN_PACKET_SIZE;
     }
@@ -384,6 +405,7 @@ static void CDC_InitiateTransmit(USBD_HandleTypeDef *pdev)
         USB_Tx_ptr = CDC_Tx_PtrOut;
         USB_Tx_length = CDC_Tx_Length;
 
+        CDC_Tx_InFlight = USB_Tx_length;
         CDC_Tx_PtrOut += CDC_Tx_Length;
         CDC_Tx_Length = 0;
     }
@@ -441,6 +463,8 @@ static int8_t  CDC_DataIn (USBD_HandleTypeDef *pdev)
 {
     if (CDC_Tx_State == 1)
     {
+        // the packet is out, its room can be reused
+        CDC_Tx_InFlight = 0;
         if (CDC_Tx_Length == 0)
         {
             CDC_Tx_State = 0;
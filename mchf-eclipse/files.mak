@@ -55,6 +55,7 @@ drivers/freedv/codebookres.c \
 drivers/freedv/codebookvq.c \
 drivers/freedv/codebookvqanssi.c \
 drivers/freedv/codec2.c \
+drivers/freedv/codec2_arena.c \
 drivers/freedv/codec2_fft.c \
 drivers/freedv/cohpsk.c \
 drivers/freedv/dct2.c \
@@ -155,6 +156,8 @@ drivers/audio/freedv_test_data.c \
 drivers/audio/freq_shift.c \
 drivers/audio/rtty.c \
 drivers/audio/psk.c \
+drivers/audio/ft8.c \
+drivers/audio/ft8_ldpc.c \
 drivers/audio/rb.c \
 drivers/audio/tx_processor.c \
 drivers/ui/lcd/ui_lcd_layouts.c \
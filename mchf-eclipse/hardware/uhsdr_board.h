@@ -401,6 +401,13 @@ typedef struct TransceiverState
 
     uint8_t spectrum_size;              // size of waterfall display (and other parameters) - size setting is in lower nybble, upper nybble/byte reserved
     uint8_t	spectrum_filter;	// strength of filter in spectrum scope
+    uint8_t spectrum_welch_overlap; // overlap of consecutive spectrum FFT segments in quarters of the FFT length
+    uint8_t spectrum_welch_avg;     // number of overlapped FFT segments averaged into one spectrum frame
+    uint8_t spectrum_fft_size;      // spectrum FFT length is SPECTRUM_FFT_LEN_MIN << spectrum_fft_size, if larger than the display needs
+    uint8_t spectrum_signal_thresh; // signal detection threshold in dB above noise floor, 0 = signal detection off
+    uint8_t spectrum_sweep_span;    // range of the band sweep, SPECTRUM_SWEEP_SPAN_BAND or an index into the fixed spans
+    uint8_t spectrum_sweep_frames;  // spectrum frames averaged for each step of the band sweep
+    uint8_t spectrum_sweep_settle;  // sysclock ticks (10ms) to wait after each LO step of the band sweep
     uint8_t spectrum_centre_line_colour;    // color of center line of scope grid
     uint8_t spectrum_freqscale_colour;  // color of spectrum scope frequency scale
     uint8_t spectrum_agc_rate;      // agc rate on the 'scope
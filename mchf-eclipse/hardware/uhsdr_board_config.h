@@ -150,9 +150,31 @@
 
 #define USE_FFT_1024
 
+#if defined(STM32F7) || defined(STM32H7)
+    // OPTION
+    // selectable spectrum FFT length up to 2048 points and a polyphase FIR decimator for the zoom FFT
+    // instead of IIR lowpass + FIR decimation. Needs about 50k more RAM than the 512 point FFT, so not for F4.
+    #define USE_SPECTRUM_FFT_2048
+#endif
+
+#if defined(STM32H7)
+    // OPTION
+    // bytes used for the compressed waterfall history (scroll-back with long press on the waterfall)
+    // if not set, the history uses the same amount of RAM as the former uncompressed waterfall buffer (~20k)
+    #define WATERFALL_HISTORY_SIZE (128*1024)
+#elif defined(STM32F7)
+    #define WATERFALL_HISTORY_SIZE (48*1024)
+#endif
+
 // OPTION
 #define USE_RTTY_PROCESSOR
 
+#if defined(STM32H7)
+    // OPTION
+    // FT8 receiver, needs ~200k RAM, so H7 only
+    #define USE_FT8_DECODER
+#endif
+
 // OPTION
 #define USE_USBHOST
 #ifdef USE_USBHOST
@@ -225,6 +247,12 @@
     #define USE_FREEDV_1600
 #else
     #define USE_FREEDV_700D
+    #if defined(STM32H7)
+        // OPTION
+        // FreeDV mode AUTO: searches for all FreeDV modes in parallel and locks to the one which syncs
+        // needs the codec2 memory of all modes at the same time, so H7 only
+        #define USE_FREEDV_AUTO
+    #endif
 #endif
 
 
@@ -28,6 +28,7 @@ typedef enum {
     ProfileTP9,
     ProfileFreeDV,
     FreeDVTXUnderrun,
+    FreeDVRXUnderrun,
     EventProfileMax
 } ProfiledEventNames;
 
@@ -13,30 +13,221 @@
 #include <assert.h>
 #include "uhsdr_math.h"
 
+// log2 and exp2 are computed with a 16 entry table for the upper mantissa / fraction bits
+// and a short polynomial for the rest. No libm calls, no divisions, no branches in the inner loops.
+//
+// log2(x) = e + log2(c) + log2(m/c), x = m * 2^e, 1 <= m < 2, c is the center of the 1/16 interval m is in,
+//           so |m/c - 1| < 1/32 and the Taylor polynomial up to r^3 is good to 3e-7 (abs)
+// exp2(x) = 2^n * 2^(j/16) * 2^g, x = n + j/16 + g, 0 <= g < 1/16, polynomial up to g^3 is good to 2e-7 (rel)
+//
+// The block functions are unrolled by 4 like the CMSIS DSP functions, the Cortex-M FPU has no SIMD,
+// but the compiler gets 4 independent chains of operations to interleave.
+#define MATH_TABLE_BITS     4
+#define MATH_TABLE_SIZE     (1 << MATH_TABLE_BITS)
+
+typedef union
+{
+    float32_t f;
+    uint32_t u;
+} Math_Float32Bits_t;
+
+typedef struct
+{
+    float32_t log2_c;   // log2(c), with c = 1/inv_c exactly
+    float32_t inv_c;    // 1/c, c = 1 + (idx + 0.5)/16
+} Math_Log2TableEntry_t;
+
+static const Math_Log2TableEntry_t math_log2_table[MATH_TABLE_SIZE] =
+{
+    { 4.439407636e-02f, 9.696969986e-01f },
+    { 1.292830089e-01f, 9.142857194e-01f },
+    { 2.094533307e-01f, 8.648648858e-01f },
+    { 2.854022001e-01f, 8.205128312e-01f },
+    { 3.575520584e-01f, 7.804877758e-01f },
+    { 4.262647601e-01f, 7.441860437e-01f },
+    { 4.918530614e-01f, 7.111111283e-01f },
+    { 5.545888974e-01f, 6.808510423e-01f },
+    { 6.147098737e-01f, 6.530612111e-01f },
+    { 6.724252909e-01f, 6.274510026e-01f },
+    { 7.279204331e-01f, 6.037735939e-01f },
+    { 7.813597592e-01f, 5.818181634e-01f },
+    { 8.328900034e-01f, 5.614035130e-01f },
+    { 8.826430467e-01f, 5.423728824e-01f },
+    { 9.307374182e-01f, 5.245901346e-01f },
+    { 9.772798402e-01f, 5.079365373e-01f },
+};
+
+// 2^(idx/16)
+static const float32_t math_exp2_table[MATH_TABLE_SIZE] =
+{
+    1.000000000e+00f, 1.044273782e+00f, 1.090507733e+00f, 1.138788635e+00f,
+    1.189207115e+00f, 1.241857812e+00f, 1.296839555e+00f, 1.354255547e+00f,
+    1.414213562e+00f, 1.476826146e+00f, 1.542210825e+00f, 1.610490332e+00f,
+    1.681792831e+00f, 1.756252160e+00f, 1.834008086e+00f, 1.915206561e+00f,
+};
+
+/**
+ * log2(|x|), x should be a normal number, 0 and denormals give about -127, inf/NaN about 129
+ */
+static inline float32_t Math_log2f_core(float32_t x)
+{
+    Math_Float32Bits_t v = { .f = x };
+
+    const int32_t e = (int32_t)((v.u >> 23) & 0xff) - 127;
+    const Math_Log2TableEntry_t* t = &math_log2_table[(v.u >> (23 - MATH_TABLE_BITS)) & (MATH_TABLE_SIZE - 1)];
+
+    v.u = (v.u & 0x007fffff) | 0x3f800000; // mantissa m as float in [1,2)
+    const float32_t r = v.f * t->inv_c - 1.0f;
+
+    // log2(1+r) = (r - r^2/2 + r^3/3 ...) / ln(2)
+    const float32_t p = r * (1.442695041f + r * (-0.7213475204f + r * 0.4808983470f));
+
+    return (float32_t)e + t->log2_c + p;
+}
+
+/**
+ * 2^x, results below 2^-126 are 0, x above 127 is limited to 127
+ */
+static inline float32_t Math_exp2f_core(float32_t x)
+{
+    if (x < -126.0f)
+    {
+        return 0.0f;
+    }
+    if (x > 127.0f)
+    {
+        x = 127.0f;
+    }
+
+    int32_t n = (int32_t)x; // rounds towards 0, we need floor
+    if ((float32_t)n > x)
+    {
+        n--;
+    }
+    const float32_t f = (x - (float32_t)n) * MATH_TABLE_SIZE;
+    // x - n may round up to 1.0 for x just below an integer, g may then be 1/16, which the polynomial still handles
+    const int32_t j = f < (MATH_TABLE_SIZE - 1) ? (int32_t)f : (MATH_TABLE_SIZE - 1);
+    const float32_t g = (f - (float32_t)j) * (1.0f / MATH_TABLE_SIZE);
+
+    // 2^g = 1 + g*ln(2) + (g*ln(2))^2/2 + (g*ln(2))^3/6 ...
+    Math_Float32Bits_t v;
+    v.f = math_exp2_table[j] * (1.0f + g * (0.6931471806f + g * (0.2402265070f + g * 0.05550410866f)));
+    v.u += (uint32_t)n << 23; // multiply by 2^n, the result is always a normal number
+
+    return v.f;
+}
+
+/**
+ * Fast algorithm for log2
+ * @param X number want log2 for, the sign is ignored
+ * @return log2(|X|), error below 4e-7 + 1 ulp of the result, i.e. 4e-7 for results near 0,
+ *         but up to 7.6e-6 for results near +-127 where the float rounding of the sum dominates
+ */
+float32_t Math_log2f_fast(float32_t X)
+{
+    return Math_log2f_core(X);
+}
+
 /**
  * Fast algorithm for log10
  *
- * This is a fast approximation to log2()
- * Y = C[0]*F*F*F + C[1]*F*F + C[2]*F + C[3] + E;
  * log10f is exactly log2(x)/log2(10.0f)
  * Math_log10f_fast(x) =(log2f_approx(x)*0.3010299956639812f)
  *
- * @param X number want log10 for
- * @return log10(x)
+ * @param X number want log10 for, the sign is ignored
+ * @return log10(|X|)
  */
-float32_t Math_log10f_fast(float32_t X) {
-    float Y, F;
-    int E;
-    F = frexpf(fabsf(X), &E);
-    Y = 1.23149591368684f;
-    Y *= F;
-    Y += -4.11852516267426f;
-    Y *= F;
-    Y += 6.02197014179219f;
-    Y *= F;
-    Y += -3.13396450166353f;
-    Y += E;
-    return(Y * 0.3010299956639812f);
+float32_t Math_log10f_fast(float32_t X)
+{
+    return Math_log2f_core(X) * MATH_LOG10_2;
+}
+
+/**
+ * Fast algorithm for 2^x
+ * @return 2^X, rel. error below 3e-7, 0 for X < -126
+ */
+float32_t Math_exp2f_fast(float32_t X)
+{
+    return Math_exp2f_core(X);
+}
+
+/**
+ * Fast algorithm for 10^x, e.g. dB to power ratio with Math_exp10f_fast(dB/10)
+ */
+float32_t Math_exp10f_fast(float32_t X)
+{
+    return Math_exp2f_core(X * MATH_LOG2_10);
+}
+
+/**
+ * Block version of the fast log2, dst[n] = offset + scale * log2(|src[n]|)
+ * scale MATH_LOG10_2 gives log10, 10*MATH_LOG10_2 gives dB of a power value.
+ * Same accuracy as Math_log2f_fast() scaled by scale, plus the rounding of scale and offset.
+ * src and dst may be the same buffer.
+ */
+void Math_log2f_fast_block(const float32_t* src, float32_t* dst, float32_t scale, float32_t offset, uint32_t blockSize)
+{
+    uint32_t blkCnt = blockSize >> 2;
+
+    while (blkCnt > 0)
+    {
+        const float32_t in1 = src[0];
+        const float32_t in2 = src[1];
+        const float32_t in3 = src[2];
+        const float32_t in4 = src[3];
+
+        dst[0] = offset + scale * Math_log2f_core(in1);
+        dst[1] = offset + scale * Math_log2f_core(in2);
+        dst[2] = offset + scale * Math_log2f_core(in3);
+        dst[3] = offset + scale * Math_log2f_core(in4);
+
+        src += 4;
+        dst += 4;
+        blkCnt--;
+    }
+
+    blkCnt = blockSize & 3;
+
+    while (blkCnt > 0)
+    {
+        *dst++ = offset + scale * Math_log2f_core(*src++);
+        blkCnt--;
+    }
+}
+
+/**
+ * Block version of the fast 2^x, dst[n] = 2^(scale * src[n])
+ * scale MATH_LOG2_E gives exp(), MATH_LOG2_10 gives 10^x.
+ * src and dst may be the same buffer.
+ */
+void Math_exp2f_fast_block(const float32_t* src, float32_t* dst, float32_t scale, uint32_t blockSize)
+{
+    uint32_t blkCnt = blockSize >> 2;
+
+    while (blkCnt > 0)
+    {
+        const float32_t in1 = src[0] * scale;
+        const float32_t in2 = src[1] * scale;
+        const float32_t in3 = src[2] * scale;
+        const float32_t in4 = src[3] * scale;
+
+        dst[0] = Math_exp2f_core(in1);
+        dst[1] = Math_exp2f_core(in2);
+        dst[2] = Math_exp2f_core(in3);
+        dst[3] = Math_exp2f_core(in4);
+
+        src += 4;
+        dst += 4;
+        blkCnt--;
+    }
+
+    blkCnt = blockSize & 3;
+
+    while (blkCnt > 0)
+    {
+        *dst++ = Math_exp2f_core(*src++ * scale);
+        blkCnt--;
+    }
 }
 
 /**
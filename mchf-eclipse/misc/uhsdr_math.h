@@ -12,7 +12,41 @@
 #define __UHSDR_MATH_H
 
 #include "uhsdr_types.h"
+
+#define MATH_LOG10_2    0.30102999566398120f    // log10(2)
+#define MATH_LOG2_E     1.44269504088896341f    // log2(e)
+#define MATH_LOG2_10    3.32192809488736235f    // log2(10)
+
+float32_t Math_log2f_fast(float32_t X);
 float32_t Math_log10f_fast(float32_t X);
+float32_t Math_exp2f_fast(float32_t X);
+float32_t Math_exp10f_fast(float32_t X);
+void Math_log2f_fast_block(const float32_t* src, float32_t* dst, float32_t scale, float32_t offset, uint32_t blockSize);
+void Math_exp2f_fast_block(const float32_t* src, float32_t* dst, float32_t scale, uint32_t blockSize);
+
+/**
+ * dst[n] = 10 * log10(|src[n]|), dB of power values
+ */
+static inline void Math_powerdBf_fast_block(const float32_t* src, float32_t* dst, uint32_t blockSize)
+{
+    Math_log2f_fast_block(src, dst, 10 * MATH_LOG10_2, 0, blockSize);
+}
+
+/**
+ * dst[n] = exp(src[n])
+ */
+static inline void Math_expf_fast_block(const float32_t* src, float32_t* dst, uint32_t blockSize)
+{
+    Math_exp2f_fast_block(src, dst, MATH_LOG2_E, blockSize);
+}
+
+/**
+ * dst[n] = 10^(src[n])
+ */
+static inline void Math_exp10f_fast_block(const float32_t* src, float32_t* dst, uint32_t blockSize)
+{
+    Math_exp2f_fast_block(src, dst, MATH_LOG2_10, blockSize);
+}
 float32_t Math_absmax(float32_t* buffer, int size);
 float32_t Math_sign_new (float32_t x);
 
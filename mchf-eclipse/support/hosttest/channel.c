@@ -0,0 +1,104 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "channel.h"
+#include "hosttest.h"
+
+/**
+ * @brief two equal power paths, each with its own complex Gaussian gain with Gaussian Doppler spectrum
+ * @param spread_hz Doppler spread (2 sigma), e.g. 1Hz for CCIR poor
+ * @param delay_ms delay of the second path, e.g. 2ms for CCIR poor
+ *
+ * The gains are sums of CHANNEL_FADING_TONES complex tones with random Doppler frequency and phase,
+ * which is close enough to Rayleigh fading for a regression test and fully reproducible.
+ */
+void Channel_FadingInit(channel_fading_t* ch, float spread_hz, float delay_ms, float fs)
+{
+	memset(ch, 0, sizeof(*ch));
+	ch->fs = fs;
+	ch->delay_samples = delay_ms * fs / 1000 + 0.5;
+	if (ch->delay_samples >= CHANNEL_DELAY_MAX)
+	{
+		ch->delay_samples = CHANNEL_DELAY_MAX - 1;
+	}
+
+	for (int path = 0; path < 2; path++)
+	{
+		for (int k = 0; k < CHANNEL_FADING_TONES; k++)
+		{
+			ch->freq[path][k] = 0.5 * spread_hz * hosttest_gauss();
+			ch->phase[path][k] = 2 * M_PI * hosttest_uniform();
+		}
+	}
+}
+
+static COMP Channel_FadingGain(const channel_fading_t* ch, int path)
+{
+	// each path has half of the power, the tones add up to a variance of 1
+	const float scale = sqrtf(0.5 / CHANNEL_FADING_TONES);
+	const double t = ch->n / ch->fs;
+	COMP g = { 0, 0 };
+
+	for (int k = 0; k < CHANNEL_FADING_TONES; k++)
+	{
+		const double phi = 2 * M_PI * ch->freq[path][k] * t + ch->phase[path][k];
+		g.real += scale * cos(phi);
+		g.imag += scale * sin(phi);
+	}
+	return g;
+}
+
+void Channel_Fading(channel_fading_t* ch, COMP* sig, uint32_t len)
+{
+	for (uint32_t i = 0; i < len; i++)
+	{
+		const COMP g0 = Channel_FadingGain(ch, 0);
+		const COMP g1 = Channel_FadingGain(ch, 1);
+
+		const COMP x0 = sig[i];
+		ch->delay[ch->delay_idx] = x0;
+		const COMP x1 = ch->delay[(ch->delay_idx + CHANNEL_DELAY_MAX - ch->delay_samples) % CHANNEL_DELAY_MAX];
+		ch->delay_idx = (ch->delay_idx + 1) % CHANNEL_DELAY_MAX;
+
+		sig[i].real = g0.real * x0.real - g0.imag * x0.imag + g1.real * x1.real - g1.imag * x1.imag;
+		sig[i].imag = g0.real * x0.imag + g0.imag * x0.real + g1.real * x1.imag + g1.imag * x1.real;
+		ch->n++;
+	}
+}
+
+/**
+ * @returns average power of the real part, i.e. of the real modem signal
+ */
+float Channel_Power(const COMP* sig, uint32_t len)
+{
+	double sum = 0;
+	for (uint32_t i = 0; i < len; i++)
+	{
+		sum += sig[i].real * sig[i].real;
+	}
+	return len ? sum / len : 0;
+}
+
+/**
+ * @brief adds white noise to the real part
+ * @param sig_pwr signal power, as returned by Channel_Power() of the signal before the channel
+ * @param snr_db SNR in 3kHz bandwidth, as used by codec2
+ */
+void Channel_AddNoise(COMP* sig, uint32_t len, float sig_pwr, float snr_db, float fs)
+{
+	// the noise is spread over fs/2
+	const float sigma = sqrtf(sig_pwr / powf(10, snr_db / 10) * (fs / 2) / 3000);
+	for (uint32_t i = 0; i < len; i++)
+	{
+		sig[i].real += sigma * hosttest_gauss();
+	}
+}
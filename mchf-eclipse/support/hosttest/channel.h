@@ -0,0 +1,41 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+/*
+ * HF channel simulation for the modem tests: white noise and a two path Watterson fading channel,
+ * working on the analytic (complex) modem signal as delivered by freedv_comptx().
+ */
+
+#ifndef __CHANNEL_H
+#define __CHANNEL_H
+
+#include <stdint.h>
+#include "comp.h"
+
+#define CHANNEL_FADING_TONES	16
+#define CHANNEL_DELAY_MAX		64
+
+typedef struct
+{
+	float freq[2][CHANNEL_FADING_TONES];	// Doppler frequency of each tone, per path
+	float phase[2][CHANNEL_FADING_TONES];
+	COMP delay[CHANNEL_DELAY_MAX];			// input of the delayed path
+	uint32_t delay_samples;
+	uint32_t delay_idx;
+	uint32_t n;								// samples processed so far
+	float fs;
+} channel_fading_t;
+
+void Channel_FadingInit(channel_fading_t* ch, float spread_hz, float delay_ms, float fs);
+void Channel_Fading(channel_fading_t* ch, COMP* sig, uint32_t len);
+
+float Channel_Power(const COMP* sig, uint32_t len);
+void Channel_AddNoise(COMP* sig, uint32_t len, float sig_pwr, float snr_db, float fs);
+
+#endif
@@ -0,0 +1,387 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+/*
+ * Scores the CW decoders (threshold based and adaptive) on a synthetic corpus.
+ *
+ * The corpus is hand keyed CW: element and space lengths vary randomly by +-15%, the keying has
+ * 5ms raised cosine edges and white noise is added. SNR is given in 500Hz bandwidth.
+ * The level is the one the AGC delivers: signal plus noise in the 500Hz CW filter at the AGC target.
+ * Each case is run in its own process since the decoders keep their state in function statics.
+ * For each speed and SNR the character error rate of both decoders is printed, the adaptive decoder
+ * has to reach the limits in cw_score_limits.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "uhsdr_board.h"
+#include "radio_management.h"
+#include "cw_decoder.h"
+#include "hosttest.h"
+
+#define CW_SCORE_FS				12000
+#define CW_SCORE_TONE			750
+#define CW_SCORE_EDGE_MS		5.0
+#define CW_SCORE_JITTER			0.15
+#define CW_SCORE_BLOCK			32 // audio block size of the decimated RX path
+#define CW_SCORE_TEXT_MAX		512
+
+// warm up text, not scored. Both decoders need a few characters to learn the speed.
+static const char cw_score_preamble[] = "VVV VVV TEST ";
+
+static const char cw_score_text[] =
+		"CQ CQ DE DL1ABC DL1ABC PSE K "
+		"R TNX FER CALL UR RST 579 579 NAME IS JOE QTH NR MUNICH HW CPY "
+		"RIG IS MCHF PWR 5W ANT DIPOLE WX SUNNY 22C 73 ES GL ";
+
+#define CW_SCORE_NOISE_ONLY		(-100) // snr_db of the case without any signal
+#define CW_SCORE_NOISE_S		60
+#define CW_SCORE_NOISE_MAX		8 // highest accepted number of characters decoded from noise alone
+
+static const int cw_score_wpm[] = { 10, 15, 20, 25, 30, 35, 40, 45 };
+static const int cw_score_snr[] = { 30, 15, 10, 6, 3 };
+
+#define CW_SCORE_NUM_WPM	(sizeof(cw_score_wpm)/sizeof(cw_score_wpm[0]))
+#define CW_SCORE_NUM_SNR	(sizeof(cw_score_snr)/sizeof(cw_score_snr[0]))
+
+// highest accepted character error rate of the adaptive decoder per SNR, a bit above what it reaches now
+static const float cw_score_limits[CW_SCORE_NUM_SNR] = { 0.03, 0.03, 0.10, 0.50, 1.0 };
+
+static const struct
+{
+	char c;
+	const char* code;
+} cw_score_morse[] =
+{
+	{ 'A', ".-" }, { 'B', "-..." }, { 'C', "-.-." }, { 'D', "-.." }, { 'E', "." }, { 'F', "..-." },
+	{ 'G', "--." }, { 'H', "...." }, { 'I', ".." }, { 'J', ".---" }, { 'K', "-.-" }, { 'L', ".-.." },
+	{ 'M', "--" }, { 'N', "-." }, { 'O', "---" }, { 'P', ".--." }, { 'Q', "--.-" }, { 'R', ".-." },
+	{ 'S', "..." }, { 'T', "-" }, { 'U', "..-" }, { 'V', "...-" }, { 'W', ".--" }, { 'X', "-..-" },
+	{ 'Y', "-.--" }, { 'Z', "--.." }, { '0', "-----" }, { '1', ".----" }, { '2', "..---" },
+	{ '3', "...--" }, { '4', "....-" }, { '5', "....." }, { '6', "-...." }, { '7', "--..." },
+	{ '8', "---.." }, { '9', "----." }, { '/', "-..-." }, { '?', "..--.." }, { '.', ".-.-.-" },
+	{ ',', "--..--" }, { '=', "-...-" },
+};
+
+typedef struct
+{
+	float phase;
+	float amplitude;
+	float noise_sigma;
+	float block[CW_SCORE_BLOCK];
+	int fill;
+} cw_score_tx_t;
+
+static char cw_score_rx[CW_SCORE_TEXT_MAX];
+static int cw_score_rx_len;
+
+// the decoders print through this function
+void UiDriver_TextMsgPutChar(char ch)
+{
+	if (cw_score_rx_len < CW_SCORE_TEXT_MAX - 1)
+	{
+		cw_score_rx[cw_score_rx_len++] = ch;
+	}
+}
+
+void Board_RedLed(ledstate_t state)
+{
+}
+
+static const char* CwScore_Code(char c)
+{
+	for (size_t i = 0; i < sizeof(cw_score_morse)/sizeof(cw_score_morse[0]); i++)
+	{
+		if (cw_score_morse[i].c == c)
+		{
+			return cw_score_morse[i].code;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief generates key down or key up audio for the given number of dit units (+-jitter) and feeds it to the decoder
+ */
+static void CwScore_Key(cw_score_tx_t* tx, bool key_down, float units, float dit_s)
+{
+	const float len_s = units * dit_s * (1.0 + CW_SCORE_JITTER * (2 * hosttest_uniform() - 1));
+	const int len = len_s * CW_SCORE_FS;
+	const int edge = CW_SCORE_EDGE_MS * CW_SCORE_FS / 1000;
+	const float dphi = 2 * M_PI * CW_SCORE_TONE / CW_SCORE_FS;
+
+	for (int i = 0; i < len; i++)
+	{
+		float env = 0;
+		if (key_down)
+		{
+			env = 1.0;
+			if (i < edge)
+			{
+				env = 0.5 - 0.5 * cosf(M_PI * i / edge);
+			}
+			else if (len - i < edge)
+			{
+				env = 0.5 - 0.5 * cosf(M_PI * (len - i) / edge);
+			}
+		}
+		tx->phase += dphi;
+		if (tx->phase > 2 * M_PI)
+		{
+			tx->phase -= 2 * M_PI;
+		}
+		tx->block[tx->fill++] = tx->amplitude * env * sinf(tx->phase) + tx->noise_sigma * hosttest_gauss();
+		if (tx->fill == CW_SCORE_BLOCK)
+		{
+			CwDecode_RxProcessor(tx->block, CW_SCORE_BLOCK);
+			tx->fill = 0;
+		}
+	}
+}
+
+static void CwScore_Send(cw_score_tx_t* tx, const char* text, float dit_s)
+{
+	for (const char* p = text; *p != '\0'; p++)
+	{
+		if (*p == ' ')
+		{
+			CwScore_Key(tx, false, 4, dit_s); // plus 3 after the last character == 7
+			continue;
+		}
+		const char* code = CwScore_Code(*p);
+		for (const char* e = code; e != NULL && *e != '\0'; e++)
+		{
+			CwScore_Key(tx, true, *e == '-' ? 3 : 1, dit_s);
+			CwScore_Key(tx, false, e[1] != '\0' ? 1 : 3, dit_s);
+		}
+	}
+}
+
+/**
+ * @brief runs one case, prints the decoded text and the speed estimate into fd
+ */
+static void CwScore_RunCase(bool adaptive, int wpm, int snr_db, int fd)
+{
+	ts.dmod_mode = DEMOD_CW;
+	ts.txrx_mode = TRX_MODE_RX;
+	ts.cw_decoder_enable = true;
+	ts.cw_sidetone_freq = CW_SCORE_TONE;
+	cw_decoder_config.use_adaptive = adaptive;
+	CwDecode_Filter_Set();
+
+	hosttest_seed(1000 * wpm + snr_db + 1);
+
+	cw_score_tx_t tx = { 0 };
+	const float dit_s = 1.2 / wpm;
+	if (snr_db == CW_SCORE_NOISE_ONLY)
+	{
+		// the AGC brings the noise in the 500Hz filter up to the target level
+		tx.noise_sigma = ADC_CLIP_WARN_THRESHOLD * sqrtf(0.5 * (CW_SCORE_FS / 2) / 500.0);
+		CwScore_Key(&tx, false, CW_SCORE_NOISE_S / dit_s, dit_s);
+	}
+	else
+	{
+		const float snr = powf(10, snr_db / 10.0);
+		tx.amplitude = ADC_CLIP_WARN_THRESHOLD * sqrtf(snr / (1 + snr));
+		// SNR in 500Hz, the noise is spread over fs/2
+		tx.noise_sigma = sqrtf(tx.amplitude * tx.amplitude / 2 / snr * (CW_SCORE_FS / 2) / 500.0);
+
+		CwScore_Key(&tx, false, 20, dit_s);
+		CwScore_Send(&tx, cw_score_preamble, dit_s);
+		CwScore_Send(&tx, cw_score_text, dit_s);
+		CwScore_Key(&tx, false, 20, dit_s);
+	}
+
+	cw_score_rx[cw_score_rx_len] = '\0';
+	dprintf(fd, "%u %s", cw_decoder_config.speed, cw_score_rx);
+}
+
+/**
+ * @brief normalizes decoder output: upper case, single spaces
+ */
+static void CwScore_Normalize(char* s)
+{
+	char* out = s;
+	bool space = true;
+	for (char* in = s; *in != '\0'; in++)
+	{
+		if (isspace((unsigned char)*in))
+		{
+			if (space == false)
+			{
+				*out++ = ' ';
+			}
+			space = true;
+		}
+		else
+		{
+			*out++ = toupper((unsigned char)*in);
+			space = false;
+		}
+	}
+	*out = '\0';
+}
+
+/**
+ * @brief edit distance of the sent text against the decoded text, garbage decoded before the text starts is free
+ */
+static int CwScore_Errors(const char* sent, const char* rx)
+{
+	const int n = strlen(sent), m = strlen(rx);
+	int* prev = malloc((m + 1) * sizeof(int));
+	int* cur = malloc((m + 1) * sizeof(int));
+
+	for (int j = 0; j <= m; j++)
+	{
+		prev[j] = 0;
+	}
+	for (int i = 1; i <= n; i++)
+	{
+		cur[0] = i;
+		for (int j = 1; j <= m; j++)
+		{
+			int d = prev[j-1] + (sent[i-1] != rx[j-1]);
+			d = prev[j] + 1 < d ? prev[j] + 1 : d;
+			d = cur[j-1] + 1 < d ? cur[j-1] + 1 : d;
+			cur[j] = d;
+		}
+		int* tmp = prev;
+		prev = cur;
+		cur = tmp;
+	}
+	const int retval = prev[m];
+	free(prev);
+	free(cur);
+	return retval;
+}
+
+/**
+ * @brief runs one case in a child process
+ * @param text decoded text, CW_SCORE_TEXT_MAX bytes
+ * @returns speed estimate of the decoder
+ */
+static unsigned int CwScore_Decode(bool adaptive, int wpm, int snr_db, char* text)
+{
+	int fds[2];
+	char buf[CW_SCORE_TEXT_MAX + 16];
+	int len = 0;
+
+	text[0] = '\0';
+	if (pipe(fds) != 0)
+	{
+		return 0;
+	}
+	const pid_t pid = fork();
+	if (pid == 0)
+	{
+		close(fds[0]);
+		CwScore_RunCase(adaptive, wpm, snr_db, fds[1]);
+		close(fds[1]);
+		_exit(0);
+	}
+	close(fds[1]);
+	int r;
+	while ((r = read(fds[0], buf + len, sizeof(buf) - 1 - len)) > 0)
+	{
+		len += r;
+	}
+	close(fds[0]);
+	waitpid(pid, NULL, 0);
+	buf[len] = '\0';
+
+	char* rx;
+	const unsigned int wpm_est = strtoul(buf, &rx, 10);
+	strncpy(text, rx, CW_SCORE_TEXT_MAX - 1);
+	text[CW_SCORE_TEXT_MAX - 1] = '\0';
+	CwScore_Normalize(text);
+	return wpm_est;
+}
+
+/**
+ * @returns character error rate of one case, speed estimate in *wpm_est
+ */
+static float CwScore_Case(bool adaptive, int wpm, int snr_db, unsigned int* wpm_est)
+{
+	char text[CW_SCORE_TEXT_MAX];
+	*wpm_est = CwScore_Decode(adaptive, wpm, snr_db, text);
+
+	char sent[sizeof(cw_score_text)];
+	strcpy(sent, cw_score_text);
+	CwScore_Normalize(sent);
+
+	return (float)CwScore_Errors(sent, text) / strlen(sent);
+}
+
+/**
+ * @returns number of characters decoded from noise alone
+ */
+static int CwScore_NoiseCase(bool adaptive)
+{
+	char text[CW_SCORE_TEXT_MAX];
+	CwScore_Decode(adaptive, 25, CW_SCORE_NOISE_ONLY, text);
+
+	int count = 0;
+	for (const char* p = text; *p != '\0'; p++)
+	{
+		count += *p != ' ';
+	}
+	return count;
+}
+
+int main(void)
+{
+	float cer_sum[2] = { 0, 0 };
+
+	printf("character error rate, threshold decoder / adaptive decoder (speed estimate)\n");
+	printf("WPM ");
+	for (size_t s = 0; s < CW_SCORE_NUM_SNR; s++)
+	{
+		printf("| %3d dB                ", cw_score_snr[s]);
+	}
+	printf("\n");
+
+	for (size_t w = 0; w < CW_SCORE_NUM_WPM; w++)
+	{
+		printf("%3d ", cw_score_wpm[w]);
+		for (size_t s = 0; s < CW_SCORE_NUM_SNR; s++)
+		{
+			unsigned int est_old, est_new;
+			const float cer_old = CwScore_Case(false, cw_score_wpm[w], cw_score_snr[s], &est_old);
+			const float cer_new = CwScore_Case(true, cw_score_wpm[w], cw_score_snr[s], &est_new);
+			cer_sum[0] += cer_old;
+			cer_sum[1] += cer_new;
+			printf("| %5.1f%% / %5.1f%% (%2u) ", 100 * cer_old, 100 * cer_new, est_new);
+
+			HOSTTEST_CHECK(cer_new <= cw_score_limits[s], "adaptive decoder %d WPM %d dB: CER %.3f above %.3f",
+					cw_score_wpm[w], cw_score_snr[s], cer_new, cw_score_limits[s]);
+			if (cw_score_snr[s] >= 10)
+			{
+				HOSTTEST_CHECK(fabsf((float)est_new - cw_score_wpm[w]) <= 0.1 * cw_score_wpm[w] + 1,
+						"adaptive decoder %d WPM %d dB: speed estimate %u", cw_score_wpm[w], cw_score_snr[s], est_new);
+			}
+		}
+		printf("\n");
+	}
+
+	const int cases = CW_SCORE_NUM_WPM * CW_SCORE_NUM_SNR;
+	printf("mean CER: threshold decoder %.1f%%, adaptive decoder %.1f%%\n", 100 * cer_sum[0] / cases, 100 * cer_sum[1] / cases);
+	HOSTTEST_CHECK(cer_sum[1] < cer_sum[0], "adaptive decoder is not better than the threshold decoder");
+
+	const int noise_old = CwScore_NoiseCase(false);
+	const int noise_new = CwScore_NoiseCase(true);
+	printf("characters decoded from %ds of noise: threshold decoder %d, adaptive decoder %d\n", CW_SCORE_NOISE_S, noise_old, noise_new);
+	HOSTTEST_CHECK(noise_new <= CW_SCORE_NOISE_MAX, "adaptive decoder decodes %d characters from noise", noise_new);
+
+	return hosttest_result();
+}
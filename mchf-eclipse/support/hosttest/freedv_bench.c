@@ -0,0 +1,301 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+/*
+ * FreeDV demodulator throughput, reported as frames (freedv_rx calls) per second of host time.
+ *
+ * 700D: test frames through AWGN at the SNRs the fixed point min-sum LDPC decoder was tuned for,
+ * the coded BER has to stay within the limits. 1600: the recorded signal of freedv_test_data.c
+ * (the vectors of FreeDV_Test()), played several times, the demodulator has to sync on it.
+ * The frame rates depend on the host and are not checked, they are meant for comparing changes.
+ *
+ * NLP pitch estimator: the CMSIS version of nlp.c (FDV_ARM_MATH, decimating FIR and real FFT) has to
+ * deliver the same pitch track as the upstream codec2 code, which is built a second time from the same
+ * nlp.c without FDV_ARM_MATH and with renamed symbols (nlp_ref_*, see CMakeLists.txt). The input is the
+ * speech decoded from the 1600 recording plus synthetic voiced, unvoiced and silent segments.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "freedv_uhsdr.h" // before freedv_api.h, which brings in the I macro of complex.h
+#include "freedv_api.h"
+#include "sine.h"
+#include "nlp.h"
+#include "channel.h"
+#include "hosttest.h"
+
+#define FDV_BENCH_FS				8000
+#define FDV_BENCH_700D_FRAMES		1000
+#define FDV_BENCH_REC_PASSES		25 // test_buffer holds 2s of signal
+#define FDV_BENCH_REC_SYNC_MS_MAX	1000
+#define FDV_BENCH_NLP_SECONDS		30
+
+// upstream nlp.c, see CMakeLists.txt
+void *nlp_ref_create(C2CONST *c2const);
+void nlp_ref_destroy(void *nlp_state);
+float nlp_ref(void *nlp_state, float Sn[], int n, float *pitch_samples, COMP Sw[], COMP W[], float *prev_f0);
+
+typedef struct
+{
+	int16_t* buf;
+	uint32_t len;
+	uint32_t max;
+} fdv_bench_speech_t;
+
+typedef struct
+{
+	float snr_db;			// in 3kHz
+	float ber_coded_max;
+} fdv_bench_case_t;
+
+// limits are set a bit above what the current code reaches
+static const fdv_bench_case_t fdv_bench_700d_cases[] =
+{
+	{ -2, 0.008 },
+	{  1, 0.002 },
+};
+
+#define FDV_BENCH_700D_CASES (sizeof(fdv_bench_700d_cases)/sizeof(fdv_bench_700d_cases[0]))
+
+/**
+ * @brief demodulates len samples of the real part of sig
+ * @param sync_ms set to the time of the first sync if still UINT32_MAX, may be NULL
+ * @param speech_out the decoded speech is appended as long as it fits, may be NULL
+ * @returns number of freedv_rx() calls, their run time is added to seconds
+ */
+static uint32_t FdvBench_Rx(struct freedv* f, const COMP* sig, uint32_t len, double* seconds, uint32_t* sync_ms,
+		fdv_bench_speech_t* speech_out)
+{
+	int16_t* speech = malloc(freedv_get_n_speech_samples(f) * sizeof(int16_t));
+	int16_t* demod_in = malloc(freedv_get_n_max_modem_samples(f) * sizeof(int16_t));
+	uint32_t calls = 0;
+
+	for (uint32_t pos = 0; pos + freedv_nin(f) <= len; )
+	{
+		const int nin = freedv_nin(f);
+		for (int i = 0; i < nin; i++)
+		{
+			const float s = sig[pos + i].real;
+			demod_in[i] = s > INT16_MAX ? INT16_MAX : (s < INT16_MIN ? INT16_MIN : s);
+		}
+		const double start = hosttest_seconds();
+		const int nout = freedv_rx(f, speech, demod_in);
+		*seconds += hosttest_seconds() - start;
+		calls++;
+		pos += nin;
+
+		if (sync_ms != NULL && *sync_ms == UINT32_MAX && freedv_get_sync(f) != 0)
+		{
+			*sync_ms = pos * 1000 / FDV_BENCH_FS;
+		}
+		if (speech_out != NULL && speech_out->len + nout <= speech_out->max)
+		{
+			memcpy(&speech_out->buf[speech_out->len], speech, nout * sizeof(int16_t));
+			speech_out->len += nout;
+		}
+	}
+
+	free(demod_in);
+	free(speech);
+	return calls;
+}
+
+static void FdvBench_700D(const fdv_bench_case_t* c)
+{
+	struct freedv* f = freedv_open(FREEDV_MODE_700D);
+	HOSTTEST_CHECK(f != NULL, "700D can't be opened");
+	if (f == NULL)
+	{
+		return;
+	}
+	freedv_set_test_frames(f, 1);
+	freedv_set_tx_bpf(f, 0);
+
+	const int n_nom = freedv_get_n_nom_modem_samples(f);
+	const uint32_t len = FDV_BENCH_700D_FRAMES * n_nom;
+	COMP* sig = malloc(len * sizeof(COMP));
+	int16_t* speech = calloc(freedv_get_n_speech_samples(f), sizeof(int16_t)); // not used with test frames
+
+	for (int frame = 0; frame < FDV_BENCH_700D_FRAMES; frame++)
+	{
+		freedv_comptx(f, &sig[frame * n_nom], speech);
+	}
+	Channel_AddNoise(sig, len, Channel_Power(sig, len), c->snr_db, FDV_BENCH_FS);
+
+	double seconds = 0;
+	const uint32_t calls = FdvBench_Rx(f, sig, len, &seconds, NULL, NULL);
+	const float ber_coded = freedv_get_total_bits_coded(f) > 0 ?
+			(float)freedv_get_total_bit_errors_coded(f) / freedv_get_total_bits_coded(f) : 1;
+
+	printf("700D AWGN %3.0fdB | %7.0f | %8.5f\n", c->snr_db, calls / seconds, ber_coded);
+	HOSTTEST_CHECK(ber_coded <= c->ber_coded_max, "700D %.0fdB: coded BER %.5f above %.5f", c->snr_db, ber_coded,
+			c->ber_coded_max);
+
+	free(speech);
+	free(sig);
+	freedv_close(f);
+}
+
+/**
+ * @param speech_out gets the speech decoded from the first pass
+ */
+static void FdvBench_Recording(fdv_bench_speech_t* speech_out)
+{
+	struct freedv* f = freedv_open(FREEDV_MODE_1600);
+	HOSTTEST_CHECK(f != NULL, "1600 can't be opened");
+	if (f == NULL)
+	{
+		return;
+	}
+
+	const uint32_t len = FREEDV_TEST_BUFFER_FRAME_SIZE * FREEDV_TEST_BUFFER_FRAME_COUNT;
+	uint32_t sync_ms = UINT32_MAX;
+	uint32_t calls = 0;
+	double seconds = 0;
+
+	// the demodulator keeps its state between the passes, the leftover samples of a pass are dropped
+	for (int pass = 0; pass < FDV_BENCH_REC_PASSES; pass++)
+	{
+		calls += FdvBench_Rx(f, test_buffer, len, &seconds, pass == 0 ? &sync_ms : NULL, pass == 0 ? speech_out : NULL);
+	}
+
+	printf("1600 recording  | %7.0f | sync after %ldms\n", calls / seconds, sync_ms == UINT32_MAX ? -1L : (long)sync_ms);
+	HOSTTEST_CHECK(sync_ms <= FDV_BENCH_REC_SYNC_MS_MAX, "1600 recording: sync after %ldms, limit %dms",
+			sync_ms == UINT32_MAX ? -1L : (long)sync_ms, FDV_BENCH_REC_SYNC_MS_MAX);
+
+	freedv_close(f);
+}
+
+/**
+ * @brief appends synthetic speech like segments of 0.4s: voiced with gliding pitch, unvoiced and silence
+ */
+static void FdvBench_SyntheticSpeech(fdv_bench_speech_t* speech)
+{
+	float f0 = 120, phase = 0;
+	float y1[2] = { 0, 0 }, y2[2] = { 0, 0 };
+	// two formants, as two pole resonators
+	const float formant_hz[2] = { 600, 1700 };
+	const float r = 0.96;
+
+	for (uint32_t seg = 0; speech->len < speech->max; seg++)
+	{
+		const int type = seg % 5 == 4 ? 2 : (seg % 5 == 2 ? 1 : 0); // 0 voiced, 1 unvoiced, 2 silence
+		const float f0_end = 70 + 280 * hosttest_uniform();
+
+		for (uint32_t i = 0; i < FDV_BENCH_FS * 2 / 5 && speech->len < speech->max; i++)
+		{
+			float x;
+			if (type == 0)
+			{
+				f0 += (f0_end - f0) / 2000;
+				phase += f0 / FDV_BENCH_FS;
+				// glottal pulse once per period
+				x = phase >= 1 ? 4000 : 0;
+				phase -= phase >= 1 ? 1 : 0;
+				x += 20 * hosttest_gauss();
+			}
+			else
+			{
+				x = (type == 1 ? 800 : 5) * hosttest_gauss();
+			}
+
+			float y = 0;
+			for (int k = 0; k < 2; k++)
+			{
+				const float v = x + 2 * r * cosf(2 * M_PI * formant_hz[k] / FDV_BENCH_FS) * y1[k] - r * r * y2[k];
+				y2[k] = y1[k];
+				y1[k] = v;
+				y += v;
+			}
+			y *= 0.05;
+			speech->buf[speech->len++] = y > INT16_MAX ? INT16_MAX : (y < INT16_MIN ? INT16_MIN : y);
+		}
+	}
+}
+
+/**
+ * @brief runs the speech through the CMSIS and the upstream NLP, the pitch tracks have to be the same
+ */
+static void FdvBench_NlpTrack(const fdv_bench_speech_t* speech)
+{
+	C2CONST c2const = c2const_create(FDV_BENCH_FS, N_S);
+	const int m = c2const.m_pitch;
+	const int n = c2const.n_samp;
+	void* nlp_arm = nlp_create(&c2const);
+	void* nlp_upstream = nlp_ref_create(&c2const);
+
+	float Sn[m];
+	COMP Sw[FFT_ENC], W[FFT_ENC]; // only used by post_process_mbe(), not built
+	float prev_f0_arm = 1 / P_MAX_S, prev_f0_upstream = 1 / P_MAX_S;
+	uint32_t frames = 0, mismatches = 0;
+	double seconds_arm = 0, seconds_upstream = 0;
+
+	memset(Sn, 0, sizeof(Sn));
+	memset(Sw, 0, sizeof(Sw));
+	memset(W, 0, sizeof(W));
+
+	for (uint32_t pos = 0; pos + n <= speech->len; pos += n)
+	{
+		memmove(Sn, &Sn[n], (m - n) * sizeof(float));
+		for (int i = 0; i < n; i++)
+		{
+			Sn[m - n + i] = speech->buf[pos + i];
+		}
+
+		float pitch_arm, pitch_upstream;
+		double start = hosttest_seconds();
+		const float f0_arm = nlp(nlp_arm, Sn, n, &pitch_arm, Sw, W, &prev_f0_arm);
+		seconds_arm += hosttest_seconds() - start;
+
+		start = hosttest_seconds();
+		const float f0_upstream = nlp_ref(nlp_upstream, Sn, n, &pitch_upstream, Sw, W, &prev_f0_upstream);
+		seconds_upstream += hosttest_seconds() - start;
+
+		if (f0_arm != f0_upstream || pitch_arm != pitch_upstream)
+		{
+			if (mismatches < 10)
+			{
+				printf("  frame %u: f0 %.3f upstream %.3f\n", frames, f0_arm, f0_upstream);
+			}
+			mismatches++;
+		}
+		frames++;
+	}
+
+	printf("NLP pitch track | %u frames, %u differ | %.2fus per frame, upstream %.2fus\n", frames, mismatches,
+			seconds_arm * 1e6 / frames, seconds_upstream * 1e6 / frames);
+	HOSTTEST_CHECK(mismatches == 0, "NLP: %u of %u pitch estimates differ from upstream codec2", mismatches, frames);
+
+	nlp_ref_destroy(nlp_upstream);
+	nlp_destroy(nlp_arm);
+}
+
+int main(void)
+{
+	static int16_t speech_buf[FDV_BENCH_NLP_SECONDS * FDV_BENCH_FS];
+	fdv_bench_speech_t speech = { speech_buf, 0, FDV_BENCH_NLP_SECONDS * FDV_BENCH_FS };
+
+	printf("mode signal     | frames/s | coded BER\n");
+
+	for (size_t idx = 0; idx < FDV_BENCH_700D_CASES; idx++)
+	{
+		hosttest_seed(32 + idx);
+		FdvBench_700D(&fdv_bench_700d_cases[idx]);
+	}
+	FdvBench_Recording(&speech);
+	printf("1600 recording  | %.2fs speech decoded\n", (float)speech.len / FDV_BENCH_FS);
+
+	hosttest_seed(36);
+	FdvBench_SyntheticSpeech(&speech);
+	FdvBench_NlpTrack(&speech);
+
+	return hosttest_result();
+}
@@ -0,0 +1,169 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+/*
+ * FreeDV mode x channel regression, the off target counterpart of FreeDV_Test() (DEBUG_FREEDV).
+ *
+ * Every enabled mode sends test frames through AWGN and CCIR poor fading channels (two paths, 2ms delay,
+ * 1Hz Doppler spread) and the demodulator the radio uses on F7/H7 (freedv_rx with real input) receives them.
+ * Time to first sync and bit error rate (for 700D also after LDPC decoding) have to stay within the limits
+ * of each case.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "freedv_api.h"
+#include "channel.h"
+#include "hosttest.h"
+
+#define FDV_CHANNEL_FS			8000
+#define FDV_CHANNEL_SECONDS		30
+
+typedef enum
+{
+	FDV_CHANNEL_AWGN = 0,
+	FDV_CHANNEL_CCIR_POOR,
+} fdv_channel_t;
+
+typedef struct
+{
+	int mode;
+	const char* name;
+	fdv_channel_t channel;
+	float snr_db;			// in 3kHz
+	uint32_t sync_ms_max;
+	float ber_max;			// raw bit error rate
+	float ber_coded_max;	// after LDPC decoding, 700D only
+} fdv_channel_case_t;
+
+// limits are set a bit above what the current code reaches
+static const fdv_channel_case_t fdv_channel_cases[] =
+{
+#if FREEDV_MODE_1600_EN
+	{ FREEDV_MODE_1600, "1600", FDV_CHANNEL_AWGN,      20, 1000, 0.001, 0 },
+	{ FREEDV_MODE_1600, "1600", FDV_CHANNEL_AWGN,       4, 1000, 0.03,  0 },
+	{ FREEDV_MODE_1600, "1600", FDV_CHANNEL_CCIR_POOR, 15, 2000, 0.06,  0 },
+#endif
+#if FREEDV_MODE_700D_EN
+	{ FREEDV_MODE_700D, "700D", FDV_CHANNEL_AWGN,      20, 1000, 0.001, 0.001 },
+	{ FREEDV_MODE_700D, "700D", FDV_CHANNEL_AWGN,       0, 2000, 0.08,  0.01 },
+	{ FREEDV_MODE_700D, "700D", FDV_CHANNEL_CCIR_POOR,  6, 3000, 0.10,  0.04 },
+#endif
+};
+
+#define FDV_CHANNEL_CASES (sizeof(fdv_channel_cases)/sizeof(fdv_channel_cases[0]))
+
+typedef struct
+{
+	uint32_t sync_ms;		// UINT32_MAX if never in sync
+	float ber;
+	float ber_coded;
+} fdv_channel_result_t;
+
+static void FdvChannel_Run(const fdv_channel_case_t* c, fdv_channel_result_t* res)
+{
+	res->sync_ms = UINT32_MAX;
+	res->ber = 1;
+	res->ber_coded = 1;
+
+	struct freedv* f = freedv_open(c->mode);
+	if (f == NULL)
+	{
+		return;
+	}
+	freedv_set_test_frames(f, 1);
+	freedv_set_tx_bpf(f, 0);
+
+	const int n_nom = freedv_get_n_nom_modem_samples(f);
+	const int frames = FDV_CHANNEL_SECONDS * FDV_CHANNEL_FS / n_nom;
+	const uint32_t len = frames * n_nom;
+	COMP* sig = malloc(len * sizeof(COMP));
+	int16_t* speech = calloc(freedv_get_n_speech_samples(f), sizeof(int16_t)); // not used with test frames
+	int16_t* demod_in = malloc(freedv_get_n_max_modem_samples(f) * sizeof(int16_t));
+
+	for (int frame = 0; frame < frames; frame++)
+	{
+		freedv_comptx(f, &sig[frame * n_nom], speech);
+	}
+
+	const float sig_pwr = Channel_Power(sig, len);
+	if (c->channel == FDV_CHANNEL_CCIR_POOR)
+	{
+		channel_fading_t fading;
+		Channel_FadingInit(&fading, 1.0, 2.0, FDV_CHANNEL_FS);
+		Channel_Fading(&fading, sig, len);
+	}
+	Channel_AddNoise(sig, len, sig_pwr, c->snr_db, FDV_CHANNEL_FS);
+
+	for (uint32_t pos = 0; pos + freedv_nin(f) <= len; )
+	{
+		const int nin = freedv_nin(f);
+		for (int i = 0; i < nin; i++)
+		{
+			const float s = sig[pos + i].real;
+			demod_in[i] = s > INT16_MAX ? INT16_MAX : (s < INT16_MIN ? INT16_MIN : s);
+		}
+		freedv_rx(f, speech, demod_in);
+		pos += nin;
+
+		if (res->sync_ms == UINT32_MAX && freedv_get_sync(f) != 0)
+		{
+			res->sync_ms = pos * 1000 / FDV_CHANNEL_FS;
+		}
+	}
+
+	if (freedv_get_total_bits(f) > 0)
+	{
+		res->ber = (float)freedv_get_total_bit_errors(f) / freedv_get_total_bits(f);
+	}
+	if (freedv_get_total_bits_coded(f) > 0)
+	{
+		res->ber_coded = (float)freedv_get_total_bit_errors_coded(f) / freedv_get_total_bits_coded(f);
+	}
+
+	free(demod_in);
+	free(speech);
+	free(sig);
+	freedv_close(f);
+}
+
+int main(void)
+{
+	printf("mode channel   SNR  | sync ms | BER      | coded BER\n");
+
+	for (size_t idx = 0; idx < FDV_CHANNEL_CASES; idx++)
+	{
+		const fdv_channel_case_t* c = &fdv_channel_cases[idx];
+		fdv_channel_result_t res;
+
+		hosttest_seed(38 + idx);
+		FdvChannel_Run(c, &res);
+
+		printf("%-4s %-8s %3.0fdB | %7ld | %8.5f | ", c->name, c->channel == FDV_CHANNEL_AWGN ? "AWGN" : "CCIRpoor", c->snr_db,
+				res.sync_ms == UINT32_MAX ? -1L : (long)res.sync_ms, res.ber);
+		if (c->ber_coded_max > 0)
+		{
+			printf("%8.5f", res.ber_coded);
+		}
+		printf("\n");
+
+		HOSTTEST_CHECK(res.sync_ms <= c->sync_ms_max, "%s %.0fdB: sync after %ldms, limit %lums", c->name, c->snr_db,
+				res.sync_ms == UINT32_MAX ? -1L : (long)res.sync_ms, (unsigned long)c->sync_ms_max);
+		HOSTTEST_CHECK(res.ber <= c->ber_max, "%s %.0fdB: BER %.5f above %.5f", c->name, c->snr_db, res.ber, c->ber_max);
+		if (c->ber_coded_max > 0)
+		{
+			HOSTTEST_CHECK(res.ber_coded <= c->ber_coded_max, "%s %.0fdB: coded BER %.5f above %.5f", c->name, c->snr_db,
+					res.ber_coded, c->ber_coded_max);
+		}
+	}
+
+	return hosttest_result();
+}
@@ -0,0 +1,395 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+/*
+ * FT8 receiver test: slots with several FT8 signals in white noise are fed to the decoder the way the
+ * radio does it, 12ksps audio blocks into Ft8_RxProcessor() and Ft8_HandleDecoder() from the "main loop",
+ * the slot timing comes from the simulated system tick.
+ *
+ * The transmitter is independent of ft8.c: message packing, CRC-14, LDPC encoding with the generator
+ * matrix of the FT8 protocol description, Gray mapping, Costas arrays and continuous phase 8-FSK.
+ * All messages, also those with +-1.9s clock error, have to be decoded with the right text, frequency, time offset and SNR estimate,
+ * a slot with noise only must not give any decode.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "uhsdr_board.h"
+#include "uhsdr_rtc.h"
+#include "ft8.h"
+#include "hosttest.h"
+
+#define FT8_TEST_FS				12000
+#define FT8_TEST_BLOCK			32 // audio block size of the decimated RX path
+#define FT8_TEST_SYMBOL_SAMPLES	1920
+#define FT8_TEST_TONE_SPACING	6.25
+#define FT8_TEST_NUM_SYMBOLS	79
+#define FT8_TEST_NOISE_SIGMA	1000.0
+
+#define FT8_TEST_FREQ_ERR_MAX	3.7 // Hz, one waterfall bin plus rounding, a neighbour bin may win the sync search
+#define FT8_TEST_DT_ERR_MAX		0.09 // s, about one waterfall step
+#define FT8_TEST_SNR_ERR_MAX	4 // dB
+
+typedef struct
+{
+	const char* text;		// as unpacked by the decoder
+	uint8_t i3;				// 1: standard message, 0: free text
+	float freq;				// Hz, tone 0
+	float dt;				// s, relative to 0.5s into the slot
+	float snr_db;			// in 2500Hz, as used by WSJT-X
+} ft8_test_signal_t;
+
+// one slot with signals of different SNR, frequency and time offset
+static const ft8_test_signal_t ft8_test_signals[] =
+{
+	{ "CQ K1ABC FN42",      1, 1000.0,  0.0, -10 },
+	{ "W9XYZ K1ABC -11",    1, 1503.1,  0.3, -15 },
+	{ "K1ABC W9XYZ R-09",   1, 2200.0, -0.2,  -5 },
+	{ "DL1ABC W9XYZ RR73",  1,  650.0,  0.1,   5 },
+	{ "TNX BOB 73 GL",      0, 2650.0,  0.0, -12 },
+	// clock errors at the edge of the search range, the first or last Costas array is outside the waterfall
+	{ "K9AN W1AW FN31",     1, 1800.0, -1.9,  -8 },
+	{ "W1AW K9AN R-08",     1,  400.0,  1.9,  -8 },
+};
+
+#define FT8_TEST_SIGNALS (sizeof(ft8_test_signals)/sizeof(ft8_test_signals[0]))
+
+// generator matrix of the (174,91) LDPC code, 83 rows of 91 bits (MSB first, 92 bits in hex)
+static const char* const ft8_test_generator[83] =
+{
+	"8329ce11bf31eaf509f27fc", "761c264e25c259335493132", "dc265902fb277c6410a1bdc",
+	"1b3f417858cd2dd33ec7f62", "09fda4fee04195fd034783a", "077cccc11b8873ed5c3d48a",
+	"29b62afe3ca036f4fe1a9da", "6054faf5f35d96d3b0c8c3e", "e20798e4310eed27884ae90",
+	"775c9c08e80e26ddae56318", "b0b811028c2bf997213487c", "18a0c9231fc60adf5c5ea32",
+	"76471e8302a0721e01b12b8", "ffbccb80ca8341fafb47b2e", "66a72a158f9325a2bf67170",
+	"c4243689fe85b1c51363a18", "0dff739414d1a1b34b1c270", "15b48830636c8b99894972e",
+	"29a89c0d3de81d665489b0e", "4f126f37fa51cbe61bd6b94", "99c47239d0d97d3c84e0940",
+	"1919b75119765621bb4f1e8", "09db12d731faee0b86df6b8", "488fc33df43fbdeea4eafb4",
+	"827423ee40b675f756eb5fe", "abe197c484cb74757144a9a", "2b500e4bc0ec5a6d2bdbdd0",
+	"c474aa53d70218761669360", "8eba1a13db3390bd6718cec", "753844673a27782cc42012e",
+	"06ff83a145c37035a5c1268", "3b37417858cc2dd33ec3f62", "9a4a5a28ee17ca9c324842c",
+	"bc29f465309c977e89610a4", "2663ae6ddf8b5ce2bb29488", "46f231efe457034c1814418",
+	"3fb2ce85abe9b0c72e06fbe", "de87481f282c153971a0a2e", "fcd7ccf23c69fa99bba1412",
+	"f0261447e9490ca8e474cec", "4410115818196f95cdd7012", "088fc31df4bfbde2a4eafb4",
+	"b8fef1b6307729fb0a078c0", "5afea7acccb77bbc9d99a90", "49a7016ac653f65ecdc9076",
+	"1944d085be4e7da8d6cc7d0", "251f62adc4032f0ee714002", "56471f8702a0721e00b12b8",
+	"2b8e4923f2dd51e2d537fa0", "6b550a40a66f4755de95c26", "a18ad28d4e27fe92a4f6c84",
+	"10c2e586388cb82a3d80758", "ef34a41817ee02133db2eb0", "7e9c0c54325a9c15836e000",
+	"3693e572d1fde4cdf079e86", "bfb2cec5abe1b0c72e07fbe", "7ee18230c583cccc57d4b08",
+	"a066cb2fedafc9f52664126", "bb23725abc47cc5f4cc4cd2", "ded9dba3bee40c59b5609b4",
+	"d9a7016ac653e6decdc9036", "9ad46aed5f707f280ab5fc4", "e5921c77822587316d7d3c2",
+	"4f14da8242a8b86dca73352", "8b8b507ad467d4441df770e", "22831c9cf1169467ad04b68",
+	"213b838fe2ae54c38ee7180", "5d926b6dd71f085181a4e12", "66ab79d4b29ee6e69509e56",
+	"958148682d748a38dd68baa", "b8ce020cf069c32a723ab14", "f4331d6d461607e95752746",
+	"6da23ba424b9596133cf9c8", "a636bcbc7b30c5fbeae67fe", "5cb0d86a07df654a9089a20",
+	"f11f106848780fc9ecdd80a", "1fbb5364fb8d2c9d730d5ba", "fcb86bc70a50c9d02a5d034",
+	"a534433029eac15f322e34c", "c989d9c7c3d3b8c55d75130", "7bb38b2f0186d46643ae962",
+	"2644ebadeb44b9467d1f42c", "608cc857594bfbb55d69600",
+};
+
+static const uint8_t ft8_test_costas[7] = { 3, 1, 4, 0, 6, 5, 2 };
+static const uint8_t ft8_test_graymap[8] = { 0, 1, 3, 2, 5, 6, 4, 7 };
+
+// stubs, the RTC is not used as ts.rtc_present is false
+RTC_HandleTypeDef hrtc;
+void Rtc_GetTime(RTC_HandleTypeDef* hrtc, RTC_TimeTypeDef* sTime, uint32_t Format)
+{
+	memset(sTime, 0, sizeof(*sTime));
+}
+
+#define FT8_TEST_TEXT_MAX		1024
+
+static char ft8_test_text[FT8_TEST_TEXT_MAX];
+static int ft8_test_text_len;
+
+// the decoder prints each message as a line of the text display through this function
+void UiDriver_TextMsgPutChar(char ch)
+{
+	if (ft8_test_text_len < FT8_TEST_TEXT_MAX - 1)
+	{
+		ft8_test_text[ft8_test_text_len++] = ch;
+	}
+}
+
+static void Ft8Test_PutBits(uint8_t* bits, int start, int len, uint32_t val)
+{
+	for (int i = 0; i < len; i++)
+	{
+		bits[start + i] = (val >> (len - 1 - i)) & 1;
+	}
+}
+
+static int Ft8Test_CharIndex(const char* set, char c)
+{
+	const char* p = strchr(set, c);
+	return p != NULL && c != '\0' ? p - set : -1;
+}
+
+/**
+ * @brief 28 bit field of a standard callsign (digit in the 2nd or 3rd position) or CQ
+ */
+static uint32_t Ft8Test_PackCall(const char* call)
+{
+	uint32_t retval = 2; // CQ
+
+	if (strcmp(call, "CQ") != 0)
+	{
+		// aligned so that the digit is the third character, padded with spaces to 6
+		char c[7] = "      ";
+		const int offset = (call[2] >= '0' && call[2] <= '9') ? 0 : 1;
+		memcpy(&c[offset], call, strlen(call));
+
+		uint32_t n = Ft8Test_CharIndex(" 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ", c[0]);
+		n = n * 36 + Ft8Test_CharIndex("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ", c[1]);
+		n = n * 10 + (c[2] - '0');
+		for (int i = 3; i < 6; i++)
+		{
+			n = n * 27 + Ft8Test_CharIndex(" ABCDEFGHIJKLMNOPQRSTUVWXYZ", c[i]);
+		}
+		retval = 2063592 + 4194304 + n; // NTOKENS + MAX22 + n
+	}
+	return retval;
+}
+
+/**
+ * @brief packs "CALL1 CALL2 EXTRA" (i3=1, EXTRA is a grid, report, R+report, RRR, RR73 or 73) or free text (i3=0)
+ */
+static void Ft8Test_Pack(const ft8_test_signal_t* sig, uint8_t* bits)
+{
+	memset(bits, 0, 77);
+
+	if (sig->i3 == 0)
+	{
+		// 13 characters base 42, first character most significant
+		unsigned __int128 n = 0;
+		char text[14];
+		snprintf(text, sizeof(text), "%-13s", sig->text);
+		for (int i = 0; i < 13; i++)
+		{
+			n = n * 42 + Ft8Test_CharIndex(" 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ+-./?", text[i]);
+		}
+		for (int i = 0; i < 71; i++)
+		{
+			bits[70 - i] = (n >> i) & 1;
+		}
+		// n3 = 0, i3 = 0
+	}
+	else
+	{
+		char call1[12], call2[12], extra[8] = "";
+		sscanf(sig->text, "%11s %11s %7s", call1, call2, extra);
+
+		uint32_t igrid4;
+		bool ir = false;
+		const char* e = extra;
+		if (e[0] == 'R' && (e[1] == '+' || e[1] == '-'))
+		{
+			ir = true;
+			e++;
+		}
+		if (strcmp(e, "RRR") == 0)
+		{
+			igrid4 = 32400 + 2;
+		}
+		else if (strcmp(e, "RR73") == 0)
+		{
+			igrid4 = 32400 + 3;
+		}
+		else if (strcmp(e, "73") == 0)
+		{
+			igrid4 = 32400 + 4;
+		}
+		else if (e[0] == '+' || e[0] == '-')
+		{
+			igrid4 = 32400 + 35 + atoi(e);
+		}
+		else
+		{
+			igrid4 = ((e[0] - 'A') * 18 + (e[1] - 'A')) * 100 + (e[2] - '0') * 10 + (e[3] - '0');
+		}
+
+		Ft8Test_PutBits(bits, 0, 28, Ft8Test_PackCall(call1));
+		Ft8Test_PutBits(bits, 29, 28, Ft8Test_PackCall(call2));
+		bits[58] = ir;
+		Ft8Test_PutBits(bits, 59, 15, igrid4);
+		Ft8Test_PutBits(bits, 74, 3, sig->i3);
+	}
+}
+
+/**
+ * @brief 79 tones of a message: CRC-14, LDPC (174,91), Gray coded 8-FSK with Costas arrays at symbols 0, 36 and 72
+ */
+static void Ft8Test_Encode(const ft8_test_signal_t* sig, uint8_t* tones)
+{
+	uint8_t cw[174];
+	Ft8Test_Pack(sig, cw);
+
+	// CRC-14 (poly 0x2757) over the 77 message bits extended with 5 zero bits
+	uint16_t crc = 0;
+	for (int i = 0; i < 82; i++)
+	{
+		const uint16_t feedback = ((crc >> 13) & 1) ^ (i < 77 ? cw[i] : 0);
+		crc = (crc << 1) & 0x3fff;
+		crc ^= feedback ? 0x2757 : 0;
+	}
+	Ft8Test_PutBits(cw, 77, 14, crc);
+
+	for (int row = 0; row < 83; row++)
+	{
+		uint8_t parity = 0;
+		for (int j = 0; j < 91; j++)
+		{
+			const char h = ft8_test_generator[row][j / 4];
+			const int digit = h <= '9' ? h - '0' : h - 'a' + 10;
+			parity ^= ((digit >> (3 - j % 4)) & 1) & cw[j];
+		}
+		cw[91 + row] = parity;
+	}
+
+	for (int sym = 0, data = 0; sym < FT8_TEST_NUM_SYMBOLS; sym++)
+	{
+		if (sym % 36 < 7)
+		{
+			tones[sym] = ft8_test_costas[sym % 36];
+		}
+		else
+		{
+			tones[sym] = ft8_test_graymap[cw[3 * data] << 2 | cw[3 * data + 1] << 1 | cw[3 * data + 2]];
+			data++;
+		}
+	}
+}
+
+typedef struct
+{
+	uint8_t tones[FT8_TEST_NUM_SYMBOLS];
+	int32_t start;			// sample of the first symbol, relative to the slot start
+	float amplitude;
+	float freq;
+	double phase;
+} ft8_test_tx_t;
+
+/**
+ * @brief runs audio from 1s before the slot start until the decoder is done with the slot
+ * @param txs signals sent in this slot, may be empty
+ */
+static void Ft8Test_RunSlot(ft8_test_tx_t* txs, int num_tx)
+{
+	static uint32_t sample; // slots follow each other, the tick never jumps back
+	if (sample == 0)
+	{
+		sample = 14 * FT8_TEST_FS;
+	}
+	const uint32_t slot_start = (sample / (15 * FT8_TEST_FS) + 1) * 15 * FT8_TEST_FS;
+	const uint32_t slot_count = ft8_result.slot_count;
+
+	while (ft8_result.slot_count == slot_count && sample < slot_start + 15 * FT8_TEST_FS)
+	{
+		float block[FT8_TEST_BLOCK];
+		for (int i = 0; i < FT8_TEST_BLOCK; i++, sample++)
+		{
+			float s = FT8_TEST_NOISE_SIGMA * hosttest_gauss();
+			const int32_t pos = (int32_t)(sample - slot_start);
+			for (int idx = 0; idx < num_tx; idx++)
+			{
+				ft8_test_tx_t* tx = &txs[idx];
+				const int32_t sym = pos >= tx->start ? (pos - tx->start) / FT8_TEST_SYMBOL_SAMPLES : -1;
+				if (sym >= 0 && sym < FT8_TEST_NUM_SYMBOLS)
+				{
+					tx->phase += 2 * M_PI * (tx->freq + tx->tones[sym] * FT8_TEST_TONE_SPACING) / FT8_TEST_FS;
+					s += tx->amplitude * sin(tx->phase);
+				}
+			}
+			block[i] = s;
+		}
+		Ft8_RxProcessor(block, FT8_TEST_BLOCK);
+
+		hosttest_tick_ms = (uint64_t)sample * 1000 / FT8_TEST_FS;
+		// the main loop comes around several times per audio block
+		for (int i = 0; i < 4; i++)
+		{
+			Ft8_HandleDecoder();
+		}
+	}
+	// the next slot starts on a slot boundary again
+	sample = slot_start + 14 * FT8_TEST_FS;
+
+	HOSTTEST_CHECK(ft8_result.slot_count == slot_count + 1, "no decode result for slot at %us", slot_start / FT8_TEST_FS);
+}
+
+static void Ft8Test_Signals(void)
+{
+	ft8_test_tx_t txs[FT8_TEST_SIGNALS];
+	// noise power in 2500Hz of the white noise spread over fs/2
+	const float noise_2500 = FT8_TEST_NOISE_SIGMA * FT8_TEST_NOISE_SIGMA * 2500 / (FT8_TEST_FS / 2);
+
+	for (int idx = 0; idx < FT8_TEST_SIGNALS; idx++)
+	{
+		const ft8_test_signal_t* sig = &ft8_test_signals[idx];
+		Ft8Test_Encode(sig, txs[idx].tones);
+		txs[idx].start = (0.5 + sig->dt) * FT8_TEST_FS;
+		txs[idx].amplitude = sqrtf(2 * noise_2500 * powf(10, sig->snr_db / 10));
+		txs[idx].freq = sig->freq;
+		txs[idx].phase = 0;
+	}
+
+	Ft8Test_RunSlot(txs, FT8_TEST_SIGNALS);
+	printf("text display:%s\n\n", ft8_test_text);
+
+	for (int idx = 0; idx < FT8_TEST_SIGNALS; idx++)
+	{
+		const ft8_test_signal_t* sig = &ft8_test_signals[idx];
+		const ft8_message_t* msg = NULL;
+		for (int i = 0; i < ft8_result.count; i++)
+		{
+			if (strcmp(ft8_result.messages[i].text, sig->text) == 0)
+			{
+				msg = &ft8_result.messages[i];
+			}
+		}
+
+		if (msg != NULL)
+		{
+			printf("%-18s %4.0fdB %7.1fHz %5.2fs | %4ddB %5uHz %5.2fs\n", sig->text, sig->snr_db, sig->freq, sig->dt, msg->snr, msg->freq,
+					msg->dt);
+			HOSTTEST_CHECK(fabsf(msg->freq - sig->freq) <= FT8_TEST_FREQ_ERR_MAX, "%s: %uHz instead of %.1fHz", sig->text, msg->freq, sig->freq);
+			HOSTTEST_CHECK(fabsf(msg->dt - sig->dt) <= FT8_TEST_DT_ERR_MAX, "%s: dt %.2fs instead of %.2fs", sig->text, msg->dt, sig->dt);
+			HOSTTEST_CHECK(fabsf(msg->snr - sig->snr_db) <= FT8_TEST_SNR_ERR_MAX, "%s: SNR %ddB instead of %.0fdB", sig->text, msg->snr,
+					sig->snr_db);
+		}
+		else
+		{
+			printf("%-18s %4.0fdB %7.1fHz %5.2fs | not decoded\n", sig->text, sig->snr_db, sig->freq, sig->dt);
+		}
+		HOSTTEST_CHECK(msg != NULL, "%s not decoded", sig->text);
+		HOSTTEST_CHECK(strstr(ft8_test_text, sig->text) != NULL, "%s not on the text display", sig->text);
+	}
+	HOSTTEST_CHECK(ft8_result.count == FT8_TEST_SIGNALS, "%u messages decoded, %u sent", ft8_result.count, (unsigned int)FT8_TEST_SIGNALS);
+	HOSTTEST_CHECK(ft8_result.overruns == 0, "%lu overruns", (unsigned long)ft8_result.overruns);
+}
+
+static void Ft8Test_NoiseOnly(void)
+{
+	Ft8Test_RunSlot(NULL, 0);
+	printf("noise only: %u messages decoded\n", ft8_result.count);
+	HOSTTEST_CHECK(ft8_result.count == 0, "%u messages decoded from noise", ft8_result.count);
+}
+
+int main(void)
+{
+	hosttest_seed(30);
+	Ft8_Decoder_Init();
+
+	Ft8Test_Signals();
+	Ft8Test_NoiseOnly();
+
+	return hosttest_result();
+}
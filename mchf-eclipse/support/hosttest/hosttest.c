@@ -0,0 +1,76 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+#include <math.h>
+#include "uhsdr_board.h"
+#include "audio_driver.h"
+#include "hosttest.h"
+
+// firmware globals which are normally defined in uhsdr_board.c and audio_driver.c
+__IO TransceiverState ts;
+AudioDriverState ads;
+
+int hosttest_failures;
+uint32_t hosttest_tick_ms;
+
+static uint32_t hosttest_rng_state = 1;
+
+void hosttest_seed(uint32_t seed)
+{
+	hosttest_rng_state = seed ? seed : 1;
+}
+
+/**
+ * @brief xorshift32, good enough for noise and keying jitter and the same on every host
+ */
+uint32_t hosttest_rand(void)
+{
+	uint32_t x = hosttest_rng_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	hosttest_rng_state = x;
+	return x;
+}
+
+float hosttest_uniform(void)
+{
+	return (hosttest_rand() >> 8) * (1.0f / 16777216.0f);
+}
+
+float hosttest_gauss(void)
+{
+	// Box-Muller, the second value is thrown away to keep the generator stateless
+	const float u1 = 1.0f - hosttest_uniform(); // (0,1]
+	const float u2 = hosttest_uniform();
+	return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+uint32_t HAL_GetTick(void)
+{
+	return hosttest_tick_ms;
+}
+
+/**
+ * @brief C version of the CMSIS assembler function in arm_bitreversal2.S, called by arm_cfft_f32()
+ */
+void arm_bitreversal_32(uint32_t* pSrc, const uint16_t bitRevLen, const uint16_t* pBitRevTab)
+{
+	for (uint32_t i = 0; i < bitRevLen; i += 2)
+	{
+		const uint32_t a = pBitRevTab[i] >> 2;
+		const uint32_t b = pBitRevTab[i + 1] >> 2;
+		uint32_t tmp = pSrc[a];
+		pSrc[a] = pSrc[b];
+		pSrc[b] = tmp;
+		tmp = pSrc[a + 1];
+		pSrc[a + 1] = pSrc[b + 1];
+		pSrc[b + 1] = tmp;
+	}
+}
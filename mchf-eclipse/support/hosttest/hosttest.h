@@ -0,0 +1,68 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+/*
+ * Helpers shared by the off target tests in support/hosttest.
+ *
+ * The tests link unchanged firmware sources, the few firmware globals and HAL functions
+ * they reach are provided by hosttest.c.
+ */
+
+#ifndef __HOSTTEST_H
+#define __HOSTTEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+extern int hosttest_failures;
+
+/**
+ * @brief counts and reports a failed check, the test keeps running so that all results are printed
+ */
+#define HOSTTEST_CHECK(cond, ...) do { \
+		if (!(cond)) \
+		{ \
+			hosttest_failures++; \
+			printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+		} \
+	} while (0)
+
+/**
+ * @returns exit code for main(), 0 if all checks passed
+ */
+static inline int hosttest_result(void)
+{
+	printf("%s: %d failed checks\n", hosttest_failures ? "FAILED" : "PASSED", hosttest_failures);
+	return hosttest_failures != 0;
+}
+
+// reproducible random numbers, every test seeds explicitly so results don't change between runs
+void hosttest_seed(uint32_t seed);
+uint32_t hosttest_rand(void);
+float hosttest_uniform(void); // [0,1)
+float hosttest_gauss(void); // mean 0, variance 1
+
+// simulated system tick returned by HAL_GetTick(), advanced by the tests
+extern uint32_t hosttest_tick_ms;
+
+/**
+ * @returns monotonic time in seconds, for the throughput figures
+ */
+static inline double hosttest_seconds(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+#endif
@@ -0,0 +1,167 @@
+/*  -*-  mode: c; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4; coding: utf-8  -*-  */
+/************************************************************************************
+**                                                                                 **
+**                               UHSDR FIRMWARE                                    **
+**                                                                                 **
+**---------------------------------------------------------------------------------**
+**  Licence:		GNU GPLv3, see LICENSE.md                                                      **
+************************************************************************************/
+
+/*
+ * Checks the table based log2/exp2 functions of uhsdr_math.c against libm (in double precision).
+ *
+ * log2: the error is at most 4e-7 plus one ulp of the result. The second part is the rounding of
+ * exponent + table value + polynomial and dominates for large exponents (~7.6e-6 for results near +-127).
+ * exp2: relative error below 3e-7.
+ * The block functions have to deliver the same values as the scalar ones, also for the
+ * samples handled outside the 4x unrolled loop.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "uhsdr_math.h"
+#include "hosttest.h"
+
+#define MATH_TEST_VALUES		2000000
+#define MATH_TEST_BLOCK			1023 // not a multiple of 4, the tail loop is tested too
+
+#define MATH_LOG2_ABS_MAX		4e-7
+#define MATH_EXP2_REL_MAX		3e-7
+#define MATH_DB_ABS_MAX			6e-5 // 10*log10(2) * (4e-7 + 1 ulp of 127) plus 1 ulp of the result near 380dB
+
+/**
+ * @returns distance between |r| and the next larger float, i.e. one ulp of the float result
+ */
+static double MathTest_Ulp(double r)
+{
+	const float a = fabs(r);
+	return nextafterf(a, INFINITY) - a;
+}
+
+/**
+ * @returns random positive normal number, either log uniform over the whole float range or near 1
+ */
+static float MathTest_RandomPositive(uint32_t i)
+{
+	return (i & 1) ? exp2f(-126 + 253 * hosttest_uniform()) : 0.5f + 1.5f * hosttest_uniform();
+}
+
+static void MathTest_Log2(void)
+{
+	double max_near_one = 0; // results with |log2| < 1
+	double max_abs = 0;
+	double max_excess = 0; // largest error relative to the allowed bound
+
+	for (uint32_t i = 0; i < MATH_TEST_VALUES; i++)
+	{
+		const float x = MathTest_RandomPositive(i);
+		const double ref = log2((double)x);
+		const double err = fabs(Math_log2f_fast(x) - ref);
+		const double bound = MATH_LOG2_ABS_MAX + MathTest_Ulp(ref);
+
+		if (fabs(ref) < 1 && err > max_near_one)
+		{
+			max_near_one = err;
+		}
+		if (err > max_abs)
+		{
+			max_abs = err;
+		}
+		if (err / bound > max_excess)
+		{
+			max_excess = err / bound;
+		}
+		// the sign is ignored
+		HOSTTEST_CHECK(Math_log2f_fast(-x) == Math_log2f_fast(x), "log2(-%g) differs from log2(%g)", x, x);
+	}
+	printf("log2:  abs. error %.2g for |result| < 1, %.2g overall, %.2f of the bound 4e-7 + 1 ulp\n", max_near_one, max_abs, max_excess);
+	HOSTTEST_CHECK(max_near_one <= MATH_LOG2_ABS_MAX, "log2 error near 1 %g above %g", max_near_one, MATH_LOG2_ABS_MAX);
+	HOSTTEST_CHECK(max_excess <= 1.0, "log2 error above 4e-7 + 1 ulp of the result");
+
+	const double log10_err = fabs(Math_log10f_fast(1000.0f) - 3.0);
+	HOSTTEST_CHECK(log10_err < 1e-6, "log10(1000) off by %g", log10_err);
+}
+
+static void MathTest_Exp2(void)
+{
+	double max_rel = 0;
+
+	for (uint32_t i = 0; i < MATH_TEST_VALUES; i++)
+	{
+		const float x = -126 + 253 * hosttest_uniform();
+		const double ref = exp2((double)x);
+		const double rel = fabs(Math_exp2f_fast(x) - ref) / ref;
+		if (rel > max_rel)
+		{
+			max_rel = rel;
+		}
+	}
+	printf("exp2:  rel. error %.2g\n", max_rel);
+	HOSTTEST_CHECK(max_rel <= MATH_EXP2_REL_MAX, "exp2 rel. error %g above %g", max_rel, MATH_EXP2_REL_MAX);
+
+	HOSTTEST_CHECK(Math_exp2f_fast(-127.0f) == 0.0f, "exp2(-127) is not 0");
+	HOSTTEST_CHECK(Math_exp2f_fast(200.0f) == exp2f(127.0f), "exp2(200) is not limited to 2^127");
+	HOSTTEST_CHECK(Math_exp2f_fast(3.0f) == 8.0f, "exp2(3) is not exact");
+}
+
+static void MathTest_Blocks(void)
+{
+	static float32_t src[MATH_TEST_BLOCK], dst[MATH_TEST_BLOCK];
+	double max_db = 0, max_exp_rel = 0;
+	uint32_t block_mismatch = 0;
+
+	for (int run = 0; run < MATH_TEST_VALUES / MATH_TEST_BLOCK; run++)
+	{
+		for (int i = 0; i < MATH_TEST_BLOCK; i++)
+		{
+			src[i] = MathTest_RandomPositive(i);
+		}
+
+		// power to dB, as used by the spectrum display
+		Math_powerdBf_fast_block(src, dst, MATH_TEST_BLOCK);
+		for (int i = 0; i < MATH_TEST_BLOCK; i++)
+		{
+			const double err = fabs(dst[i] - 10 * log10((double)src[i]));
+			max_db = err > max_db ? err : max_db;
+		}
+
+		// scale and offset are applied the same way as by the scalar function
+		Math_log2f_fast_block(src, dst, 0.5f, -3.0f, MATH_TEST_BLOCK);
+		for (int i = 0; i < MATH_TEST_BLOCK; i++)
+		{
+			block_mismatch += dst[i] != -3.0f + 0.5f * Math_log2f_fast(src[i]);
+		}
+
+		// exp(), as used by the noise reduction, src and dst being the same buffer
+		for (int i = 0; i < MATH_TEST_BLOCK; i++)
+		{
+			src[i] = -80 + 160 * hosttest_uniform();
+		}
+		memcpy(dst, src, sizeof(dst));
+		Math_expf_fast_block(dst, dst, MATH_TEST_BLOCK);
+		for (int i = 0; i < MATH_TEST_BLOCK; i++)
+		{
+			const double ref = exp((double)src[i]);
+			const double rel = fabs(dst[i] - ref) / ref;
+			max_exp_rel = rel > max_exp_rel ? rel : max_exp_rel;
+			block_mismatch += dst[i] != Math_exp2f_fast(src[i] * MATH_LOG2_E);
+		}
+	}
+	printf("block: power to dB abs. error %.2g dB, exp rel. error %.2g\n", max_db, max_exp_rel);
+	HOSTTEST_CHECK(max_db <= MATH_DB_ABS_MAX, "power to dB error %g above %g", max_db, MATH_DB_ABS_MAX);
+	// the scaling of the argument adds up to |x*log2(e)| * 2^-24 relative error, 8e-6 for x = 80
+	HOSTTEST_CHECK(max_exp_rel <= 1e-5, "exp rel. error %g above 1e-5", max_exp_rel);
+	HOSTTEST_CHECK(block_mismatch == 0, "%u block results differ from the scalar functions", block_mismatch);
+}
+
+int main(void)
+{
+	hosttest_seed(49);
+
+	MathTest_Log2();
+	MathTest_Exp2();
+	MathTest_Blocks();
+
+	return hosttest_result();
+}
@@ -42,6 +42,12 @@ class CatCmd(CatCmdFt817):
     """
     this will return the bytes ['U', 'H' , 'S', 'D', 'R' ] and is used to identify an UHSDR with high enough firmware level
     """
+
+    UHSDR_SPECTRUM_STREAM = 0x46
+    """
+    start/stop the spectrum stream, first byte max. frames per second (0 = stop), second byte bin reduction (2^n bins merged into one)
+    returns accepted frame rate and number of bins per frame (2 bytes, little endian)
+    """
     
 class UhsdrConfigIndex:
     """
@@ -104,9 +110,22 @@ class catCommands:
         cmd = bytearray([ 0x00, 0x00 , 0x00, 0x00, CatCmd.UHSDR_ID])
         ok,res = self.execute(cmd,5)
 
-        return res == bytearray("UHSDR")
+        return res == bytearray(b"UHSDR")
    
 
+    def setSpectrumStream(self, fps, reduce = 0):
+        """
+        start (fps > 0) or stop (fps = 0) the spectrum stream
+        returns tuple (ok, accepted frame rate, bins per frame)
+        when stopping a running stream, the answer may be preceded by frame data, flush the input instead of relying on it
+        """
+        cmd = bytearray([ fps & 0xff, reduce & 0xff, 0x00, 0x00, CatCmd.UHSDR_SPECTRUM_STREAM])
+        ok,res = self.execute(cmd,3)
+        if ok:
+            return True,res[0],res[1] + res[2] * 256
+        else:
+            return False,0,0
+
     def writeEEPROM(self, addr, value16bit):
         cmd = bytearray([ (addr & 0xff00)>>8,addr & 0xff, (value16bit & 0xff) >> 0, (value16bit & 0xff00) >> 8, CatCmd.WRITE_EEPROM])
         ok,res = self.execute(cmd,1)
@@ -217,3 +236,85 @@ class UhsdrConfig():
             retval = False
         return retval,retmsg
 
+
+class UhsdrSpectrumStream:
+    """
+    Decoder for the spectrum stream frames the TRX sends on the CAT serial port after
+    catCommands.setSpectrumStream(), see UiSpectrum_StreamFrame() in the firmware for the format.
+    Feed it with whatever the serial port returns, it hands out complete frames
+    and resynchronizes on garbage (e.g. CAT answers) by searching the next 'US' header with valid checksum
+    """
+    HEADER_LEN = 18
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.bins = []          # current bins as codes, valid after the first key frame
+        self.seq = None
+        self.lost = 0           # frames missing in the sequence
+        self.errors = 0         # bytes skipped while searching the next frame
+
+    def _apply(self, ftype, nbins, payload):
+        if ftype == ord('K'):
+            self.bins = list(payload)
+            return True
+        if len(self.bins) != nbins:
+            return False        # delta without a key frame before, wait for the next key frame
+        idx = 0
+        for b in payload:
+            if b & 0x80:
+                idx += (b & 0x7f) + 1
+            elif idx < nbins:
+                self.bins[idx] += b - 0x80 if b & 0x40 else b
+                idx += 1
+        return True
+
+    def feed(self, data):
+        """
+        returns list of decoded frames as dictionaries with keys
+        center, span (Hz), seq, key (True for key frames) and db (list of bin levels in dB, lowest frequency first)
+        """
+        self.buf += data
+        frames = []
+        while True:
+            start = self.buf.find(b'US')
+            if start < 0:
+                self.errors += max(0, len(self.buf) - 1)
+                del self.buf[:-1]
+                break
+            if start > 0:
+                self.errors += start
+                del self.buf[:start]
+            if len(self.buf) < self.HEADER_LEN:
+                break
+            b = self.buf
+            ftype = b[2]
+            length = b[16] + b[17] * 256
+            nbins = b[12] + b[13] * 256
+            if ftype not in (ord('K'), ord('D')) or length > 4096 or nbins > 4096:
+                del self.buf[:1]
+                self.errors += 1
+                continue
+            if len(b) < self.HEADER_LEN + length + 1:
+                break
+            if sum(b[:self.HEADER_LEN + length]) & 0xff != b[self.HEADER_LEN + length]:
+                del self.buf[:1]
+                self.errors += 1
+                continue
+
+            seq = b[3]
+            center = b[4] + (b[5] << 8) + (b[6] << 16) + (b[7] << 24)
+            span = b[8] + (b[9] << 8) + (b[10] << 16) + (b[11] << 24)
+            ref = b[14] + b[15] * 256
+            if ref >= 0x8000:
+                ref -= 0x10000
+            payload = bytearray(b[self.HEADER_LEN:self.HEADER_LEN + length])
+            del self.buf[:self.HEADER_LEN + length + 1]
+
+            if self.seq is not None:
+                self.lost += (seq - self.seq - 1) & 0xff
+            self.seq = seq
+
+            if self._apply(ftype, nbins, payload):
+                frames.append({ 'center' : center, 'span' : span, 'seq' : seq, 'key' : ftype == ord('K'),
+                                'db' : [ (ref + code) / 2.0 for code in self.bins ] })
+        return frames
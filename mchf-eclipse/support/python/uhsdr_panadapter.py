@@ -0,0 +1,149 @@
+"""
+This module contains a small panadapter display for the spectrum stream
+of an UHSDR TRX (CAT command UHSDR_SPECTRUM_STREAM) on a PC.
+
+Shows spectrum and waterfall using matplotlib, or a simple text line per
+frame if matplotlib is not available or --text is given.
+
+This program is free software: you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation, either version 3 of the License, or (at your option) any later
+version.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+You should have received a copy of the GNU General Public License along with
+this program. If not, see <http://www.gnu.org/licenses/>.
+"""
+
+from __future__ import print_function
+
+__author__ = "UHSDR project"
+__copyright__ = "Copyright 2018, UHSDR project"
+__license__ = "GPLv3"
+__status__ = "Prototype"
+
+import sys
+import os
+import uhsdr
+
+WATERFALL_LINES = 200
+TEXT_LEVELS = " .:-=+*#%@"
+
+def textLine(frame, width):
+    """
+    one line of characters, each character the strongest bin of its part of the spectrum
+    """
+    db = frame['db']
+    step = max(1, len(db) // width)
+    cols = [ max(db[idx:idx + step]) for idx in range(0, len(db), step) ]
+    low = min(cols)
+    high = max(max(cols), low + 1)
+    chars = [ TEXT_LEVELS[min(len(TEXT_LEVELS) - 1, int((val - low) * len(TEXT_LEVELS) / (high - low)))] for val in cols ]
+    return "{:10.3f} kHz {}".format(frame['center'] / 1000.0, "".join(chars))
+
+def runText(stream, port):
+    while True:
+        for frame in stream.feed(port.read(4096)):
+            print(textLine(frame, 100))
+
+def runPlot(stream, port):
+    import numpy as np
+    import matplotlib.pyplot as plt
+
+    plt.ion()
+    fig, (axSpec, axWfall) = plt.subplots(2, 1, sharex=True)
+    line = None
+    image = None
+    wfall = None
+
+    while plt.fignum_exists(fig.number):
+        frames = stream.feed(port.read(4096))
+        if frames == []:
+            plt.pause(0.01)
+            continue
+        for frame in frames:
+            db = np.array(frame['db'])
+            if wfall is None or wfall.shape[1] != len(db):
+                wfall = np.full((WATERFALL_LINES, len(db)), db.min())
+                line = None
+            wfall = np.roll(wfall, 1, axis=0)
+            wfall[0] = db
+
+        # only the last frame of a batch is drawn, matplotlib is slow
+        start = (frame['center'] - frame['span'] / 2.0) / 1000.0
+        stop = (frame['center'] + frame['span'] / 2.0) / 1000.0
+        freqs = np.linspace(start, stop, len(db), endpoint = False)
+        if line is None:
+            axSpec.clear()
+            axWfall.clear()
+            line, = axSpec.plot(freqs, db)
+            axSpec.set_ylabel("dB")
+            image = axWfall.imshow(wfall, aspect = 'auto', cmap = 'viridis', extent = (start, stop, WATERFALL_LINES, 0))
+            axWfall.set_xlabel("kHz")
+        line.set_data(freqs, db)
+        axSpec.set_xlim(start, stop)
+        axSpec.set_ylim(db.min() - 5, max(db.max(), db.min() + 30) + 5)
+        image.set_data(wfall)
+        image.set_extent((start, stop, WATERFALL_LINES, 0))
+        image.set_clim(np.percentile(wfall, 5), wfall.max())
+        axSpec.set_title("{:.3f} kHz  frame {}  lost {}".format(frame['center'] / 1000.0, frame['seq'], stream.lost))
+        plt.pause(0.001)
+
+def panadapterApp():
+    import serial
+    import argparse
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-p","--port", help="UHSDR serial port either by number (COM<num> in Windows, Linux /dev/ttyACM<num>) or full device name", type=str, default="0")
+    parser.add_argument("-r","--rate", help="max. frames per second (1-25)", type=int, default=10)
+    parser.add_argument("-m","--merge", help="merge 2^n bins into one (0-3)", type=int, default=0)
+    parser.add_argument("-t","--text", help="text output instead of matplotlib window", action="store_true")
+
+    args = parser.parse_args()
+
+    try:
+        int(args.port);
+        comPort= ("COM" if os.name == "nt" else "/dev/ttyACM") + str(args.port)
+    except:
+        comPort = args.port
+
+    uhsdr.eprint("Opening serial port ",comPort,":")
+    mySer = serial.Serial(comPort, 38400, timeout=0.100, parity=serial.PARITY_NONE)
+    myCAT = uhsdr.catCommands(uhsdr.catSerial(mySer))
+
+    # a stream left running by an earlier session would be mixed into the CAT answers
+    myCAT.setSpectrumStream(0)
+    mySer.reset_input_buffer()
+
+    if uhsdr.UhsdrConfig(myCAT).isUhsdrConnected() == False:
+        uhsdr.eprint("... could not find a connected UHSDR with extended CAT commands (required)")
+        mySer.close()
+        return
+
+    ok,rate,bins = myCAT.setSpectrumStream(args.rate, args.merge)
+    if ok == False or rate == 0:
+        uhsdr.eprint("... TRX did not start the spectrum stream, firmware too old?")
+        mySer.close()
+        return
+    uhsdr.eprint("... streaming {} bins with up to {} frames per second".format(bins, rate))
+
+    stream = uhsdr.UhsdrSpectrumStream()
+    try:
+        if args.text:
+            runText(stream, mySer)
+        else:
+            try:
+                runPlot(stream, mySer)
+            except ImportError:
+                uhsdr.eprint("matplotlib/numpy not available, using text output")
+                runText(stream, mySer)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        myCAT.setSpectrumStream(0)
+        mySer.close()
+
+
+if __name__ == "__main__":
+    panadapterApp()